@@ -128,7 +128,7 @@ namespace cli
             bool DoSoar(const char pOp = 0, const std::string* pArg1 = 0, const std::string* pArg2 = 0, const std::string* pArg3 = 0);
             bool DoSP(const std::string& production);
             bool DoSRand(uint32_t* pSeed = 0);
-            bool DoStats(const StatsBitset& options, int sort = 0);
+            bool DoStats(const StatsBitset& options, int sort = 0, const std::string* pPool = 0);
             bool DoSVS(const std::vector<std::string>& args);
             bool DoTrace(const WatchBitset& options, const WatchBitset& settings, const int wmeSetting, const int learnSetting, bool fromWatch);
             bool DoVisualize(const std::string* pArg = 0, const std::string* pArg2 = 0, const std::string* pArg3 = 0);
@@ -195,6 +195,7 @@ namespace cli
             bool AddSaveText(const char* pAddString);
             bool DoAddWME(const std::string& id, std::string attribute, const std::string& value, bool acceptable);
             bool DoAllocate(const std::string& pool, int blocks);
+            bool DoTrim();
             bool DoCaptureInput(eCaptureInputMode mode, bool autoflush = false, std::string* pathname = 0);
             bool DoCLog(const eLogMode mode = LOG_QUERY, const std::string* pFilename = 0, const std::string* pToAdd = 0, bool silent = false);
             bool DoCommandToFile(const eLogMode mode, const std::string& filename, std::vector< std::string >& argv);
@@ -203,8 +204,10 @@ namespace cli
             bool DoIndifferentSelection(const char pOp = 0, const std::string* p1 = 0, const std::string* p2 = 0, const std::string* p3 = 0);
             bool DoLoadLibrary(const std::string& libraryCommand);
             bool DoMatches(const eMatchesMode mode, const eWMEDetail detail = WME_DETAIL_NONE, const std::string* pProduction = 0);
+            bool DoMatchProfile(const eMatchProfileMode mode, int n = 0);
             bool DoMemories(const MemoriesBitset options, int n = 0, const std::string* pProduction = 0);
             bool DoMultiAttributes(const std::string* pAttribute = 0, int n = 0);
+            bool DoReorder(int n, int period = -1);
             bool DoNumericIndifferentMode(bool query, bool usesAvgNIM);
             bool DoPbreak(const char& mode, const std::string& production);
             bool DoPredict();
@@ -212,7 +215,8 @@ namespace cli
             bool DoPWatch(bool query = true, const std::string* pProduction = 0, bool setting = false);
             bool DoRemoveWME(uint64_t timetag);
             bool DoReplayInput(eReplayInputMode mode, std::string* pathname);
-            bool DoReteNet(bool save, std::string filename);
+            bool DoReteNet(bool save, std::string filename, bool compact = false);
+            bool DoReteNetCopy(const std::string& sourceAgentName);
             bool DoSelect(const std::string* pOp = 0);
             bool DoSource(std::string filename, SourceBitset* pOptions = 0);
             bool DoTime(std::vector<std::string>& argv);
@@ -227,8 +231,10 @@ namespace cli
             bool ParseFC(std::vector< std::string >& argv);
             bool ParseMemories(std::vector< std::string >& argv);
             bool ParseMatches(std::vector< std::string >& argv);
+            bool ParseMatchProfile(std::vector< std::string >& argv);
             bool ParseMultiAttributes(std::vector< std::string >& argv);
             bool ParsePBreak(std::vector< std::string >& argv);
+            bool ParseReorder(std::vector< std::string >& argv);
             bool ParsePFind(std::vector< std::string >& argv);
             bool ParsePWatch(std::vector< std::string >& argv);
             bool ParseReplayInput(std::vector< std::string >& argv);
@@ -283,6 +289,8 @@ namespace cli
             void GetMaxStats(); // for stats
             void GetReteStats(); // for stats
             void GetAgentStats(); // for stats
+            void GetMemoryPoolCounters(); // for stats
+            bool GetMemoryPoolHistory(const std::string& pool_name); // for stats
 
             bool Evaluate(const char* pInput); // source, formerly StreamSource
 
@@ -127,7 +127,7 @@ namespace cli
             }
             [[nodiscard]] const char* GetSyntax() const override
             {
-                return "Syntax: debug [ allocate | internal-symbols | port | time | ? ] [arguments*]";
+                return "Syntax: debug [ allocate | internal-symbols | port | time | trim | ? ] [arguments*]";
             }
 
             bool Parse(std::vector< std::string >& argv) override
@@ -1550,11 +1550,14 @@ namespace cli
                     {'C', "cycle-csv",  OPTARG_NONE},
                     {'S', "sort",       OPTARG_REQUIRED},
                     {'a', "agent",      OPTARG_NONE},
+                    {'p', "pools",      OPTARG_NONE},
+                    {'P', "pool-history", OPTARG_REQUIRED},
                     {0, nullptr, OPTARG_NONE}
                 };
 
                 cli::StatsBitset options(0);
                 int sort = 0;
+                std::string pool;
 
                 for (;;)
                 {
@@ -1612,6 +1615,13 @@ namespace cli
                         case 'a':
                             options.set(cli::STATS_AGENT);
                             break;
+                        case 'p':
+                            options.set(cli::STATS_POOLS);
+                            break;
+                        case 'P':
+                            options.set(cli::STATS_POOL_HISTORY);
+                            pool = opt.GetOptionArgument();
+                            break;
                     }
                 }
 
@@ -1621,7 +1631,7 @@ namespace cli
                     return cli.SetError(GetSyntax());
                 }
 
-                return cli.DoStats(options, sort);
+                return cli.DoStats(options, sort, &pool);
             }
 
             StatsCommand& operator=(const StatsCommand&) = delete;
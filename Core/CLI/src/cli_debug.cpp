@@ -23,6 +23,7 @@
 #include "sml_Names.h"
 #include "sml_AgentSML.h"
 #include "soar_instance.h"
+#include "symbol_manager.h"
 
 #include <time.h>
 
@@ -47,6 +48,10 @@ bool CommandLineInterface::DoDebug(std::vector< std::string >* argv)
 
     numArgs = argv->size() - 1;
     sub_command = argv->front();
+    if ((sub_command == "trim") && (numArgs == 0))
+    {
+        return DoTrim();
+    }
     if (sub_command[0] == 't')
     {
         if (numArgs < 1)
@@ -174,6 +179,7 @@ bool CommandLineInterface::DoDebug(std::vector< std::string >* argv)
             PrintCLIMessage_Justify("internal-symbols", "Prints symbol table", 70);
             PrintCLIMessage_Justify("port", "Prints listening port", 70);
             PrintCLIMessage_Justify("time <command> [args]", "Executes command and prints time spent", 70);
+            PrintCLIMessage_Justify("trim", "Releases free memory pool blocks", 70);
         }
         else
         {
@@ -237,8 +243,10 @@ bool CommandLineInterface::DoAllocate(const std::string& pool, int blocks)
         return true;
     }
 
+    /* Agent pools come first; the shared pools hold the rest, e.g. "dynamic" */
     agent* thisAgent = m_pAgentSML->GetSoarAgent();
-    if (thisAgent->memoryManager->add_block_to_memory_pool_by_name(pool, blocks))
+    if (thisAgent->memoryManager->add_block_to_memory_pool_by_name(pool, blocks) ||
+            Memory_Manager::Get_MPM().add_block_to_memory_pool_by_name(pool, blocks))
     {
         m_Result << pool << " blocks increased by " << blocks;
         return true;
@@ -248,6 +256,18 @@ bool CommandLineInterface::DoAllocate(const std::string& pool, int blocks)
     return false;
 }
 
+bool CommandLineInterface::DoTrim()
+{
+    agent* thisAgent = m_pAgentSML->GetSoarAgent();
+    size_t released = thisAgent->memoryManager->trim_memory_pools();
+    released += Memory_Manager::Get_MPM().trim_shared_memory_pools();
+    size_t compacted = thisAgent->symbolManager->compact_str_constant_names();
+
+    m_Result << released << " bytes of free memory pool blocks released\n";
+    m_Result << compacted << " bytes of symbol name storage released";
+    return true;
+}
+
 bool CommandLineInterface::DoTime(std::vector<std::string>& argv)
 {
 
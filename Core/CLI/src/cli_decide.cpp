@@ -744,13 +744,13 @@ bool CommandLineInterface::DoSRand(uint32_t* pSeed)
     std::ostringstream lFeedback;
     if (pSeed)
     {
-        SoarSeedRNG(*pSeed);
+        SoarSeedRNG(m_pAgentSML->GetSoarAgent(), *pSeed);
         lFeedback << "Random number generator seed set to " << (*pSeed);
 
     }
     else
     {
-        SoarSeedRNG();
+        SoarSeedRNG(m_pAgentSML->GetSoarAgent());
         lFeedback << "Random number generator seed set to new random value.";
     }
 
@@ -93,6 +93,14 @@ namespace cli
         MATCHES_ASSERTIONS_RETRACTIONS,
     };
 
+    enum eMatchProfileMode
+    {
+        MATCH_PROFILE_REPORT,
+        MATCH_PROFILE_ENABLE,
+        MATCH_PROFILE_DISABLE,
+        MATCH_PROFILE_RESET,
+    };
+
     enum eWMEDetail
     {
         WME_DETAIL_NONE,
@@ -183,6 +191,8 @@ namespace cli
         STATS_DECISION,
         STATS_AGENT,
         STATS_EBC,
+        STATS_POOLS,
+        STATS_POOL_HISTORY,
         STATS_NUM_OPTIONS, // must be last
     };
     typedef std::bitset<STATS_NUM_OPTIONS> StatsBitset;
@@ -212,6 +222,7 @@ namespace cli
         WATCH_WMA,
         WATCH_GDS_WMES,
         WATCH_GDS_STATE_REMOVAL,
+        WATCH_REORDER,
         WATCH_NUM_OPTIONS, // must be last
     };
 
@@ -484,6 +484,7 @@ void initdocstrings()
 		"  internal-symbols                                   Prints symbol table\n"
 		"  port                                             Prints listening port\n"
 		"  time <command> [args]           Executes command and prints time spent\n"
+		"  trim                                  Releases free memory pool blocks\n"
 		"\n"
 		"debug allocate\n"
 		"\n"
@@ -499,7 +500,9 @@ void initdocstrings()
 		"Issuing the command with no parameters lists current pool usage, exactly like\n"
 		"stats command's memory flag.\n"
 		"Issuing the command with part of a pool's name and a positive integer will\n"
-		"allocate that many additional blocks for the specified pool. Only the first few\n"
+		"allocate that many additional blocks for the specified pool of the current\n"
+		"agent. Each agent has its own pools, so usage is listed as the total over all\n"
+		"agents in the process. Only the first few\n"
 		"letters of the pool's name are necessary. If more than one pool starts with the\n"
 		"given letters, which pool will be chosen is unspecified.\n"
 		"Memory pool block size in this context is approximately 32 kilobytes, the exact\n"
@@ -523,6 +526,15 @@ void initdocstrings()
 		"executing a command. The most common use for this is to time how long an agent\n"
 		"takes to run.\n"
 		"\n"
+		"debug trim\n"
+		"\n"
+		"The trim command hands every memory pool block that has no items in use back\n"
+		"to the allocator and prints how many bytes were released. Blocks are normally\n"
+		"kept for reuse until the agent is destroyed, so an agent that once had a very\n"
+		"large working memory keeps that footprint. It also moves the names of string\n"
+		"constants out of symbol name arena chunks that are mostly freed space. See\n"
+		"also soar pool-trim.\n"
+		"\n"
 		"See Also\n"
 		"\n"
 		"stats\n"
@@ -681,7 +693,8 @@ void initdocstrings()
 		"Seeds the random number generator with the passed seed. Calling decide set-\n"
 		"random-seed (or equivalently, decide srand) without providing a seed will seed\n"
 		"the generator based on the contents of /dev/urandom (if available) or else\n"
-		"based on time() and clock() values.\n"
+		"based on time() and clock() values. Each agent has its own generator, so this\n"
+		"only affects the agent the command is sent to.\n"
 		"\n"
 		"Example\n"
 		"\n"
@@ -1521,6 +1534,7 @@ void initdocstrings()
 		"  load library                    <filename> <args...>\n"
 		"  ------------------------------------------------------------\n"
 		"  load rete-network               --load <filename>\n"
+		"  load rete-network               --agent <agent-name>\n"
 		"  ------------------------------------------------------------\n"
 		"  load percepts                   --open <filename>\n"
 		"  load percepts                   --close\n"
@@ -1615,6 +1629,15 @@ void initdocstrings()
 		"productions. This command provides a fast method of saving and loading\n"
 		"productions since a special format is used and no parsing is necessary. Rete-\n"
 		"net files are portable across platforms that support Soar.\n"
+		"The file format is detected automatically, so both snapshot and compact\n"
+		"files saved by save rete-network can be loaded.\n"
+		"With --agent, the Rete net of another agent in the same kernel is copied\n"
+		"instead, without going through a file. This is the quickest way to start\n"
+		"several agents with the same productions: source them into one agent, then\n"
+		"copy its net into each of the others. Each agent gets its own copy of the\n"
+		"net, so this saves the time it takes to source the rules but not the memory\n"
+		"they take. The net can't be copied while the other agent has justifications;\n"
+		"the current agent is left unchanged if the copy fails.\n"
 		"If the filename contains a suffix of .Z, then the file is compressed\n"
 		"automatically when it is saved and uncompressed when it is loaded. Compressed\n"
 		"files may not be portable to another platform if that platform does not support\n"
@@ -1623,6 +1646,7 @@ void initdocstrings()
 		"Usage:\n"
 		"\n"
 		"  load rete-network -l <filename>\n"
+		"  load rete-network -A <agent-name>\n"
 		"\n"
 		"load percepts\n"
 		"\n"
@@ -2203,11 +2227,17 @@ void initdocstrings()
 		"  production matches            [--names --count  ] [--assertions ]\n"
 		"                                [--timetags --wmes] [--retractions]\n"
 		"  ------------------------------------------------------------------\n"
+		"  production match-profile      [--on --off --reset]\n"
+		"  production match-profile      [n]\n"
+		"  ------------------------------------------------------------------\n"
 		"  production memory-usage       [options] [max]\n"
 		"  production memory-usage       <production_name>\n"
 		"  ------------------------------------------------------------------\n"
 		"  production optimize-attribute [symbol [n]]\n"
 		"  ------------------------------------------------------------------\n"
+		"  production reorder            [n]\n"
+		"  production reorder            --period <decisions>\n"
+		"  ------------------------------------------------------------------\n"
 		"  production watch              [--disable --enable] <prod-name>\n"
 		"  ------------------------------------------------------------------\n"
 		"\n"
@@ -2295,6 +2325,11 @@ void initdocstrings()
 		"\n"
 		"  production excise --all\n"
 		"\n"
+		"Productions removed by one of the flags are taken out of the rete together,\n"
+		"which is much faster than removing them one at a time when there are many of\n"
+		"them. The command reports how many productions it removed and how long that\n"
+		"took, in seconds.\n"
+		"\n"
 		"production find\n"
 		"\n"
 		"Find productions by condition or action patterns.\n"
@@ -2488,6 +2523,33 @@ void initdocstrings()
 		"\n"
 		"  production matches -t my*first*production\n"
 		"\n"
+		"production match-profile\n"
+		"\n"
+		"Profile the work the Rete matcher does for each production.\n"
+		"\n"
+		"Synopsis\n"
+		"\n"
+		"  production match-profile [--on | --off | --reset]\n"
+		"  production match-profile [number]\n"
+		"\n"
+		"Options:\n"
+		"\n"
+		"Option               Description\n"
+		"-e, --on, --enable   Start counting match work.\n"
+		"-d, --off, --disable Stop counting match work. Counts are kept.\n"
+		"-r, --reset          Clear all counts.\n"
+		"number               Number of productions to print (default 20).\n"
+		"\n"
+		"Description\n"
+		"\n"
+		"While the match profiler is on, every node in the Rete network counts its left\n"
+		"and right activations, the tokens it creates and the join tests it performs.\n"
+		"With no options, match-profile adds up the counts of the nodes used by each\n"
+		"production and prints the productions that did the most work (join tests plus\n"
+		"activations) first. Because the Rete shares nodes between productions with\n"
+		"common conditions, work done in a shared node is charged to every production\n"
+		"that uses it. The profiler is off by default and costs very little when off.\n"
+		"\n"
 		"production memory-usage\n"
 		"\n"
 		"Print memory usage for partial matches.\n"
@@ -2537,6 +2599,10 @@ void initdocstrings()
 		"small amount of memory, numbers above 1000 mean that the production is using a\n"
 		"large amount of memory, and numbers above 10,000 mean that the production is\n"
 		"using a very large amount of memory.\n"
+		"The rete keeps a running token count on each of its nodes, so the counts are\n"
+		"cheap to read and memory-usage can be polled every cycle for all productions.\n"
+		"Over SML, memory-usage without a production name returns every count in one\n"
+		"response, as a name and a count argument for each production.\n"
 		"\n"
 		"production optimize-attribute\n"
 		"\n"
@@ -2586,6 +2652,45 @@ void initdocstrings()
 		"\n"
 		"  production optimize-attribute thing 4\n"
 		"\n"
+		"production reorder\n"
+		"\n"
+		"Re-order the conditions of productions using what the match profiler saw.\n"
+		"\n"
+		"Synopsis\n"
+		"\n"
+		"  production reorder [number]\n"
+		"  production reorder --period <decisions>\n"
+		"\n"
+		"Options:\n"
+		"\n"
+		"Option               Description\n"
+		"number               Number of productions to look at (default 20).\n"
+		"-p, --period         Also reorder at the end of every <decisions> decision\n"
+		"                     cycles. 0 turns this off.\n"
+		"\n"
+		"Description\n"
+		"\n"
+		"Soar orders the conditions of a production once, when it is loaded, using\n"
+		"fixed guesses about how many values each attribute has. reorder looks at the\n"
+		"productions whose partial matches created the most tokens while the match\n"
+		"profiler was on (see production match-profile), replaces those guesses with the\n"
+		"branching factor each condition actually showed, and re-orders the conditions.\n"
+		"A production whose order changes is rebuilt in the Rete. For each one, reorder\n"
+		"prints the new order (as the old positions of the conditions) and how many\n"
+		"tokens its partial matches hold before and after. If the new order would hold\n"
+		"more tokens, the old one is put back.\n"
+		"\n"
+		"Productions that currently match, or have pending firings or retractions, are\n"
+		"skipped so that nothing fires or retracts again; a later pass picks them up.\n"
+		"Templates and justifications are never reordered. Setting a period turns the\n"
+		"match profiler on.\n"
+		"\n"
+		"Example:\n"
+		"\n"
+		"  production match-profile --on\n"
+		"  run 100\n"
+		"  production reorder 5\n"
+		"\n"
 		"production watch\n"
 		"\n"
 		"Trace firings and retractions of specific productions.\n"
@@ -2959,7 +3064,7 @@ void initdocstrings()
 		"  save percepts                        --open <filename>\n"
 		"  save percepts                        [--close --flush]\n"
 		"  ------------------------------------------------------\n"
-		"  save rete-network                    --save <filename>\n"
+		"  save rete-network                    [--compact] --save <filename>\n"
 		"  ------------------------------------------------------\n"
 		"  For a detailed explanation of sub-commands:  help save\n"
 		"\n"
@@ -2984,6 +3089,12 @@ void initdocstrings()
 		"net files are portable across platforms that support Soar.\n"
 		"Note that justifications cannot be present when saving the Rete net. Issuing a\n"
 		"production_excise_-j before saving a Rete net will remove all justifications.\n"
+		"By default the net is saved as a snapshot that load rete-network maps\n"
+		"straight into memory, which is the fastest format to load. The --compact\n"
+		"option writes the older SoarCompactReteNet version 4 layout instead; load\n"
+		"rete-network reads either one. The compact layout has no room for the\n"
+		":collection flag, so a net with :collection productions can only be saved\n"
+		"as a snapshot.\n"
 		"If the filename contains a suffix of .Z, then the file is compressed\n"
 		"automatically when it is saved and uncompressed when it is loaded. Compressed\n"
 		"files may not be portable to another platform if that platform does not support\n"
@@ -2991,7 +3102,7 @@ void initdocstrings()
 		"\n"
 		"Usage:\n"
 		"\n"
-		"  save rete-network -s <filename>\n"
+		"  save rete-network [-c] -s <filename>\n"
 		"\n"
 		"save percepts\n"
 		"\n"
@@ -3434,6 +3545,8 @@ void initdocstrings()
 		"  soar stop [--self]                                     Stop Soar execution\n"
 		"  soar version                                           Print version number\n"
 		"  ------------------- Settings ----------------------\n"
+		"  alpha-threads                                     1    Threads for alpha lookups of large WM batches\n"
+		"  gc-batch                                          0    Disconnected ids held per collection sweep\n"
 		"  keep-all-top-oprefs                    [ on | OFF ]    Keep prefs for o-supported WMEs in top-state\n"
 		"  max-elaborations                                100    Max elaborations per decision cycle\n"
 		"  max-goal-depth                                   23    Halt at this goal stack depth\n"
@@ -3441,6 +3554,10 @@ void initdocstrings()
 		"  max-dc-time                                       0    Interrupt after this much time\n"
 		"  max-memory-usage                          100000000    Threshold for memory warning\n"
 		"  max-gp                                        20000    Max rules gp can generate\n"
+		"  pool-trim                              [ on | OFF ]    Release free memory pool blocks\n"
+		"  pool-trim-slack                            16777216    Pool growth allowed before trim\n"
+		"  pool-huge-pages                        [ on | OFF ]    Grow large pools in huge pages\n"
+		"  run-threads                                       1    Threads that step agents in a run\n"
 		"  stop-phase   [input|propose|decision|APPLY|output]    Phase before which Soar will stop\n"
 		"  tcl                                    [ on | OFF ]    Allow Tcl code in commands\n"
 		"  timers                                 [ ON | off ]    Profile Soar\n"
@@ -3509,6 +3626,8 @@ void initdocstrings()
 		"commands are accepted.\n"
 		"\n"
 		"Option                Valid Values Default\n"
+		"alpha-threads         1 to 64      1\n"
+		"gc-batch              >= 0         0\n"
 		"keep-all-top-oprefs   on or off    off\n"
 		"max-dc-time           >= 0         0\n"
 		"max-elaborations      > 0          100\n"
@@ -3516,11 +3635,38 @@ void initdocstrings()
 		"max-gp                > 0          20000\n"
 		"max-memory-usage      > 0          100000000\n"
 		"max-nil-output-cycles > 0          15\n"
+		"pool-trim             on or off    off\n"
+		"pool-trim-slack       > 0          16777216\n"
+		"pool-huge-pages       on or off    off\n"
+		"run-threads           1 to 64      1\n"
 		"stop-phase                         apply\n"
 		"tcl                   on or off    off\n"
 		"timers                on or off    on\n"
 		"wait-snc              >= 1         1\n"
 		"\n"
+		"soar alpha-threads\n"
+		"\n"
+		"alpha-threads sets how many threads look up the alpha memories of the WMEs\n"
+		"added in one phase. Above 1, a phase that adds at least 1024 WMEs splits the\n"
+		"lookups across a pool of that many threads. The matching that follows is done\n"
+		"in the same order as with one thread, so runs are reproducible. The stats\n"
+		"--rete command reports how many batches were looked up in parallel.\n"
+		"\n"
+		"soar gc-batch\n"
+		"\n"
+		"gc-batch controls when Soar garbage collects identifiers that may have been\n"
+		"disconnected from the goal stack. Identifiers whose last link is removed are\n"
+		"always collected at the end of the phase. Identifiers that lose a link but\n"
+		"still have others, for example because of a ^parent link in the structure\n"
+		"being removed, need a walk of working memory to find out whether they are\n"
+		"still connected. With 0, that walk is done at the end of every phase that\n"
+		"needs one. Above 0, while there are no substates, these identifiers are held\n"
+		"back until that many are waiting or that many decision cycles have passed,\n"
+		"and are then sorted out with a single walk. This helps agents that take apart\n"
+		"a large structure piece by piece, but disconnected WMEs stay in working\n"
+		"memory until the next walk. As soon as there is a substate, the walk is done\n"
+		"every phase again, since the goal stack levels of identifiers must be right.\n"
+		"\n"
 		"soar keep-all-top-oprefs\n"
 		"\n"
 		"Enabling keep-all-top-oprefs turns off an optimization that reduces memory\n"
@@ -3576,6 +3722,29 @@ void initdocstrings()
 		"long time while those productions are added to memory. The max-gp setting\n"
 		"bounds this.\n"
 		"\n"
+		"soar pool-trim\n"
+		"\n"
+		"Memory pools keep the blocks they grow for reuse. When pool-trim is on, blocks\n"
+		"with no items in use are handed back to the allocator after every init-soar.\n"
+		"While running, the pools are also checked at the end of each decision cycle;\n"
+		"if they hold more than pool-trim-slack bytes beyond the smallest size seen\n"
+		"since the last trim, free blocks are released. When a trim finds nothing to\n"
+		"release, the check backs off for twice as many cycles each time, and an agent\n"
+		"that keeps that much memory in use simply has its baseline raised. The slack\n"
+		"is given in bytes. Trimming walks each pool's free list, so it costs time\n"
+		"proportional to the number of free items.\n"
+		"\n"
+		"soar pool-huge-pages\n"
+		"\n"
+		"Memory pools normally grow in blocks of about 32 kilobytes. For agents whose\n"
+		"working memory and rete grow very large, that means many small blocks and many\n"
+		"TLB misses. When pool-huge-pages is on, a pool that already holds 2 megabytes\n"
+		"of items gets each new block as one 2 megabyte huge page. Reserved huge pages\n"
+		"are used if the OS has any; otherwise the block is aligned and marked for\n"
+		"transparent huge pages. If neither is available, as on systems other than\n"
+		"Linux, pools keep growing in ordinary blocks. The setting only affects blocks\n"
+		"added after it is changed. Small pools are not affected.\n"
+		"\n"
 		"soar max-memory-usage\n"
 		"\n"
 		"The max-memory-usage setting is used to trigger the memory usage exceeded\n"
@@ -3598,6 +3767,20 @@ void initdocstrings()
 		"generate no output allowed when a run --out command is issued. After this limit\n"
 		"has been reached, Soar stops. The default initial setting of n is 15.\n"
 		"\n"
+		"soar run-threads\n"
+		"\n"
+		"run-threads sets how many threads step the agents in a kernel during a run.\n"
+		"It is a kernel setting, so changing it in one agent changes it for all of\n"
+		"them, and it takes effect at the next run. With 1, agents take turns on one\n"
+		"thread. Above 1, every agent still running takes its next interleave step at\n"
+		"the same time on a pool of that many threads, and the run waits for all of\n"
+		"them before the next step, so agents stay as closely in step as they do on one\n"
+		"thread. Callbacks to the client, such as print and RHS function events, are\n"
+		"still made one at a time, but they are made on the thread stepping the agent,\n"
+		"and above 1 thread a callback can't send commands to the kernel: they fail\n"
+		"until the run returns. Each agent has its own random number generator, so\n"
+		"seeded agents make the same random choices on any number of threads.\n"
+		"\n"
 		"soar stop-phase\n"
 		"\n"
 		"stop-phase allows the user to control which phase Soar stops in. When running\n"
@@ -3774,6 +3957,11 @@ void initdocstrings()
 		"                  new reinforcement learning rules by filling in those\n"
 		"                  variables that match constants in working memory\n"
 		"\n"
+		"  :collection     specifies that partial matches of this production should\n"
+		"                  be stored in factored form where possible, only building\n"
+		"                  the combinations later conditions actually extend\n"
+		"                  (this can save memory on cross-product heavy rules)\n"
+		"\n"
 		"Multiple flags may be used, but not both of o-support and no-support.\n"
 		"Although you could force your productions to provide o-support or i-support by\n"
 		"using these commands --- regardless of the structure of the conditions and\n"
@@ -3805,7 +3993,7 @@ void initdocstrings()
 		"Options\n"
 		"\n"
 		"Option           Description\n"
-		"-m, --memory     report usage for Soar's memory pools\n"
+		"-m, --memory     report usage for Soar's memory pools, summed over all agents\n"
 		"-l, --learning   report statistics about rules learned via explanation-based\n"
 		"                 chunking\n"
 		"-r, --rete       report statistics about the rete structure\n"
@@ -3823,6 +4011,11 @@ void initdocstrings()
 		"                 track in comma-separated form\n"
 		"-S, --sort N     sort the tracked cycle stats by column number N, see table\n"
 		"                 below\n"
+		"-p, --pools      report allocation counters for each memory pool, summed over\n"
+		"                 all agents\n"
+		"-P, --pool-history NAME\n"
+		"                 print the current agent's recent per-cycle samples of the\n"
+		"                 named memory pool\n"
 		"\n"
 		"--sort parameters:\n"
 		"\n"
@@ -3862,7 +4055,8 @@ void initdocstrings()
 		"\n"
 		"The stats argument --memory provides information about memory usage and Soar's\n"
 		"memory pools, which are used to allocate space for the various data structures\n"
-		"used in Soar.\n"
+		"used in Soar. It also shows how much space the symbol name arenas, which hold\n"
+		"the names of string constants, save over giving each name its own block.\n"
 		"The stats argument --learning provides information about rules learned through\n"
 		"Soar's explanation-based chunking mechanism. This is the same output that chunk\n"
 		"stats provides. For statistics about a specific rule learned, see the explain\n"
@@ -3884,6 +4078,16 @@ void initdocstrings()
 		"--cycle, it may be sorted using the --sort argument and a column integer. Use\n"
 		"negative numbers for descending sort. Issue --stop-track to reset and clear\n"
 		"this data.\n"
+		"The --pools argument lists, for every memory pool, how many items have been\n"
+		"allocated and freed, how many are in use now, the most that were ever in use\n"
+		"at once, and how many blocks the pool holds. At the end of each decision\n"
+		"cycle, the in-use and block counts of an agent's pools are also recorded; the\n"
+		"last 256 of these samples can be printed for one pool with --pool-history,\n"
+		"giving the name shown by --memory (for example, stats -P wme). These counters\n"
+		"are always kept and are not cleared by init-soar. When the command is issued\n"
+		"through SML with structured output, both report XML instead: a pools element\n"
+		"with one pool element per pool, or a pool-history element with one sample\n"
+		"element per decision cycle.\n"
 		"\n"
 		"A Note on Timers\n"
 		"\n"
@@ -194,8 +194,14 @@ bool CommandLineInterface::DoSave(std::vector<std::string>& argv, const std::str
                 if (!AddSaveSettingOnOff(thisAgent->explanationBasedChunker->ebc_settings[SETTING_EBC_ADD_LTM_LINKS], "chunk add-ltm-links")) return false;
                 if (!AddSaveSettingInt("chunk max-chunks", thisAgent->explanationBasedChunker->max_chunks)) return false;
                 if (!AddSaveSettingInt("chunk max-dupes", thisAgent->explanationBasedChunker->max_dupes)) return false;
+                if (!AddSaveSettingInt("soar alpha-threads", thisAgent->Decider->settings[DECIDER_ALPHA_THREADS])) return false;
+                if (!AddSaveSettingInt("soar gc-batch", thisAgent->Decider->settings[DECIDER_GC_BATCH])) return false;
                 if (!AddSaveSettingInt("soar max-elaborations", thisAgent->Decider->settings[DECIDER_MAX_ELABORATIONS])) return false;
                 if (!AddSaveSettingInt("soar max-goal-depth", thisAgent->Decider->settings[DECIDER_MAX_GOAL_DEPTH])) return false;
+                if (!AddSaveSettingOnOff(thisAgent->Decider->settings[DECIDER_POOL_TRIM], "soar pool-trim")) return false;
+                if (!AddSaveSettingInt("soar run-threads", m_pKernelSML->GetRunThreads())) return false;
+                if (!AddSaveSettingInt("soar pool-trim-slack", thisAgent->Decider->settings[DECIDER_POOL_TRIM_SLACK])) return false;
+                if (!AddSaveSettingOnOff(thisAgent->Decider->settings[DECIDER_POOL_HUGE_PAGES], "soar pool-huge-pages")) return false;
                 if (!AddSaveSettingOnOff(thisAgent->Decider->settings[DECIDER_WAIT_SNC], "soar wait-snc")) return false;
             }
 
@@ -342,6 +348,8 @@ bool CommandLineInterface::ParseReteLoad(std::vector< std::string >& argv)
     cli::Options opt;
     OptionsData optionsData[] =
     {
+        {'A', "agent",       OPTARG_REQUIRED},
+        {'c', "compact",     OPTARG_NONE},
         {'l', "load",        OPTARG_REQUIRED},
         {'r', "restore",    OPTARG_REQUIRED},
         {'s', "save",        OPTARG_REQUIRED},
@@ -350,6 +358,8 @@ bool CommandLineInterface::ParseReteLoad(std::vector< std::string >& argv)
 
     bool save = false;
     bool load = false;
+    bool copy = false;
+    bool compact = false;
     std::string filename;
 
     for (;;)
@@ -366,31 +376,46 @@ bool CommandLineInterface::ParseReteLoad(std::vector< std::string >& argv)
 
         switch (opt.GetOption())
         {
+            case 'A':
+                copy = true;
+                load = false;
+                save = false;
+                filename = opt.GetOptionArgument();
+                break;
+            case 'c':
+                compact = true;
+                break;
             case 'l':
             case 'r':
                 load = true;
                 save = false;
+                copy = false;
                 filename = opt.GetOptionArgument();
                 break;
             case 's':
                 save = true;
                 load = false;
+                copy = false;
                 filename = opt.GetOptionArgument();
                 break;
         }
     }
 
-    // Must have a save or load operation
-    if (!save && !load)
+    // Must have a save, load or copy operation
+    if (!save && !load && !copy)
     {
         return SetError("Invalid syntax for that command.");
     }
     if (opt.GetNonOptionArguments())
     {
-        return SetError("Please specify a file name.");
+        return SetError(copy ? "Please specify an agent name." : "Please specify a file name.");
     }
 
-    return DoReteNet(save, filename);
+    if (copy)
+    {
+        return DoReteNetCopy(filename);
+    }
+    return DoReteNet(save, filename, compact);
 
 
 }
@@ -468,6 +493,7 @@ bool CommandLineInterface::ParseReteSave(std::vector< std::string >& argv)
     cli::Options opt;
     OptionsData optionsData[] =
     {
+        {'c', "compact",     OPTARG_NONE},
         {'l', "load",        OPTARG_REQUIRED},
         {'r', "restore",    OPTARG_REQUIRED},
         {'s', "save",        OPTARG_REQUIRED},
@@ -475,6 +501,7 @@ bool CommandLineInterface::ParseReteSave(std::vector< std::string >& argv)
     };
 
     bool save = false;
+    bool compact = false;
     std::string filename;
 
     for (;;)
@@ -491,6 +518,9 @@ bool CommandLineInterface::ParseReteSave(std::vector< std::string >& argv)
 
         switch (opt.GetOption())
         {
+            case 'c':
+                compact = true;
+                break;
             case 'r':
             case 'l':
                 return ParseReteLoad(argv);
@@ -513,7 +543,7 @@ bool CommandLineInterface::ParseReteSave(std::vector< std::string >& argv)
         return SetError(opt.GetError().c_str());
     }
 
-    return DoReteNet(true, filename);
+    return DoReteNet(true, filename, compact);
 }
 bool CommandLineInterface::DoReplayInput(eReplayInputMode mode, std::string* pathname)
 {
@@ -585,7 +615,7 @@ bool CommandLineInterface::DoCaptureInput(eCaptureInputMode mode, bool autoflush
                 return SetError("File name required.");
             }
 
-            uint32_t seed = SoarRandInt();
+            uint32_t seed = SoarRandInt(m_pAgentSML->GetSoarAgent());
 
             if (!m_pAgentSML->StartCaptureInput(*pathname, autoflush, seed))
             {
@@ -604,7 +634,7 @@ bool CommandLineInterface::DoCaptureInput(eCaptureInputMode mode, bool autoflush
     return true;
 }
 
-bool CommandLineInterface::DoReteNet(bool save, std::string filename)
+bool CommandLineInterface::DoReteNet(bool save, std::string filename, bool compact)
 {
     if (!filename.size())
     {
@@ -621,8 +651,9 @@ bool CommandLineInterface::DoReteNet(bool save, std::string filename)
             return SetError("Open file failed.");
         }
 
-        if (! save_rete_net(thisAgent, file, true))
+        if (! save_rete_net(thisAgent, file, compact ? RETE_NET_COMPACT_64 : RETE_NET_SNAPSHOT))
         {
+            fclose(file);
             // TODO: additional error information
             return SetError("Rete save operation failed.");
         }
@@ -651,6 +682,27 @@ bool CommandLineInterface::DoReteNet(bool save, std::string filename)
     return true;
 }
 
+bool CommandLineInterface::DoReteNetCopy(const std::string& sourceAgentName)
+{
+    if (!sourceAgentName.size())
+    {
+        return SetError("Missing agent name.");
+    }
+
+    AgentSML* pSourceAgentSML = m_pKernelSML->GetAgentSML(sourceAgentName.c_str());
+    if (!pSourceAgentSML)
+    {
+        return SetError("No agent named " + sourceAgentName + ".");
+    }
+
+    if (! copy_rete_net(m_pAgentSML->GetSoarAgent(), pSourceAgentSML->GetSoarAgent()))
+    {
+        return SetError("Rete copy operation failed.");
+    }
+
+    return true;
+}
+
 bool CommandLineInterface::DoLoadLibrary(const std::string& libraryCommand)
 {
 
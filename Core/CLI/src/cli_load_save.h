@@ -45,6 +45,7 @@ namespace cli
                     {'a', "all",            OPTARG_NONE},
                     {'d', "disable",        OPTARG_NONE},
                     {'v', "verbose",        OPTARG_NONE},
+                    {'A', "agent",          OPTARG_REQUIRED},
                     {0, 0, OPTARG_NONE}
                 };
 
@@ -100,6 +101,7 @@ namespace cli
                 OptionsData optionsData[] =
                 {
                     {'c', "close", OPTARG_NONE},
+                    {'c', "compact", OPTARG_NONE},
                     {'f', "flush", OPTARG_NONE},
                     {'o', "open", OPTARG_REQUIRED},
                     {'l', "load",        OPTARG_REQUIRED},
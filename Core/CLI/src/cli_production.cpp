@@ -23,10 +23,12 @@
 #include "lexer.h"
 #include "mem.h"
 #include "memory_manager.h"
+#include "misc.h"
 #include "output_manager.h"
 #include "parser.h"
 #include "print.h"
 #include "production.h"
+#include "production_reorder.h"
 #include "reinforcement_learning.h"
 #include "rete.h"
 #include "rhs.h"
@@ -68,6 +70,10 @@ bool CommandLineInterface::DoProduction(std::vector<std::string>& argv, const st
     {
         return ParseMatches(argv);
     }
+    else if (my_param == thisAgent->command_params->production_params->match_profile_cmd)
+    {
+        return ParseMatchProfile(argv);
+    }
     else if (my_param == thisAgent->command_params->production_params->memories_cmd)
     {
         return ParseMemories(argv);
@@ -80,6 +86,10 @@ bool CommandLineInterface::DoProduction(std::vector<std::string>& argv, const st
     {
         return ParsePBreak(argv);
     }
+    else if (my_param == thisAgent->command_params->production_params->reorder_cmd)
+    {
+        return ParseReorder(argv);
+    }
     else if (my_param == thisAgent->command_params->production_params->find_cmd)
     {
         return ParsePFind(argv);
@@ -358,6 +368,72 @@ bool CommandLineInterface::ParseMatches(std::vector< std::string >& argv)
 
     return DoMatches(mode, detail);
 }
+bool CommandLineInterface::ParseMatchProfile(std::vector< std::string >& argv)
+{
+    cli::Options opt;
+    OptionsData optionsData[] =
+    {
+        {'d', "disable",    OPTARG_NONE},
+        {'e', "enable",     OPTARG_NONE},
+        {'d', "off",        OPTARG_NONE},
+        {'e', "on",         OPTARG_NONE},
+        {'r', "reset",      OPTARG_NONE},
+        {0, 0, OPTARG_NONE}
+    };
+
+    cli::eMatchProfileMode mode = cli::MATCH_PROFILE_REPORT;
+
+    for (;;)
+    {
+        if (!opt.ProcessOptions(argv, optionsData))
+        {
+            return SetError(opt.GetError().c_str());
+        }
+
+        if (opt.GetOption() == -1)
+        {
+            break;
+        }
+
+        if (mode != cli::MATCH_PROFILE_REPORT)
+        {
+            return SetError("match-profile takes only one option at a time.");
+        }
+        switch (opt.GetOption())
+        {
+            case 'd':
+                mode = cli::MATCH_PROFILE_DISABLE;
+                break;
+            case 'e':
+                mode = cli::MATCH_PROFILE_ENABLE;
+                break;
+            case 'r':
+                mode = cli::MATCH_PROFILE_RESET;
+                break;
+        }
+    }
+
+    if (opt.GetNonOptionArguments() > 2)
+    {
+        return SetError("Syntax: production match-profile [--on | --off | --reset]\nproduction match-profile [number]");
+    }
+
+    // Optional number of productions to list, defaulting to the top 20
+    int n = 20;
+    if (opt.GetNonOptionArguments() == 2)
+    {
+        if (mode != cli::MATCH_PROFILE_REPORT)
+        {
+            return SetError("Do not specify a number when turning the match profiler on or off.");
+        }
+        if (!from_string(n, argv[opt.GetArgument() - opt.GetNonOptionArguments() + 1]) || (n <= 0))
+        {
+            return SetError("Expected positive integer.");
+        }
+    }
+
+    return DoMatchProfile(mode, n);
+}
 bool CommandLineInterface::ParseMultiAttributes(std::vector< std::string >& argv)
 {
     // No more than three arguments
@@ -574,6 +650,57 @@ bool CommandLineInterface::ParsePWatch(std::vector< std::string >& argv)
     return DoPWatch(query, 0);
 }
 
+bool CommandLineInterface::ParseReorder(std::vector< std::string >& argv)
+{
+    cli::Options opt;
+    OptionsData optionsData[] =
+    {
+        {'p', "period", OPTARG_REQUIRED},
+        {0, 0, OPTARG_NONE}
+    };
+
+    int period = -1;
+
+    for (;;)
+    {
+        if (!opt.ProcessOptions(argv, optionsData))
+        {
+            return SetError(opt.GetError().c_str());
+        }
+
+        if (opt.GetOption() == -1)
+        {
+            break;
+        }
+
+        if (!from_string(period, opt.GetOptionArgument()) || (period < 0))
+        {
+            return SetError("Expected non-negative integer for --period.");
+        }
+    }
+
+    if (opt.GetNonOptionArguments() > 2)
+    {
+        return SetError("Syntax: production reorder [number]\nproduction reorder --period <decisions>");
+    }
+
+    // Optional number of productions to look at, defaulting to the top 20
+    int n = DEFAULT_REORDER_PRODUCTIONS;
+    if (opt.GetNonOptionArguments() == 2)
+    {
+        if (period >= 0)
+        {
+            return SetError("Do not specify a number when setting the reorder period.");
+        }
+        if (!from_string(n, argv[opt.GetArgument() - opt.GetNonOptionArguments() + 1]) || (n <= 0))
+        {
+            return SetError("Expected positive integer.");
+        }
+    }
+
+    return DoReorder(n, period);
+}
+
 bool CommandLineInterface::DoPbreak(const char& mode, const std::string& production)
 {
     agent* thisAgent = m_pAgentSML->GetSoarAgent();
@@ -629,7 +756,10 @@ bool CommandLineInterface::DoExcise(const ExciseBitset& options, const std::stri
 {
     int64_t exciseCount = 0;
     agent* thisAgent = m_pAgentSML->GetSoarAgent();
-    production* nextProd = NULL;
+    std::vector< production* > prods;
+    soar_timer timer;
+
+    timer.start();
 
     // Process the general options
     if (options.test(EXCISE_ALL))
@@ -657,52 +787,52 @@ bool CommandLineInterface::DoExcise(const ExciseBitset& options, const std::stri
     }
     if (options.test(EXCISE_RL))
     {
-        for (production* prod = thisAgent->all_productions_of_type[DEFAULT_PRODUCTION_TYPE]; prod != NIL; prod = nextProd)
+        prods.clear();
+        for (production* prod = thisAgent->all_productions_of_type[DEFAULT_PRODUCTION_TYPE]; prod != NIL; prod = prod->next)
         {
-            nextProd = prod->next;
             if (prod->rl_rule)
             {
-                exciseCount++;
-                excise_production(thisAgent, prod, true, true);
+                prods.push_back(prod);
             }
         }
 
-        for (production* prod = thisAgent->all_productions_of_type[USER_PRODUCTION_TYPE]; prod != NIL; prod = nextProd)
+        for (production* prod = thisAgent->all_productions_of_type[USER_PRODUCTION_TYPE]; prod != NIL; prod = prod->next)
         {
-            nextProd = prod->next;
             if (prod->rl_rule)
             {
-                exciseCount++;
-                excise_production(thisAgent, prod, true, true);
+                prods.push_back(prod);
             }
         }
 
-        for (production* prod = thisAgent->all_productions_of_type[CHUNK_PRODUCTION_TYPE]; prod != NIL; prod = nextProd)
+        for (production* prod = thisAgent->all_productions_of_type[CHUNK_PRODUCTION_TYPE]; prod != NIL; prod = prod->next)
         {
-            nextProd = prod->next;
             if (prod->rl_rule)
             {
-                exciseCount++;
-                excise_production(thisAgent, prod, true, true);
+                prods.push_back(prod);
             }
         }
 
+        exciseCount += prods.size();
+        excise_productions(thisAgent, prods, true, true);
+
         rl_initialize_template_tracking(thisAgent);
     }
     if (options.test(EXCISE_NEVER_FIRED))
     {
+        prods.clear();
         for (int i = 0; i < NUM_PRODUCTION_TYPES; i++)
         {
-            for (production* prod = thisAgent->all_productions_of_type[i]; prod != NIL; prod = nextProd)
+            for (production* prod = thisAgent->all_productions_of_type[i]; prod != NIL; prod = prod->next)
             {
-                nextProd = prod->next;
                 if (!prod->firing_count)
                 {
-                    exciseCount++;
-                    excise_production(thisAgent, prod);
+                    prods.push_back(prod);
                 }
             }
         }
+
+        exciseCount += prods.size();
+        excise_productions(thisAgent, prods, true);
     }
     if (options.test(EXCISE_TASK))
     {
@@ -747,15 +877,24 @@ bool CommandLineInterface::DoExcise(const ExciseBitset& options, const std::stri
         excise_production(thisAgent, sym->sc->production, false, true);
     }
 
+    timer.stop();
+    double elapsed = timer.get_usec() / 1000000.0;
+
     if (m_RawOutput)
     {
-        m_Result << exciseCount << " production" << (exciseCount == 1 ? " " : "s ") << "excised.\n";
+        m_Result << exciseCount << " production" << (exciseCount == 1 ? " " : "s ") << "excised";
+        if (exciseCount)
+        {
+            m_Result << " (" << elapsed << "s)";
+        }
+        m_Result << ".\n";
     }
     else
     {
         // Add the count tag to the front
         std::string temp;
         PrependArgTag(sml_Names::kParamCount, sml_Names::kTypeInt, to_string(exciseCount, temp));
+        AppendArgTagFast(sml_Names::kParamRealSeconds, sml_Names::kTypeDouble, to_string(elapsed, temp));
     }
 
     return true;
@@ -967,6 +1106,102 @@ bool CommandLineInterface::DoMatches(const eMatchesMode mode, const eWMEDetail d
     return true;
 }
 
+struct MatchProfileSort
+{
+    static uint64_t cost(const rete_node_profile& p)
+    {
+        return p.join_tests + p.left_activations + p.right_activations;
+    }
+    bool operator()(const std::pair< std::string, rete_node_profile >& a, const std::pair< std::string, rete_node_profile >& b) const
+    {
+        return cost(a.second) > cost(b.second);
+    }
+};
+
+bool CommandLineInterface::DoMatchProfile(const eMatchProfileMode mode, int n)
+{
+    agent* thisAgent = m_pAgentSML->GetSoarAgent();
+
+    switch (mode)
+    {
+        case MATCH_PROFILE_ENABLE:
+            thisAgent->match_profiling = true;
+            PrintCLIMessage("Match profiler enabled.");
+            return true;
+        case MATCH_PROFILE_DISABLE:
+            thisAgent->match_profiling = false;
+            PrintCLIMessage("Match profiler disabled.");
+            return true;
+        case MATCH_PROFILE_RESET:
+            reset_match_profile(thisAgent);
+            PrintCLIMessage("Match profile reset.");
+            return true;
+        default:
+            break;
+    }
+
+    // Roll the per-node counts up into per-production totals, skipping
+    // productions that did no matching work while the profiler was on
+    std::vector< std::pair< std::string, rete_node_profile > > profiles;
+    for (unsigned int i = 0; i < NUM_PRODUCTION_TYPES; ++i)
+    {
+        for (production* pSoarProduction = thisAgent->all_productions_of_type[i];
+                pSoarProduction != 0;
+                pSoarProduction = pSoarProduction->next)
+        {
+            std::pair< std::string, rete_node_profile > profile;
+            profile.first = pSoarProduction->name->sc->name;
+            get_match_profile_for_production(thisAgent, pSoarProduction, &profile.second);
+            if (MatchProfileSort::cost(profile.second) || profile.second.tokens_created)
+            {
+                profiles.push_back(profile);
+            }
+        }
+    }
+
+    MatchProfileSort s;
+    sort(profiles.begin(), profiles.end(), s);
+
+    if (m_RawOutput)
+    {
+        if (!thisAgent->match_profiling)
+        {
+            m_Result << "Match profiler is off.  Use 'production match-profile --on' to start it.\n";
+        }
+        if (profiles.empty())
+        {
+            return true;
+        }
+        m_Result << "  Join Tests   Left Acts  Right Acts      Tokens  Production\n";
+        m_Result << "------------  ----------  ----------  ----------  ----------\n";
+    }
+
+    int i = 0;
+    for (std::vector< std::pair< std::string, rete_node_profile > >::iterator j = profiles.begin();
+            j != profiles.end() && i < n;
+            ++j, ++i)
+    {
+        if (m_RawOutput)
+        {
+            m_Result << std::setw(12) << j->second.join_tests << "  "
+                     << std::setw(10) << j->second.left_activations << "  "
+                     << std::setw(10) << j->second.right_activations << "  "
+                     << std::setw(10) << j->second.tokens_created << "  "
+                     << j->first << "\n";
+        }
+        else
+        {
+            std::string temp;
+            AppendArgTagFast(sml_Names::kParamName, sml_Names::kTypeString, j->first);
+            AppendArgTagFast(sml_Names::kParamMatchProfileJoinTests, sml_Names::kTypeInt, to_string(j->second.join_tests, temp));
+            AppendArgTagFast(sml_Names::kParamMatchProfileLeftActivations, sml_Names::kTypeInt, to_string(j->second.left_activations, temp));
+            AppendArgTagFast(sml_Names::kParamMatchProfileRightActivations, sml_Names::kTypeInt, to_string(j->second.right_activations, temp));
+            AppendArgTagFast(sml_Names::kParamMatchProfileTokensCreated, sml_Names::kTypeInt, to_string(j->second.tokens_created, temp));
+        }
+    }
+    return true;
+}
+
 bool CommandLineInterface::DoMultiAttributes(const std::string* pAttribute, int n)
 {
     agent* thisAgent = m_pAgentSML->GetSoarAgent();
@@ -1139,6 +1374,47 @@ bool CommandLineInterface::DoPWatch(bool query, const std::string* pProduction,
     return true;
 }
 
+bool CommandLineInterface::DoReorder(int n, int period)
+{
+    agent* thisAgent = m_pAgentSML->GetSoarAgent();
+
+    if (period >= 0)
+    {
+        thisAgent->reorder_period = period;
+        if (period)
+        {
+            // The periodic passes have nothing to go on without the profiler
+            thisAgent->match_profiling = true;
+            std::ostringstream message;
+            message << "Reordering productions every " << period << " decisions.";
+            PrintCLIMessage(&message);
+        }
+        else
+        {
+            PrintCLIMessage("Periodic reordering disabled.");
+        }
+        return true;
+    }
+
+    if (!thisAgent->match_profiling && m_RawOutput)
+    {
+        m_Result << "Match profiler is off.  Use 'production match-profile --on' to collect the counts reorder uses.\n";
+    }
+
+    uint64_t count = reorder_productions_from_match_profile(thisAgent, n, true);
+
+    if (m_RawOutput)
+    {
+        m_Result << "\n" << count << " production" << (count == 1 ? "" : "s") << " reordered.";
+    }
+    else
+    {
+        std::string temp;
+        AppendArgTagFast(sml_Names::kParamCount, sml_Names::kTypeInt, to_string(count, temp));
+    }
+    return true;
+}
+
 void free_binding_list(agent* thisAgent, cons* bindings)
 {
     cons* c;
@@ -48,12 +48,18 @@ namespace cli
                     {'e', "clear",              OPTARG_NONE},
                     {'f', "fired",              OPTARG_NONE},
                     {'d', "defaults",           OPTARG_NONE},
+                    {'D', "disable",            OPTARG_NONE},
+                    {'E', "enable",             OPTARG_NONE},
                     {'j', "justifications",     OPTARG_NONE},
                     {'l', "lhs",                OPTARG_NONE},
                     {'n', "names",              OPTARG_NONE},
                     {'o', "never-fired",        OPTARG_NONE},
+                    {'P', "period",             OPTARG_REQUIRED},
+                    {'D', "off",                OPTARG_NONE},
+                    {'E', "on",                 OPTARG_NONE},
                     {'q', "nochunks",           OPTARG_NONE},
                     {'p', "print",              OPTARG_NONE},
+                    {'R', "reset",              OPTARG_NONE},
                     {'r', "retractions",        OPTARG_NONE},
                     {'v', "rhs",                OPTARG_NONE},
                     {'r', "rl",                 OPTARG_NONE},
@@ -37,6 +37,10 @@ bool CommandLineInterface::DoSoar(const char pOp, const std::string* pArg1, cons
     std::ostringstream tempStringStream;
     std::string tempString;
 
+    /* run-threads belongs to the kernel, so another agent may have changed it */
+    thisAgent->Decider->params->run_threads->set_value(m_pKernelSML->GetRunThreads());
+    thisAgent->Decider->settings[DECIDER_RUN_THREADS] = m_pKernelSML->GetRunThreads();
+
     if (!pOp)
     {
         thisAgent->Decider->params->print_status(thisAgent);
@@ -278,6 +282,49 @@ bool CommandLineInterface::DoSoar(const char pOp, const std::string* pArg1, cons
                 PrintCLIMessage("Soar will no longer interrupt based on how how long a decision takes. (default)");
             }
         }
+        else if (my_param == thisAgent->Decider->params->alpha_threads)
+        {
+            thisAgent->Decider->settings[DECIDER_ALPHA_THREADS] = thisAgent->Decider->params->alpha_threads->get_value();
+            thisAgent->outputManager->sprint_sf(tempString, "Alpha lookups for large WM batches will now use %u thread(s).", thisAgent->Decider->settings[DECIDER_ALPHA_THREADS]);
+            PrintCLIMessage(tempString.c_str());
+        }
+        else if (my_param == thisAgent->Decider->params->gc_batch)
+        {
+            thisAgent->Decider->settings[DECIDER_GC_BATCH] = thisAgent->Decider->params->gc_batch->get_value();
+            if (thisAgent->Decider->settings[DECIDER_GC_BATCH])
+            {
+                thisAgent->outputManager->sprint_sf(tempString, "Disconnected identifiers will now be collected in batches of %u.", thisAgent->Decider->settings[DECIDER_GC_BATCH]);
+                PrintCLIMessage(tempString.c_str());
+            } else {
+                PrintCLIMessage("Disconnected identifiers will now be collected at the end of every phase. (default)");
+            }
+        }
+        else if (my_param == thisAgent->Decider->params->pool_trim)
+        {
+            thisAgent->Decider->settings[DECIDER_POOL_TRIM] = thisAgent->Decider->params->pool_trim->get_value();
+            thisAgent->outputManager->sprint_sf(tempString, "Soar will now %s free memory pool blocks.", thisAgent->Decider->settings[DECIDER_POOL_TRIM] ? "release" : "keep");
+            PrintCLIMessage(tempString.c_str());
+        }
+        else if (my_param == thisAgent->Decider->params->pool_trim_slack)
+        {
+            thisAgent->Decider->settings[DECIDER_POOL_TRIM_SLACK] = thisAgent->Decider->params->pool_trim_slack->get_value();
+            thisAgent->outputManager->sprint_sf(tempString, "Memory pools will now be trimmed when they grow by more than %u bytes.", thisAgent->Decider->settings[DECIDER_POOL_TRIM_SLACK]);
+            PrintCLIMessage(tempString.c_str());
+        }
+        else if (my_param == thisAgent->Decider->params->pool_huge_pages)
+        {
+            thisAgent->Decider->settings[DECIDER_POOL_HUGE_PAGES] = thisAgent->Decider->params->pool_huge_pages->get_value();
+            thisAgent->memoryManager->set_huge_pages(thisAgent->Decider->settings[DECIDER_POOL_HUGE_PAGES]);
+            thisAgent->outputManager->sprint_sf(tempString, "Large memory pools will now grow in %s blocks.", thisAgent->Decider->settings[DECIDER_POOL_HUGE_PAGES] ? "huge page" : "ordinary");
+            PrintCLIMessage(tempString.c_str());
+        }
+        else if (my_param == thisAgent->Decider->params->run_threads)
+        {
+            thisAgent->Decider->settings[DECIDER_RUN_THREADS] = thisAgent->Decider->params->run_threads->get_value();
+            m_pKernelSML->SetRunThreads(static_cast<int>(thisAgent->Decider->settings[DECIDER_RUN_THREADS]));
+            thisAgent->outputManager->sprint_sf(tempString, "Runs will now step agents on %u thread(s).", thisAgent->Decider->settings[DECIDER_RUN_THREADS]);
+            PrintCLIMessage(tempString.c_str());
+        }
         else if (my_param == thisAgent->Decider->params->max_elaborations)
         {
             thisAgent->Decider->settings[DECIDER_MAX_ELABORATIONS] = thisAgent->Decider->params->max_elaborations->get_value();
@@ -29,7 +29,7 @@ extern const char* bnode_type_names[256];
 using namespace cli;
 using namespace sml;
 
-bool CommandLineInterface::DoStats(const StatsBitset& options, int sort)
+bool CommandLineInterface::DoStats(const StatsBitset& options, int sort, const std::string* pPool)
 {
 
     //soar_print_detailed_callback_stats();
@@ -73,6 +73,17 @@ bool CommandLineInterface::DoStats(const StatsBitset& options, int sort)
         return true;
     }
 
+    if (options.test(STATS_POOLS))
+    {
+        GetMemoryPoolCounters();
+        return true;
+    }
+
+    if (options.test(STATS_POOL_HISTORY))
+    {
+        return GetMemoryPoolHistory(*pPool);
+    }
+
     // Set precision now, RESET BEFORE RETURN
     size_t oldPrecision = static_cast<size_t>(m_Result.precision(3));
     m_Result << std::setiosflags(std::ios_base::fixed);
@@ -173,6 +184,10 @@ bool CommandLineInterface::DoStats(const StatsBitset& options, int sort)
     AppendArgTagFast(sml_Names::kParamStatsWmeCount,                            sml_Names::kTypeInt,    to_string(thisAgent->num_wmes_in_rete, temp));
     AppendArgTagFast(sml_Names::kParamStatsWmeCountAverage,                        sml_Names::kTypeDouble, to_string((thisAgent->num_wm_sizes_accumulated ? (thisAgent->cumulative_wm_size / thisAgent->num_wm_sizes_accumulated) : 0.0), temp));
     AppendArgTagFast(sml_Names::kParamStatsWmeCountMax,                            sml_Names::kTypeInt,    to_string(thisAgent->max_wm_size, temp));
+    AppendArgTagFast(sml_Names::kParamStatsGDSElaborationPasses,                sml_Names::kTypeInt,    to_string(thisAgent->gds_elaboration_passes, temp));
+    AppendArgTagFast(sml_Names::kParamStatsGDSInstantiationsExplored,            sml_Names::kTypeInt,    to_string(thisAgent->gds_instantiations_explored, temp));
+    AppendArgTagFast(sml_Names::kParamStatsGDSWmeAdditions,                        sml_Names::kTypeInt,    to_string(thisAgent->gds_wme_additions, temp));
+    AppendArgTagFast(sml_Names::kParamStatsGDSStateRemovals,                    sml_Names::kTypeInt,    to_string(thisAgent->gds_state_removals, temp));
 #ifndef NO_TIMING_STUFF
     AppendArgTagFast(sml_Names::kParamStatsKernelCPUTime,                        sml_Names::kTypeDouble, to_string(thisAgent->timers_total_kernel_time.get_sec(), temp));
     AppendArgTagFast(sml_Names::kParamStatsTotalCPUTime,                        sml_Names::kTypeDouble, to_string(thisAgent->timers_total_cpu_time.get_sec(), temp));
@@ -190,6 +205,13 @@ bool CommandLineInterface::DoStats(const StatsBitset& options, int sort)
     AppendArgTagFast(sml_Names::kParamStatsMonitorTimeOutputPhase,                sml_Names::kTypeDouble, to_string(thisAgent->timers_monitors_cpu_time[OUTPUT_PHASE].get_sec(), temp));
     AppendArgTagFast(sml_Names::kParamStatsMonitorTimePreferencePhase,            sml_Names::kTypeDouble, to_string(thisAgent->timers_monitors_cpu_time[PREFERENCE_PHASE].get_sec(), temp));
     AppendArgTagFast(sml_Names::kParamStatsMonitorTimeWorkingMemoryPhase,        sml_Names::kTypeDouble, to_string(thisAgent->timers_monitors_cpu_time[WM_PHASE].get_sec(), temp));
+    AppendArgTagFast(sml_Names::kParamStatsGDSTimeInputPhase,         sml_Names::kTypeDouble, to_string(thisAgent->timers_gds_cpu_time[INPUT_PHASE].get_sec(), temp));
+    AppendArgTagFast(sml_Names::kParamStatsGDSTimePreferencePhase,    sml_Names::kTypeDouble, to_string(thisAgent->timers_gds_cpu_time[PREFERENCE_PHASE].get_sec(), temp));
+    AppendArgTagFast(sml_Names::kParamStatsGDSTimeWorkingMemoryPhase, sml_Names::kTypeDouble, to_string(thisAgent->timers_gds_cpu_time[WM_PHASE].get_sec(), temp));
+    AppendArgTagFast(sml_Names::kParamStatsGDSTimeOutputPhase,        sml_Names::kTypeDouble, to_string(thisAgent->timers_gds_cpu_time[OUTPUT_PHASE].get_sec(), temp));
+    AppendArgTagFast(sml_Names::kParamStatsGDSTimeDecisionPhase,      sml_Names::kTypeDouble, to_string(thisAgent->timers_gds_cpu_time[DECIDE_PHASE].get_sec(), temp));
+    AppendArgTagFast(sml_Names::kParamStatsGDSTimeProposePhase,       sml_Names::kTypeDouble, to_string(thisAgent->timers_gds_cpu_time[PROPOSE_PHASE].get_sec(), temp));
+    AppendArgTagFast(sml_Names::kParamStatsGDSTimeApplyPhase,         sml_Names::kTypeDouble, to_string(thisAgent->timers_gds_cpu_time[APPLY_PHASE].get_sec(), temp));
     AppendArgTagFast(sml_Names::kParamStatsInputFunctionTime,                    sml_Names::kTypeDouble, to_string(thisAgent->timers_input_function_cpu_time.get_sec(), temp));
     AppendArgTagFast(sml_Names::kParamStatsOutputFunctionTime,                    sml_Names::kTypeDouble, to_string(thisAgent->timers_output_function_cpu_time.get_sec(), temp));
 
@@ -215,13 +237,6 @@ bool CommandLineInterface::DoStats(const StatsBitset& options, int sort)
     AppendArgTagFast(sml_Names::kParamStatsChunkingTimeDecisionPhase,            sml_Names::kTypeDouble, to_string(thisAgent->timers_chunking_cpu_time[DECIDE_PHASE].get_sec(), temp));
     AppendArgTagFast(sml_Names::kParamStatsChunkingTimeProposePhase,            sml_Names::kTypeDouble, to_string(thisAgent->timers_chunking_cpu_time[PROPOSE_PHASE].get_sec(), temp));
     AppendArgTagFast(sml_Names::kParamStatsChunkingTimeApplyPhase,                sml_Names::kTypeDouble, to_string(thisAgent->timers_chunking_cpu_time[APPLY_PHASE].get_sec(), temp));
-    AppendArgTagFast(sml_Names::kParamStatsGDSTimeInputPhase,         sml_Names::kTypeDouble, to_string(thisAgent->timers_gds_cpu_time[INPUT_PHASE].get_sec(), temp));
-    AppendArgTagFast(sml_Names::kParamStatsGDSTimePreferencePhase,    sml_Names::kTypeDouble, to_string(thisAgent->timers_gds_cpu_time[PREFERENCE_PHASE].get_sec(), temp));
-    AppendArgTagFast(sml_Names::kParamStatsGDSTimeWorkingMemoryPhase, sml_Names::kTypeDouble, to_string(thisAgent->timers_gds_cpu_time[WM_PHASE].get_sec(), temp));
-    AppendArgTagFast(sml_Names::kParamStatsGDSTimeOutputPhase,        sml_Names::kTypeDouble, to_string(thisAgent->timers_gds_cpu_time[OUTPUT_PHASE].get_sec(), temp));
-    AppendArgTagFast(sml_Names::kParamStatsGDSTimeDecisionPhase,      sml_Names::kTypeDouble, to_string(thisAgent->timers_gds_cpu_time[DECIDE_PHASE].get_sec(), temp));
-    AppendArgTagFast(sml_Names::kParamStatsGDSTimeProposePhase,       sml_Names::kTypeDouble, to_string(thisAgent->timers_gds_cpu_time[PROPOSE_PHASE].get_sec(), temp));
-    AppendArgTagFast(sml_Names::kParamStatsGDSTimeApplyPhase,         sml_Names::kTypeDouble, to_string(thisAgent->timers_gds_cpu_time[APPLY_PHASE].get_sec(), temp));
 #endif // DETAILED_TIMING_STATS
 
     AppendArgTagFast(sml_Names::kParamStatsMaxDecisionCycleTimeCycle,            sml_Names::kTypeInt,    to_string(thisAgent->max_dc_time_cycle, temp));
@@ -238,11 +253,13 @@ bool CommandLineInterface::DoStats(const StatsBitset& options, int sort)
     AppendArgTagFast(sml_Names::kParamStatsMaxDecisionCycleFireCountCycle,        sml_Names::kTypeInt,    to_string(thisAgent->max_dc_production_firing_count_cycle, temp));
     AppendArgTagFast(sml_Names::kParamStatsMaxDecisionCycleFireCountValue,        sml_Names::kTypeInt,    to_string(thisAgent->max_dc_production_firing_count_value, temp));
 
-    AppendArgTagFast(sml_Names::kParamStatsMemoryUsageMiscellaneous,            sml_Names::kTypeInt,    to_string(thisAgent->memoryManager->memory_for_usage[MISCELLANEOUS_MEM_USAGE], temp));
-    AppendArgTagFast(sml_Names::kParamStatsMemoryUsageHash,                        sml_Names::kTypeInt,    to_string(thisAgent->memoryManager->memory_for_usage[HASH_TABLE_MEM_USAGE], temp));
-    AppendArgTagFast(sml_Names::kParamStatsMemoryUsageString,                    sml_Names::kTypeInt,    to_string(thisAgent->memoryManager->memory_for_usage[STRING_MEM_USAGE], temp));
-    AppendArgTagFast(sml_Names::kParamStatsMemoryUsagePool,                        sml_Names::kTypeInt,    to_string(thisAgent->memoryManager->memory_for_usage[POOL_MEM_USAGE], temp));
-    AppendArgTagFast(sml_Names::kParamStatsMemoryUsageStatsOverhead,            sml_Names::kTypeInt,    to_string(thisAgent->memoryManager->memory_for_usage[STATS_OVERHEAD_MEM_USAGE], temp));
+    size_t memory_for_usage[NUM_MEM_USAGE_CODES];
+    Memory_Manager::get_total_memory_usage(memory_for_usage);
+    AppendArgTagFast(sml_Names::kParamStatsMemoryUsageMiscellaneous,            sml_Names::kTypeInt,    to_string(memory_for_usage[MISCELLANEOUS_MEM_USAGE], temp));
+    AppendArgTagFast(sml_Names::kParamStatsMemoryUsageHash,                        sml_Names::kTypeInt,    to_string(memory_for_usage[HASH_TABLE_MEM_USAGE], temp));
+    AppendArgTagFast(sml_Names::kParamStatsMemoryUsageString,                    sml_Names::kTypeInt,    to_string(memory_for_usage[STRING_MEM_USAGE], temp));
+    AppendArgTagFast(sml_Names::kParamStatsMemoryUsagePool,                        sml_Names::kTypeInt,    to_string(memory_for_usage[POOL_MEM_USAGE], temp));
+    AppendArgTagFast(sml_Names::kParamStatsMemoryUsageStatsOverhead,            sml_Names::kTypeInt,    to_string(memory_for_usage[STATS_OVERHEAD_MEM_USAGE], temp));
 
     if (options.test(STATS_RESET))
     {
@@ -498,13 +515,29 @@ void CommandLineInterface::GetSystemStats()
     uint64_t wme_changes = thisAgent->wme_addition_count + thisAgent->wme_removal_count;
     m_Result << wme_changes << " wme changes ("
              << thisAgent->wme_addition_count << " additions, "
-             << thisAgent->wme_removal_count << " removals)\n";
+             << thisAgent->wme_removal_count << " removals, "
+             << thisAgent->wme_cancel_count << " cancelled)\n";
 
     m_Result << "WM size: "
              << thisAgent->num_wmes_in_rete << " current, "
              << (thisAgent->num_wm_sizes_accumulated ? (thisAgent->cumulative_wm_size / thisAgent->num_wm_sizes_accumulated) : 0.0)
              << " mean, "
-             << thisAgent->max_wm_size << " maximum\n\n";
+             << thisAgent->max_wm_size << " maximum\n";
+
+    m_Result << "GDS: "
+             << thisAgent->gds_elaboration_passes << " elaboration passes, "
+             << thisAgent->gds_instantiations_explored << " instantiations explored, "
+             << thisAgent->gds_wme_additions << " wme additions, "
+             << thisAgent->gds_state_removals << " states removed";
+#ifndef NO_TIMING_STUFF
+    double gds_sec = 0.0;
+    for (int i = 0; i < NUM_PHASE_TYPES; i++)
+    {
+        gds_sec += thisAgent->timers_gds_cpu_time[i].get_sec();
+    }
+    m_Result << " (" << gds_sec << " sec)";
+#endif // NO_TIMING_STUFF
+    m_Result << "\n\n";
 }
 
 void CommandLineInterface::GetMaxStats()
@@ -539,53 +572,149 @@ void CommandLineInterface::GetMaxStats()
 
 }
 
+/* Memory is reported for the whole process, summed across the pools of every agent. */
 void CommandLineInterface::GetMemoryStats()
 {
-    agent* thisAgent = m_pAgentSML->GetSoarAgent();
+    size_t memory_for_usage[NUM_MEM_USAGE_CODES];
     size_t total = 0;
+
+    Memory_Manager::get_total_memory_usage(memory_for_usage);
     for (int i = 0; i < NUM_MEM_USAGE_CODES; i++)
     {
-        total += thisAgent->memoryManager->memory_for_usage[i];
+        total += memory_for_usage[i];
     }
 
     m_Result << std::setw(8) << total << " bytes total memory allocated\n";
-    m_Result << std::setw(8) << thisAgent->memoryManager->memory_for_usage[STATS_OVERHEAD_MEM_USAGE] << " bytes statistics overhead\n";
-    m_Result << std::setw(8) << thisAgent->memoryManager->memory_for_usage[STRING_MEM_USAGE] << " bytes for strings\n";
-    m_Result << std::setw(8) << thisAgent->memoryManager->memory_for_usage[HASH_TABLE_MEM_USAGE] << " bytes for hash tables\n";
-    m_Result << std::setw(8) << thisAgent->memoryManager->memory_for_usage[POOL_MEM_USAGE] << " bytes for various memory pools\n";
-    m_Result << std::setw(8) << thisAgent->memoryManager->memory_for_usage[MISCELLANEOUS_MEM_USAGE] << " bytes for miscellaneous other things\n";
+    m_Result << std::setw(8) << memory_for_usage[STATS_OVERHEAD_MEM_USAGE] << " bytes statistics overhead\n";
+    m_Result << std::setw(8) << memory_for_usage[STRING_MEM_USAGE] << " bytes for strings\n";
+    m_Result << std::setw(8) << memory_for_usage[HASH_TABLE_MEM_USAGE] << " bytes for hash tables\n";
+    m_Result << std::setw(8) << memory_for_usage[POOL_MEM_USAGE] << " bytes for various memory pools\n";
+    m_Result << std::setw(8) << memory_for_usage[MISCELLANEOUS_MEM_USAGE] << " bytes for miscellaneous other things\n";
+
+    string_arena_stats arena;
+    Memory_Manager::get_total_string_arena_stats(arena);
+    m_Result << std::setw(8) << arena.chunk_bytes << " bytes in symbol name arenas (" << arena.live_strings << " names, " << arena.live_bytes << " bytes in use)\n";
+    m_Result << std::setw(8) << arena.saved_bytes << " bytes saved over separately allocated names\n";
 
     GetMemoryPoolStatistics();
 }
 
 void CommandLineInterface::GetMemoryPoolStatistics()
 {
-    agent* thisAgent = m_pAgentSML->GetSoarAgent();
+    std::vector< memory_pool > pools;
+
+    Memory_Manager::get_total_memory_pools(pools);
     m_Result << "Memory pool statistics:\n\n";
-#ifdef MEMORY_POOL_STATS
     m_Result << "Pool Name        Used Items  Free Items  Item Size  Itm/Blk  Blocks  Total Bytes\n";
     m_Result << "---------------  ----------  ----------  ---------  -------  ------  -----------\n";
-#else
-    m_Result << "Pool Name        Item Size  Itm/Blk  Blocks  Total Bytes\n";
-    m_Result << "---------------  ---------  -------  ------  -----------\n";
-#endif
 
-    for (memory_pool* p = thisAgent->memoryManager->memory_pools_in_use; p != NIL; p = p->next)
+    for (std::vector< memory_pool >::iterator p = pools.begin(); p != pools.end(); ++p)
     {
         m_Result << std::setw(MAX_POOL_NAME_LENGTH) << p->name;
-#ifdef MEMORY_POOL_STATS
         m_Result << "  " << std::setw(10) << p->used_count;
-        size_t total_items = p->num_blocks * p->items_per_block;
-        m_Result << "  " << std::setw(10) << total_items - p->used_count;
-#endif
+        m_Result << "  " << std::setw(10) << p->num_items - p->used_count;
         m_Result << "  " << std::setw(9) << p->item_size;
         m_Result << "  " << std::setw(7) << p->items_per_block;
         m_Result << "  " << std::setw(6) << p->num_blocks;
-        m_Result << "  " << std::setw(11) << p->num_blocks* p->items_per_block* p->item_size;
+        m_Result << "  " << std::setw(11) << p->num_items * p->item_size;
         m_Result << "\n";
     }
 }
 
+/* Running counts for every pool, summed over all agents.  The peak is the
+ * sum of each agent's own high-water mark. */
+void CommandLineInterface::GetMemoryPoolCounters()
+{
+    std::vector< memory_pool > pools;
+    std::string temp;
+
+    Memory_Manager::get_total_memory_pools(pools);
+
+    if (!m_RawOutput)
+    {
+        for (std::vector< memory_pool >::iterator p = pools.begin(); p != pools.end(); ++p)
+        {
+            XMLBeginTag("pool");
+            XMLAddAttribute("name", p->name);
+            XMLAddAttribute("itemsize", to_string(p->item_size, temp).c_str());
+            XMLAddAttribute("allocs", to_string(p->alloc_count, temp).c_str());
+            XMLAddAttribute("frees", to_string(p->free_count, temp).c_str());
+            XMLAddAttribute("used", to_string(p->used_count, temp).c_str());
+            XMLAddAttribute("peak", to_string(p->high_water, temp).c_str());
+            XMLAddAttribute("blocks", to_string(p->num_blocks, temp).c_str());
+            XMLEndTag("pool");
+        }
+        XMLResultToResponse("pools");
+        return;
+    }
+
+    m_Result << "Memory pool counters:\n\n";
+    m_Result << "Pool Name        Item Size        Allocs         Frees  Used Items  Peak Items  Blocks\n";
+    m_Result << "---------------  ---------  ------------  ------------  ----------  ----------  ------\n";
+
+    for (std::vector< memory_pool >::iterator p = pools.begin(); p != pools.end(); ++p)
+    {
+        m_Result << std::setw(MAX_POOL_NAME_LENGTH) << p->name;
+        m_Result << "  " << std::setw(9) << p->item_size;
+        m_Result << "  " << std::setw(12) << p->alloc_count;
+        m_Result << "  " << std::setw(12) << p->free_count;
+        m_Result << "  " << std::setw(10) << p->used_count;
+        m_Result << "  " << std::setw(10) << p->high_water;
+        m_Result << "  " << std::setw(6) << p->num_blocks;
+        m_Result << "\n";
+    }
+}
+
+/* The current agent's samples for one pool, one per decision cycle. */
+bool CommandLineInterface::GetMemoryPoolHistory(const std::string& pool_name)
+{
+    agent* thisAgent = m_pAgentSML->GetSoarAgent();
+    std::vector< uint64_t > cycles;
+    std::vector< pool_sample > samples;
+    std::string temp;
+
+    memory_pool* pool = thisAgent->memoryManager->find_memory_pool(pool_name);
+    if (!pool)
+    {
+        return SetError("No memory pool named " + pool_name + ".");
+    }
+    if (pool->index >= num_memory_pools)
+    {
+        return SetError("Only the core memory pools keep a history.");
+    }
+    thisAgent->memoryManager->get_memory_pool_history(pool, cycles, samples);
+
+    if (!m_RawOutput)
+    {
+        for (size_t i = 0; i < samples.size(); i++)
+        {
+            XMLBeginTag("sample");
+            XMLAddAttribute("dc", to_string(cycles[i], temp).c_str());
+            XMLAddAttribute("used", to_string(samples[i].used_count, temp).c_str());
+            XMLAddAttribute("blocks", to_string(samples[i].num_blocks, temp).c_str());
+            XMLEndTag("sample");
+        }
+        XMLResultToResponse("pool-history");
+        return true;
+    }
+
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        if (i % 20 == 0)
+        {
+            m_Result << "\n";
+            m_Result << "----------- ----------- -----------\n";
+            m_Result << "DC          Used Items  Blocks\n";
+            m_Result << "----------- ----------- -----------\n";
+        }
+
+        m_Result << std::setw(11) << cycles[i] << " ";
+        m_Result << std::setw(11) << samples[i].used_count << " ";
+        m_Result << std::setw(11) << samples[i].num_blocks << "\n";
+    }
+    return true;
+}
+
 void CommandLineInterface::GetReteStats()
 {
     agent* thisAgent = m_pAgentSML->GetSoarAgent();
@@ -653,6 +782,36 @@ void CommandLineInterface::GetReteStats()
              << thisAgent->num_null_right_activations << " null), "
              << thisAgent->num_left_activations << " left ("
              << thisAgent->num_null_left_activations << " null)\n";
+
+    /* --- print token and right memory hash table occupancy --- */
+    rete_ht_stats ht_stats;
+    std::streamsize old_precision = m_Result.precision();
+    m_Result << "\n Hash Table     Buckets       Items   Load        Used  Avg Chain  Longest      Splits      Merges\n";
+    m_Result << "-----------  ----------  ----------  -----  ----------  ---------  -------  ----------  ----------\n";
+    for (i = 0; i < 2; i++)
+    {
+        get_rete_ht_stats(thisAgent, (i == 0), &ht_stats);
+        m_Result << std::setw(11) << ((i == 0) ? "Left/Token" : "Right/WME") << "  "
+                 << std::setw(10) << ht_stats.buckets << "  "
+                 << std::setw(10) << ht_stats.items << "  "
+                 << std::fixed << std::setprecision(2)
+                 << std::setw(5) << (static_cast<double>(ht_stats.items) / ht_stats.buckets) << "  "
+                 << std::setw(10) << ht_stats.used_buckets << "  "
+                 << std::setw(9) << (ht_stats.used_buckets ? static_cast<double>(ht_stats.items) / ht_stats.used_buckets : 0.0) << "  "
+                 << std::setw(7) << ht_stats.longest_chain << "  "
+                 << std::setw(10) << ht_stats.splits << "  "
+                 << std::setw(10) << ht_stats.merges << "\n";
+    }
+
+    /* --- and alpha memory index occupancy --- */
+    alpha_index* am_index = thisAgent->alpha_mem_index;
+    m_Result << "\nAlpha memories: " << am_index->count << " in " << am_index->size << " slots ("
+             << std::setprecision(2) << (static_cast<double>(am_index->count) / am_index->size) << " load), "
+             << (am_index->num_lookups ? static_cast<double>(am_index->num_probes) / am_index->num_lookups : 0.0)
+             << " probes per lookup, "
+             << am_index->num_parallel_batches << " parallel batches\n";
+    m_Result.unsetf(std::ios_base::floatfield);
+    m_Result.precision(old_precision);
 }
 
 
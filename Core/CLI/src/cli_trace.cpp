@@ -82,6 +82,7 @@ bool CommandLineInterface::DoTrace(const WatchBitset& options, const WatchBitset
             PrintCLIMessage_Justify("Goal dependency set changes", (thisAgent->trace_settings[TRACE_GDS_WMES_SYSPARAM] ? "on" : "off"), 60, "-G, --gds-wmes");
             PrintCLIMessage_Justify("Numeric preference calculations", (thisAgent->trace_settings[TRACE_INDIFFERENT_SYSPARAM] ? "on" : "off"), 60, "-i, --indifferent-selection");
             PrintCLIMessage_Justify("Reinforcement learning value updates", (thisAgent->trace_settings[TRACE_RL_SYSPARAM] ? "on" : "off"), 60, "-R, --rl");
+            PrintCLIMessage_Justify("Periodic production reordering", (thisAgent->trace_settings[TRACE_REORDER_SYSPARAM] ? "on" : "off"), 60, "-O, --reorder");
             PrintCLIMessage_Justify("WME Detail Level", ((thisAgent->trace_settings[TRACE_FIRINGS_WME_TRACE_TYPE_SYSPARAM] == NONE_WME_TRACE) ? "none" :
                 ((thisAgent->trace_settings[TRACE_FIRINGS_WME_TRACE_TYPE_SYSPARAM] == TIMETAG_WME_TRACE) ? "timetag" : "full detail")), 60, "--nowmes, --timetags, --fullwmes");
             PrintCLIMessage(" ");
@@ -298,6 +299,13 @@ bool CommandLineInterface::DoTrace(const WatchBitset& options, const WatchBitset
         traceFeedback.append("when working memory elements are added to or removed from memory.\n");
     }
     
+    if (options.test(WATCH_REORDER))
+    {
+        set_trace_setting(thisAgent, TRACE_REORDER_SYSPARAM, settings.test(WATCH_REORDER));
+        traceFeedback.append(settings.test(WATCH_REORDER) ? "Now printing " : "Will not print ");
+        traceFeedback.append("productions rebuilt or kept by periodic reordering.\n");
+    }
+
     if (options.test(WATCH_WATERFALL))
     {
         set_trace_setting(thisAgent, TRACE_WATERFALL_SYSPARAM, settings.test(WATCH_WATERFALL));
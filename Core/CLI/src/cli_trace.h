@@ -58,6 +58,7 @@ namespace cli
                     {'N', "none",                        OPTARG_NONE},
                     {'n', "nowmes",                      OPTARG_NONE},
                     {'o', "consistency",                 OPTARG_OPTIONAL},
+                    {'O', "reorder",                     OPTARG_OPTIONAL},
                     {'p', "phases",                      OPTARG_OPTIONAL},
                     {'P', "productions",                 OPTARG_OPTIONAL},
                     {'r', "preferences",                 OPTARG_OPTIONAL},
@@ -298,6 +299,19 @@ namespace cli
                             }
                             break;
 
+                        case 'O':
+                            options.set(cli::WATCH_REORDER);
+                            if (opt.GetOptionArgument().size())
+                            {
+                                if (!CheckOptargRemoveOrZero(opt)) return cli.SetError(opt.GetError().c_str());
+                                settings.reset(cli::WATCH_REORDER);
+                            }
+                            else
+                            {
+                                settings.set(cli::WATCH_REORDER);
+                            }
+                            break;
+
                         case 'p':
                             options.set(cli::WATCH_PHASES);
                             if (opt.GetOptionArgument().size())
@@ -1241,6 +1241,11 @@ char const* Kernel::ExecuteCommandLine(char const* pCommandLine, char const* pAg
         {
             m_CommandLineResult += response.GetErrorTag()->GetCharacterData();
         }
+        else if (GetConnection()->HadError())
+        {
+            // The command never reached the kernel
+            m_CommandLineResult += Error::GetErrorDescription(GetConnection()->GetLastError());
+        }
         else
         {
             m_CommandLineResult += "<No error message returned by command>";
@@ -45,6 +45,9 @@
 using namespace sml ;
 using namespace soarxml;
 
+// Set on each thread while it steps an agent alongside others (see SetInParallelStep)
+static thread_local bool s_InParallelStep = false ;
+
 /*************************************************************
 * @brief Constructor
 *************************************************************/
@@ -474,6 +477,16 @@ ElementXML* Connection::InvokeCallbacks(ElementXML* pIncomingMsg)
     return NULL ;
 }
 
+void Connection::SetInParallelStep(bool state)
+{
+    s_InParallelStep = state ;
+}
+
+bool Connection::IsInParallelStep()
+{
+    return s_InParallelStep ;
+}
+
 /*************************************************************
 * @brief Send a message and get the response.
 *
@@ -489,6 +502,14 @@ bool Connection::SendMessageGetResponse(AnalyzeXML* pAnalysis, ElementXML* pMsg)
         return false ;
     }
     
+    // A client handler called while agents step in parallel would wait forever
+    // for the connection, which the thread that started the run is holding.
+    if (!IsKernelSide() && s_InParallelStep)
+    {
+        SetError(Error::kInParallelStep) ;
+        return false ;
+    }
+    
     // Make sure only one thread is sending messages at a time
     // (This allows us to run a separate thread in clients polling for events even
     //  when the client is sleeping, but we don't want them both to be sending/receiving at the same time).
@@ -300,6 +300,16 @@ namespace sml
                 return m_bIsKernelSide ;
             }
             
+            /*************************************************************
+            * @brief Marks the calling thread as stepping an agent while other
+            *        agents step on other threads (see "soar run-threads").
+            *        A client can't send commands from such a thread until the
+            *        step is over: the thread that started the run holds the
+            *        connection and the kernel, so the send fails instead.
+            *************************************************************/
+            static void         SetInParallelStep(bool state) ;
+            static bool         IsInParallelStep() ;
+            
             /*************************************************************
             * @brief Send a message to the SML receiver (e.g. from the environment to the Soar kernel).
             *        The error code that is returned indicates whether the command was successfully sent,
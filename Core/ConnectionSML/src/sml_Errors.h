@@ -43,6 +43,7 @@ class Error
             kDetailedError,
             kAgentExists,
             kOutputError,
+            kInParallelStep,
         } ;
         
         /** Returns a description of the error which can be shown to a user */
@@ -96,6 +97,8 @@ class Error
                     return "Trying to create an agent that already exists in the kernel." ;
                 case kOutputError:
                     return "Invalid format for output." ;
+                case kInParallelStep:
+                    return "Agents are stepping on several run threads, so commands can't be sent from a handler until the run returns." ;
             }
             
             return "Unknown error code" ;
@@ -362,8 +362,12 @@ char const* const sml_Names::kParamStatsGDSTimePreferencePhase    = "statsgdstim
 char const* const sml_Names::kParamStatsGDSTimeWorkingMemoryPhase = "statsgdstimeworkingmemoryphase" ;
 char const* const sml_Names::kParamStatsGDSTimeOutputPhase        = "statsgdstimeoutputphase" ;
 char const* const sml_Names::kParamStatsGDSTimeDecisionPhase      = "statsgdstimedecisionphase" ;
-char const* const sml_Names::kParamStatsGDSTimeProposePhase       = "statsgdstimedecisionphase" ;
-char const* const sml_Names::kParamStatsGDSTimeApplyPhase         = "statsgdstimedecisionphase" ;
+char const* const sml_Names::kParamStatsGDSTimeProposePhase       = "statsgdstimeproposephase" ;
+char const* const sml_Names::kParamStatsGDSTimeApplyPhase         = "statsgdstimeapplyphase" ;
+char const* const sml_Names::kParamStatsGDSElaborationPasses      = "statsgdselaborationpasses" ;
+char const* const sml_Names::kParamStatsGDSInstantiationsExplored = "statsgdsinstantiationsexplored" ;
+char const* const sml_Names::kParamStatsGDSWmeAdditions           = "statsgdswmeadditions" ;
+char const* const sml_Names::kParamStatsGDSStateRemovals          = "statsgdsstateremovals" ;
 
 char const* const sml_Names::kParamStatsMemoryUsageMiscellaneous            = "statsmemoryusagemiscellaneous" ;
 char const* const sml_Names::kParamStatsMemoryUsageHash                     = "statsmemoryusagehash" ;
@@ -382,6 +386,12 @@ char const* const sml_Names::kParamStatsMaxDecisionCycleSMemTimeValueSec    = "s
 char const* const sml_Names::kParamStatsMaxDecisionCycleFireCountCycle      = "statsmaxdecisioncyclefirecountcycle" ;
 char const* const sml_Names::kParamStatsMaxDecisionCycleFireCountValue      = "statsmaxdecisioncyclefirecountvalue" ;
 
+// Parameter names for production match-profile command
+char const* const sml_Names::kParamMatchProfileLeftActivations  = "matchprofileleftactivations";
+char const* const sml_Names::kParamMatchProfileRightActivations = "matchprofilerightactivations";
+char const* const sml_Names::kParamMatchProfileTokensCreated    = "matchprofiletokenscreated";
+char const* const sml_Names::kParamMatchProfileJoinTests        = "matchprofilejointests";
+
 // Parameter names for watch command
 char const* const sml_Names::kParamWatchDecisions                   = "watchdecisions";
 char const* const sml_Names::kParamWatchPhases                      = "watchphases";
@@ -355,6 +355,10 @@ namespace sml
             static char const* const kParamStatsGDSTimeDecisionPhase;
             static char const* const kParamStatsGDSTimeProposePhase;
             static char const* const kParamStatsGDSTimeApplyPhase;
+            static char const* const kParamStatsGDSElaborationPasses;
+            static char const* const kParamStatsGDSInstantiationsExplored;
+            static char const* const kParamStatsGDSWmeAdditions;
+            static char const* const kParamStatsGDSStateRemovals;
             static char const* const kParamStatsMemoryUsageMiscellaneous;
             static char const* const kParamStatsMemoryUsageHash;
             static char const* const kParamStatsMemoryUsageString;
@@ -372,6 +376,12 @@ namespace sml
             static char const* const kParamStatsMaxDecisionCycleFireCountCycle;
             static char const* const kParamStatsMaxDecisionCycleFireCountValue;
 
+            // Parameter names for production match-profile command
+            static char const* const kParamMatchProfileLeftActivations;
+            static char const* const kParamMatchProfileRightActivations;
+            static char const* const kParamMatchProfileTokensCreated;
+            static char const* const kParamMatchProfileJoinTests;
+
             // Parameter names for watch command
             static char const* const kParamWatchDecisions;
             static char const* const kParamWatchPhases;
@@ -1283,7 +1283,7 @@ bool AgentSML::StartCaptureInput(const std::string& pathname, bool autoflush, ui
     m_pCaptureFile = new std::fstream(pathname.c_str(), std::fstream::out | std::fstream::trunc);
     if (m_pCaptureFile && m_pCaptureFile->good())
     {
-        SoarSeedRNG(seed);
+        SoarSeedRNG(m_agent, seed);
         *m_pCaptureFile << seed << std::endl;
         return true;
     }
@@ -1363,7 +1363,7 @@ bool AgentSML::StartReplayInput(const std::string& pathname)
     {
         return false;
     }
-    SoarSeedRNG(seed);
+    SoarSeedRNG(m_agent, seed);
 
     // load replay file
     while (getline(replayFile, line))
@@ -508,6 +508,21 @@ smlPhase KernelSML::GetStopBefore()
     return m_pRunScheduler->GetStopBefore() ;
 }
 
+/*************************************************************
+* @brief    Sets how many threads step the agents during a run.
+*           This is a setting which modifies the future behavior of all run commands.
+*************************************************************/
+void KernelSML::SetRunThreads(int threads)
+{
+    m_pRunScheduler->SetRunThreads(threads) ;
+    this->FireSystemEvent(smlEVENT_SYSTEM_PROPERTY_CHANGED) ;
+}
+
+int KernelSML::GetRunThreads()
+{
+    return m_pRunScheduler->GetRunThreads() ;
+}
+
 top_level_phase KernelSML::ConvertSMLToSoarPhase(smlPhase phase)
 {
     // check a few
@@ -607,6 +622,18 @@ soarxml::ElementXML* KernelSML::ProcessIncomingSML(Connection* pConnection, soar
         return NULL ;
     }
 
+    // A command arriving on a thread that is stepping an agent alongside others
+    // can't have the kernel, which the thread that started the run is holding.
+    if (Connection::IsInParallelStep())
+    {
+        soarxml::ElementXML* pResponse = pConnection->CreateSMLResponse(pIncomingMsg) ;
+        if (pResponse)
+        {
+            AddErrorMsg(pConnection, pResponse, Error::GetErrorDescription(Error::kInParallelStep)) ;
+        }
+        return pResponse ;
+    }
+
     // Make sure only one thread is executing commands in the kernel at a time.
     // This is really just an insurance policy as I don't think we'll ever execute
     // commands on different threads within kernelSML because we
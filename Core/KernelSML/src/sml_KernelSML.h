@@ -420,6 +420,13 @@ namespace sml
             smlPhase GetStopBefore() ;
             top_level_phase ConvertSMLToSoarPhase(smlPhase phase) ;
             
+            /*************************************************************
+            * @brief    Sets how many threads step the agents during a run.
+            *           This is a setting which modifies the future behavior of all run commands.
+            *************************************************************/
+            void SetRunThreads(int threads) ;
+            int GetRunThreads() ;
+            
             /*************************************************************
             * @brief    If true, whenever a user issues a command that changes the state of the kernel in some manner
             *           the command and its results are echoed to anyone listening.  This is useful when two users
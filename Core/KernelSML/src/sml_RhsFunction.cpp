@@ -16,6 +16,7 @@
 #include "sml_KernelSML.h"
 
 #include "agent.h"
+#include "callback.h"
 #include "mem.h"
 #include "symbol.h"
 #include "symbol_manager.h"
@@ -47,7 +48,13 @@ Symbol* RhsFunction::RhsFunctionCallback(agent* thisAgent, cons* args, void* use
     {
         // Actually make the call.  We can do the dynamic cast because we passed in the
         //  symbol factory and thus know how the symbol was created.
-        Symbol* pReturn = rhsFunction->Execute(&symVector);
+        // Like other callbacks, these run one at a time when agents are stepped
+        //  on separate threads, since many of them use the command line interface.
+        Symbol* pReturn;
+        {
+            std::lock_guard< std::recursive_mutex > guard(soar_callback_mutex());
+            pReturn = rhsFunction->Execute(&symVector);
+        }
         
         // Return the result, assuming it is not NIL
         if (rhsFunction->IsValueReturned() == true)
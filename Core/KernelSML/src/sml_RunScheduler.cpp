@@ -18,6 +18,10 @@
 #include "sml_KernelSML.h"
 #include "sml_AgentSML.h"
 #include "sml_Events.h"
+#include "sml_Connection.h"
+
+#include "memory_manager.h"
+#include "worker_pool.h"
 
 #include <cassert>
 
@@ -29,6 +33,13 @@ RunScheduler::RunScheduler(KernelSML* pKernelSML)
     m_RunFlags = sml_NONE ;
     m_IsRunning = false ;
     m_StopBeforePhase = sml_APPLY_PHASE ;
+    m_RunThreads = 1 ;
+    m_pRunWorkers = NULL ;
+}
+
+RunScheduler::~RunScheduler()
+{
+    delete m_pRunWorkers ;
 }
 
 /*************************************************************
@@ -267,6 +278,87 @@ void RunScheduler::InitializeStepList()
     }
 }
 
+/*************************************************************
+* @brief    Records the result of one interleave step for an agent
+*           and takes it off the step or run list when it is done.
+*           Returns true if the run has to keep going for this agent.
+*************************************************************/
+bool RunScheduler::FinishAgentStep(AgentSML* pAgentSML, smlRunResult runResult, bool forever, smlRunStepSize runStepSize, uint64_t count)
+{
+    bool keepRunning = false ;
+
+    // if agent finished one runType, incr counter and remove from stepList
+    if (pAgentSML->CompletedRunType(pAgentSML->GetRunCounter(runStepSize)) /* || pAgent->MaxNilOutputCyclesReached */)
+    {
+        pAgentSML->IncrementLocalRunCounter();
+        pAgentSML->PutAgentOnStepList(false);
+    }
+    else
+    {
+        keepRunning = true ;
+    }
+
+    // if agent finished count runTypes, remove from RunList, else runFinished = false;
+    // can also return true if a gSKI_STOP_AFTER_DECISION_CYCLE interrupt occurred
+    // or is pending on agents with RunType DECIDE or FOREVER.
+    bool agentFinishedRun = IsAgentFinished(pAgentSML, forever, runStepSize, count) ;
+
+    // Have to test the run state to find out if we are still ok to keep running
+    // (not sure if runResult provides this as well, but they're from different enums).
+    smlRunState runState = pAgentSML->GetRunState() ;
+
+    // An agent should return "stopped" if it's just pausing in the middle of a run
+    // before we run it for the next phase.  Anything else means this agent is done running.
+    if (runState != sml_RUNSTATE_STOPPED || agentFinishedRun)
+    {
+        pAgentSML->RemoveAgentFromRunList() ;
+        pAgentSML->SetResultOfRun(runResult) ;
+        // If we know we won't have to step to StopBefore phase
+        // notify listeners that this agent is finished running
+        if ((runStepSize != sml_DECIDE) && !forever)
+        {
+            pAgentSML->FireRunEvent(smlEVENT_AFTER_RUN_ENDS) ;
+        }
+    }
+    else
+    {
+        // If at least one agent wants to keep running, we keep running.
+        keepRunning = true ;
+    }
+
+    return keepRunning ;
+}
+
+/*************************************************************
+* @brief    Steps every agent on the step list one interleave step
+*           on the run thread pool and waits for all of them.
+*           The agents and their results are left in m_StepAgents
+*           and m_StepResults, in agent map order.
+*************************************************************/
+void RunScheduler::StepAgentsInParallel(smlRunStepSize interleaveStepSize)
+{
+    m_StepAgents.clear() ;
+    for (AgentMapIter iter = m_pKernelSML->m_AgentMap.begin() ; iter != m_pKernelSML->m_AgentMap.end() ; iter++)
+    {
+        if (iter->second->IsAgentOnStepList())
+        {
+            m_StepAgents.push_back(iter->second) ;
+        }
+    }
+    m_StepResults.assign(m_StepAgents.size(), sml_RUN_ERROR) ;
+
+    // The agents' STL containers share the MPM's pools, which only need their lock
+    // while more than one agent is stepping.
+    Memory_Manager::Get_MPM().set_shared_locking(true) ;
+    m_pRunWorkers->run(m_StepAgents.size(), [this, interleaveStepSize](size_t i)
+    {
+        Connection::SetInParallelStep(true) ;
+        m_StepResults[i] = m_StepAgents[i]->StepInClientThread(interleaveStepSize) ;
+        Connection::SetInParallelStep(false) ;
+    }) ;
+    Memory_Manager::Get_MPM().set_shared_locking(false) ;
+}
+
 /********************************************************************
 * @brief    Returns true if all currently active agents have not yet
 *           completed a RunType.
@@ -764,6 +856,17 @@ smlRunResult RunScheduler::RunScheduledAgents(bool forever, smlRunStepSize runSt
 
     int interruptCheckRate = m_pKernelSML->GetInterruptCheckRate() ;
 
+    // Agents only share a step thread pool if there is more than one thread to run on.
+    if (m_pRunWorkers && (m_RunThreads <= 1 || m_pRunWorkers->num_threads() != static_cast<size_t>(m_RunThreads)))
+    {
+        delete m_pRunWorkers ;
+        m_pRunWorkers = NULL ;
+    }
+    if (!m_pRunWorkers && m_RunThreads > 1)
+    {
+        m_pRunWorkers = new Worker_Pool(m_RunThreads) ;
+    }
+
     // If we need to synchronize agents, we'll set the synchAgent pointer.
     // Otherwise, we'll clear it to indicate no synch needed.
     // This only matters when interleaving by Phases, since SoarKernel methods
@@ -833,6 +936,22 @@ smlRunResult RunScheduler::RunScheduledAgents(bool forever, smlRunStepSize runSt
             //    note that there is not a corresponding AFTER_AGENTS_RUN_STEP event...
             m_pKernelSML->FireSystemEvent(smlEVENT_BEFORE_AGENTS_RUN_STEP) ;
 
+            if (m_pRunWorkers)
+            {
+                // Every agent on the step list takes its step at once, then the results
+                // are recorded in the same order the sequential loop below uses.
+                StepAgentsInParallel(interleaveStepSize) ;
+
+                for (size_t i = 0 ; i < m_StepAgents.size() ; i++)
+                {
+                    if (FinishAgentStep(m_StepAgents[i], m_StepResults[i], forever, runStepSize, count))
+                    {
+                        runFinished = false ;
+                    }
+                }
+                continue ;
+            }
+
             for (AgentMapIter iter = m_pKernelSML->m_AgentMap.begin() ; iter != m_pKernelSML->m_AgentMap.end() ; iter++)
             {
                 AgentSML* pAgentSML = iter->second ;
@@ -845,43 +964,8 @@ smlRunResult RunScheduler::RunScheduledAgents(bool forever, smlRunStepSize runSt
 
                     // halted and running agents will return an error from StepInClientThread
                     //
-
-                    // if agent finished one runType, incr counter and remove from stepList
-                    if (pAgentSML->CompletedRunType(pAgentSML->GetRunCounter(runStepSize)) /* || pAgent->MaxNilOutputCyclesReached */)
-                    {
-                        pAgentSML->IncrementLocalRunCounter();
-                        pAgentSML->PutAgentOnStepList(false);
-                    }
-                    else
-                    {
-                        runFinished = false;
-                    }
-
-                    // if agent finished count runTypes, remove from RunList, else runFinished = false;
-                    // can also return true if a gSKI_STOP_AFTER_DECISION_CYCLE interrupt occurred
-                    // or is pending on agents with RunType DECIDE or FOREVER.
-                    bool agentFinishedRun = IsAgentFinished(pAgentSML, forever, runStepSize, count) ;
-
-                    // Have to test the run state to find out if we are still ok to keep running
-                    // (not sure if runResult provides this as well, but they're from different enums).
-                    smlRunState runState = pAgentSML->GetRunState() ;
-
-                    // An agent should return "stopped" if it's just pausing in the middle of a run
-                    // before we run it for the next phase.  Anything else means this agent is done running.
-                    if (runState != sml_RUNSTATE_STOPPED || agentFinishedRun)
-                    {
-                        pAgentSML->RemoveAgentFromRunList() ;
-                        pAgentSML->SetResultOfRun(runResult) ;
-                        // If we know we won't have to step to StopBefore phase
-                        // notify listeners that this agent is finished running
-                        if ((runStepSize != sml_DECIDE) && !forever)
-                        {
-                            pAgentSML->FireRunEvent(smlEVENT_AFTER_RUN_ENDS) ;
-                        }
-                    }
-                    else
+                    if (FinishAgentStep(pAgentSML, runResult, forever, runStepSize, count))
                     {
-                        // If at least one agent wants to keep running, we keep running.
                         runFinished = false ;
                     }
                 }
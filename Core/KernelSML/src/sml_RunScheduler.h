@@ -13,6 +13,10 @@
 
 #include "sml_Events.h"
 
+#include <vector>
+
+class Worker_Pool ;
+
 namespace sml
 {
 
@@ -34,8 +38,16 @@ namespace sml
             // When running multiple agents, we synchronize them to this agent (same phase) before starting the real run.
             AgentSML*   m_pSynchAgentSML ;
             
+            // With more than one run thread, the agents on the step list all take their
+            // step at once on a pool of that many threads.  The pool is made when a run starts.
+            int         m_RunThreads ;
+            Worker_Pool* m_pRunWorkers ;
+            std::vector<AgentSML*>    m_StepAgents ;
+            std::vector<smlRunResult> m_StepResults ;
+            
         public:
             RunScheduler(KernelSML* pKernelSML) ;
+            ~RunScheduler() ;
             
             /********************************************************************
             * @brief    This is a method for getting the default value
@@ -114,6 +126,25 @@ namespace sml
                 return m_StopBeforePhase ;
             }
             
+            /*********************************************************************
+            * @brief    Sets how many threads step the scheduled agents.  With one,
+            *           agents take turns on the calling thread.  With more, every
+            *           agent still stepping takes its next interleave step at the
+            *           same time as the others, and the run waits for all of them
+            *           before the next step, so agents stay as closely in step as
+            *           they do on one thread.  While they do, client handlers
+            *           can't send commands (see Connection::SetInParallelStep).
+            *           Takes effect at the next run.
+            **********************************************************************/
+            void SetRunThreads(int threads)
+            {
+                m_RunThreads = threads ;
+            }
+            int GetRunThreads()
+            {
+                return m_RunThreads ;
+            }
+            
         protected:
             bool            AgentsStillStepping() ;
             bool            AreAgentsSynchronized(AgentSML* pSynchAgent) ;
@@ -131,6 +162,8 @@ namespace sml
             void            TerminateUpdateWorldEvents(bool removeListeners) ;
             void            TestForFiringUpdateWorldEvents();
             bool            TestIfAllFinished(bool forever, smlRunStepSize runStepSize, uint64_t count) ;
+            bool            FinishAgentStep(AgentSML* pAgentSML, smlRunResult runResult, bool forever, smlRunStepSize runStepSize, uint64_t count) ;
+            void            StepAgentsInParallel(smlRunStepSize interleaveStepSize) ;
             
             AgentSML*       GetAgentToSynchronizeWith() ;
     } ;
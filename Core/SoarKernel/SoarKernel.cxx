@@ -84,5 +84,6 @@
 #include <visualize_settings.cpp>
 #include <working_memory_activation.cpp>
 #include <working_memory.cpp>
+#include <worker_pool.cpp>
 #include <xml.cpp>
 
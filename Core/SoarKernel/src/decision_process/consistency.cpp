@@ -315,6 +315,7 @@ void remove_current_decision(agent* thisAgent, slot* s)
 
     /* If there is an operator in the slot, remove it */
     remove_wmes_for_context_slot(thisAgent, s);
+    s->consistent_at = 0;
 
     /* If there are any subgoals, remove those */
     if (s->id->id->lower_goal)
@@ -366,7 +367,9 @@ bool check_context_slot_decisions(agent* thisAgent, goal_stack_level level)
 #ifdef DEBUG_CONSISTENCY_CHECK
             printf("      This is a goal that either has subgoals or, if the bottom goal, has an operator in the slot\n");
 #endif
-            if (s->changed)   /* Only need to check a goal if its prefs have changed */
+            /* Only need to check a goal if its prefs have changed, and only once
+               for each change, see consistent_at in decide.h */
+            if (s->changed && (s->consistent_at != s->pref_changes))
             {
 #ifdef DEBUG_CONSISTENCY_CHECK
                 printf("      This goal's preferences have changed.\n");
@@ -386,6 +389,7 @@ bool check_context_slot_decisions(agent* thisAgent, goal_stack_level level)
                     return false;
                     break;   /* No need to continue once a decision is removed */
                 }
+                s->consistent_at = s->pref_changes;
             }
         }
 #ifdef DEBUG_CONSISTENCY_CHECK
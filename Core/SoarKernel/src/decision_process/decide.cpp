@@ -481,6 +481,15 @@ void do_promotion(agent* thisAgent)
          the link count, nothing else--because we already took the TC of
          each id in step 3, so we're already certain of what's connected
          and what's not.  (Here link_update_mode is JUST_UPDATE_COUNT.)
+
+   With "soar gc-batch" above 0, stages (3) and (4) are deferred while the
+   top state is the only goal:  the ids with unknown level are left on
+   ids_with_unknown_level, and more pile up there in later phases, until
+   gc-batch of them are waiting or gc-batch decision cycles have passed.
+   One mark & walk then sorts them all out.  With no substates no id can
+   be demoted, so holding them back only delays the GC of what's really
+   disconnected; anything that drops to a link count of 0 meanwhile is
+   still GC'd by stages (1) and (2) at the end of its phase.
 ====================================================================== */
 
 /* ----------------------------------------------
@@ -814,6 +823,7 @@ void do_demotion(agent* thisAgent)
 {
     Symbol* g, *id;
     dl_cons* dc, *next_dc;
+    uint64_t batch, held;
 
     /* --- scan through ids_with_unknown_level, move the ones with link_count==0
      *  over to disconnected_ids --- */
@@ -845,9 +855,31 @@ void do_demotion(agent* thisAgent)
     /* --- if nothing's left with an unknown level, we're done --- */
     if (! thisAgent->ids_with_unknown_level)
     {
+        thisAgent->gc_ids_held = false;
         return;
     }
 
+    /* --- with a gc batch, hold them over while there are no substates --- */
+    batch = thisAgent->Decider->settings[DECIDER_GC_BATCH];
+    if (batch && thisAgent->top_goal && !thisAgent->top_goal->id->lower_goal)
+    {
+        if (!thisAgent->gc_ids_held || (thisAgent->d_cycle_count < thisAgent->gc_held_since_cycle))
+        {
+            thisAgent->gc_ids_held = true;
+            thisAgent->gc_held_since_cycle = thisAgent->d_cycle_count;
+        }
+        held = 0;
+        for (dc = thisAgent->ids_with_unknown_level; dc != NIL && held < batch; dc = dc->next)
+        {
+            held++;
+        }
+        if ((held < batch) && (thisAgent->d_cycle_count - thisAgent->gc_held_since_cycle < batch))
+        {
+            return;
+        }
+    }
+    thisAgent->gc_ids_held = false;
+
     /* --- do the mark --- */
     thisAgent->highest_level_anything_could_fall_from =
         LOWEST_POSSIBLE_GOAL_LEVEL;
@@ -1101,6 +1133,115 @@ preference* run_non_context_preference_semantics(agent* thisAgent, slot* s)
     return candidates;
 }
 
+/* ------------------------------------------------------------------
+                  Indifferent Pairs of a Context Slot
+
+   The tie check in run_preference_semantics() asks whether every
+   candidate is binary indifferent to every other one.  Scanning the
+   binary indifferent prefs for each pair of candidates gets slow once
+   an agent proposes a few hundred operators, so context slots keep a
+   count of the binary indifferent prefs between each unordered pair of
+   values, updated as prefs enter and leave the slot.  A pref between a
+   value and itself never matters to the check and isn't counted.
+------------------------------------------------------------------ */
+
+/* --- with fewer candidates than this, the tie check just scans the
+   binary indifferent prefs --- */
+#define INDIFFERENT_PAIR_MIN_CANDIDATES 8
+
+inline std::pair<Symbol*, Symbol*> indifferent_pair_key(preference* pref)
+{
+    if (std::less<Symbol*>()(pref->value, pref->referent))
+    {
+        return std::make_pair(pref->value, pref->referent);
+    }
+    return std::make_pair(pref->referent, pref->value);
+}
+
+void add_indifferent_pair(agent* thisAgent, slot* s, preference* pref)
+{
+    if (pref->value == pref->referent)
+    {
+        return;
+    }
+    if (!s->indifferent_pairs)
+    {
+        s->indifferent_pairs = static_cast<sym_pair_count_map*>(thisAgent->memoryManager->allocate_memory(sizeof(sym_pair_count_map), HASH_TABLE_MEM_USAGE));
+        s->indifferent_pairs = new (s->indifferent_pairs) sym_pair_count_map();
+    }
+    (*s->indifferent_pairs)[indifferent_pair_key(pref)]++;
+}
+
+void remove_indifferent_pair(agent* thisAgent, slot* s, preference* pref)
+{
+    sym_pair_count_map::iterator lIter;
+
+    if ((pref->value == pref->referent) || !s->indifferent_pairs)
+    {
+        return;
+    }
+    lIter = s->indifferent_pairs->find(indifferent_pair_key(pref));
+    if ((lIter != s->indifferent_pairs->end()) && (--lIter->second == 0))
+    {
+        s->indifferent_pairs->erase(lIter);
+    }
+}
+
+/* --- Same answer as the pairwise scan in run_preference_semantics(),
+   but counts each candidate's indifferent partners among the other
+   candidates in one pass over the slot's pairs.  Expects the decider
+   flags of the candidates to be set up for the tie check. --- */
+bool candidates_all_indifferent(slot* s, preference* candidates, bool* some_numeric)
+{
+    sym_to_id_map partners;
+    sym_to_id_map::iterator lFirst, lSecond;
+    sym_pair_count_map::iterator lPair;
+    preference* cand;
+    uint64_t num_candidates;
+
+    num_candidates = 0;
+    for (cand = candidates; cand != NIL; cand = cand->next_candidate)
+    {
+        partners[cand->value] = 0;
+        num_candidates++;
+    }
+    for (lPair = s->indifferent_pairs->begin(); lPair != s->indifferent_pairs->end(); ++lPair)
+    {
+        lFirst = partners.find(lPair->first.first);
+        if (lFirst == partners.end())
+        {
+            continue;
+        }
+        lSecond = partners.find(lPair->first.second);
+        if (lSecond == partners.end())
+        {
+            continue;
+        }
+        lFirst->second++;
+        lSecond->second++;
+    }
+
+    /* Unary and numeric indifferent candidates are fine on their own;
+     * every other one has to be indifferent to all the rest */
+    for (cand = candidates; cand != NIL; cand = cand->next_candidate)
+    {
+        if (cand->value->decider_flag == UNARY_INDIFFERENT_DECIDER_FLAG)
+        {
+            continue;
+        }
+        else if (cand->value->decider_flag == UNARY_INDIFFERENT_CONSTANT_DECIDER_FLAG)
+        {
+            *some_numeric = true;
+            continue;
+        }
+        if (partners.find(cand->value)->second != num_candidates - 1)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 byte run_preference_semantics(agent* thisAgent,
                               slot* s,
                               preference** result_candidates,
@@ -1111,6 +1252,7 @@ byte run_preference_semantics(agent* thisAgent,
     bool match_found, not_all_indifferent, some_numeric, add_OSK, some_not_worst = false;
     preference* candidates;
     Symbol* value;
+    int num_candidates = 0;
 
     /* Set a flag to determine if a context-dependent preference set makes sense in this context.
      * We can ignore OSK prefs when:
@@ -1688,51 +1830,69 @@ byte run_preference_semantics(agent* thisAgent,
     not_all_indifferent = false;
     some_numeric = false;
 
-    for (cand = candidates; cand != NIL; cand = cand->next_candidate)
-    {
+    /* Large candidate sets use the slot's counts of indifferent pairs instead */
 
-        /* If this candidate has a unary indifferent preference, skip. Numeric indifferent
-         * prefs are considered to have an implicit unary indifferent pref,
-         * which is why they are skipped too. */
-
-        if (cand->value->decider_flag == UNARY_INDIFFERENT_DECIDER_FLAG)
+    if (s->indifferent_pairs)
+    {
+        num_candidates = 0;
+        for (cand = candidates; (cand != NIL) && (num_candidates < INDIFFERENT_PAIR_MIN_CANDIDATES); cand = cand->next_candidate)
         {
-            continue;
+            num_candidates++;
         }
-        else if (cand->value->decider_flag == UNARY_INDIFFERENT_CONSTANT_DECIDER_FLAG)
+    }
+
+    if (s->indifferent_pairs && (num_candidates >= INDIFFERENT_PAIR_MIN_CANDIDATES))
+    {
+        not_all_indifferent = !candidates_all_indifferent(s, candidates, &some_numeric);
+    }
+    else
+    {
+        for (cand = candidates; cand != NIL; cand = cand->next_candidate)
         {
-            some_numeric = true;
-            continue;
-        }
 
-        /* Candidate has either only binary indifferences or no indifference prefs
-         * at all, so make sure there is a binary preference between its operator
-         * and every other preference's operator in the candidate list */
+            /* If this candidate has a unary indifferent preference, skip. Numeric indifferent
+             * prefs are considered to have an implicit unary indifferent pref,
+             * which is why they are skipped too. */
 
-        for (p = candidates; p != NIL; p = p->next_candidate)
-        {
-            if (p == cand)
+            if (cand->value->decider_flag == UNARY_INDIFFERENT_DECIDER_FLAG)
             {
                 continue;
             }
-            match_found = false;
-            for (p2 = s->preferences[BINARY_INDIFFERENT_PREFERENCE_TYPE]; p2 != NIL; p2 = p2->next)
-                if (((p2->value == cand->value) && (p2->referent == p->value)) ||
-                    ((p2->value == p->value) && (p2->referent == cand->value)))
+            else if (cand->value->decider_flag == UNARY_INDIFFERENT_CONSTANT_DECIDER_FLAG)
+            {
+                some_numeric = true;
+                continue;
+            }
+
+            /* Candidate has either only binary indifferences or no indifference prefs
+             * at all, so make sure there is a binary preference between its operator
+             * and every other preference's operator in the candidate list */
+
+            for (p = candidates; p != NIL; p = p->next_candidate)
+            {
+                if (p == cand)
+                {
+                    continue;
+                }
+                match_found = false;
+                for (p2 = s->preferences[BINARY_INDIFFERENT_PREFERENCE_TYPE]; p2 != NIL; p2 = p2->next)
+                    if (((p2->value == cand->value) && (p2->referent == p->value)) ||
+                        ((p2->value == p->value) && (p2->referent == cand->value)))
+                    {
+                        match_found = true;
+                        break;
+                    }
+                if (!match_found)
                 {
-                    match_found = true;
+                    not_all_indifferent = true;
                     break;
                 }
-            if (!match_found)
+            }
+            if (not_all_indifferent)
             {
-                not_all_indifferent = true;
                 break;
             }
         }
-        if (not_all_indifferent)
-        {
-            break;
-        }
     }
 
     if (!not_all_indifferent)
@@ -2159,6 +2319,13 @@ void decide_non_context_slot(agent* thisAgent, slot* s)
         else
         {
             remove_from_dll(s->wmes, w, next, prev);
+            /* A pending GDS pass may still put this wme into a GDS, so settle
+             * it first; the removal below must see the same GDS it would have
+             * seen had each new wme been elaborated on its own. */
+            if (thisAgent->parent_list_head)
+            {
+                elaborate_gds(thisAgent);
+            }
             if (w->gds)
             {
                 if (w->gds->goal != NIL)
@@ -2210,12 +2377,17 @@ void decide_non_context_slot(agent* thisAgent, slot* s)
                 element was not created in the top state -- the top goal has
                 no gds).  */
 
-#ifndef NO_TIMING_STUFF
-#ifdef DETAILED_TIMING_STATS
-            thisAgent->timers_gds.start();
-#endif
-#endif
-            thisAgent->parent_list_head = NIL;
+            /* Instantiations found here are queued on parent_list_head and
+             * explored by one elaborate_gds() pass at the end of
+             * decide_non_context_slots().  The only thing a queued pass can
+             * change that we test below is whether a goal still has a GDS
+             * (a GDS is freed once its last wme moves up), so settle the queue
+             * before testing a goal that has one. */
+            if (thisAgent->parent_list_head && (w->preference->o_supported == true) &&
+                (w->preference->level != 1) && w->preference->inst->match_goal->id->gds)
+            {
+                elaborate_gds(thisAgent);
+            }
 
             /* If the working memory element being added is going to have
                 o_supported preferences and the instantiation that created it
@@ -2261,18 +2433,6 @@ void decide_non_context_slot(agent* thisAgent, slot* s)
                 }
             }
 
-            if (thisAgent->parent_list_head)
-            {
-                elaborate_gds(thisAgent);
-            }
-
-            #ifndef NO_TIMING_STUFF
-            #ifdef DETAILED_TIMING_STATS
-            thisAgent->timers_gds.stop();
-            thisAgent->timers_gds_cpu_time[thisAgent->current_phase].update(thisAgent->timers_gds);
-            #endif
-            #endif
-
             add_wme_to_wm(thisAgent, w);
         }
     }
@@ -2299,6 +2459,12 @@ void decide_non_context_slots(agent* thisAgent)
         s->changed = NIL;
         thisAgent->memoryManager->free_with_pool(MP_dl_cons, dc);
     }
+
+    /* --- one GDS pass for the new o-supported wmes of every slot above --- */
+    if (thisAgent->parent_list_head)
+    {
+        elaborate_gds(thisAgent);
+    }
 }
 
 /* ------------------------------------------------------------------
@@ -2390,6 +2556,7 @@ void remove_existing_context_and_descendents(agent* thisAgent, Symbol* goal)
     {
         thisAgent->bottom_goal = goal->id->higher_goal;
         thisAgent->bottom_goal->id->lower_goal = NIL;
+        thisAgent->bottom_goal->id->operator_slot->consistent_at = 0;
     }
 
     /* --- remove any preferences supported by this goal --- */
@@ -2799,6 +2966,7 @@ bool decide_context_slot(agent* thisAgent, Symbol* goal, slot* s, bool predict =
 
     /* --- mark the slot as not changed --- */
     s->changed = NIL;
+    s->consistent_at = 0;
 
     /* --- determine the attribute of the impasse (if there is no impasse,
     * this doesn't matter) --- */
@@ -3516,21 +3684,16 @@ void print_lowest_slot_in_context_stack(agent* thisAgent)
     }
 }
 
+/* Queues an instantiation for the next elaborate_gds() pass.  Every caller
+ * tests and sets inst->GDS_evaluated_already around this call, so an
+ * instantiation is queued at most once and no scan of the queue is needed. */
 void uniquely_add_to_head_of_dll(agent* thisAgent, instantiation* inst)
 {
+    parent_inst* new_pi;
 
-    parent_inst* new_pi, *curr_pi;
-
-    for (curr_pi = thisAgent->parent_list_head; curr_pi; curr_pi = curr_pi->next)
-    {
-        if (curr_pi->inst == inst) return;
-    } /* end for loop */
-
-    new_pi = static_cast<parent_inst*>(malloc(sizeof(parent_inst)));
-    new_pi->next = NIL;
-    new_pi->prev = NIL;
+    thisAgent->memoryManager->allocate_with_pool(MP_parent_inst, &new_pi);
     new_pi->inst = inst;
-
+    new_pi->prev = NIL;
     new_pi->next = thisAgent->parent_list_head;
 
     if (thisAgent->parent_list_head != NIL) thisAgent->parent_list_head->prev = new_pi;
@@ -3542,6 +3705,7 @@ void add_wme_to_gds(agent* thisAgent, goal_dependency_set* gds, wme* wme_to_add)
 {
     /* Set the correct GDS for this wme (wme's point to their gds) */
     wme_to_add->gds = gds;
+    thisAgent->gds_wme_additions++;
     insert_at_head_of_dll(gds->wmes_in_gds, wme_to_add, gds_next, gds_prev);
 
     if (thisAgent->trace_settings[TRACE_GDS_WMES_SYSPARAM])
@@ -3561,7 +3725,11 @@ void add_wme_to_gds(agent* thisAgent, goal_dependency_set* gds, wme* wme_to_add)
 
 /*
 ========================
-
+   Explores every instantiation queued on parent_list_head, adding the
+   supergoal wmes they tested to the GDS of their match goal and queueing the
+   instantiations of any local i-supported wmes.  Those are explored a
+   generation at a time, in the order the old recursive version used, until
+   the queue is empty.
 ========================
 */
 void elaborate_gds(agent* thisAgent)
@@ -3575,10 +3743,22 @@ void elaborate_gds(agent* thisAgent)
     slot* s;
     instantiation* inst;
 
-    for (curr_pi = thisAgent->parent_list_head; curr_pi; curr_pi = temp_pi)
+#ifndef NO_TIMING_STUFF
+    thisAgent->timers_gds.start();
+#endif
+    thisAgent->gds_elaboration_passes++;
+
+    /* take the first generation off the queue; its parents are queued behind it */
+    curr_pi = thisAgent->parent_list_head;
+    thisAgent->parent_list_head = NIL;
+
+    for (; curr_pi; curr_pi = temp_pi)
     {
 
         inst = curr_pi->inst;
+        temp_pi = curr_pi->next;
+        thisAgent->memoryManager->free_with_pool(MP_parent_inst, curr_pi);
+        thisAgent->gds_instantiations_explored++;
 
         for (cond = inst->top_of_instantiated_conditions; cond != NIL; cond = cond->next)
         {
@@ -3803,37 +3983,19 @@ void elaborate_gds(agent* thisAgent)
             }
         }  /* for (cond = inst->top_of_instantiated_cond ...  *;*/
 
-        /* remove just used instantiation from list */
-        if (curr_pi->next != NIL)
-        {
-            curr_pi->next->prev = curr_pi->prev;
-        }
-
-        if (curr_pi->prev != NIL)
+        /* once this generation is done, move on to the parents it queued */
+        if (temp_pi == NIL)
         {
-            curr_pi->prev->next = curr_pi->next;
-        }
-
-        if (thisAgent->parent_list_head == curr_pi)
-        {
-            thisAgent->parent_list_head = curr_pi->next;
+            temp_pi = thisAgent->parent_list_head;
+            thisAgent->parent_list_head = NIL;
         }
 
-        temp_pi = curr_pi->next;
-        free(curr_pi);
-
-    } /* end of "for (curr_pi = thisAgent->parent_list_head ... */
-
-
-    if (thisAgent->parent_list_head != NIL)
-    {
-        /* recursively explore the parents of all the instantiations */
-        elaborate_gds(thisAgent);
+    } /* end of "for (; curr_pi; ... */
 
-        /* free the parent instantiation list.  technically, the list
-        * should be empty at this point ??? */
-        free_parent_list(thisAgent);
-    }
+#ifndef NO_TIMING_STUFF
+    thisAgent->timers_gds.stop();
+    thisAgent->timers_gds_cpu_time[thisAgent->current_phase].update(thisAgent->timers_gds);
+#endif
 
 } /* end of elaborate_gds   */
 
@@ -3863,10 +4025,9 @@ void gds_invalid_so_remove_goal(agent* thisAgent, wme* w)
     }
 
 #ifndef NO_TIMING_STUFF
-#ifdef DETAILED_TIMING_STATS
     thisAgent->timers_gds.start();
 #endif
-#endif
+    thisAgent->gds_state_removals++;
 
     /* This call to GDS_PrintCmd will have to be uncommented later. -ajc */
     //if (thisAgent->outputManager->settings[OM_VERBOSE]) {} //GDS_PrintCmd();
@@ -3906,6 +4067,7 @@ void gds_invalid_so_remove_goal(agent* thisAgent, wme* w)
             if (s->isa_context_slot && !s->changed)
             {
                 s->changed = reinterpret_cast<dl_cons*>(1); // use non-zero value to indicate change, see definition of slot::changed
+                s->consistent_at = 0;
             }
         }
     }
@@ -3926,23 +4088,20 @@ void gds_invalid_so_remove_goal(agent* thisAgent, wme* w)
     */
 
 #ifndef NO_TIMING_STUFF
-#ifdef DETAILED_TIMING_STATS
     thisAgent->timers_gds.stop();
     thisAgent->timers_gds_cpu_time[thisAgent->current_phase].update(thisAgent->timers_gds);
 #endif
-#endif
 }
 
 
 void free_parent_list(agent* thisAgent)
 {
-    parent_inst* curr_pi;
+    parent_inst* curr_pi, *next_pi;
 
-    for (curr_pi = thisAgent->parent_list_head;
-            curr_pi;
-            curr_pi = curr_pi->next)
+    for (curr_pi = thisAgent->parent_list_head; curr_pi; curr_pi = next_pi)
     {
-        free(curr_pi);
+        next_pi = curr_pi->next;
+        thisAgent->memoryManager->free_with_pool(MP_parent_inst, curr_pi);
     }
 
     thisAgent->parent_list_head = NIL;
@@ -123,6 +123,19 @@ typedef struct gds_struct
       acceptable_preference_changed:  for context slots only; this is zero
         if no acceptable or require preference in this slot has changed;
         if one has changed, it points to a dl_cons.
+
+      pref_changes:  counts changes to the slot's preferences.  Starts at 1.
+
+      consistent_at:  for context slots only; the pref_changes count at
+        which the consistency check last found the slot's decision to
+        agree with its preferences, or 0.  The check isn't repeated until
+        the preferences change again, and deciding the slot or changing
+        the goal below it resets this to 0.
+
+      indifferent_pairs:  for context slots only; the number of binary
+        indifferent preferences between each unordered pair of values,
+        kept up to date by the preference manager.  NIL until the slot
+        gets its first binary indifferent preference.
 ------------------------------------------------------------------------ */
 
 extern void post_link_addition(agent* thisAgent, Symbol* from, Symbol* to);
@@ -143,6 +156,8 @@ extern int GDS_PrintCmd(/****ClientData****/ int clientData,
                         int argc, char* argv[]);
 
 void rl_update_for_one_candidate(agent* thisAgent, slot* s, bool consistency, preference* candidates);
+extern void add_indifferent_pair(agent* thisAgent, slot* s, preference* pref);
+extern void remove_indifferent_pair(agent* thisAgent, slot* s, preference* pref);
 extern byte run_preference_semantics(agent* thisAgent, slot* s, preference** result_candidates, bool consistency = false, bool predict = false);
 extern preference* run_non_context_preference_semantics(agent* thisAgent, slot* s);
 
@@ -29,6 +29,12 @@ decider_param_container::decider_param_container(agent* new_agent, uint64_t pDec
     pDecider_settings[DECIDER_WAIT_SNC] = 0;
     pDecider_settings[DECIDER_EXPLORATION_POLICY] = USER_SELECT_SOFTMAX;
     pDecider_settings[DECIDER_AUTO_REDUCE] = false;
+    pDecider_settings[DECIDER_ALPHA_THREADS] = 1;
+    pDecider_settings[DECIDER_POOL_TRIM] = false;
+    pDecider_settings[DECIDER_POOL_TRIM_SLACK] = 16777216;
+    pDecider_settings[DECIDER_POOL_HUGE_PAGES] = false;
+    pDecider_settings[DECIDER_RUN_THREADS] = 1;
+    pDecider_settings[DECIDER_GC_BATCH] = 0;
 
     stop_phase = new soar_module::constant_param<top_level_phase>("stop-phase", APPLY_PHASE, new soar_module::f_predicate<top_level_phase>());
     stop_phase->add_mapping(APPLY_PHASE, "apply");
@@ -58,6 +64,18 @@ decider_param_container::decider_param_container(agent* new_agent, uint64_t pDec
     add(timers_enabled);
     wait_snc = new soar_module::boolean_param("wait-snc", pDecider_settings[DECIDER_WAIT_SNC] ? on : off, new soar_module::f_predicate<boolean>());
     add(wait_snc);
+    alpha_threads = new soar_module::integer_param("alpha-threads", pDecider_settings[DECIDER_ALPHA_THREADS], new soar_module::btw_predicate<int64_t>(1, 64, true), new soar_module::f_predicate<int64_t>());
+    add(alpha_threads);
+    pool_trim = new soar_module::boolean_param("pool-trim", pDecider_settings[DECIDER_POOL_TRIM] ? on : off, new soar_module::f_predicate<boolean>());
+    add(pool_trim);
+    pool_trim_slack = new soar_module::integer_param("pool-trim-slack", pDecider_settings[DECIDER_POOL_TRIM_SLACK], new soar_module::gt_predicate<int64_t>(0, true), new soar_module::f_predicate<int64_t>());
+    add(pool_trim_slack);
+    pool_huge_pages = new soar_module::boolean_param("pool-huge-pages", pDecider_settings[DECIDER_POOL_HUGE_PAGES] ? on : off, new soar_module::f_predicate<boolean>());
+    add(pool_huge_pages);
+    run_threads = new soar_module::integer_param("run-threads", pDecider_settings[DECIDER_RUN_THREADS], new soar_module::btw_predicate<int64_t>(1, 64, true), new soar_module::f_predicate<int64_t>());
+    add(run_threads);
+    gc_batch = new soar_module::integer_param("gc-batch", pDecider_settings[DECIDER_GC_BATCH], new soar_module::btw_predicate<int64_t>(0, 1000000, true), new soar_module::f_predicate<int64_t>());
+    add(gc_batch);
 
     init_cmd = new soar_module::boolean_param("init", on, new soar_module::f_predicate<boolean>());
     add(init_cmd);
@@ -126,6 +144,8 @@ void decider_param_container::print_settings(agent* thisAgent)
 //    outputManager->printa_sf(thisAgent, "soar run%-%-%s\n", "Run Soar");
     outputManager->printa_sf(thisAgent, "soar version%-%-%s\n", "Print version number of Soar");
     outputManager->printa(thisAgent, "----------------- Settings --------------------\n");
+    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("alpha-threads", alpha_threads->get_string(), 47).c_str(), "Threads for alpha lookups of large WM batches");
+    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("gc-batch", gc_batch->get_string(), 47).c_str(), "Disconnected ids held back per collection sweep");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("keep-all-top-oprefs", keep_all_top_oprefs->get_string(), 47).c_str(), "Keep all preferences for o-supported WMEs on top state");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("max-elaborations", max_elaborations->get_string(), 47).c_str(), "Maximum elaboration in a decision cycle");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("max-goal-depth", max_goal_depth->get_string(), 47).c_str(), "Halt if goal stack reaches this depth");
@@ -133,6 +153,10 @@ void decider_param_container::print_settings(agent* thisAgent)
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("max-dc-time", max_dc_time->get_string(), 47).c_str(), "Interrupt decision after this much time");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("max-memory-usage", max_memory_usage->get_string(), 47).c_str(), "Threshold for memory warning (see help)");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("max-gp", max_gp->get_string(), 47).c_str(), "Maximum rules gp can generate");
+    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("pool-trim", pool_trim->get_string(), 47).c_str(), "Give free memory pool blocks back to the OS");
+    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("pool-trim-slack", pool_trim_slack->get_string(), 47).c_str(), "Pool growth in bytes that triggers a trim");
+    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("pool-huge-pages", pool_huge_pages->get_string(), 47).c_str(), "Grow large memory pools in huge pages");
+    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("run-threads", run_threads->get_string(), 47).c_str(), "Threads that step agents during a run");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("stop-phase", stop_phase->get_string(), 47).c_str(), "Phase before which Soar will stop");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("tcl", tcl_enabled->get_string(), 47).c_str(), "Allow Tcl code in commands");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("timers", timers_enabled->get_string(), 47).c_str(), "Profile where Soar spends its time");
@@ -28,6 +28,12 @@ class decider_param_container: public soar_module::param_container
         soar_module::boolean_param* tcl_enabled;
         soar_module::boolean_param* timers_enabled;
         soar_module::boolean_param* wait_snc;
+        soar_module::integer_param* alpha_threads;
+        soar_module::boolean_param* pool_trim;
+        soar_module::integer_param* pool_trim_slack;
+        soar_module::boolean_param* pool_huge_pages;
+        soar_module::integer_param* run_threads;
+        soar_module::integer_param* gc_batch;
 
         soar_module::boolean_param* init_cmd;
         soar_module::boolean_param* reset_cmd;
@@ -4,6 +4,7 @@
 #include "callback.h"
 #include "condition.h"
 #include "decide.h"
+#include "decider.h"
 #include "ebc.h"
 #include "episodic_memory.h"
 #include "instantiation.h"
@@ -24,11 +25,19 @@
 #include "symbol.h"
 #include "test.h"
 #include "working_memory.h"
+#include "worker_pool.h"
 #include "xml.h"
 
+#include <algorithm>
 #include <cassert>
+#include <queue>
 #include <sstream>
 #include <stdlib.h>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
 
 /*************************************************************************
  *
@@ -400,6 +409,54 @@ inline unsigned mp_bnode_is_left_unlinked(rete_node* node)
     return ((node)->a.np.is_left_unlinked);
 }
 
+/* ----------------------------------------------------------------------
+
+             Structures and Declarations:  Collection Memories
+
+   Productions marked :collection build some of their beta memories as
+   "collection" memories.  A collection memory does not keep a token for
+   every (tok,w) pair its parent join produces; the pairs are kept in
+   factored form -- the parent join's left memory and alpha memory --
+   and a token is only materialized once a child join actually extends
+   it.  Left activations that no child extends are dropped right away,
+   and when a child join is right activated it enumerates the factored
+   pairs itself (see collection_join_right_addition()).  This trades
+   right activation time for memory on cross-product heavy conditions.
+
+   To keep the enumeration to one level, a collection memory's parent
+   join must read its left tokens from an ordinary memory.  Children of
+   a collection memory are never right unlinked (the memory may look
+   empty while it has matches), and a collection memory is never merged
+   into an MP node.
+---------------------------------------------------------------------- */
+
+inline bool bnode_is_collection_mem(rete_node* node)
+{
+    return (((node->node_type == MEMORY_BNODE) ||
+             (node->node_type == UNHASHED_MEMORY_BNODE)) &&
+            node->a.np.is_collection);
+}
+
+/* --- returns the node whose tokens a positive or MP join reads --- */
+inline rete_node* left_mem_of_join(rete_node* join)
+{
+    return (bnode_is_bottom_of_split_mp(join->node_type) ? join->parent : join);
+}
+
+/* --- can a new memory under <parent> be built as a collection memory? --- */
+inline bool collection_mem_allowed(agent* thisAgent, rete_node* parent)
+{
+    rete_node* left_mem;
+
+    if (! bnode_is_positive(parent->node_type))
+    {
+        return false;
+    }
+    left_mem = left_mem_of_join(parent);
+    return ((! bnode_is_collection_mem(left_mem)) &&
+            (left_mem->parent != thisAgent->dummy_top_node));
+}
+
 /* ----------------------------------------------------------------------
 
                  Structures and Declarations:  Tokens
@@ -423,6 +480,7 @@ inline void new_left_token(token* New, rete_node* current_node,
     (New)->node = (current_node);
     insert_at_head_of_dll((current_node)->a.np.tokens, (New),
                           next_of_node, prev_of_node);
+    (current_node)->a.np.num_tokens++;
     (New)->first_child = NIL;
     (New)->parent = (parent_tok);
     insert_at_head_of_dll((parent_tok)->first_child, (New),
@@ -433,6 +491,49 @@ inline void new_left_token(token* New, rete_node* current_node,
 
 }
 
+/* --- The referent of the hashed test a token was put into the left_ht
+   with (NIL on unhashed nodes).  With COMPACT_TOKENS this isn't kept on
+   the token; it is read again from the wme the node's hash location
+   points at, which never changes while the token exists. --- */
+inline Symbol* token_referent(token* tok)
+{
+#ifdef COMPACT_TOKENS
+    rete_node* node;
+    int levels_up;
+
+    node = tok->node;
+    if (! bnode_is_hashed(node->node_type))
+    {
+        return NIL;
+    }
+    for (levels_up = node->left_hash_loc_levels_up; levels_up > 1; levels_up--)
+    {
+        tok = tok->parent;
+    }
+    return field_from_wme(tok->w, node->left_hash_loc_field_num);
+#else
+    return tok->a.ht.referent;
+#endif
+}
+
+inline void set_token_referent(token* tok, Symbol* referent)
+{
+#ifndef COMPACT_TOKENS
+    tok->a.ht.referent = referent;
+#endif
+}
+
+/* --- The Neg/CN token a negrm or CN partner token is a local join
+   result for --- */
+inline token*& token_left_token(token* tok)
+{
+#ifdef COMPACT_TOKENS
+    return tok->left_token;
+#else
+    return tok->a.neg.left_token;
+#endif
+}
+
 /* Note: (most) tokens are stored in hash table thisAgent->left_ht */
 
 /* ----------------------------------------------------------------------
@@ -440,20 +541,56 @@ inline void new_left_token(token* New, rete_node* current_node,
             Structures and Declarations:  Memory Hash Tables
 
    Tokens and alpha memory entries (right memory's) as stored in two
-   global hash tables.  Unlike most hash tables in Soar, these two tables
-   are not dynamically resized -- their size is fixed at compile-time.
+   global hash tables.  Unlike the other hash tables in Soar, these two
+   are never rehashed all at once -- a single table can hold millions of
+   tokens, and rehashing it in the middle of a decision cycle would stall
+   the agent.  Instead, they use linear hashing:  a table has
+   (1 << log2size) + split buckets, and each resize step splits (or
+   merges) exactly one bucket, moving just the items in that bucket.
+   Like other hash tables, a table grows when # of items >= 2 * # of
+   buckets, and shrinks when # of items < # of buckets / 2, but never
+   below its initial size.
+
+   The beta node routines scan hash buckets while they may be adding
+   tokens, so resize steps are never taken when an item is inserted.
+   Instead, adjust_rete_ht_sizes() is called at the entry points to the
+   matcher (adding/removing a wme, adding/excising a production), where
+   no bucket is being scanned, and does a bounded amount of work.
 ---------------------------------------------------------------------- */
 
-/* --- Hash table sizes (actual sizes are powers of 2) --- */
+/* --- Initial (and minimum) table sizes (actual sizes are powers of 2) --- */
 #define LOG2_LEFT_HT_SIZE 14
 #define LOG2_RIGHT_HT_SIZE 14
 
-#define LEFT_HT_SIZE (1 << LOG2_LEFT_HT_SIZE)
-#define RIGHT_HT_SIZE (1 << LOG2_RIGHT_HT_SIZE)
+/* --- Bucket headers are allocated in segments of this many buckets --- */
+#define LOG2_RETE_HT_SEGMENT_SIZE 10
+#define RETE_HT_SEGMENT_SIZE (1 << LOG2_RETE_HT_SEGMENT_SIZE)
+#define RETE_HT_SEGMENT_MASK (RETE_HT_SEGMENT_SIZE - 1)
+
+/* --- Each call to adjust_rete_ht_sizes() stops resizing a table once it
+   has moved at least this many items --- */
+#define RETE_HT_ITEMS_PER_ADJUSTMENT 4096
+
+inline void*& rete_ht_slot(rete_ht* ht, uint32_t index)
+{
+    return ht->segments[index >> LOG2_RETE_HT_SEGMENT_SIZE][index & RETE_HT_SEGMENT_MASK];
+}
 
-#define LEFT_HT_MASK (LEFT_HT_SIZE - 1)
-#define RIGHT_HT_MASK (RIGHT_HT_SIZE - 1)
+/* --- Given the hash value (hv), find the bucket it belongs in --- */
+inline uint32_t rete_ht_index(rete_ht* ht, uint32_t hv)
+{
+    uint32_t index = hv & ht->low_mask;
+    if (index < ht->split)
+    {
+        index = hv & ht->high_mask;
+    }
+    return index;
+}
 
+inline uint64_t rete_ht_num_buckets(rete_ht* ht)
+{
+    return (static_cast<uint64_t>(1) << ht->log2size) + ht->split;
+}
 
 /* --- Given the hash value (hv), get contents of bucket header cell ---
 #define left_ht_bucket(hv) \
@@ -466,12 +603,12 @@ inline void new_left_token(token* New, rete_node* current_node,
    hence the call by reference, */
 inline token*& left_ht_bucket(agent* thisAgent, uint32_t hv)
 {
-    return * (reinterpret_cast<token**>(thisAgent->left_ht) + (hv & LEFT_HT_MASK));
+    return reinterpret_cast<token*&>(rete_ht_slot(thisAgent->left_ht, rete_ht_index(thisAgent->left_ht, hv)));
 }
 
-inline right_mem* right_ht_bucket(agent* thisAgent, uint32_t hv)
+inline right_mem*& right_ht_bucket(agent* thisAgent, uint32_t hv)
 {
-    return * (reinterpret_cast<right_mem**>(thisAgent->right_ht) + (hv & RIGHT_HT_MASK));
+    return reinterpret_cast<right_mem*&>(rete_ht_slot(thisAgent->right_ht, rete_ht_index(thisAgent->right_ht, hv)));
 }
 
 /*#define insert_token_into_left_ht(tok,hv) { \
@@ -482,9 +619,10 @@ inline right_mem* right_ht_bucket(agent* thisAgent, uint32_t hv)
 inline void insert_token_into_left_ht(agent* thisAgent, token* tok, uint32_t hv)
 {
     token** header_zy37;
-    header_zy37 = reinterpret_cast<token**>(thisAgent->left_ht) + (hv & LEFT_HT_MASK);
+    header_zy37 = &left_ht_bucket(thisAgent, hv);
     insert_at_head_of_dll(*header_zy37, tok,
                           a.ht.next_in_bucket, a.ht.prev_in_bucket);
+    thisAgent->left_ht->count++;
 }
 
 /*#define remove_token_from_left_ht(tok,hv) { \
@@ -494,6 +632,277 @@ inline void remove_token_from_left_ht(agent* thisAgent, token* tok, uint32_t hv)
 {
     fast_remove_from_dll(left_ht_bucket(thisAgent, hv), tok, token,
                          a.ht.next_in_bucket, a.ht.prev_in_bucket);
+    thisAgent->left_ht->count--;
+}
+
+/* --- Recomputes the hash value a token was inserted into the left_ht
+   with.  CN nodes hash on the parent token and wme; all other nodes hash
+   on the referent of the hashed test, if any. --- */
+inline uint32_t left_ht_hash_value_of_token(token* tok)
+{
+    Symbol* referent;
+
+    if (tok->node->node_type == CN_BNODE)
+    {
+        return tok->node->node_id ^ cast_and_possibly_truncate<uint32_t>(tok->parent) ^
+               cast_and_possibly_truncate<uint32_t>(tok->w);
+    }
+    referent = token_referent(tok);
+    return tok->node->node_id ^ (referent ? referent->hash_id : 0);
+}
+
+/* --- How to get at the bucket links and hash value of the items in each
+   of the two tables, for the generic resizing routines below --- */
+struct left_ht_items
+{
+    typedef token item;
+    static token*& next(token* t) { return t->a.ht.next_in_bucket; }
+    static token*& prev(token* t) { return t->a.ht.prev_in_bucket; }
+    static uint32_t hash_value(token* t) { return left_ht_hash_value_of_token(t); }
+};
+
+struct right_ht_items
+{
+    typedef right_mem item;
+    static right_mem*& next(right_mem* rm) { return rm->next_in_bucket; }
+    static right_mem*& prev(right_mem* rm) { return rm->prev_in_bucket; }
+    static uint32_t hash_value(right_mem* rm) { return rm->am->am_id ^ rm->w->id->hash_id; }
+};
+
+inline void set_rete_ht_masks(rete_ht* ht)
+{
+    ht->low_mask = masks_for_n_low_order_bits[ht->log2size];
+    ht->high_mask = masks_for_n_low_order_bits[ht->log2size + 1];
+}
+
+void add_segment_to_rete_ht(agent* thisAgent, rete_ht* ht)
+{
+    void*** new_segments;
+
+    if (ht->num_segments == ht->max_segments)
+    {
+        new_segments = static_cast<void***>(thisAgent->memoryManager->allocate_memory_and_zerofill(
+                           2 * ht->max_segments * sizeof(void**), HASH_TABLE_MEM_USAGE));
+        memcpy(new_segments, ht->segments, ht->num_segments * sizeof(void**));
+        thisAgent->memoryManager->free_memory(ht->segments, HASH_TABLE_MEM_USAGE);
+        ht->segments = new_segments;
+        ht->max_segments *= 2;
+    }
+    ht->segments[ht->num_segments++] = static_cast<void**>(thisAgent->memoryManager->allocate_memory_and_zerofill(
+                                           RETE_HT_SEGMENT_SIZE * sizeof(void*), HASH_TABLE_MEM_USAGE));
+}
+
+rete_ht* make_rete_ht(agent* thisAgent, short log2size)
+{
+    rete_ht* ht;
+
+    ht = static_cast<rete_ht*>(thisAgent->memoryManager->allocate_memory(sizeof(rete_ht), HASH_TABLE_MEM_USAGE));
+    ht->log2size = log2size;
+    ht->min_log2size = log2size;
+    ht->split = 0;
+    set_rete_ht_masks(ht);
+    ht->count = 0;
+    ht->num_splits = 0;
+    ht->num_merges = 0;
+    ht->num_segments = 0;
+    ht->max_segments = 2 * ((1 << log2size) >> LOG2_RETE_HT_SEGMENT_SIZE);
+    ht->segments = static_cast<void***>(thisAgent->memoryManager->allocate_memory_and_zerofill(
+                       ht->max_segments * sizeof(void**), HASH_TABLE_MEM_USAGE));
+    while (ht->num_segments < ((1u << log2size) >> LOG2_RETE_HT_SEGMENT_SIZE))
+    {
+        add_segment_to_rete_ht(thisAgent, ht);
+    }
+    return ht;
+}
+
+void free_rete_ht(agent* thisAgent, rete_ht* ht)
+{
+    for (uint32_t i = 0; i < ht->num_segments; i++)
+    {
+        thisAgent->memoryManager->free_memory(ht->segments[i], HASH_TABLE_MEM_USAGE);
+    }
+    thisAgent->memoryManager->free_memory(ht->segments, HASH_TABLE_MEM_USAGE);
+    thisAgent->memoryManager->free_memory(ht, HASH_TABLE_MEM_USAGE);
+}
+
+/* --- Adds one bucket to the table by splitting bucket "split" in two.
+   Items are redistributed in order, so the relative order of items with
+   the same hash value never changes.  Returns the number of items moved. --- */
+template <class T>
+uint64_t split_rete_ht_bucket(agent* thisAgent, rete_ht* ht)
+{
+    typedef typename T::item item;
+    item* it, *next;
+    item* tails[2] = { NIL, NIL };
+    uint32_t targets[2];
+    uint64_t num_items = 0;
+    int which;
+
+    targets[0] = ht->split;
+    targets[1] = ht->split + (1u << ht->log2size);
+    if ((targets[1] & RETE_HT_SEGMENT_MASK) == 0)
+    {
+        add_segment_to_rete_ht(thisAgent, ht);
+    }
+
+    it = static_cast<item*>(rete_ht_slot(ht, targets[0]));
+    rete_ht_slot(ht, targets[0]) = NIL;
+
+    ht->split++;
+    if (ht->split == (1u << ht->log2size))
+    {
+        ht->log2size++;
+        ht->split = 0;
+        set_rete_ht_masks(ht);
+    }
+    ht->num_splits++;
+
+    for (; it != NIL; it = next)
+    {
+        next = T::next(it);
+        which = (rete_ht_index(ht, T::hash_value(it)) == targets[0]) ? 0 : 1;
+        T::next(it) = NIL;
+        T::prev(it) = tails[which];
+        if (tails[which])
+        {
+            T::next(tails[which]) = it;
+        }
+        else
+        {
+            rete_ht_slot(ht, targets[which]) = it;
+        }
+        tails[which] = it;
+        num_items++;
+    }
+    return num_items;
+}
+
+/* --- Removes the last bucket from the table, appending its items to
+   the bucket it was originally split from.  Returns the number of items
+   walked over. --- */
+template <class T>
+uint64_t merge_rete_ht_bucket(agent* thisAgent, rete_ht* ht)
+{
+    typedef typename T::item item;
+    item* chain, *tail;
+    uint32_t last_bucket;
+    uint64_t num_items = 0;
+
+    if (ht->split == 0)
+    {
+        ht->log2size--;
+        ht->split = 1u << ht->log2size;
+        set_rete_ht_masks(ht);
+    }
+    ht->split--;
+    ht->num_merges++;
+    last_bucket = ht->split + (1u << ht->log2size);
+
+    chain = static_cast<item*>(rete_ht_slot(ht, last_bucket));
+    rete_ht_slot(ht, last_bucket) = NIL;
+    if (chain)
+    {
+        tail = static_cast<item*>(rete_ht_slot(ht, ht->split));
+        if (tail)
+        {
+            for (; T::next(tail) != NIL; tail = T::next(tail))
+            {
+                num_items++;
+            }
+            T::next(tail) = chain;
+            T::prev(chain) = tail;
+        }
+        else
+        {
+            rete_ht_slot(ht, ht->split) = chain;
+        }
+        for (; chain != NIL; chain = T::next(chain))
+        {
+            num_items++;
+        }
+    }
+
+    /* --- if that emptied the last segment, release it --- */
+    if ((last_bucket & RETE_HT_SEGMENT_MASK) == 0)
+    {
+        ht->num_segments--;
+        thisAgent->memoryManager->free_memory(ht->segments[ht->num_segments], HASH_TABLE_MEM_USAGE);
+    }
+    return num_items;
+}
+
+template <class T>
+void adjust_rete_ht_size(agent* thisAgent, rete_ht* ht)
+{
+    uint64_t num_items_moved = 0;
+    uint64_t num_buckets;
+
+    while (num_items_moved < RETE_HT_ITEMS_PER_ADJUSTMENT)
+    {
+        num_buckets = rete_ht_num_buckets(ht);
+        if ((ht->count >= 2 * num_buckets) && (ht->log2size < 31))
+        {
+            num_items_moved += split_rete_ht_bucket<T>(thisAgent, ht) + 1;
+        }
+        else if ((ht->count < num_buckets / 2) && (ht->log2size > ht->min_log2size || ht->split > 0))
+        {
+            num_items_moved += merge_rete_ht_bucket<T>(thisAgent, ht) + 1;
+        }
+        else
+        {
+            break;
+        }
+    }
+}
+
+/* --- Only call this when no bucket of either table is being scanned --- */
+inline void adjust_rete_ht_sizes(agent* thisAgent)
+{
+    adjust_rete_ht_size<left_ht_items>(thisAgent, thisAgent->left_ht);
+    adjust_rete_ht_size<right_ht_items>(thisAgent, thisAgent->right_ht);
+}
+
+template <class T>
+void collect_rete_ht_stats(rete_ht* ht, rete_ht_stats* stats)
+{
+    typedef typename T::item item;
+    item* it;
+    uint64_t chain_length, i;
+
+    stats->buckets = rete_ht_num_buckets(ht);
+    stats->items = ht->count;
+    stats->used_buckets = 0;
+    stats->longest_chain = 0;
+    stats->splits = ht->num_splits;
+    stats->merges = ht->num_merges;
+    for (i = 0; i < stats->buckets; i++)
+    {
+        chain_length = 0;
+        for (it = static_cast<item*>(rete_ht_slot(ht, static_cast<uint32_t>(i))); it != NIL; it = T::next(it))
+        {
+            chain_length++;
+        }
+        if (chain_length)
+        {
+            stats->used_buckets++;
+        }
+        if (chain_length > stats->longest_chain)
+        {
+            stats->longest_chain = chain_length;
+        }
+    }
+}
+
+void get_rete_ht_stats(agent* thisAgent, bool left_table, rete_ht_stats* stats)
+{
+    if (left_table)
+    {
+        collect_rete_ht_stats<left_ht_items>(thisAgent->left_ht, stats);
+    }
+    else
+    {
+        collect_rete_ht_stats<right_ht_items>(thisAgent->right_ht, stats);
+    }
 }
 
 /* ----------------------------------------------------------------------
@@ -543,6 +952,8 @@ void (*(right_addition_routines[256]))(agent* thisAgent, rete_node* node, wme* w
 
 
 void remove_token_and_subtree(agent* thisAgent, token* tok);
+void collection_join_right_addition(agent* thisAgent, rete_node* node, wme* w,
+                                    bool w_pending);
 
 /* ----------------------------------------------------------------------
 
@@ -724,10 +1135,10 @@ inline uint64_t real_sharing_factor(rete_node* node)
     return ((node)->sharing_factor ? (node)->sharing_factor : 1);
 }
 
-/*#define token_added(node) { \
+/*#define token_sharing_stats_for_added_token(node) { \
   thisAgent->token_additions++; \
   thisAgent->token_additions_without_sharing += real_sharing_factor(node);}*/
-inline void token_added(rete_node* node)
+inline void token_sharing_stats_for_added_token(agent* thisAgent, rete_node* node)
 {
     thisAgent->token_additions++;
     thisAgent->token_additions_without_sharing += real_sharing_factor(node);
@@ -735,28 +1146,99 @@ inline void token_added(rete_node* node)
 
 #else
 
-#define token_added(node) {}
+#define token_sharing_stats_for_added_token(thisAgent, node) {}
 
 #endif
 
+/* ----------------------------------------------------------------------
+
+             Structures and Declarations:  Match Profiler
+
+   Unlike the statistics above, the match profiler can be turned on and
+   off at run time (see "production match-profile").  While it is on,
+   each beta node gets a rete_node_profile record (allocated the first
+   time the node does anything) counting its left and right activations,
+   the tokens it created, and the join tests it performed.  When it is
+   off, the only cost is one test of thisAgent->match_profiling per
+   activation.  Join tests are counted in a local variable by each join
+   routine and added in once on the way out.
+---------------------------------------------------------------------- */
+
+inline rete_node_profile* profile_for_node(agent* thisAgent, rete_node* node)
+{
+    if (! node->profile)
+    {
+        thisAgent->memoryManager->allocate_with_pool(MP_rete_node_profile, &node->profile);
+        memset(node->profile, 0, sizeof(rete_node_profile));
+    }
+    return node->profile;
+}
+
+inline void join_tests_performed(agent* thisAgent, rete_node* node, uint64_t num_join_tests)
+{
+    if (thisAgent->match_profiling)
+    {
+        profile_for_node(thisAgent, node)->join_tests += num_join_tests;
+    }
+}
+
+/* --- Called just before a node is freed, or when its profile should be
+   folded into another node's (e.g., when merging a Mem node into an MP
+   node); "into" may be NIL --- */
+void release_node_profile(agent* thisAgent, rete_node* node, rete_node* into)
+{
+    rete_node_profile* into_profile;
+
+    if (! node->profile)
+    {
+        return;
+    }
+    if (into)
+    {
+        into_profile = profile_for_node(thisAgent, into);
+        into_profile->left_activations += node->profile->left_activations;
+        into_profile->right_activations += node->profile->right_activations;
+        into_profile->tokens_created += node->profile->tokens_created;
+        into_profile->join_tests += node->profile->join_tests;
+    }
+    thisAgent->memoryManager->free_with_pool(MP_rete_node_profile, node->profile);
+    node->profile = NIL;
+}
+
+/* --- Invoked whenever a node creates a new token --- */
+inline void token_added(agent* thisAgent, rete_node* node)
+{
+    token_sharing_stats_for_added_token(thisAgent, node);
+    if (thisAgent->match_profiling)
+    {
+        profile_for_node(thisAgent, node)->tokens_created++;
+    }
+}
+
 /* --- Invoked on every right activation; add=true means right addition --- */
 /* NOT invoked on removals unless DO_ACTIVATION_STATS_ON_REMOVALS is set */
 /*#define right_node_activation(node,add) { \
   null_activation_stats_for_right_activation(node); }*/
-inline void right_node_activation(rete_node* node, bool/*add*/)
+inline void right_node_activation(agent* thisAgent, rete_node* node, bool add)
 {
-    (void)node;
     null_activation_stats_for_right_activation(node);
+    if (add && thisAgent->match_profiling)
+    {
+        profile_for_node(thisAgent, node)->right_activations++;
+    }
 }
 
 /* --- Invoked on every left activation; add=true means left addition --- */
 /* NOT invoked on removals unless DO_ACTIVATION_STATS_ON_REMOVALS is set */
 /*#define left_node_activation(node,add) { \
   null_activation_stats_for_left_activation(node); }*/
-inline void left_node_activation(rete_node* node, bool/*add*/)
+inline void left_node_activation(agent* thisAgent, rete_node* node, bool add)
 {
-    (void)node;
     null_activation_stats_for_left_activation(node);
+    if (add && thisAgent->match_profiling)
+    {
+        profile_for_node(thisAgent, node)->left_activations++;
+    }
 }
 
 /* --- The following two macros are used when creating/destroying nodes --- */
@@ -770,6 +1252,7 @@ inline void init_new_rete_node_with_type(agent* thisAgent, rete_node* node, byte
     (node)->node_type = (type);
     thisAgent->rete_node_counts[(type)]++;
     init_sharing_stats_for_new_node(node);
+    (node)->profile = NIL;
 }
 
 /*#define update_stats_for_destroying_node(node) { \
@@ -1165,15 +1648,22 @@ bool get_next_nil_goal_retraction(agent* thisAgent, instantiation** inst)
    SECTION 3:  Alpha Portion of the Rete Net
 
    The alpha (top) part of the rete net consists of the alpha memories.
-   Each of these memories is stored in one of 16 hash tables, depending
-   on which fields it tests:
+   Each alpha memory is one of 16 kinds, depending on which fields it
+   tests:
 
       bit 0 (value 1) indicates it tests the id slot
       bit 1 (value 2) indicates it tests the attr slot
       bit 2 (value 4) indicates it tests the value slot
       bit 3 (value 8) indicates it tests for an acceptable preference
 
-   The hash tables are dynamically resized hash tables.
+   All of them are kept in one open-addressing (linear probing) table,
+   thisAgent->alpha_mem_index, hashed on the kind and the constants
+   tested.  A new wme can go into at most one alpha memory of each of
+   the 8 kinds that match its acceptable flag; the index counts the
+   memories of each kind, so only kinds that have any are looked up.
+   The table doubles when it gets 3/4 full, and removal shifts later
+   entries back instead of leaving tombstones, so probe sequences stay
+   short.
 
    Find_or_make_alpha_mem() either shares an existing alpha memory or
    creates a new one, adjusting reference counts accordingly.
@@ -1198,42 +1688,149 @@ inline bool wme_matches_alpha_mem(wme* w, alpha_mem* am)
            (am->acceptable == w->acceptable);
 }
 
-/* --- Returns hash value for the given id/attr/value symbols --- */
-/*#define alpha_hash_value(i,a,v,num_bits) \
- ( ( ((i) ? ((Symbol *)(i))->hash_id : 0) ^ \
-     ((a) ? ((Symbol *)(a))->hash_id : 0) ^ \
-     ((v) ? ((Symbol *)(v))->hash_id : 0) ) & \
-   masks_for_n_low_order_bits[(num_bits)] )*/
-inline uint32_t alpha_hash_value(Symbol* i, Symbol* a, Symbol* v, short num_bits)
+/* --- Which of the 16 kinds of alpha memory tests these fields? --- */
+inline uint32_t alpha_mem_kind(Symbol* id, Symbol* attr, Symbol* value, bool acceptable)
 {
-    return
-        (((i ? i->hash_id : 0) ^
-          (a ? a->hash_id : 0) ^
-          (v ? v->hash_id : 0)) &
-         masks_for_n_low_order_bits[(num_bits)]);
+    return (id ? 1 : 0) + (attr ? 2 : 0) + (value ? 4 : 0) + (acceptable ? 8 : 0);
 }
 
-/* --- rehash funciton for resizable hash table routines --- */
-uint32_t hash_alpha_mem(void* item, short num_bits)
+/* --- Hash value for an alpha memory of the given kind testing the given
+   symbols' hash_id's (0 for untested fields).  Symbol hash_id's are
+   handed out in sequence, so they are multiplied out to spread them over
+   the whole word before the low bits are used. --- */
+inline uint32_t alpha_index_hash(uint32_t kind, uint32_t hi, uint32_t ha, uint32_t hv)
 {
-    alpha_mem* am;
+    uint64_t h;
+
+    h = (hi * 0x9E3779B97F4A7C15ULL) ^ (ha * 0xC2B2AE3D27D4EB4FULL) ^
+        (hv * 0x165667B19E3779F9ULL) ^ (kind * 0x27D4EB2F165667C5ULL);
+    h ^= (h >> 32);
+    h *= 0x9E3779B97F4A7C15ULL;
+    return static_cast<uint32_t>(h >> 32);
+}
+
+inline uint32_t alpha_index_hash_for_mem(alpha_mem* am)
+{
+    return alpha_index_hash(alpha_mem_kind(am->id, am->attr, am->value, am->acceptable),
+                            am->id ? am->id->hash_id : 0,
+                            am->attr ? am->attr->hash_id : 0,
+                            am->value ? am->value->hash_id : 0);
+}
+
+#define LOG2_ALPHA_INDEX_INITIAL_SIZE 10
+
+alpha_index* make_alpha_index(agent* thisAgent)
+{
+    alpha_index* index;
+
+    index = static_cast<alpha_index*>(thisAgent->memoryManager->allocate_memory_and_zerofill(sizeof(alpha_index), HASH_TABLE_MEM_USAGE));
+    index->size = 1 << LOG2_ALPHA_INDEX_INITIAL_SIZE;
+    index->slots = static_cast<alpha_index_slot*>(thisAgent->memoryManager->allocate_memory_and_zerofill(
+                       index->size * sizeof(alpha_index_slot), HASH_TABLE_MEM_USAGE));
+    return index;
+}
+
+void free_alpha_index(agent* thisAgent, alpha_index* index)
+{
+    thisAgent->memoryManager->free_memory(index->slots, HASH_TABLE_MEM_USAGE);
+    thisAgent->memoryManager->free_memory(index, HASH_TABLE_MEM_USAGE);
+}
 
-    am = static_cast<alpha_mem_struct*>(item);
-    return alpha_hash_value(am->id, am->attr, am->value, num_bits);
+/* --- Puts an alpha memory in the first free slot of its probe sequence.
+   Does not check the load, see add_to_alpha_index() --- */
+inline void place_in_alpha_index(alpha_index* index, uint32_t hash, alpha_mem* am)
+{
+    uint32_t mask, i;
+
+    mask = index->size - 1;
+    for (i = hash & mask; index->slots[i].am != NIL; i = (i + 1) & mask)
+        ;
+    index->slots[i].hash = hash;
+    index->slots[i].am = am;
+}
+
+void add_to_alpha_index(agent* thisAgent, alpha_mem* am)
+{
+    alpha_index* index;
+    alpha_index_slot* old_slots;
+    uint32_t old_size, i;
+
+    index = thisAgent->alpha_mem_index;
+    if ((index->count + 1) * 4 > static_cast<uint64_t>(index->size) * 3)
+    {
+        old_slots = index->slots;
+        old_size = index->size;
+        index->size = old_size * 2;
+        index->slots = static_cast<alpha_index_slot*>(thisAgent->memoryManager->allocate_memory_and_zerofill(
+                           index->size * sizeof(alpha_index_slot), HASH_TABLE_MEM_USAGE));
+        for (i = 0; i < old_size; i++)
+            if (old_slots[i].am)
+            {
+                place_in_alpha_index(index, old_slots[i].hash, old_slots[i].am);
+            }
+        thisAgent->memoryManager->free_memory(old_slots, HASH_TABLE_MEM_USAGE);
+    }
+    place_in_alpha_index(index, alpha_index_hash_for_mem(am), am);
+    index->count++;
+    index->kind_counts[alpha_mem_kind(am->id, am->attr, am->value, am->acceptable)]++;
+}
+
+/* --- Removes an alpha memory, then moves back any later entry of the same
+   probe run that could now be found earlier, so that no lookup has to
+   step over an empty slot --- */
+void remove_from_alpha_index(agent* thisAgent, alpha_mem* am)
+{
+    alpha_index* index;
+    uint32_t mask, i, j, home;
+
+    index = thisAgent->alpha_mem_index;
+    mask = index->size - 1;
+    for (i = alpha_index_hash_for_mem(am) & mask; index->slots[i].am != am; i = (i + 1) & mask)
+        ;
+    for (j = (i + 1) & mask; index->slots[j].am != NIL; j = (j + 1) & mask)
+    {
+        home = index->slots[j].hash & mask;
+        /* --- entry j may move to i unless its home lies cyclically in (i,j] --- */
+        if (((j - home) & mask) >= ((j - i) & mask))
+        {
+            index->slots[i] = index->slots[j];
+            i = j;
+        }
+    }
+    index->slots[i].am = NIL;
+    index->count--;
+    index->kind_counts[alpha_mem_kind(am->id, am->attr, am->value, am->acceptable)]--;
 }
 
-/* --- Which of the 16 hash tables to use? --- */
-/*#define table_for_tests(id,attr,value,acceptable) \
-  thisAgent->alpha_hash_tables [ ((id) ? 1 : 0) + ((attr) ? 2 : 0) + \
-                                     ((value) ? 4 : 0) + \
-                                     ((acceptable) ? 8 : 0) ]*/
-inline hash_table* table_for_tests(agent* thisAgent,
-                                   Symbol* id, Symbol* attr, Symbol* value,
-                                   bool acceptable)
+/* --- Looks up the alpha mem of the given kind testing the given symbols
+   (NIL for untested fields); hi/ha/hv are their hash_id's --- */
+inline alpha_mem* lookup_alpha_index(alpha_index* index, uint32_t kind,
+                                     Symbol* id, Symbol* attr, Symbol* value,
+                                     uint32_t hi, uint32_t ha, uint32_t hv,
+                                     uint64_t* num_lookups, uint64_t* num_probes)
 {
-    return thisAgent->alpha_hash_tables [(id ? 1 : 0) + (attr ? 2 : 0) +
-                                         (value ? 4 : 0) +
-                                         (acceptable ? 8 : 0) ];
+    alpha_index_slot* slot;
+    alpha_mem* am;
+    uint32_t hash, mask, i;
+
+    hash = alpha_index_hash(kind, hi, ha, hv);
+    mask = index->size - 1;
+    (*num_lookups)++;
+    for (i = hash & mask; ; i = (i + 1) & mask)
+    {
+        (*num_probes)++;
+        slot = &index->slots[i];
+        am = slot->am;
+        if (am == NIL)
+        {
+            return NIL;
+        }
+        if ((slot->hash == hash) && (am->id == id) && (am->attr == attr) &&
+                (am->value == value) && ((kind & 8) ? am->acceptable : ! am->acceptable))
+        {
+            return am;
+        }
+    }
 }
 
 //#define get_next_alpha_mem_id() (thisAgent->alpha_mem_id_counter++)
@@ -1256,8 +1853,9 @@ void add_wme_to_alpha_mem(agent* thisAgent, wme* w, alpha_mem* am)
 
     /* --- add it to dll's for the hash bucket, alpha mem, and wme --- */
     hv = am->am_id ^ w->id->hash_id;
-    header = reinterpret_cast<right_mem**>(thisAgent->right_ht) + (hv & RIGHT_HT_MASK);
+    header = &right_ht_bucket(thisAgent, hv);
     insert_at_head_of_dll(*header, rm, next_in_bucket, prev_in_bucket);
+    thisAgent->right_ht->count++;
     insert_at_head_of_dll(am->right_mems, rm, next_in_am, prev_in_am);
     insert_at_head_of_dll(w->right_mems, rm, next_from_wme, prev_from_wme);
 }
@@ -1276,8 +1874,9 @@ void remove_wme_from_alpha_mem(agent* thisAgent, right_mem* rm)
 
     /* --- remove it from dll's for the hash bucket, alpha mem, and wme --- */
     hv = am->am_id ^ w->id->hash_id;
-    header = reinterpret_cast<right_mem**>(thisAgent->right_ht) + (hv & RIGHT_HT_MASK);
+    header = &right_ht_bucket(thisAgent, hv);
     remove_from_dll(*header, rm, next_in_bucket, prev_in_bucket);
+    thisAgent->right_ht->count--;
     remove_from_dll(am->right_mems, rm, next_in_am, prev_in_am);
     remove_from_dll(w->right_mems, rm, next_from_wme, prev_from_wme);
 
@@ -1289,21 +1888,10 @@ void remove_wme_from_alpha_mem(agent* thisAgent, right_mem* rm)
 alpha_mem* find_alpha_mem(agent* thisAgent, Symbol* id, Symbol* attr,
                           Symbol* value, bool acceptable)
 {
-    hash_table* ht;
-    alpha_mem* am;
-    uint32_t hash_value;
-
-    ht = table_for_tests(thisAgent, id, attr, value, acceptable);
-    hash_value = alpha_hash_value(id, attr, value, ht->log2size);
-
-    for (am = reinterpret_cast<alpha_mem*>(*(ht->buckets + hash_value)); am != NIL;
-            am = am->next_in_hash_table)
-        if ((am->id == id) && (am->attr == attr) &&
-                (am->value == value) && (am->acceptable == acceptable))
-        {
-            return am;
-        }
-    return NIL;
+    return lookup_alpha_index(thisAgent->alpha_mem_index,
+                              alpha_mem_kind(id, attr, value, acceptable), id, attr, value,
+                              id ? id->hash_id : 0, attr ? attr->hash_id : 0, value ? value->hash_id : 0,
+                              &thisAgent->alpha_mem_index->num_lookups, &thisAgent->alpha_mem_index->num_probes);
 }
 
 /* --- Find and share existing alpha memory, or create new one.  Adjusts
@@ -1311,7 +1899,6 @@ alpha_mem* find_alpha_mem(agent* thisAgent, Symbol* id, Symbol* attr,
 alpha_mem* find_or_make_alpha_mem(agent* thisAgent, Symbol* id, Symbol* attr,
                                   Symbol* value, bool acceptable)
 {
-    hash_table* ht;
     alpha_mem* am, *more_general_am;
     wme* w;
     right_mem* rm;
@@ -1326,7 +1913,6 @@ alpha_mem* find_or_make_alpha_mem(agent* thisAgent, Symbol* id, Symbol* attr,
 
     /* --- no existing alpha_mem found, so create a new one --- */
     thisAgent->memoryManager->allocate_with_pool(MP_alpha_mem, &am);
-    am->next_in_hash_table = NIL;
     am->right_mems = NIL;
     am->beta_nodes = NIL;
     am->last_beta_node = NIL;
@@ -1348,8 +1934,7 @@ alpha_mem* find_or_make_alpha_mem(agent* thisAgent, Symbol* id, Symbol* attr,
     }
     am->acceptable = acceptable;
     am->am_id = get_next_alpha_mem_id(thisAgent);
-    ht = table_for_tests(thisAgent, id, attr, value, acceptable);
-    add_to_hash_table(thisAgent, ht, am);
+    add_to_alpha_index(thisAgent, am);
 
     /* --- fill new mem with any existing matching WME's --- */
     more_general_am = NIL;
@@ -1383,82 +1968,73 @@ alpha_mem* find_or_make_alpha_mem(agent* thisAgent, Symbol* id, Symbol* attr,
     return am;
 }
 
-/* --- Using the given hash table and hash value, try to find a
-   matching alpha memory in the indicated hash bucket.  If we find one,
-   we add the wme to it and inform successor nodes. --- */
-void add_wme_to_aht(agent* thisAgent, hash_table* ht, uint32_t hash_value, wme* w)
+/* --- Adds the wme to the given alpha memory and informs its successor
+   nodes --- */
+inline void add_wme_to_alpha_mem_and_successors(agent* thisAgent, wme* w, alpha_mem* am)
 {
-    alpha_mem* am;
     rete_node* node, *next;
 
-    hash_value = hash_value & masks_for_n_low_order_bits[ht->log2size];
-    am = reinterpret_cast<alpha_mem*>(*(ht->buckets + hash_value));
-    while (am != NIL)
-    {
-        if (wme_matches_alpha_mem(w, am))
-        {
-            /* --- found the right alpha memory, first add the wme --- */
-            add_wme_to_alpha_mem(thisAgent, w, am);
+    /* --- first add the wme --- */
+    add_wme_to_alpha_mem(thisAgent, w, am);
 
-            /* --- now call the beta nodes --- */
-            for (node = am->beta_nodes; node != NIL; node = next)
-            {
-                next = node->b.posneg.next_from_alpha_mem;
-                (*(right_addition_routines[node->node_type]))(thisAgent, node, w);
-            }
-            return; /* only one possible alpha memory per table could match */
-        }
-        am = am->next_in_hash_table;
+    /* --- now call the beta nodes --- */
+    for (node = am->beta_nodes; node != NIL; node = next)
+    {
+        next = node->b.posneg.next_from_alpha_mem;
+        (*(right_addition_routines[node->node_type]))(thisAgent, node, w);
     }
 }
 
-/* We cannot use 'xor' as the name of a function because it is defined in UNIX. */
-//#define xor_op(i,a,v) ((i) ^ (a) ^ (v))
-inline uint32_t xor_op(uint32_t i, uint32_t a, uint32_t v)
+/* --- Gets w ready to enter the rete:  links it into all_wmes_in_rete
+   and clears its memberships --- */
+inline void enter_wme_into_rete(agent* thisAgent, wme* w)
 {
-    return ((i) ^ (a) ^ (v));
-}
-
-/* --- Adds a WME to the Rete. --- */
-void add_wme_to_rete(agent* thisAgent, wme* w)
-{
-    uint32_t hi, ha, hv;
-
-    /* --- add w to all_wmes_in_rete --- */
-    insert_at_head_of_dll(thisAgent->all_wmes_in_rete, w, rete_next, rete_prev);
-    thisAgent->num_wmes_in_rete++;
+    /* --- add w to all_wmes_in_rete --- */
+    insert_at_head_of_dll(thisAgent->all_wmes_in_rete, w, rete_next, rete_prev);
+    thisAgent->num_wmes_in_rete++;
 
     /* --- it's not in any right memories or tokens yet --- */
     w->right_mems = NIL;
     w->tokens = NIL;
+}
+
+/* --- Finds the matching alpha_mem of each of the 8 possible kinds, in
+   order of kind.  Fills in <ams> and returns how many were found.  Only
+   reads the index, counting into <num_lookups> and <num_probes>, so
+   several threads can run it at once. --- */
+inline int find_alpha_mems_for_wme(alpha_index* index, wme* w, alpha_mem** ams,
+                                   uint64_t* num_lookups, uint64_t* num_probes)
+{
+    alpha_mem* am;
+    uint32_t hi, ha, hv, kind, base;
+    int num_found;
 
-    /* --- add w to the appropriate alpha_mem in each of 8 possible tables --- */
     hi = w->id->hash_id;
     ha = w->attr->hash_id;
     hv = w->value->hash_id;
-
-    if (w->acceptable)
+    base = w->acceptable ? 8 : 0;
+    num_found = 0;
+    for (kind = base; kind < base + 8; kind++)
     {
-        add_wme_to_aht(thisAgent, thisAgent->alpha_hash_tables[8],  xor_op(0, 0, 0), w);
-        add_wme_to_aht(thisAgent, thisAgent->alpha_hash_tables[9],  xor_op(hi, 0, 0), w);
-        add_wme_to_aht(thisAgent, thisAgent->alpha_hash_tables[10], xor_op(0, ha, 0), w);
-        add_wme_to_aht(thisAgent, thisAgent->alpha_hash_tables[11], xor_op(hi, ha, 0), w);
-        add_wme_to_aht(thisAgent, thisAgent->alpha_hash_tables[12], xor_op(0, 0, hv), w);
-        add_wme_to_aht(thisAgent, thisAgent->alpha_hash_tables[13], xor_op(hi, 0, hv), w);
-        add_wme_to_aht(thisAgent, thisAgent->alpha_hash_tables[14], xor_op(0, ha, hv), w);
-        add_wme_to_aht(thisAgent, thisAgent->alpha_hash_tables[15], xor_op(hi, ha, hv), w);
-    }
-    else
-    {
-        add_wme_to_aht(thisAgent, thisAgent->alpha_hash_tables[0],  xor_op(0, 0, 0), w);
-        add_wme_to_aht(thisAgent, thisAgent->alpha_hash_tables[1],  xor_op(hi, 0, 0), w);
-        add_wme_to_aht(thisAgent, thisAgent->alpha_hash_tables[2],  xor_op(0, ha, 0), w);
-        add_wme_to_aht(thisAgent, thisAgent->alpha_hash_tables[3],  xor_op(hi, ha, 0), w);
-        add_wme_to_aht(thisAgent, thisAgent->alpha_hash_tables[4],  xor_op(0, 0, hv), w);
-        add_wme_to_aht(thisAgent, thisAgent->alpha_hash_tables[5],  xor_op(hi, 0, hv), w);
-        add_wme_to_aht(thisAgent, thisAgent->alpha_hash_tables[6],  xor_op(0, ha, hv), w);
-        add_wme_to_aht(thisAgent, thisAgent->alpha_hash_tables[7],  xor_op(hi, ha, hv), w);
+        if (! index->kind_counts[kind])
+        {
+            continue;
+        }
+        am = lookup_alpha_index(index, kind,
+                                (kind & 1) ? w->id : NIL, (kind & 2) ? w->attr : NIL, (kind & 4) ? w->value : NIL,
+                                (kind & 1) ? hi : 0, (kind & 2) ? ha : 0, (kind & 4) ? hv : 0,
+                                num_lookups, num_probes);
+        if (am)
+        {
+            ams[num_found++] = am;
+        }
     }
+    return num_found;
+}
+
+/* --- Epmem bookkeeping for a wme that just entered the rete --- */
+inline void _epmem_add_wme(agent* thisAgent, wme* w)
+{
     w->epmem_id = EPMEM_NODEID_BAD;
     w->epmem_valid = NIL;
     {
@@ -1487,6 +2063,27 @@ void add_wme_to_rete(agent* thisAgent, wme* w)
     }
 }
 
+/* --- Adds a WME to the Rete. --- */
+void add_wme_to_rete(agent* thisAgent, wme* w)
+{
+    alpha_mem* ams[8];
+    int i, num_ams;
+
+    adjust_rete_ht_sizes(thisAgent);
+
+    enter_wme_into_rete(thisAgent, w);
+
+    /* --- add w to the matching alpha_mem of each of the 8 possible kinds,
+       in order of kind --- */
+    num_ams = find_alpha_mems_for_wme(thisAgent->alpha_mem_index, w, ams,
+                                      &thisAgent->alpha_mem_index->num_lookups, &thisAgent->alpha_mem_index->num_probes);
+    for (i = 0; i < num_ams; i++)
+    {
+        add_wme_to_alpha_mem_and_successors(thisAgent, w, ams[i]);
+    }
+    _epmem_add_wme(thisAgent, w);
+}
+
 inline void _epmem_remove_wme(agent* thisAgent, wme* w)
 {
     bool was_encoded = false;
@@ -1616,27 +2213,14 @@ inline void _epmem_process_ids(agent* thisAgent)
     }
 }
 
-/* --- Removes a WME from the Rete. --- */
-void remove_wme_from_rete(agent* thisAgent, wme* w)
+/* --- Removes w from each alpha_mem it's in, left unlinking any Pos or
+   MP nodes whose alpha memory goes empty --- */
+inline void remove_wme_from_alpha_mems(agent* thisAgent, wme* w)
 {
     right_mem* rm;
     alpha_mem* am;
-    rete_node* node, *next, *child;
-    token* tok, *left;
-
-    {
-        if (thisAgent->EpMem->epmem_db->get_status() == soar_module::connected)
-        {
-            _epmem_remove_wme(thisAgent, w);
-            _epmem_process_ids(thisAgent);
-        }
-    }
-
-    /* --- remove w from all_wmes_in_rete --- */
-    remove_from_dll(thisAgent->all_wmes_in_rete, w, rete_next, rete_prev);
-    thisAgent->num_wmes_in_rete--;
+    rete_node* node, *next;
 
-    /* --- remove w from each alpha_mem it's in --- */
     while (w->right_mems)
     {
         rm = w->right_mems;
@@ -1649,7 +2233,7 @@ void remove_wme_from_rete(agent* thisAgent, wme* w)
         for (node = am->beta_nodes; node != NIL; node = next)
         {
             next = node->b.posneg.next_from_alpha_mem;
-            right_node_activation(node, false);
+            right_node_activation(thisAgent, node, false);
         }
 #endif
 
@@ -1674,8 +2258,14 @@ void remove_wme_from_rete(agent* thisAgent, wme* w)
             }
         }
     }
+}
+
+/* --- Tree-based removal of all tokens that involve w --- */
+inline void remove_wme_tokens(agent* thisAgent, wme* w)
+{
+    rete_node* node, *child;
+    token* tok, *left;
 
-    /* --- tree-based removal of all tokens that involve w --- */
     while (w->tokens)
     {
         tok = w->tokens;
@@ -1683,7 +2273,7 @@ void remove_wme_from_rete(agent* thisAgent, wme* w)
         if (! tok->parent)
         {
             /* Note: parent pointer is NIL only on negative node negrm tokens */
-            left = tok->a.neg.left_token;
+            left = token_left_token(tok);
             remove_from_dll(w->tokens, tok, next_from_wme, prev_from_wme);
             remove_from_dll(left->negrm_tokens, tok,
                             a.neg.next_negrm, a.neg.prev_negrm);
@@ -1703,19 +2293,228 @@ void remove_wme_from_rete(agent* thisAgent, wme* w)
     }
 }
 
+/* --- Removes a WME from the Rete. --- */
+void remove_wme_from_rete(agent* thisAgent, wme* w)
+{
+    adjust_rete_ht_sizes(thisAgent);
+
+    {
+        if (thisAgent->EpMem->epmem_db->get_status() == soar_module::connected)
+        {
+            _epmem_remove_wme(thisAgent, w);
+            _epmem_process_ids(thisAgent);
+        }
+    }
+
+    /* --- remove w from all_wmes_in_rete --- */
+    remove_from_dll(thisAgent->all_wmes_in_rete, w, rete_next, rete_prev);
+    thisAgent->num_wmes_in_rete--;
+
+    remove_wme_from_alpha_mems(thisAgent, w);
+    remove_wme_tokens(thisAgent, w);
+}
+
+/* ----------------------------------------------------------------------
+                  Apply a Batch of WM Changes to the Rete
+
+   Apply_wme_changes_to_rete() takes the whole set of buffered additions
+   and removals for a phase.  A wme that is both added and removed in the
+   same batch never touches the rete at all.
+
+   Additions are all looked up in the alpha index first, grouping the
+   batch into (alpha mem, wme) pairs, and the pairs are then added and
+   right activated in arrival order.  Reordering the pairs by alpha
+   memory would give the same match set, but it changes the order of the
+   resulting assertions, and with it which chunks get learned.
+
+   The lookups only read the index, so a large batch can split them
+   across the agent's alpha worker pool.  Each task fills in the entries
+   for its own run of wmes, so the activations that follow are the same
+   whatever the thread count.
+
+   Removals take every wme out of its alpha memories before any tokens
+   are torn down, so negative nodes that become unblocked while removing
+   one wme do not build tokens for another wme leaving in the same batch.
+---------------------------------------------------------------------- */
+
+typedef struct alpha_lookup_struct
+{
+    alpha_mem* ams[8];
+    int num_ams;
+} alpha_lookup;
+
+/* --- Returns the agent's alpha worker pool, (re)making it if the thread
+   count setting changed, or NIL if lookups are single-threaded --- */
+inline Worker_Pool* get_alpha_workers(agent* thisAgent)
+{
+    size_t num_threads;
+
+    num_threads = static_cast<size_t>(thisAgent->Decider->settings[DECIDER_ALPHA_THREADS]);
+    if (num_threads <= 1)
+    {
+        if (thisAgent->alpha_workers)
+        {
+            delete thisAgent->alpha_workers;
+            thisAgent->alpha_workers = NIL;
+        }
+        return NIL;
+    }
+    if (thisAgent->alpha_workers && (thisAgent->alpha_workers->num_threads() != num_threads))
+    {
+        delete thisAgent->alpha_workers;
+        thisAgent->alpha_workers = NIL;
+    }
+    if (! thisAgent->alpha_workers)
+    {
+        thisAgent->alpha_workers = new Worker_Pool(num_threads);
+    }
+    return thisAgent->alpha_workers;
+}
+
+/* --- Fills in <found> for each wme in <entering> --- */
+void find_alpha_mems_for_wmes(agent* thisAgent, std::vector< wme* >& entering,
+                              std::vector< alpha_lookup >& found)
+{
+    alpha_index* index;
+    Worker_Pool* workers;
+    size_t i, num_tasks;
+
+    index = thisAgent->alpha_mem_index;
+    found.resize(entering.size());
+
+    workers = NIL;
+    if (entering.size() >= ALPHA_PARALLEL_MIN_WMES)
+    {
+        workers = get_alpha_workers(thisAgent);
+    }
+    if (! workers)
+    {
+        for (i = 0; i < entering.size(); i++)
+        {
+            found[i].num_ams = find_alpha_mems_for_wme(index, entering[i], found[i].ams,
+                                                       &index->num_lookups, &index->num_probes);
+        }
+        return;
+    }
+
+    num_tasks = (entering.size() + ALPHA_TASK_WMES - 1) / ALPHA_TASK_WMES;
+    std::vector< uint64_t > task_lookups(num_tasks, 0), task_probes(num_tasks, 0);
+
+    workers->run(num_tasks, [&](size_t task)
+    {
+        size_t j, end;
+
+        end = std::min(entering.size(), (task + 1) * ALPHA_TASK_WMES);
+        for (j = task * ALPHA_TASK_WMES; j < end; j++)
+        {
+            found[j].num_ams = find_alpha_mems_for_wme(index, entering[j], found[j].ams,
+                                                       &task_lookups[task], &task_probes[task]);
+        }
+    });
+
+    for (i = 0; i < num_tasks; i++)
+    {
+        index->num_lookups += task_lookups[i];
+        index->num_probes += task_probes[i];
+    }
+    index->num_parallel_batches++;
+}
+
+void apply_wme_changes_to_rete(agent* thisAgent, cons* adds, cons* removes)
+{
+    std::vector< wme* > entering, leaving;
+    std::vector< alpha_lookup > found;
+    tc_number removed_tc, cancelled_tc;
+    cons* c;
+    wme* w;
+    size_t i;
+    int j;
+
+    /* --- mark the removals, then any addition carrying the mark was
+       added and removed in the same batch --- */
+    cancelled_tc = 0;
+    if (adds && removes)
+    {
+        removed_tc = get_new_tc_number(thisAgent);
+        for (c = removes; c != NIL; c = c->rest)
+        {
+            static_cast<wme*>(c->first)->tc = removed_tc;
+        }
+        cancelled_tc = get_new_tc_number(thisAgent);
+        for (c = adds; c != NIL; c = c->rest)
+        {
+            w = static_cast<wme*>(c->first);
+            if (w->tc == removed_tc)
+            {
+                w->tc = cancelled_tc;
+                w->right_mems = NIL;
+                w->tokens = NIL;
+                thisAgent->wme_cancel_count++;
+            }
+        }
+    }
+
+    /* --- additions: enter each wme and find its alpha memories --- */
+    for (c = adds; c != NIL; c = c->rest)
+    {
+        w = static_cast<wme*>(c->first);
+        if (cancelled_tc && (w->tc == cancelled_tc))
+        {
+            continue;
+        }
+        enter_wme_into_rete(thisAgent, w);
+        _epmem_add_wme(thisAgent, w);
+        entering.push_back(w);
+    }
+    find_alpha_mems_for_wmes(thisAgent, entering, found);
+
+    /* --- then run each (alpha mem, wme) pair through the successors --- */
+    for (i = 0; i < entering.size(); i++)
+    {
+        for (j = 0; j < found[i].num_ams; j++)
+        {
+            adjust_rete_ht_sizes(thisAgent);
+            add_wme_to_alpha_mem_and_successors(thisAgent, entering[i], found[i].ams[j]);
+        }
+    }
+
+    /* --- removals: take every wme out of its alpha memories first --- */
+    for (c = removes; c != NIL; c = c->rest)
+    {
+        w = static_cast<wme*>(c->first);
+        if (cancelled_tc && (w->tc == cancelled_tc))
+        {
+            continue;
+        }
+        if (thisAgent->EpMem->epmem_db->get_status() == soar_module::connected)
+        {
+            _epmem_remove_wme(thisAgent, w);
+            _epmem_process_ids(thisAgent);
+        }
+        remove_from_dll(thisAgent->all_wmes_in_rete, w, rete_next, rete_prev);
+        thisAgent->num_wmes_in_rete--;
+        remove_wme_from_alpha_mems(thisAgent, w);
+        leaving.push_back(w);
+    }
+
+    /* --- and then tear down their tokens --- */
+    for (i = 0; i < leaving.size(); i++)
+    {
+        adjust_rete_ht_sizes(thisAgent);
+        remove_wme_tokens(thisAgent, leaving[i]);
+    }
+}
+
 /* --- Decrements reference count, deallocates alpha memory if unused. --- */
 void remove_ref_to_alpha_mem(agent* thisAgent, alpha_mem* am)
 {
-    hash_table* ht;
-
     am->reference_count--;
     if (am->reference_count != 0)
     {
         return;
     }
-    /* --- remove from hash table, and deallocate the alpha_mem --- */
-    ht = table_for_tests(thisAgent, am->id, am->attr, am->value, am->acceptable);
-    remove_from_hash_table(thisAgent, ht, am);
+    /* --- remove from the index, and deallocate the alpha_mem --- */
+    remove_from_alpha_index(thisAgent, am);
     if (am->id)
     {
         thisAgent->symbolManager->symbol_remove_ref(&am->id);
@@ -1796,6 +2595,7 @@ void init_dummy_top_node(agent* thisAgent)
     thisAgent->dummy_top_token->next_of_node = NIL;
     thisAgent->dummy_top_token->prev_of_node = NIL;
     thisAgent->dummy_top_node->a.np.tokens = thisAgent->dummy_top_token;
+    thisAgent->dummy_top_node->a.np.num_tokens = 1;
 }
 
 /* ------------------------------------------------------------------------
@@ -1876,7 +2676,15 @@ void update_node_with_matches_from_above(agent* thisAgent, rete_node* child)
         rete_node* node_to_ignore_for_activation_stats = parent;
         for (rm = parent->b.posneg.alpha_mem_->right_mems; rm != NIL; rm = rm->next_in_am)
         {
-            (*(right_addition_routines[parent->node_type]))(thisAgent, parent, rm->w);
+            if (bnode_is_collection_mem(parent->parent))
+            {
+                /* --- every wme here has been through the whole net --- */
+                collection_join_right_addition(thisAgent, parent, rm->w, false);
+            }
+            else
+            {
+                (*(right_addition_routines[parent->node_type]))(thisAgent, parent, rm->w);
+            }
         }
         node_to_ignore_for_activation_stats = NIL;
         parent->first_child = saved_parents_first_child;
@@ -1923,12 +2731,13 @@ rete_node* nearest_ancestor_with_same_am(rete_node* node, alpha_mem* am)
 /* --------------------------------------------------------------------
                          Make New Mem Node
 
-   Make a new beta memory node, return a pointer to it.
+   Make a new beta memory node, return a pointer to it.  If <collection>
+   is true, the node is built as a collection memory.
 -------------------------------------------------------------------- */
 
 rete_node* make_new_mem_node(agent* thisAgent,
                              rete_node* parent, byte node_type,
-                             var_location left_hash_loc)
+                             var_location left_hash_loc, bool collection)
 {
     rete_node* node;
 
@@ -1947,6 +2756,8 @@ rete_node* make_new_mem_node(agent* thisAgent,
 
     node->node_id = get_next_beta_node_id(thisAgent);
     node->a.np.tokens = NIL;
+    node->a.np.num_tokens = 0;
+    node->a.np.is_collection = collection ? 1 : 0;
 
     /* --- call new node's add_left routine with all the parent's tokens --- */
     update_node_with_matches_from_above(thisAgent, node);
@@ -1954,6 +2765,38 @@ rete_node* make_new_mem_node(agent* thisAgent,
     return node;
 }
 
+/* --------------------------------------------------------------------
+                         Join Kernel For Tests
+
+   Picks the join kernel (see rete.h) a positive, negative or MP node
+   with the given other_tests should use.  The variable equality kernels
+   only take tests against earlier conditions, whose values stay fixed
+   while a left activation walks the right memory.
+-------------------------------------------------------------------- */
+
+byte join_kernel_for_tests(rete_test* rt)
+{
+    int num_tests;
+
+    for (num_tests = 0; rt != NIL; rt = rt->next, num_tests++)
+        if ((rt->type != VARIABLE_RELATIONAL_RETE_TEST + RELATIONAL_EQUAL_RETE_TEST) ||
+                (rt->data.variable_referent.levels_up == 0))
+        {
+            return GENERIC_JOIN_KERNEL;
+        }
+    switch (num_tests)
+    {
+        case 0:
+            return NO_TESTS_JOIN_KERNEL;
+        case 1:
+            return ONE_VAR_EQUAL_JOIN_KERNEL;
+        case 2:
+            return TWO_VAR_EQUAL_JOIN_KERNEL;
+        default:
+            return GENERIC_JOIN_KERNEL;
+    }
+}
+
 /* --------------------------------------------------------------------
                          Make New Positive Node
 
@@ -1976,6 +2819,7 @@ rete_node* make_new_positive_node(agent* thisAgent,
     node->first_child = NIL;
     relink_to_left_mem(node);
     node->b.posneg.other_tests = rt;
+    node->b.posneg.join_kernel = join_kernel_for_tests(rt);
     node->b.posneg.alpha_mem_ = am;
     node->b.posneg.nearest_ancestor_with_same_am =
         nearest_ancestor_with_same_am(node, am);
@@ -1984,8 +2828,10 @@ rete_node* make_new_positive_node(agent* thisAgent,
     /* --- don't need to force WM through new node yet, as it's just a
        join node with no children --- */
 
-    /* --- unlink the join node from one side if possible --- */
-    if (! parent_mem->a.np.tokens)
+    /* --- unlink the join node from one side if possible; a collection
+       memory may hold matches without any tokens, so its children stay
+       right linked --- */
+    if ((! parent_mem->a.np.tokens) && ! bnode_is_collection_mem(parent_mem))
     {
         unlink_from_right_mem(node);
     }
@@ -1994,7 +2840,7 @@ rete_node* make_new_positive_node(agent* thisAgent,
         unlink_from_left_mem(node);
     }
     if (prefer_left_unlinking && (! parent_mem->a.np.tokens) &&
-            (! am->right_mems))
+            (! am->right_mems) && ! bnode_is_collection_mem(parent_mem))
     {
         relink_to_right_mem(node);
         unlink_from_left_mem(node);
@@ -2053,6 +2899,8 @@ rete_node* split_mp_node(agent* thisAgent, rete_node* mp_node)
     mem_node->node_id = mp_copy.node_id;
 
     mem_node->a.np.tokens = mp_node->a.np.tokens;
+    mem_node->a.np.num_tokens = mp_node->a.np.num_tokens;
+    mem_node->a.np.is_collection = 0;
     for (t = mp_node->a.np.tokens; t != NIL; t = t->next_of_node)
     {
         t->node = mem_node;
@@ -2060,6 +2908,7 @@ rete_node* split_mp_node(agent* thisAgent, rete_node* mp_node)
 
     /* --- transmogrify the old MP node into the new Pos node --- */
     init_new_rete_node_with_type(thisAgent, pos_node, node_type);
+    pos_node->profile = mp_copy.profile;
     pos_node->parent = mem_node;
     pos_node->first_child = mp_copy.first_child;
     pos_node->next_sibling = NIL;
@@ -2119,11 +2968,14 @@ rete_node* merge_into_mp_node(agent* thisAgent, rete_node* mem_node)
     /* --- the old Pos node gets transmogrified into the new MP node --- */
     mp_node = pos_node;
     init_new_rete_node_with_type(thisAgent, mp_node, node_type);
+    mp_node->profile = pos_copy.profile;
     set_sharing_factor(mp_node, pos_copy.sharing_factor);
     mp_node->b.posneg = pos_copy.b.posneg;
 
     /* --- transfer the Mem node's tokens to the MP node --- */
     mp_node->a.np.tokens = mem_node->a.np.tokens;
+    mp_node->a.np.num_tokens = mem_node->a.np.num_tokens;
+    mp_node->a.np.is_collection = 0;
     for (t = mem_node->a.np.tokens; t != NIL; t = t->next_of_node)
     {
         t->node = mp_node;
@@ -2140,6 +2992,7 @@ rete_node* merge_into_mp_node(agent* thisAgent, rete_node* mem_node)
 
     remove_node_from_parents_list_of_children(mem_node);
     update_stats_for_destroying_node(thisAgent, mem_node);   /* clean up rete stats stuff */
+    release_node_profile(thisAgent, mem_node, mp_node);
     thisAgent->memoryManager->free_with_pool(MP_rete_node, mem_node);
 
     /* --- set MP node's unlinking status according to pos_copy's --- */
@@ -2176,7 +3029,7 @@ rete_node* make_new_mp_node(agent* thisAgent,
         pos_node_type = UNHASHED_POSITIVE_BNODE;
         mem_node_type = UNHASHED_MEMORY_BNODE;
     }
-    mem_node = make_new_mem_node(thisAgent, parent, mem_node_type, left_hash_loc);
+    mem_node = make_new_mem_node(thisAgent, parent, mem_node_type, left_hash_loc, false);
     pos_node = make_new_positive_node(thisAgent, mem_node, pos_node_type, am, rt,
                                       prefer_left_unlinking);
     return merge_into_mp_node(thisAgent, mem_node);
@@ -2204,8 +3057,10 @@ rete_node* make_new_negative_node(agent* thisAgent,
     node->left_hash_loc_field_num = left_hash_loc.field_num;
     node->left_hash_loc_levels_up = left_hash_loc.levels_up;
     node->b.posneg.other_tests = rt;
+    node->b.posneg.join_kernel = join_kernel_for_tests(rt);
     node->b.posneg.alpha_mem_ = am;
     node->a.np.tokens = NIL;
+    node->a.np.num_tokens = 0;
     node->b.posneg.nearest_ancestor_with_same_am =
         nearest_ancestor_with_same_am(node, am);
     relink_to_right_mem(node);
@@ -2258,6 +3113,7 @@ rete_node* make_new_cn_node(agent* thisAgent,
     node->first_child = NIL;
 
     node->a.np.tokens = NIL;
+    node->a.np.num_tokens = 0;
     node->b.cn.partner = partner;
     node->node_id = get_next_beta_node_id(thisAgent);
 
@@ -2266,6 +3122,7 @@ rete_node* make_new_cn_node(agent* thisAgent,
     bottom_of_subconditions->first_child = partner;
     partner->first_child = NIL;
     partner->a.np.tokens = NIL;
+    partner->a.np.num_tokens = 0;
     partner->b.cn.partner = node;
 
     /* --- call partner's add_left routine with all the parent's tokens --- */
@@ -2302,6 +3159,7 @@ rete_node* make_new_production_node(agent* thisAgent,
     p_node->first_child = NIL;
     p_node->b.p.prod = new_prod;
     p_node->a.np.tokens = NIL;
+    p_node->a.np.num_tokens = 0;
     p_node->b.p.tentative_assertions = NIL;
     p_node->b.p.tentative_retractions = NIL;
     return p_node;
@@ -2326,6 +3184,9 @@ rete_node* make_new_production_node(agent* thisAgent,
    not be a p_node), cleaning up any tokens it contains, removing
    references (to symbols and alpha memories).  It also continues
    deallocating nodes up the net if they are no longer used.
+   Release_rete_node_contents() does just the cleanup part, leaving the
+   node in its parent's list of children; the batch excise code uses it
+   to unlink many children from one parent in a single pass.
 ********************************************************************** */
 
 void deallocate_rete_test_list(agent* thisAgent, rete_test* rt)
@@ -2349,6 +3210,34 @@ void deallocate_rete_test_list(agent* thisAgent, rete_test* rt)
     }
 }
 
+void release_rete_node_contents(agent* thisAgent, rete_node* node)
+{
+    /* --- clean up any tokens at the node --- */
+    if (! bnode_is_bottom_of_split_mp(node->node_type))
+        while (node->a.np.tokens)
+        {
+            remove_token_and_subtree(thisAgent, node->a.np.tokens);
+        }
+
+    /* --- stuff for posneg nodes only --- */
+    if (bnode_is_posneg(node->node_type))
+    {
+        deallocate_rete_test_list(thisAgent, node->b.posneg.other_tests);
+        /* --- right unlink the node, cleanup alpha memory --- */
+        if (! node_is_right_unlinked(node))
+        {
+            unlink_from_right_mem(node);
+        }
+        remove_ref_to_alpha_mem(thisAgent, node->b.posneg.alpha_mem_);
+    }
+
+    /* --- for unmerged pos. nodes: unlink from the beta memory --- */
+    if (bnode_is_bottom_of_split_mp(node->node_type) && ! node_is_left_unlinked(node))
+    {
+        unlink_from_left_mem(node);
+    }
+}
+
 void deallocate_rete_node(agent* thisAgent, rete_node* node)
 {
     rete_node* parent;
@@ -2376,37 +3265,17 @@ void deallocate_rete_node(agent* thisAgent, rete_node* node)
         deallocate_rete_node(thisAgent, node->b.cn.partner);
     }
 
-    /* --- clean up any tokens at the node --- */
-    if (! bnode_is_bottom_of_split_mp(node->node_type))
-        while (node->a.np.tokens)
-        {
-            remove_token_and_subtree(thisAgent, node->a.np.tokens);
-        }
-
-    /* --- stuff for posneg nodes only --- */
-    if (bnode_is_posneg(node->node_type))
-    {
-        deallocate_rete_test_list(thisAgent, node->b.posneg.other_tests);
-        /* --- right unlink the node, cleanup alpha memory --- */
-        if (! node_is_right_unlinked(node))
-        {
-            unlink_from_right_mem(node);
-        }
-        remove_ref_to_alpha_mem(thisAgent, node->b.posneg.alpha_mem_);
-    }
+    release_rete_node_contents(thisAgent, node);
 
     /* --- remove the node from its parent's list --- */
     remove_node_from_parents_list_of_children(node);
 
-    /* --- for unmerged pos. nodes: unlink, maybe merge its parent --- */
+    /* --- for unmerged pos. nodes: maybe merge its parent --- */
     if (bnode_is_bottom_of_split_mp(node->node_type))
     {
-        if (! node_is_left_unlinked(node))
-        {
-            unlink_from_left_mem(node);
-        }
         /* --- if parent is mem node with just one child, merge them --- */
-        if (parent->first_child && (! parent->first_child->next_sibling))
+        if (parent->first_child && (! parent->first_child->next_sibling) &&
+                ! bnode_is_collection_mem(parent))
         {
             merge_into_mp_node(thisAgent, parent);
             parent = NIL;
@@ -2414,6 +3283,7 @@ void deallocate_rete_node(agent* thisAgent, rete_node* node)
     }
 
     update_stats_for_destroying_node(thisAgent, node);   /* clean up rete stats stuff */
+    release_node_profile(thisAgent, node, NIL);
     thisAgent->memoryManager->free_with_pool(MP_rete_node, node);
 
     /* --- if parent has no other children, deallocate it, and recurse  --- */
@@ -3187,7 +4057,7 @@ rete_node* make_node_for_positive_cond(agent* thisAgent,
     rete_node* node, *mem_node, *mp_node;
     alpha_mem* am;
     rete_test* rt;
-    bool hash_this_node;
+    bool hash_this_node, collection_mem;
     var_location left_hash_loc;
     left_hash_loc.var_location_struct::field_num = 0;
     left_hash_loc.var_location_struct::levels_up = 0;
@@ -3243,10 +4113,16 @@ rete_node* make_node_for_positive_cond(agent* thisAgent,
         mp_node_type = UNHASHED_MP_BNODE;
     }
 
+    /* --- :collection productions get a separate collection memory, if the
+       parent can feed one; it is never shared with ordinary productions --- */
+    collection_mem = (thisAgent->building_collection_net &&
+                      collection_mem_allowed(thisAgent, parent));
+
     /* --- look for a matching existing memory node --- */
     for (mem_node = parent->first_child; mem_node != NIL;
             mem_node = mem_node->next_sibling)
         if ((mem_node->node_type == mem_node_type) &&
+                (static_cast<bool>(mem_node->a.np.is_collection) == collection_mem) &&
                 ((!hash_this_node) ||
                  ((mem_node->left_hash_loc_field_num == left_hash_loc.field_num) &&
                   (mem_node->left_hash_loc_levels_up == left_hash_loc.levels_up))))
@@ -3282,6 +4158,7 @@ rete_node* make_node_for_positive_cond(agent* thisAgent,
     for (mp_node = parent->first_child; mp_node != NIL;
             mp_node = mp_node->next_sibling)
         if ((mp_node->node_type == mp_node_type) &&
+                (static_cast<bool>(mp_node->a.np.is_collection) == collection_mem) &&
                 ((!hash_this_node) ||
                  ((mp_node->left_hash_loc_field_num == left_hash_loc.field_num) &&
                   (mp_node->left_hash_loc_levels_up == left_hash_loc.levels_up))))
@@ -3306,6 +4183,14 @@ rete_node* make_node_for_positive_cond(agent* thisAgent,
         return node;
     }
 
+    /* --- For :collection productions, make the collection memory and
+       join instead --- */
+    if (collection_mem)
+    {
+        mem_node = make_new_mem_node(thisAgent, parent, mem_node_type, left_hash_loc, true);
+        return make_new_positive_node(thisAgent, mem_node, pos_node_type, am, rt, false);
+    }
+
     /* --- Didn't even find a matching M part of MP, so make a new MP node --- */
     return make_new_mp_node(thisAgent, parent, mp_node_type, left_hash_loc, am, rt, false);
 }
@@ -3729,10 +4614,13 @@ void update_max_rhs_unbound_variables(agent* thisAgent, uint64_t num_for_new_pro
    activation routine filled in the token info on the instantiation for
    us).  If so, there was no match for the refracted instantiation.
 
+   "invoke_callbacks" is false when an existing production is only being
+   rebuilt (see production reorder), so listeners don't see it come and go.
+
    BUGBUG should we check for duplicate justifications?
 --------------------------------------------------------------------- */
 
-byte add_production_to_rete(agent* thisAgent, production* p, condition* lhs_top, instantiation* refracted_inst, bool warn_on_duplicates, production* &duplicate_rule, bool ignore_rhs)
+byte add_production_to_rete(agent* thisAgent, production* p, condition* lhs_top, instantiation* refracted_inst, bool warn_on_duplicates, production* &duplicate_rule, bool ignore_rhs, bool invoke_callbacks)
 {
     rete_node* bottom_node, *p_node;
     rete_node_level bottom_depth;
@@ -3741,9 +4629,13 @@ byte add_production_to_rete(agent* thisAgent, production* p, condition* lhs_top,
     action* a;
     byte production_addition_result;
 
+    adjust_rete_ht_sizes(thisAgent);
+
     /* --- build the network for all the conditions --- */
+    thisAgent->building_collection_net = p->collection_match;
     build_network_for_condition_list(thisAgent, lhs_top, 1, thisAgent->dummy_top_node,
                                      &bottom_node, &bottom_depth, &vars_bound);
+    thisAgent->building_collection_net = false;
 
     /* --- change variable names in RHS to Rete location references or
     unbound variable indices --- */
@@ -3939,7 +4831,10 @@ byte add_production_to_rete(agent* thisAgent, production* p, condition* lhs_top,
     }
 
     /* --- invoke callback functions --- */
-    soar_invoke_callbacks(thisAgent, PRODUCTION_JUST_ADDED_CALLBACK, static_cast<soar_call_data>(p));
+    if (invoke_callbacks)
+    {
+        soar_invoke_callbacks(thisAgent, PRODUCTION_JUST_ADDED_CALLBACK, static_cast<soar_call_data>(p));
+    }
 
     return production_addition_result;
 }
@@ -3948,15 +4843,21 @@ byte add_production_to_rete(agent* thisAgent, production* p, condition* lhs_top,
                       Excise Production from Rete
 
    This removes a given production from the Rete net, and enqueues all
-   its existing instantiations as pending retractions.
+   its existing instantiations as pending retractions.  As above,
+   "invoke_callbacks" is false when the production is about to be rebuilt.
 --------------------------------------------------------------------- */
 
-void excise_production_from_rete(agent* thisAgent, production* pProd)
+void excise_production_from_rete(agent* thisAgent, production* pProd, bool invoke_callbacks)
 {
     rete_node* p_node, *parent;
     ms_change* msc;
 
-    soar_invoke_callbacks(thisAgent, PRODUCTION_JUST_ABOUT_TO_BE_EXCISED_CALLBACK, static_cast<soar_call_data>(pProd));
+    adjust_rete_ht_sizes(thisAgent);
+
+    if (invoke_callbacks)
+    {
+        soar_invoke_callbacks(thisAgent, PRODUCTION_JUST_ABOUT_TO_BE_EXCISED_CALLBACK, static_cast<soar_call_data>(pProd));
+    }
 
     p_node = pProd->p_node;
     pProd->p_node = NIL;      /* mark production as not being in the rete anymore */
@@ -3985,6 +4886,7 @@ void excise_production_from_rete(agent* thisAgent, production* pProd)
     /* --- finally, excise the p_node --- */
     remove_node_from_parents_list_of_children(p_node);
     update_stats_for_destroying_node(thisAgent, p_node);    /* clean up rete stats stuff */
+    release_node_profile(thisAgent, p_node, NIL);
     thisAgent->memoryManager->free_with_pool(MP_rete_node, p_node);
 
     /* --- update sharing factors on the path from here to the top node --- */
@@ -3997,23 +4899,169 @@ void excise_production_from_rete(agent* thisAgent, production* pProd)
     }
 }
 
+/* ---------------------------------------------------------------------
+                   Excise Productions from Rete (Batch)
+
+   Excising productions one at a time unlinks every node that goes away
+   by walking its parent's list of children, which is quadratic when
+   thousands of chunks hang off the same node, and a memory node can be
+   merged into an MP node and split apart again several times on the
+   way.  Excise_productions_from_rete() removes a whole set at once.
+   First each p_node's instantiations are retracted and the p_node is
+   marked dead.  Then the nodes they leave behind are swept from the
+   bottom of the net up: each parent's list of children is filtered
+   once, however many of its children went away, and a parent left
+   with no children is released and marked dead in turn.  Parents are
+   swept deepest first, so by the time a memory node is merged with its
+   one remaining child, nothing below it is still waiting to go.
+--------------------------------------------------------------------- */
 
+typedef std::pair< uint64_t, rete_node* > rete_sweep_entry;
+typedef std::priority_queue< rete_sweep_entry > rete_sweep_queue;
 
+/* --- A node waiting to be unlinked from its parent is marked dead by
+   pointing its (otherwise empty) list of children at itself --- */
+inline void mark_rete_node_dead(rete_node* node)
+{
+    node->first_child = node;
+}
 
+inline bool rete_node_is_dead(rete_node* node)
+{
+    return (node->first_child == node);
+}
 
+inline void schedule_rete_sweep(agent* thisAgent, rete_sweep_queue& sweep, rete_node* node)
+{
+    uint64_t depth;
+    rete_node* n;
 
+    depth = 0;
+    for (n = node; n != thisAgent->dummy_top_node; n = n->parent)
+    {
+        depth++;
+    }
+    sweep.push(rete_sweep_entry(depth, node));
+}
 
+void excise_productions_from_rete(agent* thisAgent, std::vector< production* >& prods)
+{
+    rete_node* p_node, *parent, *last_parent, *node, *child, **link;
+    ms_change* msc;
+    rete_sweep_queue sweep;
+    bool removed_split_mp;
 
+    adjust_rete_ht_sizes(thisAgent);
 
+    /* --- pass 1: retract instantiations, mark the p_nodes dead --- */
+    last_parent = NIL;
+    for (std::vector< production* >::iterator it = prods.begin(); it != prods.end(); ++it)
+    {
+        soar_invoke_callbacks(thisAgent, PRODUCTION_JUST_ABOUT_TO_BE_EXCISED_CALLBACK, static_cast<soar_call_data>(*it));
 
+        p_node = (*it)->p_node;
+        (*it)->p_node = NIL;
+        parent = p_node->parent;
 
+        if (p_node->b.p.parents_nvn)
+            deallocate_node_varnames(thisAgent, parent, thisAgent->dummy_top_node,
+                                     p_node->b.p.parents_nvn);
+        while (p_node->a.np.tokens)
+        {
+            remove_token_and_subtree(thisAgent, p_node->a.np.tokens);
+        }
+        for (msc = p_node->b.p.tentative_retractions; msc != NIL; msc = msc->next_of_node)
+        {
+            msc->p_node = NIL;
+        }
+        adjust_sharing_factors_from_here_to_top(parent, -1);
 
+        mark_rete_node_dead(p_node);
+        if (parent != last_parent)
+        {
+            schedule_rete_sweep(thisAgent, sweep, parent);
+            last_parent = parent;
+        }
+    }
 
-/* **********************************************************************
-
-   SECTION 10:  Building Conditions (instantiated or not) from the Rete Net
+    /* --- pass 2: sweep the dead nodes out, bottom up --- */
+    while (! sweep.empty())
+    {
+        /* --- a node scheduled more than once is swept once; its entries
+           are equal, so they come off the queue together --- */
+        node = sweep.top().second;
+        while ((! sweep.empty()) && (sweep.top().second == node))
+        {
+            sweep.pop();
+        }
 
-   These routines are used for two things.  First, when we want to print
+        removed_split_mp = false;
+        link = &node->first_child;
+        while (*link)
+        {
+            child = *link;
+            if (rete_node_is_dead(child))
+            {
+                *link = child->next_sibling;
+                if (bnode_is_bottom_of_split_mp(child->node_type))
+                {
+                    removed_split_mp = true;
+                }
+                update_stats_for_destroying_node(thisAgent, child);
+                release_node_profile(thisAgent, child, NIL);
+                thisAgent->memoryManager->free_with_pool(MP_rete_node, child);
+            }
+            else
+            {
+                link = &child->next_sibling;
+            }
+        }
+
+        if (node == thisAgent->dummy_top_node)
+        {
+            continue;
+        }
+        if (node->first_child)
+        {
+            /* --- if a mem node is left with just one child, merge them --- */
+            if (removed_split_mp && (! node->first_child->next_sibling) &&
+                    ! bnode_is_collection_mem(node))
+            {
+                merge_into_mp_node(thisAgent, node);
+            }
+            continue;
+        }
+
+        /* --- no children left, so this node goes too --- */
+        if (node->node_type == CN_BNODE)
+        {
+            release_rete_node_contents(thisAgent, node->b.cn.partner);
+            mark_rete_node_dead(node->b.cn.partner);
+            schedule_rete_sweep(thisAgent, sweep, node->b.cn.partner->parent);
+        }
+        release_rete_node_contents(thisAgent, node);
+        mark_rete_node_dead(node);
+        schedule_rete_sweep(thisAgent, sweep, node->parent);
+    }
+}
+
+
+
+
+
+
+
+
+
+
+
+
+
+/* **********************************************************************
+
+   SECTION 10:  Building Conditions (instantiated or not) from the Rete Net
+
+   These routines are used for two things.  First, when we want to print
    out the source code for a production, we need to reconstruct its
    conditions and actions.  Second, when we fire a production, we need to
    build its instantiated conditions.  (These are used for run-time
@@ -4587,7 +5635,7 @@ bool constant_smem_link_not_rete_test_routine(agent* /*thisAgent*/, rete_test* r
     return static_cast<bool>(!s1->is_lti() ||  !s2->is_int() || (s1->id->LTI_ID != s2->ic->value));
 }
 
-bool variable_equal_rete_test_routine(agent* /*thisAgent*/, rete_test* rt, token* left, wme* w)
+inline bool variable_equal_test_passes(rete_test* rt, token* left, wme* w)
 {
     Symbol* s1, *s2;
     int i;
@@ -4609,6 +5657,11 @@ bool variable_equal_rete_test_routine(agent* /*thisAgent*/, rete_test* rt, token
     return (s1 == s2);
 }
 
+bool variable_equal_rete_test_routine(agent* /*thisAgent*/, rete_test* rt, token* left, wme* w)
+{
+    return variable_equal_test_passes(rt, left, w);
+}
+
 bool variable_not_equal_rete_test_routine(agent* /*thisAgent*/, rete_test* rt, token* left,
         wme* w)
 {
@@ -4796,6 +5849,120 @@ bool variable_smem_link_not_rete_test_routine(agent* /*thisAgent*/, rete_test* r
     return return_val;
 }
 
+/* ---------------------------------------------------------------------
+   Join kernels
+
+   Most join nodes test nothing beyond their hashed test, or one or two
+   variable equalities against earlier conditions.  match_join_tests()
+   runs those shapes inline (the node's join_kernel is set when it is
+   built), and only falls back to calling through rete_test_routines[]
+   once per test for the rest.  Left activations, which try one token
+   against many wmes, first look up the token's side of the equalities
+   with prepare_join_tests() and then use match_prepared_join_tests().
+--------------------------------------------------------------------- */
+
+template <int num_tests>
+inline bool variable_equal_tests_pass(rete_test* rt, token* left, wme* w)
+{
+    for (int i = 0; i < num_tests; i++, rt = rt->next)
+        if (! variable_equal_test_passes(rt, left, w))
+        {
+            return false;
+        }
+    return true;
+}
+
+template <int num_tests>
+inline void get_variable_equal_left_values(rete_test* rt, token* left, Symbol** left_values)
+{
+    token* t;
+    int i;
+
+    for (int j = 0; j < num_tests; j++, rt = rt->next)
+    {
+        t = left;
+        for (i = rt->data.variable_referent.levels_up - 1; i != 0; i--)
+        {
+            t = t->parent;
+        }
+        left_values[j] = field_from_wme(t->w, rt->data.variable_referent.field_num);
+    }
+}
+
+template <int num_tests>
+inline bool variable_equal_right_values_match(rete_test* rt, Symbol** left_values, wme* w)
+{
+    for (int j = 0; j < num_tests; j++, rt = rt->next)
+        if (field_from_wme(w, rt->right_field_num) != left_values[j])
+        {
+            return false;
+        }
+    return true;
+}
+
+inline bool match_generic_join_tests(agent* thisAgent, rete_test* rt, token* left, wme* w)
+{
+    for (; rt != NIL; rt = rt->next)
+        if (! match_left_and_right(thisAgent, rt, left, w))
+        {
+            return false;
+        }
+    return true;
+}
+
+inline bool match_join_tests(agent* thisAgent, rete_node* node, token* left, wme* w)
+{
+    rete_test* rt;
+
+    rt = node->b.posneg.other_tests;
+    switch (node->b.posneg.join_kernel)
+    {
+        case NO_TESTS_JOIN_KERNEL:
+            return true;
+        case ONE_VAR_EQUAL_JOIN_KERNEL:
+            return variable_equal_tests_pass<1>(rt, left, w);
+        case TWO_VAR_EQUAL_JOIN_KERNEL:
+            return variable_equal_tests_pass<2>(rt, left, w);
+        default:
+            return match_generic_join_tests(thisAgent, rt, left, w);
+    }
+}
+
+/* --- left_values needs room for two symbols --- */
+inline void prepare_join_tests(rete_node* node, token* left, Symbol** left_values)
+{
+    switch (node->b.posneg.join_kernel)
+    {
+        case ONE_VAR_EQUAL_JOIN_KERNEL:
+            get_variable_equal_left_values<1>(node->b.posneg.other_tests, left, left_values);
+            break;
+        case TWO_VAR_EQUAL_JOIN_KERNEL:
+            get_variable_equal_left_values<2>(node->b.posneg.other_tests, left, left_values);
+            break;
+        default:
+            break;
+    }
+}
+
+inline bool match_prepared_join_tests(agent* thisAgent, rete_node* node, token* left,
+                                      Symbol** left_values, wme* w)
+{
+    rete_test* rt;
+
+    rt = node->b.posneg.other_tests;
+    switch (node->b.posneg.join_kernel)
+    {
+        case NO_TESTS_JOIN_KERNEL:
+            return true;
+        case ONE_VAR_EQUAL_JOIN_KERNEL:
+            return variable_equal_right_values_match<1>(rt, left_values, w);
+        case TWO_VAR_EQUAL_JOIN_KERNEL:
+            return variable_equal_right_values_match<2>(rt, left_values, w);
+        default:
+            return match_generic_join_tests(thisAgent, rt, left, w);
+    }
+}
+
 
 /* ************************************************************************
 
@@ -4825,6 +5992,22 @@ void rete_error_right(agent* thisAgent, rete_node* node, wme* /*w*/)
     abort_with_fatal_error(thisAgent, msg);
 }
 
+/* --- Frees a childless token at a collection memory.  The pair it
+   stands for is still available to the memory's children in factored
+   form, so nothing downstream needs to hear about it. --- */
+void discard_collection_token(agent* thisAgent, token* tok)
+{
+    remove_token_from_left_ht(thisAgent, tok, left_ht_hash_value_of_token(tok));
+    fast_remove_from_dll(tok->node->a.np.tokens, tok, token, next_of_node,
+                         prev_of_node);
+    tok->node->a.np.num_tokens--;
+    fast_remove_from_dll(tok->parent->first_child, tok, token,
+                         next_sibling, prev_sibling);
+    fast_remove_from_dll(tok->w->tokens, tok, token, next_from_wme,
+                         prev_from_wme);
+    thisAgent->memoryManager->free_with_pool(MP_token, tok);
+}
+
 void beta_memory_node_left_addition(agent* thisAgent, rete_node* node,
                                     token* tok, wme* w)
 {
@@ -4834,7 +6017,7 @@ void beta_memory_node_left_addition(agent* thisAgent, rete_node* node,
     token* New;
 
     activation_entry_sanity_check();
-    left_node_activation(node, true);
+    left_node_activation(thisAgent, node, true);
 
     {
         int levels_up;
@@ -4858,11 +6041,11 @@ void beta_memory_node_left_addition(agent* thisAgent, rete_node* node,
     hv = node->node_id ^ referent->hash_id;
 
     /* --- build new left token, add it to the hash table --- */
-    token_added(node);
+    token_added(thisAgent, node);
     thisAgent->memoryManager->allocate_with_pool(MP_token, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
-    New->a.ht.referent = referent;
+    set_token_referent(New, referent);
 
     /* --- inform each linked child (positive join) node --- */
     for (child = node->b.mem.first_linked_child; child != NIL; child = next)
@@ -4870,6 +6053,12 @@ void beta_memory_node_left_addition(agent* thisAgent, rete_node* node,
         next = child->a.pos.next_from_beta_mem;
         positive_node_left_addition(thisAgent, child, New, referent);
     }
+
+    /* --- collection memories only keep tokens something extended --- */
+    if (node->a.np.is_collection && ! New->first_child)
+    {
+        discard_collection_token(thisAgent, New);
+    }
     activation_exit_sanity_check();
 }
 
@@ -4882,16 +6071,16 @@ void unhashed_beta_memory_node_left_addition(agent* thisAgent,
     token* New;
 
     activation_entry_sanity_check();
-    left_node_activation(node, true);
+    left_node_activation(thisAgent, node, true);
 
     hv = node->node_id;
 
     /* --- build new left token, add it to the hash table --- */
-    token_added(node);
+    token_added(thisAgent, node);
     thisAgent->memoryManager->allocate_with_pool(MP_token, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
-    New->a.ht.referent = NIL;
+    set_token_referent(New, NIL);
 
     /* --- inform each linked child (positive join) node --- */
     for (child = node->b.mem.first_linked_child; child != NIL; child = next)
@@ -4899,6 +6088,12 @@ void unhashed_beta_memory_node_left_addition(agent* thisAgent,
         next = child->a.pos.next_from_beta_mem;
         unhashed_positive_node_left_addition(thisAgent, child, New);
     }
+
+    /* --- collection memories only keep tokens something extended --- */
+    if (node->a.np.is_collection && ! New->first_child)
+    {
+        discard_collection_token(thisAgent, New);
+    }
     activation_exit_sanity_check();
 }
 
@@ -4909,12 +6104,13 @@ void positive_node_left_addition(agent* thisAgent,
     uint32_t right_hv;
     right_mem* rm;
     alpha_mem* am;
-    rete_test* rt;
     bool failed_a_test;
+    Symbol* left_values[2];
+    uint64_t num_join_tests = 0;
     rete_node* child;
 
     activation_entry_sanity_check();
-    left_node_activation(node, true);
+    left_node_activation(thisAgent, node, true);
 
     am = node->b.posneg.alpha_mem_;
 
@@ -4931,6 +6127,7 @@ void positive_node_left_addition(agent* thisAgent,
 
     /* --- look through right memory for matches --- */
     right_hv = am->am_id ^ hash_referent->hash_id;
+    prepare_join_tests(node, New, left_values);
     for (rm = right_ht_bucket(thisAgent, right_hv); rm != NIL; rm = rm->next_in_bucket)
     {
         if (rm->am != am)
@@ -4942,13 +6139,8 @@ void positive_node_left_addition(agent* thisAgent,
         {
             continue;
         }
-        failed_a_test = false;
-        for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-            if (! match_left_and_right(thisAgent, rt, New, rm->w))
-            {
-                failed_a_test = true;
-                break;
-            }
+        num_join_tests++;
+        failed_a_test = ! match_prepared_join_tests(thisAgent, node, New, left_values, rm->w);
         if (failed_a_test)
         {
             continue;
@@ -4959,18 +6151,20 @@ void positive_node_left_addition(agent* thisAgent,
             (*(left_addition_routines[child->node_type]))(thisAgent, child, New, rm->w);
         }
     }
+    join_tests_performed(thisAgent, node, num_join_tests);
     activation_exit_sanity_check();
 }
 
 void unhashed_positive_node_left_addition(agent* thisAgent, rete_node* node, token* New)
 {
     right_mem* rm;
-    rete_test* rt;
     bool failed_a_test;
+    Symbol* left_values[2];
+    uint64_t num_join_tests = 0;
     rete_node* child;
 
     activation_entry_sanity_check();
-    left_node_activation(node, true);
+    left_node_activation(thisAgent, node, true);
 
     if (node_is_right_unlinked(node))
     {
@@ -4984,17 +6178,13 @@ void unhashed_positive_node_left_addition(agent* thisAgent, rete_node* node, tok
     }
 
     /* --- look through right memory for matches --- */
+    prepare_join_tests(node, New, left_values);
     for (rm = node->b.posneg.alpha_mem_->right_mems; rm != NIL;
             rm = rm->next_in_am)
     {
         /* --- does rm->w match new? --- */
-        failed_a_test = false;
-        for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-            if (! match_left_and_right(thisAgent, rt, New, rm->w))
-            {
-                failed_a_test = true;
-                break;
-            }
+        num_join_tests++;
+        failed_a_test = ! match_prepared_join_tests(thisAgent, node, New, left_values, rm->w);
         if (failed_a_test)
         {
             continue;
@@ -5005,6 +6195,7 @@ void unhashed_positive_node_left_addition(agent* thisAgent, rete_node* node, tok
             (*(left_addition_routines[child->node_type]))(thisAgent, child, New, rm->w);
         }
     }
+    join_tests_performed(thisAgent, node, num_join_tests);
     activation_exit_sanity_check();
 }
 
@@ -5017,11 +6208,12 @@ void mp_node_left_addition(agent* thisAgent, rete_node* node, token* tok, wme* w
     uint32_t right_hv;
     right_mem* rm;
     alpha_mem* am;
-    rete_test* rt;
     bool failed_a_test;
+    Symbol* left_values[2];
+    uint64_t num_join_tests = 0;
 
     activation_entry_sanity_check();
-    left_node_activation(node, true);
+    left_node_activation(thisAgent, node, true);
 
     {
         int levels_up;
@@ -5045,11 +6237,11 @@ void mp_node_left_addition(agent* thisAgent, rete_node* node, token* tok, wme* w
     hv = node->node_id ^ referent->hash_id;
 
     /* --- build new left token, add it to the hash table --- */
-    token_added(node);
+    token_added(thisAgent, node);
     thisAgent->memoryManager->allocate_with_pool(MP_token, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
-    New->a.ht.referent = referent;
+    set_token_referent(New, referent);
 
     if (mp_bnode_is_left_unlinked(node))
     {
@@ -5072,6 +6264,7 @@ void mp_node_left_addition(agent* thisAgent, rete_node* node, token* tok, wme* w
 
     /* --- look through right memory for matches --- */
     right_hv = am->am_id ^ referent->hash_id;
+    prepare_join_tests(node, New, left_values);
     for (rm = right_ht_bucket(thisAgent, right_hv); rm != NIL; rm = rm->next_in_bucket)
     {
         if (rm->am != am)
@@ -5083,15 +6276,8 @@ void mp_node_left_addition(agent* thisAgent, rete_node* node, token* tok, wme* w
         {
             continue;
         }
-        failed_a_test = false;
-        for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-        {
-            if (! match_left_and_right(thisAgent, rt, New, rm->w))
-            {
-                failed_a_test = true;
-                break;
-            }
-        }
+        num_join_tests++;
+        failed_a_test = ! match_prepared_join_tests(thisAgent, node, New, left_values, rm->w);
         if (failed_a_test)
         {
             continue;
@@ -5102,6 +6288,7 @@ void mp_node_left_addition(agent* thisAgent, rete_node* node, token* tok, wme* w
             (*(left_addition_routines[child->node_type]))(thisAgent, child, New, rm->w);
         }
     }
+    join_tests_performed(thisAgent, node, num_join_tests);
     activation_exit_sanity_check();
 }
 
@@ -5113,20 +6300,21 @@ void unhashed_mp_node_left_addition(agent* thisAgent, rete_node* node,
     rete_node* child;
     token* New;
     right_mem* rm;
-    rete_test* rt;
     bool failed_a_test;
+    Symbol* left_values[2];
+    uint64_t num_join_tests = 0;
 
     activation_entry_sanity_check();
-    left_node_activation(node, true);
+    left_node_activation(thisAgent, node, true);
 
     hv = node->node_id;
 
     /* --- build new left token, add it to the hash table --- */
-    token_added(node);
+    token_added(thisAgent, node);
     thisAgent->memoryManager->allocate_with_pool(MP_token, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
-    New->a.ht.referent = NIL;
+    set_token_referent(New, NIL);
 
     if (mp_bnode_is_left_unlinked(node))
     {
@@ -5145,17 +6333,13 @@ void unhashed_mp_node_left_addition(agent* thisAgent, rete_node* node,
     }
 
     /* --- look through right memory for matches --- */
+    prepare_join_tests(node, New, left_values);
     for (rm = node->b.posneg.alpha_mem_->right_mems; rm != NIL;
             rm = rm->next_in_am)
     {
         /* --- does rm->w match new? --- */
-        failed_a_test = false;
-        for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-            if (! match_left_and_right(thisAgent, rt, New, rm->w))
-            {
-                failed_a_test = true;
-                break;
-            }
+        num_join_tests++;
+        failed_a_test = ! match_prepared_join_tests(thisAgent, node, New, left_values, rm->w);
         if (failed_a_test)
         {
             continue;
@@ -5166,6 +6350,7 @@ void unhashed_mp_node_left_addition(agent* thisAgent, rete_node* node,
             (*(left_addition_routines[child->node_type]))(thisAgent, child, New, rm->w);
         }
     }
+    join_tests_performed(thisAgent, node, num_join_tests);
     activation_exit_sanity_check();
 }
 
@@ -5174,12 +6359,18 @@ void positive_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
     uint32_t hv;
     token* tok;
     Symbol* referent;
-    rete_test* rt;
     bool failed_a_test;
+    uint64_t num_join_tests = 0;
     rete_node* child;
 
+    if (node->parent->a.np.is_collection)
+    {
+        collection_join_right_addition(thisAgent, node, w, true);
+        return;
+    }
+
     activation_entry_sanity_check();
-    right_node_activation(node, true);
+    right_node_activation(thisAgent, node, true);
 
     if (node_is_left_unlinked(node))
     {
@@ -5202,17 +6393,12 @@ void positive_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
             continue;
         }
         /* --- does tok match w? --- */
-        if (tok->a.ht.referent != referent)
+        if (token_referent(tok) != referent)
         {
             continue;
         }
-        failed_a_test = false;
-        for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-            if (! match_left_and_right(thisAgent, rt, tok, w))
-            {
-                failed_a_test = true;
-                break;
-            }
+        num_join_tests++;
+        failed_a_test = ! match_join_tests(thisAgent, node, tok, w);
         if (failed_a_test)
         {
             continue;
@@ -5223,6 +6409,7 @@ void positive_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
             (*(left_addition_routines[child->node_type]))(thisAgent, child, tok, w);
         }
     }
+    join_tests_performed(thisAgent, node, num_join_tests);
     activation_exit_sanity_check();
 }
 
@@ -5230,12 +6417,18 @@ void unhashed_positive_node_right_addition(agent* thisAgent, rete_node* node, wm
 {
     uint32_t hv;
     token* tok;
-    rete_test* rt;
     bool failed_a_test;
+    uint64_t num_join_tests = 0;
     rete_node* child;
 
+    if (node->parent->a.np.is_collection)
+    {
+        collection_join_right_addition(thisAgent, node, w, true);
+        return;
+    }
+
     activation_entry_sanity_check();
-    right_node_activation(node, true);
+    right_node_activation(thisAgent, node, true);
 
     if (node_is_left_unlinked(node))
     {
@@ -5257,13 +6450,8 @@ void unhashed_positive_node_right_addition(agent* thisAgent, rete_node* node, wm
             continue;
         }
         /* --- does tok match w? --- */
-        failed_a_test = false;
-        for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-            if (! match_left_and_right(thisAgent, rt, tok, w))
-            {
-                failed_a_test = true;
-                break;
-            }
+        num_join_tests++;
+        failed_a_test = ! match_join_tests(thisAgent, node, tok, w);
         if (failed_a_test)
         {
             continue;
@@ -5274,6 +6462,188 @@ void unhashed_positive_node_right_addition(agent* thisAgent, rete_node* node, wm
             (*(left_addition_routines[child->node_type]))(thisAgent, child, tok, w);
         }
     }
+    join_tests_performed(thisAgent, node, num_join_tests);
+    activation_exit_sanity_check();
+}
+
+/* ----------------------------------------------------------------------
+   Right activation of a join below a collection memory.  The memory's
+   pairs (tok,w_in) are enumerated from its parent join's left memory and
+   alpha memory; each pair that passes the parent join's tests and joins
+   with w gets its token materialized (or found, if some earlier match
+   already made it) and is passed to the children.
+
+   When the collection memory's parent join uses the same alpha memory,
+   the add_wme_to_aht() ordering right activates this node before its
+   ancestor, so pairs built from w itself do not exist yet; <w_pending>
+   says to skip them, as they will arrive by left activation instead.
+---------------------------------------------------------------------- */
+
+/* --- the hash referent a collection memory would give the pair --- */
+inline Symbol* collection_pair_referent(rete_node* mem, token* tok, wme* w_in)
+{
+    int levels_up;
+
+    if (! bnode_is_hashed(mem->node_type))
+    {
+        return NIL;
+    }
+    levels_up = mem->left_hash_loc_levels_up;
+    if (levels_up == 1)
+    {
+        return field_from_wme(w_in, mem->left_hash_loc_field_num);
+    }
+    for (levels_up -= 2; levels_up != 0; levels_up--)
+    {
+        tok = tok->parent;
+    }
+    return field_from_wme(tok->w, mem->left_hash_loc_field_num);
+}
+
+void collection_join_pair(agent* thisAgent, rete_node* node, token* tok,
+                          wme* w_in, Symbol* referent, wme* w,
+                          uint64_t* num_join_tests)
+{
+    rete_node* mem, *child;
+    token pair, *New;
+    uint32_t hv;
+
+    mem = node->parent;
+
+    /* --- does the pair exist, i.e., pass the parent join's tests? --- */
+    if (! match_join_tests(thisAgent, mem->parent, tok, w_in))
+    {
+        return;
+    }
+
+    /* --- does w match the pair?  Rete tests only look at the parent
+       and wme of the left token, so a stack copy will do --- */
+    memset(&pair, 0, sizeof(token));
+    pair.parent = tok;
+    pair.w = w_in;
+    (*num_join_tests)++;
+    if (! match_join_tests(thisAgent, node, &pair, w))
+    {
+        return;
+    }
+
+    /* --- find or make the real token for the pair --- */
+    hv = mem->node_id ^ (referent ? referent->hash_id : 0);
+    for (New = left_ht_bucket(thisAgent, hv); New != NIL; New = New->a.ht.next_in_bucket)
+        if ((New->node == mem) && (New->parent == tok) && (New->w == w_in))
+        {
+            break;
+        }
+    if (! New)
+    {
+        token_added(thisAgent, mem);
+        thisAgent->memoryManager->allocate_with_pool(MP_token, &New);
+        new_left_token(New, mem, tok, w_in);
+        insert_token_into_left_ht(thisAgent, New, hv);
+        set_token_referent(New, referent);
+    }
+
+    /* --- match found, so call each child node --- */
+    for (child = node->first_child; child != NIL; child = child->next_sibling)
+    {
+        (*(left_addition_routines[child->node_type]))(thisAgent, child, New, w);
+    }
+}
+
+void collection_join_right_addition(agent* thisAgent, rete_node* node, wme* w,
+                                    bool w_pending)
+{
+    rete_node* mem, *join, *left_mem;
+    alpha_mem* join_am;
+    right_mem* rm;
+    token* tok;
+    Symbol* referent, *left_referent;
+    uint32_t hv;
+    bool skip_w;
+    uint64_t num_join_tests = 0;
+
+    activation_entry_sanity_check();
+    right_node_activation(thisAgent, node, true);
+
+    if (node_is_left_unlinked(node))
+    {
+        relink_to_left_mem(node);
+    }
+
+    mem = node->parent;
+    join = mem->parent;
+    left_mem = left_mem_of_join(join);
+    join_am = join->b.posneg.alpha_mem_;
+    skip_w = w_pending && (join_am == node->b.posneg.alpha_mem_);
+
+    if (bnode_is_hashed(mem->node_type) && (mem->left_hash_loc_levels_up == 1))
+    {
+        /* --- the pair's own wme holds the join value, so start from the
+           alpha memory entries that have w's id in that field --- */
+        for (rm = join_am->right_mems; rm != NIL; rm = rm->next_in_am)
+        {
+            if ((field_from_wme(rm->w, mem->left_hash_loc_field_num) != w->id) ||
+                    (skip_w && (rm->w == w)))
+            {
+                continue;
+            }
+            if (bnode_is_hashed(join->node_type))
+            {
+                hv = left_mem->node_id ^ rm->w->id->hash_id;
+                for (tok = left_ht_bucket(thisAgent, hv); tok != NIL; tok = tok->a.ht.next_in_bucket)
+                    if ((tok->node == left_mem) && (token_referent(tok) == rm->w->id))
+                    {
+                        collection_join_pair(thisAgent, node, tok, rm->w, w->id, w, &num_join_tests);
+                    }
+            }
+            else
+            {
+                for (tok = left_mem->a.np.tokens; tok != NIL; tok = tok->next_of_node)
+                {
+                    collection_join_pair(thisAgent, node, tok, rm->w, w->id, w, &num_join_tests);
+                }
+            }
+        }
+    }
+    else
+    {
+        /* --- otherwise start from the left tokens, checking the join
+           value (if it comes from above the pair) before going right --- */
+        for (tok = left_mem->a.np.tokens; tok != NIL; tok = tok->next_of_node)
+        {
+            referent = collection_pair_referent(mem, tok, NIL);
+            if (referent && (referent != w->id))
+            {
+                continue;
+            }
+            if (bnode_is_hashed(join->node_type))
+            {
+                left_referent = token_referent(tok);
+                hv = join_am->am_id ^ left_referent->hash_id;
+                for (rm = right_ht_bucket(thisAgent, hv); rm != NIL; rm = rm->next_in_bucket)
+                {
+                    if ((rm->am != join_am) || (rm->w->id != left_referent) ||
+                            (skip_w && (rm->w == w)))
+                    {
+                        continue;
+                    }
+                    collection_join_pair(thisAgent, node, tok, rm->w, referent, w, &num_join_tests);
+                }
+            }
+            else
+            {
+                for (rm = join_am->right_mems; rm != NIL; rm = rm->next_in_am)
+                {
+                    if (skip_w && (rm->w == w))
+                    {
+                        continue;
+                    }
+                    collection_join_pair(thisAgent, node, tok, rm->w, referent, w, &num_join_tests);
+                }
+            }
+        }
+    }
+    join_tests_performed(thisAgent, node, num_join_tests);
     activation_exit_sanity_check();
 }
 
@@ -5282,12 +6652,12 @@ void mp_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
     uint32_t hv;
     token* tok;
     Symbol* referent;
-    rete_test* rt;
     bool failed_a_test;
+    uint64_t num_join_tests = 0;
     rete_node* child;
 
     activation_entry_sanity_check();
-    right_node_activation(node, true);
+    right_node_activation(thisAgent, node, true);
 
     if (mp_bnode_is_left_unlinked(node))
     {
@@ -5310,19 +6680,12 @@ void mp_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
             continue;
         }
         /* --- does tok match w? --- */
-        if (tok->a.ht.referent != referent)
+        if (token_referent(tok) != referent)
         {
             continue;
         }
-        failed_a_test = false;
-        for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-        {
-            if (! match_left_and_right(thisAgent, rt, tok, w))
-            {
-                failed_a_test = true;
-                break;
-            }
-        }
+        num_join_tests++;
+        failed_a_test = ! match_join_tests(thisAgent, node, tok, w);
         if (failed_a_test)
         {
             continue;
@@ -5333,6 +6696,7 @@ void mp_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
             (*(left_addition_routines[child->node_type]))(thisAgent, child, tok, w);
         }
     }
+    join_tests_performed(thisAgent, node, num_join_tests);
     activation_exit_sanity_check();
 }
 
@@ -5340,12 +6704,12 @@ void unhashed_mp_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
 {
     uint32_t hv;
     token* tok;
-    rete_test* rt;
     bool failed_a_test;
+    uint64_t num_join_tests = 0;
     rete_node* child;
 
     activation_entry_sanity_check();
-    right_node_activation(node, true);
+    right_node_activation(thisAgent, node, true);
 
     if (mp_bnode_is_left_unlinked(node))
     {
@@ -5367,13 +6731,8 @@ void unhashed_mp_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
             continue;
         }
         /* --- does tok match w? --- */
-        failed_a_test = false;
-        for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-            if (! match_left_and_right(thisAgent, rt, tok, w))
-            {
-                failed_a_test = true;
-                break;
-            }
+        num_join_tests++;
+        failed_a_test = ! match_join_tests(thisAgent, node, tok, w);
         if (failed_a_test)
         {
             continue;
@@ -5384,6 +6743,7 @@ void unhashed_mp_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
             (*(left_addition_routines[child->node_type]))(thisAgent, child, tok, w);
         }
     }
+    join_tests_performed(thisAgent, node, num_join_tests);
     activation_exit_sanity_check();
 }
 
@@ -5400,13 +6760,14 @@ void negative_node_left_addition(agent* thisAgent, rete_node* node,
     Symbol* referent;
     right_mem* rm;
     alpha_mem* am;
-    rete_test* rt;
     bool failed_a_test;
+    Symbol* left_values[2];
+    uint64_t num_join_tests = 0;
     rete_node* child;
     token* New;
 
     activation_entry_sanity_check();
-    left_node_activation(node, true);
+    left_node_activation(thisAgent, node, true);
 
     if (node_is_right_unlinked(node))
     {
@@ -5435,16 +6796,17 @@ void negative_node_left_addition(agent* thisAgent, rete_node* node,
     hv = node->node_id ^ referent->hash_id;
 
     /* --- build new token, add it to the hash table --- */
-    token_added(node);
+    token_added(thisAgent, node);
     thisAgent->memoryManager->allocate_with_pool(MP_token, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
-    New->a.ht.referent = referent;
+    set_token_referent(New, referent);
     New->negrm_tokens = NIL;
 
     /* --- look through right memory for matches --- */
     am = node->b.posneg.alpha_mem_;
     right_hv = am->am_id ^ referent->hash_id;
+    prepare_join_tests(node, New, left_values);
     for (rm = right_ht_bucket(thisAgent, right_hv); rm != NIL; rm = rm->next_in_bucket)
     {
         if (rm->am != am)
@@ -5456,13 +6818,8 @@ void negative_node_left_addition(agent* thisAgent, rete_node* node,
         {
             continue;
         }
-        failed_a_test = false;
-        for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-            if (! match_left_and_right(thisAgent, rt, New, rm->w))
-            {
-                failed_a_test = true;
-                break;
-            }
+        num_join_tests++;
+        failed_a_test = ! match_prepared_join_tests(thisAgent, node, New, left_values, rm->w);
         if (failed_a_test)
         {
             continue;
@@ -5473,7 +6830,7 @@ void negative_node_left_addition(agent* thisAgent, rete_node* node,
             t->node = node;
             t->parent = NIL;
             t->w = rm->w;
-            t->a.neg.left_token = New;
+            token_left_token(t) = New;
             insert_at_head_of_dll(rm->w->tokens, t, next_from_wme, prev_from_wme);
             t->first_child = NIL;
             insert_at_head_of_dll(New->negrm_tokens, t,
@@ -5489,6 +6846,7 @@ void negative_node_left_addition(agent* thisAgent, rete_node* node,
             (*(left_addition_routines[child->node_type]))(thisAgent, child, New, NIL);
         }
     }
+    join_tests_performed(thisAgent, node, num_join_tests);
     activation_exit_sanity_check();
 }
 
@@ -5496,14 +6854,15 @@ void unhashed_negative_node_left_addition(agent* thisAgent, rete_node* node,
         token* tok, wme* w)
 {
     uint32_t hv;
-    rete_test* rt;
     bool failed_a_test;
+    Symbol* left_values[2];
+    uint64_t num_join_tests = 0;
     right_mem* rm;
     rete_node* child;
     token* New;
 
     activation_entry_sanity_check();
-    left_node_activation(node, true);
+    left_node_activation(thisAgent, node, true);
 
     if (node_is_right_unlinked(node))
     {
@@ -5513,24 +6872,20 @@ void unhashed_negative_node_left_addition(agent* thisAgent, rete_node* node,
     hv = node->node_id;
 
     /* --- build new token, add it to the hash table --- */
-    token_added(node);
+    token_added(thisAgent, node);
     thisAgent->memoryManager->allocate_with_pool(MP_token, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
-    New->a.ht.referent = NIL;
+    set_token_referent(New, NIL);
     New->negrm_tokens = NIL;
 
     /* --- look through right memory for matches --- */
+    prepare_join_tests(node, New, left_values);
     for (rm = node->b.posneg.alpha_mem_->right_mems; rm != NIL; rm = rm->next_in_am)
     {
         /* --- does rm->w match new? --- */
-        failed_a_test = false;
-        for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-            if (! match_left_and_right(thisAgent, rt, New, rm->w))
-            {
-                failed_a_test = true;
-                break;
-            }
+        num_join_tests++;
+        failed_a_test = ! match_prepared_join_tests(thisAgent, node, New, left_values, rm->w);
         if (failed_a_test)
         {
             continue;
@@ -5541,7 +6896,7 @@ void unhashed_negative_node_left_addition(agent* thisAgent, rete_node* node,
             t->node = node;
             t->parent = NIL;
             t->w = rm->w;
-            t->a.neg.left_token = New;
+            token_left_token(t) = New;
             insert_at_head_of_dll(rm->w->tokens, t, next_from_wme, prev_from_wme);
             t->first_child = NIL;
             insert_at_head_of_dll(New->negrm_tokens, t,
@@ -5557,6 +6912,7 @@ void unhashed_negative_node_left_addition(agent* thisAgent, rete_node* node,
             (*(left_addition_routines[child->node_type]))(thisAgent, child, New, NIL);
         }
     }
+    join_tests_performed(thisAgent, node, num_join_tests);
     activation_exit_sanity_check();
 }
 
@@ -5565,11 +6921,11 @@ void negative_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
     uint32_t hv;
     token* tok;
     Symbol* referent;
-    rete_test* rt;
     bool failed_a_test;
+    uint64_t num_join_tests = 0;
 
     activation_entry_sanity_check();
-    right_node_activation(node, true);
+    right_node_activation(thisAgent, node, true);
 
     referent = w->id;
     hv = node->node_id ^ referent->hash_id;
@@ -5581,17 +6937,12 @@ void negative_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
             continue;
         }
         /* --- does tok match w? --- */
-        if (tok->a.ht.referent != referent)
+        if (token_referent(tok) != referent)
         {
             continue;
         }
-        failed_a_test = false;
-        for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-            if (! match_left_and_right(thisAgent, rt, tok, w))
-            {
-                failed_a_test = true;
-                break;
-            }
+        num_join_tests++;
+        failed_a_test = ! match_join_tests(thisAgent, node, tok, w);
         if (failed_a_test)
         {
             continue;
@@ -5603,7 +6954,7 @@ void negative_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
             t->node = node;
             t->parent = NIL;
             t->w = w;
-            t->a.neg.left_token = tok;
+            token_left_token(t) = tok;
             insert_at_head_of_dll(w->tokens, t, next_from_wme, prev_from_wme);
             t->first_child = NIL;
             insert_at_head_of_dll(tok->negrm_tokens, t,
@@ -5614,6 +6965,7 @@ void negative_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
             remove_token_and_subtree(thisAgent, tok->first_child);
         }
     }
+    join_tests_performed(thisAgent, node, num_join_tests);
     activation_exit_sanity_check();
 }
 
@@ -5621,11 +6973,11 @@ void unhashed_negative_node_right_addition(agent* thisAgent, rete_node* node, wm
 {
     uint32_t hv;
     token* tok;
-    rete_test* rt;
     bool failed_a_test;
+    uint64_t num_join_tests = 0;
 
     activation_entry_sanity_check();
-    right_node_activation(node, true);
+    right_node_activation(thisAgent, node, true);
 
     hv = node->node_id;
 
@@ -5636,13 +6988,8 @@ void unhashed_negative_node_right_addition(agent* thisAgent, rete_node* node, wm
             continue;
         }
         /* --- does tok match w? --- */
-        failed_a_test = false;
-        for (rt = node->b.posneg.other_tests; rt != NIL; rt = rt->next)
-            if (! match_left_and_right(thisAgent, rt, tok, w))
-            {
-                failed_a_test = true;
-                break;
-            }
+        num_join_tests++;
+        failed_a_test = ! match_join_tests(thisAgent, node, tok, w);
         if (failed_a_test)
         {
             continue;
@@ -5654,7 +7001,7 @@ void unhashed_negative_node_right_addition(agent* thisAgent, rete_node* node, wm
             t->node = node;
             t->parent = NIL;
             t->w = w;
-            t->a.neg.left_token = tok;
+            token_left_token(t) = tok;
             insert_at_head_of_dll(w->tokens, t, next_from_wme, prev_from_wme);
             t->first_child = NIL;
             insert_at_head_of_dll(tok->negrm_tokens, t,
@@ -5665,6 +7012,7 @@ void unhashed_negative_node_right_addition(agent* thisAgent, rete_node* node, wm
             remove_token_and_subtree(thisAgent, tok->first_child);
         }
     }
+    join_tests_performed(thisAgent, node, num_join_tests);
     activation_exit_sanity_check();
 }
 
@@ -5684,7 +7032,7 @@ void cn_node_left_addition(agent* thisAgent, rete_node* node, token* tok, wme* w
     rete_node* child;
 
     activation_entry_sanity_check();
-    left_node_activation(node, true);
+    left_node_activation(thisAgent, node, true);
 
     hv = node->node_id ^ cast_and_possibly_truncate<uint32_t>(tok) ^ cast_and_possibly_truncate<uint32_t>(w);
 
@@ -5698,7 +7046,7 @@ void cn_node_left_addition(agent* thisAgent, rete_node* node, token* tok, wme* w
         }
 
     /* --- build left token, add it to the hash table --- */
-    token_added(node);
+    token_added(thisAgent, node);
     thisAgent->memoryManager->allocate_with_pool(MP_token, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
@@ -5721,12 +7069,12 @@ void cn_partner_node_left_addition(agent* thisAgent, rete_node* node,
     token* left, *negrm_tok;
 
     activation_entry_sanity_check();
-    left_node_activation(node, true);
+    left_node_activation(thisAgent, node, true);
 
     partner = node->b.cn.partner;
 
     /* --- build new negrm token --- */
-    token_added(node);
+    token_added(thisAgent, node);
     thisAgent->memoryManager->allocate_with_pool(MP_token, &negrm_tok);
     new_left_token(negrm_tok, node, tok, w);
 
@@ -5750,7 +7098,7 @@ void cn_partner_node_left_addition(agent* thisAgent, rete_node* node,
     /* --- if not found, create a new left token --- */
     if (!left)
     {
-        token_added(partner);
+        token_added(thisAgent, partner);
         thisAgent->memoryManager->allocate_with_pool(MP_token, &left);
         new_left_token(left, partner, tok, w);
         insert_token_into_left_ht(thisAgent, left, hv);
@@ -5758,7 +7106,7 @@ void cn_partner_node_left_addition(agent* thisAgent, rete_node* node,
     }
 
     /* --- add new negrm token to the left token --- */
-    negrm_tok->a.neg.left_token = left;
+    token_left_token(negrm_tok) = left;
     insert_at_head_of_dll(left->negrm_tokens, negrm_tok,
                           a.neg.next_negrm, a.neg.prev_negrm);
 
@@ -5818,10 +7166,10 @@ void p_node_left_addition(agent* thisAgent, rete_node* node, token* tok, wme* w)
     wme* lowest_goal_wme;
 
     activation_entry_sanity_check();
-    left_node_activation(node, true);
+    left_node_activation(thisAgent, node, true);
 
     /* --- build new left token (used only for tree-based remove) --- */
-    token_added(node);
+    token_added(thisAgent, node);
     thisAgent->memoryManager->allocate_with_pool(MP_token, &New);
     new_left_token(New, node, tok, w);
 
@@ -6385,9 +7733,17 @@ void p_node_left_removal(agent* thisAgent, rete_node* node, token* tok, wme* w)
 void remove_token_and_subtree(agent* thisAgent, token* root)
 {
     rete_node* node, *child, *next;
-    token* tok, *next_value_for_tok, *left, *t, *next_t;
+    token* tok, *next_value_for_tok, *left, *t, *next_t, *collection_tok;
     byte node_type;
 
+    /* --- a collection memory token loses its reason to exist when its
+       last child goes, so note it for cleanup below --- */
+    collection_tok = NIL;
+    if (root->parent && bnode_is_collection_mem(root->parent->node))
+    {
+        collection_tok = root->parent;
+    }
+
     tok = root;
 
     while (true)
@@ -6401,9 +7757,10 @@ void remove_token_and_subtree(agent* thisAgent, token* root)
 
         /* --- cleanup stuff common to all types of nodes --- */
         node = tok->node;
-        left_node_activation(node, false);
+        left_node_activation(thisAgent, node, false);
         fast_remove_from_dll(node->a.np.tokens, tok, token, next_of_node,
                              prev_of_node);
+        node->a.np.num_tokens--;
         fast_remove_from_dll(tok->parent->first_child, tok, token,
                              next_sibling, prev_sibling);
         if (tok->w) fast_remove_from_dll(tok->w->tokens, tok, token,
@@ -6413,9 +7770,7 @@ void remove_token_and_subtree(agent* thisAgent, token* root)
         /* --- for merged Mem/Pos nodes --- */
         if ((node_type == MP_BNODE) || (node_type == UNHASHED_MP_BNODE))
         {
-            remove_token_from_left_ht(thisAgent, tok, node->node_id ^
-                                      (tok->a.ht.referent ?
-                                       tok->a.ht.referent->hash_id : 0));
+            remove_token_from_left_ht(thisAgent, tok, left_ht_hash_value_of_token(tok));
             if (! mp_bnode_is_left_unlinked(node))
             {
                 if (! node->a.np.tokens)
@@ -6435,9 +7790,7 @@ void remove_token_and_subtree(agent* thisAgent, token* root)
         else if ((node_type == NEGATIVE_BNODE) ||
                  (node_type == UNHASHED_NEGATIVE_BNODE))
         {
-            remove_token_from_left_ht(thisAgent, tok, node->node_id ^
-                                      (tok->a.ht.referent ?
-                                       tok->a.ht.referent->hash_id : 0));
+            remove_token_from_left_ht(thisAgent, tok, left_ht_hash_value_of_token(tok));
             if (! node->a.np.tokens)
             {
                 unlink_from_right_mem(node);
@@ -6453,20 +7806,18 @@ void remove_token_and_subtree(agent* thisAgent, token* root)
         }
         else if ((node_type == MEMORY_BNODE) || (node_type == UNHASHED_MEMORY_BNODE))
         {
-            remove_token_from_left_ht(thisAgent, tok, node->node_id ^
-                                      (tok->a.ht.referent ?
-                                       tok->a.ht.referent->hash_id : 0));
+            remove_token_from_left_ht(thisAgent, tok, left_ht_hash_value_of_token(tok));
 #ifdef DO_ACTIVATION_STATS_ON_REMOVALS
             /* --- if doing statistics stuff, then activate each attached node --- */
             for (child = node->b.mem.first_linked_child; child != NIL; child = next)
             {
                 next = child->a.pos.next_from_beta_mem;
-                left_node_activation(child, false);
+                left_node_activation(thisAgent, child, false);
             }
 #endif
             /* --- for right unlinking, then if the beta memory just went to
                zero, right unlink any attached Pos nodes --- */
-            if (! node->a.np.tokens)
+            if ((! node->a.np.tokens) && ! node->a.np.is_collection)
             {
                 for (child = node->b.mem.first_linked_child; child != NIL; child = next)
                 {
@@ -6489,6 +7840,7 @@ void remove_token_and_subtree(agent* thisAgent, token* root)
                                                    next_from_wme, prev_from_wme);
                 fast_remove_from_dll(t->node->a.np.tokens, t, token,
                                      next_of_node, prev_of_node);
+                t->node->a.np.num_tokens--;
                 fast_remove_from_dll(t->parent->first_child, t, token,
                                      next_sibling, prev_sibling);
                 thisAgent->memoryManager->free_with_pool(MP_token, t);
@@ -6498,7 +7850,7 @@ void remove_token_and_subtree(agent* thisAgent, token* root)
         }
         else if (node_type == CN_PARTNER_BNODE)
         {
-            left = tok->a.neg.left_token;
+            left = token_left_token(tok);
             fast_remove_from_dll(left->negrm_tokens, tok, token,
                                  a.neg.next_negrm, a.neg.prev_negrm);
             if (! left->negrm_tokens)   /* just went to 0, so call children */
@@ -6528,6 +7880,11 @@ void remove_token_and_subtree(agent* thisAgent, token* root)
         }
         tok = next_value_for_tok; /* else go get the leftmost leaf again */
     }
+
+    if (collection_tok && ! collection_tok->first_child)
+    {
+        discard_collection_token(thisAgent, collection_tok);
+    }
 }
 
 
@@ -6608,14 +7965,156 @@ void remove_token_and_subtree(agent* thisAgent, token* root)
     4 bytes: number of children
     node records for each child
 
+  Version 4 is identical to version 3 except that every 4-byte count and
+  index is widened to 8 bytes.
+
+  File format (version 6, the "snapshot" format):
+    Version 6 uses the 8-byte records of version 4, but is laid out so that
+    the loader can map the whole file into memory and walk it in place:
+
+     magic number sequence and version byte, as above
+     8 bytes: length of the whole file
+     8 bytes: offset (from the start of the file) of the symbol table
+     8 bytes: offset of the alpha memory definitions
+     8 bytes: offset of the root node's child count
+
+    The offsets are patched in after the sections are written, so a
+    truncated or spliced file is rejected before anything is built, and the
+    loader positions itself at each section by offset rather than relying
+    on the previous section to end in the right place.  In the symbol table,
+    int_constants and float_constants are stored as their raw 8-byte values
+    (the float bit pattern) instead of ASCII, so they need no parsing and
+    floats round-trip exactly.
+    Memory node records end with 1 byte (0 or 1): flag -- is it a
+    collection memory, and p_node records end with 1 byte (0 or 1): flag --
+    is the production marked :collection.  The older versions have no room
+    for these, so a net with :collection productions can only be saved as
+    a snapshot.
+
+  Whatever the version, the loader maps (or, where mmap isn't available,
+  reads with a single fread) the whole file and reads from memory; strings
+  are interned straight out of the mapped image rather than being copied
+  through a buffer.  The saver collects the file in memory and writes it
+  with a single fwrite.
+
   EXTERNAL INTERFACE:
   Save_rete_net() and load_rete_net() save and load everything to and
-  from the given (already open) files.  They return true if successful,
-  false if any error occurred.
+  from the given (already open) files.  Copy_rete_net() loads another
+  agent's net through an in-memory image instead of a file.  They return
+  true if successful, false if any error occurred.
 ********************************************************************** */
 
-FILE* rete_fs_file;  /* File handle we're using -- "fs" for "fast-save" */
-bool rete_net_64; // used by reteload_eight_bytes, retesave_eight_bytes, BADBAD global, fix with rete_fs_file above
+/* --- the file being loaded is mapped (or read) into memory here --- */
+typedef struct rete_fs_image_struct
+{
+    uint8_t* start;           /* first byte of the file */
+    const uint8_t* next;      /* next byte to be read */
+    const uint8_t* end;       /* one past the last byte of the file */
+    size_t mapped_length;     /* nonzero if start came from mmap() */
+    bool overrun;             /* set if a read ran off the end of the file */
+} rete_fs_image;
+
+/* --- everything one save or load works on; each save_rete_net(),
+   load_rete_net() or copy_rete_net() call has its own, so agents on
+   different threads can save and load at the same time --- */
+typedef struct rete_fs_struct
+{
+    std::vector<uint8_t> buffer;  /* the file being saved, written out in one go */
+    rete_fs_image in;             /* the file being loaded */
+    ReteNetFormat format;         /* format of the file being saved or loaded */
+    bool net_64;                  /* counts and indices take 8 bytes, not 4 */
+
+    rete_fs_struct() : format(RETE_NET_SNAPSHOT), net_64(true)
+    {
+        in.start = NIL;
+        in.next = in.end = NIL;
+        in.mapped_length = 0;
+        in.overrun = false;
+    }
+} rete_fs;
+
+/* ----------------------------------------------------------------------
+                     Mapping and Writing the FS File
+
+   Reteload_map_file() makes the whole of an (already open) file
+   available at rfs->in, starting at the file's current position.
+   Where we can, the file is mmap'ed so loading is bounded by page-in
+   speed; otherwise it's read into memory with a single fread.
+   Reteload_unmap_file() releases it.
+
+   Retesave_write_file() writes the collected rfs->buffer to the
+   destination file and releases the buffer.
+---------------------------------------------------------------------- */
+
+bool reteload_map_file(agent* thisAgent, rete_fs* rfs, FILE* f)
+{
+    long here, length;
+
+    rfs->in.start = NIL;
+    rfs->in.mapped_length = 0;
+    rfs->in.overrun = false;
+
+    here = ftell(f);
+    if ((here < 0) || fseek(f, 0, SEEK_END))
+    {
+        return false;
+    }
+    length = ftell(f);
+    if ((length <= here) || fseek(f, here, SEEK_SET))
+    {
+        return false;
+    }
+
+#ifndef _WIN32
+    void* mapping = mmap(NULL, static_cast<size_t>(length), PROT_READ, MAP_PRIVATE, fileno(f), 0);
+    if (mapping != MAP_FAILED)
+    {
+        madvise(mapping, static_cast<size_t>(length), MADV_WILLNEED);
+        rfs->in.start = static_cast<uint8_t*>(mapping);
+        rfs->in.mapped_length = static_cast<size_t>(length);
+    }
+#endif
+    if (!rfs->in.start)
+    {
+        rfs->in.start = static_cast<uint8_t*>(thisAgent->memoryManager->allocate_memory(static_cast<size_t>(length), MISCELLANEOUS_MEM_USAGE));
+        if (fseek(f, 0, SEEK_SET) ||
+                (fread(rfs->in.start, 1, static_cast<size_t>(length), f) != static_cast<size_t>(length)))
+        {
+            thisAgent->memoryManager->free_memory(rfs->in.start, MISCELLANEOUS_MEM_USAGE);
+            rfs->in.start = NIL;
+            return false;
+        }
+    }
+    rfs->in.next = rfs->in.start + here;
+    rfs->in.end = rfs->in.start + length;
+    return true;
+}
+
+void reteload_unmap_file(agent* thisAgent, rete_fs* rfs)
+{
+#ifndef _WIN32
+    if (rfs->in.mapped_length)
+    {
+        munmap(rfs->in.start, rfs->in.mapped_length);
+    }
+    else
+#endif
+    {
+        thisAgent->memoryManager->free_memory(rfs->in.start, MISCELLANEOUS_MEM_USAGE);
+    }
+    rfs->in.start = NIL;
+    rfs->in.next = rfs->in.end = NIL;
+    rfs->in.mapped_length = 0;
+}
+
+bool retesave_write_file(rete_fs* rfs, FILE* f)
+{
+    bool ok;
+
+    ok = (fwrite(&rfs->buffer[0], 1, rfs->buffer.size(), f) == rfs->buffer.size());
+    std::vector<uint8_t>().swap(rfs->buffer);
+    return ok;
+}
 
 /* ----------------------------------------------------------------------
                 Save/Load Bytes, Short and Long Integers
@@ -6623,91 +8122,98 @@ bool rete_net_64; // used by reteload_eight_bytes, retesave_eight_bytes, BADBAD
    These are the lowest-level routines for accessing the FS file.  Note
    that all 16-bit or 32-bit words are written LSB first.  We do this
    carefully, so that fastsave files will be portable across machine
-   types (big-endian vs. little-endian).
+   types (big-endian vs. little-endian).  Reading past the end of the
+   file yields zeros and sets rfs->in.overrun, which
+   reteload_check_image() reports before anything is loaded.
 ---------------------------------------------------------------------- */
 
-void retesave_one_byte(uint8_t b, FILE* /*f*/)
+void retesave_one_byte(uint8_t b, rete_fs* rfs)
 {
-    fputc(b, rete_fs_file);
+    rfs->buffer.push_back(b);
 }
 
-uint8_t reteload_one_byte(FILE* f)
+uint8_t reteload_one_byte(rete_fs* rfs)
 {
-    return static_cast<uint8_t>(fgetc(f));
+    if (rfs->in.next < rfs->in.end)
+    {
+        return *(rfs->in.next++);
+    }
+    rfs->in.overrun = true;
+    return 0;
 }
 
-void retesave_two_bytes(uint16_t w, FILE* f)
+void retesave_two_bytes(uint16_t w, rete_fs* rfs)
 {
-    retesave_one_byte(static_cast<uint8_t>(w & 0xFF), f);
-    retesave_one_byte(static_cast<uint8_t>((w >> 8) & 0xFF), f);
+    retesave_one_byte(static_cast<uint8_t>(w & 0xFF), rfs);
+    retesave_one_byte(static_cast<uint8_t>((w >> 8) & 0xFF), rfs);
 }
 
-uint16_t reteload_two_bytes(FILE* f)
+uint16_t reteload_two_bytes(rete_fs* rfs)
 {
     uint16_t i;
-    i = reteload_one_byte(f);
-    i += (reteload_one_byte(f) << 8);
+    i = reteload_one_byte(rfs);
+    i += (reteload_one_byte(rfs) << 8);
     return i;
 }
 
-void retesave_four_bytes(uint32_t w, FILE* f)
+void retesave_four_bytes(uint32_t w, rete_fs* rfs)
 {
-    retesave_one_byte(static_cast<uint8_t>(w & 0xFF), f);
-    retesave_one_byte(static_cast<uint8_t>((w >> 8) & 0xFF), f);
-    retesave_one_byte(static_cast<uint8_t>((w >> 16) & 0xFF), f);
-    retesave_one_byte(static_cast<uint8_t>((w >> 24) & 0xFF), f);
+    retesave_one_byte(static_cast<uint8_t>(w & 0xFF), rfs);
+    retesave_one_byte(static_cast<uint8_t>((w >> 8) & 0xFF), rfs);
+    retesave_one_byte(static_cast<uint8_t>((w >> 16) & 0xFF), rfs);
+    retesave_one_byte(static_cast<uint8_t>((w >> 24) & 0xFF), rfs);
 }
 
-uint32_t reteload_four_bytes(FILE* f)
+uint32_t reteload_four_bytes(rete_fs* rfs)
 {
     uint32_t i;
-    i = reteload_one_byte(f);
-    i += (reteload_one_byte(f) << 8);
-    i += (reteload_one_byte(f) << 16);
-    i += (reteload_one_byte(f) << 24);
+    i = reteload_one_byte(rfs);
+    i += (reteload_one_byte(rfs) << 8);
+    i += (reteload_one_byte(rfs) << 16);
+    i += (reteload_one_byte(rfs) << 24);
     return i;
 }
 
-void retesave_eight_bytes(uint64_t w, FILE* f)
+void retesave_eight_bytes(uint64_t w, rete_fs* rfs)
 {
-    if (!rete_net_64)
+    if (!rfs->net_64)
     {
-        retesave_four_bytes(static_cast<uint32_t>(w), f);
+        retesave_four_bytes(static_cast<uint32_t>(w), rfs);
         return;
     }
-    retesave_one_byte(static_cast<uint8_t>(w & 0xFF), f);
-    retesave_one_byte(static_cast<uint8_t>((w >> 8) & 0xFF), f);
-    retesave_one_byte(static_cast<uint8_t>((w >> 16) & 0xFF), f);
-    retesave_one_byte(static_cast<uint8_t>((w >> 24) & 0xFF), f);
-    retesave_one_byte(static_cast<uint8_t>((w >> 32) & 0xFF), f);
-    retesave_one_byte(static_cast<uint8_t>((w >> 40) & 0xFF), f);
-    retesave_one_byte(static_cast<uint8_t>((w >> 48) & 0xFF), f);
-    retesave_one_byte(static_cast<uint8_t>((w >> 56) & 0xFF), f);
+    retesave_one_byte(static_cast<uint8_t>(w & 0xFF), rfs);
+    retesave_one_byte(static_cast<uint8_t>((w >> 8) & 0xFF), rfs);
+    retesave_one_byte(static_cast<uint8_t>((w >> 16) & 0xFF), rfs);
+    retesave_one_byte(static_cast<uint8_t>((w >> 24) & 0xFF), rfs);
+    retesave_one_byte(static_cast<uint8_t>((w >> 32) & 0xFF), rfs);
+    retesave_one_byte(static_cast<uint8_t>((w >> 40) & 0xFF), rfs);
+    retesave_one_byte(static_cast<uint8_t>((w >> 48) & 0xFF), rfs);
+    retesave_one_byte(static_cast<uint8_t>((w >> 56) & 0xFF), rfs);
 }
 
-uint64_t reteload_eight_bytes(FILE* f)
+uint64_t reteload_eight_bytes(rete_fs* rfs)
 {
-    if (!rete_net_64)
+    if (!rfs->net_64)
     {
-        return reteload_four_bytes(f);
+        return reteload_four_bytes(rfs);
     }
 
     uint64_t i;
     uint64_t tmp;
-    i = reteload_one_byte(f);
-    tmp = reteload_one_byte(f);
+    i = reteload_one_byte(rfs);
+    tmp = reteload_one_byte(rfs);
     i += (tmp << 8);
-    tmp = reteload_one_byte(f);
+    tmp = reteload_one_byte(rfs);
     i += (tmp << 16);
-    tmp = reteload_one_byte(f);
+    tmp = reteload_one_byte(rfs);
     i += (tmp << 24);
-    tmp = reteload_one_byte(f);
+    tmp = reteload_one_byte(rfs);
     i += (tmp << 32);
-    tmp = reteload_one_byte(f);
+    tmp = reteload_one_byte(rfs);
     i += (tmp << 40);
-    tmp = reteload_one_byte(f);
+    tmp = reteload_one_byte(rfs);
     i += (tmp << 48);
-    tmp = reteload_one_byte(f);
+    tmp = reteload_one_byte(rfs);
     i += (tmp << 56);
     return i;
 }
@@ -6716,32 +8222,36 @@ uint64_t reteload_eight_bytes(FILE* f)
                             Save/Load Strings
 
    Strings are written as null-terminated sequences of characters, just
-   like the usual C format.  Reteload_string() leaves the result in
-   reteload_string_buf[].
+   like the usual C format.  Reteload_string() returns a pointer to the
+   string where it sits in the mapped file, so it's only valid until
+   load_rete_net() releases the file.
 ---------------------------------------------------------------------- */
 
-char reteload_string_buf[4 * MAX_LEXEME_LENGTH];
-
-void retesave_string(const char* s, FILE* f)
+void retesave_string(const char* s, rete_fs* rfs)
 {
     while (*s)
     {
-        retesave_one_byte(*s, f);
+        retesave_one_byte(*s, rfs);
         s++;
     }
-    retesave_one_byte(0, f);
+    retesave_one_byte(0, rfs);
 }
 
-void reteload_string(FILE* f)
+const char* reteload_string(rete_fs* rfs)
 {
-    int i, ch;
-    i = 0;
-    do
+    const char* s;
+    const uint8_t* terminator;
+
+    s = reinterpret_cast<const char*>(rfs->in.next);
+    terminator = static_cast<const uint8_t*>(memchr(rfs->in.next, 0, rfs->in.end - rfs->in.next));
+    if (!terminator)
     {
-        ch = reteload_one_byte(f);
-        reteload_string_buf[i++] = static_cast<char>(ch);
+        rfs->in.overrun = true;
+        rfs->in.next = rfs->in.end;
+        return "";
     }
-    while (ch);
+    rfs->in.next = terminator + 1;
+    return s;
 }
 
 /* ----------------------------------------------------------------------
@@ -6764,6 +8274,10 @@ void reteload_string(FILE* f)
          values of all int_constants (each as a null-term. ASCII string)
          values of all float_constants (each as a null-term. ASCII string)
 
+   In the snapshot format (version 5), int_constants and float_constants
+   are instead written as 8 bytes each: the integer value, or the bit
+   pattern of the double.  Retesave_symbol() writes one symbol's record.
+
    To reload symbols, we read the records and make new symbols, and
    also create an array (reteload_symbol_table) that maps from the
    index numbers to the Symbol structures.  Reteload_all_symbols() does
@@ -6772,23 +8286,45 @@ void reteload_string(FILE* f)
    Reteload_free_symbol_table() frees up the symbol table when we're done.
 ---------------------------------------------------------------------- */
 
-void retesave_symbol_table(agent* thisAgent, FILE* f)
+void retesave_symbol(Symbol* sym, rete_fs* rfs)
+{
+    uint64_t bits;
+
+    if (rfs->format == RETE_NET_SNAPSHOT)
+    {
+        if (sym->is_int())
+        {
+            retesave_eight_bytes(static_cast<uint64_t>(sym->ic->value), rfs);
+            return;
+        }
+        if (sym->is_float())
+        {
+            memcpy(&bits, &sym->fc->value, sizeof(bits));
+            retesave_eight_bytes(bits, rfs);
+            return;
+        }
+    }
+    retesave_string(sym->to_string(), rfs);
+}
+
+void retesave_symbol_table(agent* thisAgent, rete_fs* rfs)
 {
     thisAgent->current_retesave_symindex = 0;
-    thisAgent->symbolManager->retesave(f);
+    thisAgent->symbolManager->retesave(rfs);
 }
 
-void reteload_all_symbols(agent* thisAgent, FILE* f)
+void reteload_all_symbols(agent* thisAgent, rete_fs* rfs)
 {
     uint64_t num_str_constants, num_variables;
     uint64_t num_int_constants, num_float_constants;
     Symbol** current_place_in_symtab;
-    uint64_t i;
+    uint64_t i, bits;
+    double float_value;
 
-    num_str_constants = reteload_eight_bytes(f);
-    num_variables = reteload_eight_bytes(f);
-    num_int_constants = reteload_eight_bytes(f);
-    num_float_constants = reteload_eight_bytes(f);
+    num_str_constants = reteload_eight_bytes(rfs);
+    num_variables = reteload_eight_bytes(rfs);
+    num_int_constants = reteload_eight_bytes(rfs);
+    num_float_constants = reteload_eight_bytes(rfs);
 
     thisAgent->reteload_num_syms = num_str_constants + num_variables + num_int_constants
                                    + num_float_constants;
@@ -6801,33 +8337,46 @@ void reteload_all_symbols(agent* thisAgent, FILE* f)
     current_place_in_symtab = thisAgent->reteload_symbol_table;
     for (i = 0; i < num_str_constants; i++)
     {
-        reteload_string(f);
-        *(current_place_in_symtab++) = thisAgent->symbolManager->make_str_constant(reteload_string_buf);
+        *(current_place_in_symtab++) = thisAgent->symbolManager->make_str_constant(reteload_string(rfs));
     }
     for (i = 0; i < num_variables; i++)
     {
-        reteload_string(f);
-        *(current_place_in_symtab++) = thisAgent->symbolManager->make_variable(reteload_string_buf);
+        *(current_place_in_symtab++) = thisAgent->symbolManager->make_variable(reteload_string(rfs));
     }
     for (i = 0; i < num_int_constants; i++)
     {
-        reteload_string(f);
-        *(current_place_in_symtab++) =
-            thisAgent->symbolManager->make_int_constant(strtol(reteload_string_buf, NULL, 10));
+        if (rfs->format == RETE_NET_SNAPSHOT)
+        {
+            *(current_place_in_symtab++) =
+                thisAgent->symbolManager->make_int_constant(static_cast<int64_t>(reteload_eight_bytes(rfs)));
+        }
+        else
+        {
+            *(current_place_in_symtab++) =
+                thisAgent->symbolManager->make_int_constant(strtol(reteload_string(rfs), NULL, 10));
+        }
     }
     for (i = 0; i < num_float_constants; i++)
     {
-        reteload_string(f);
-        *(current_place_in_symtab++) =
-            thisAgent->symbolManager->make_float_constant(strtod(reteload_string_buf, NULL));
+        if (rfs->format == RETE_NET_SNAPSHOT)
+        {
+            bits = reteload_eight_bytes(rfs);
+            memcpy(&float_value, &bits, sizeof(float_value));
+            *(current_place_in_symtab++) = thisAgent->symbolManager->make_float_constant(float_value);
+        }
+        else
+        {
+            *(current_place_in_symtab++) =
+                thisAgent->symbolManager->make_float_constant(strtod(reteload_string(rfs), NULL));
+        }
     }
 }
 
-Symbol* reteload_symbol_from_index(agent* thisAgent, FILE* f)
+Symbol* reteload_symbol_from_index(agent* thisAgent, rete_fs* rfs)
 {
     uint64_t index;
 
-    index = reteload_eight_bytes(f);
+    index = reteload_eight_bytes(rfs);
     if (index == 0)
     {
         return NIL;
@@ -6879,61 +8428,55 @@ void reteload_free_symbol_table(agent* thisAgent)
    Reteload_free_am_table() frees up the table when we're done.
 ---------------------------------------------------------------------- */
 
-bool retesave_alpha_mem_and_assign_index(agent* thisAgent, void* item, void* userdata)
+void retesave_alpha_mem_and_assign_index(agent* thisAgent, alpha_mem* am, rete_fs* rfs)
 {
-    alpha_mem* am;
-    FILE* f = reinterpret_cast<FILE*>(userdata);
-
-    am = static_cast<alpha_mem_struct*>(item);
     thisAgent->current_retesave_amindex++;
     am->retesave_amindex = thisAgent->current_retesave_amindex;
-    retesave_eight_bytes(am->id ? am->id->retesave_symindex : 0, f);
-    retesave_eight_bytes(am->attr ? am->attr->retesave_symindex : 0, f);
-    retesave_eight_bytes(am->value ? am->value->retesave_symindex : 0, f);
-    retesave_one_byte(static_cast<byte>(am->acceptable ? 1 : 0), f);
-    return false;
+    retesave_eight_bytes(am->id ? am->id->retesave_symindex : 0, rfs);
+    retesave_eight_bytes(am->attr ? am->attr->retesave_symindex : 0, rfs);
+    retesave_eight_bytes(am->value ? am->value->retesave_symindex : 0, rfs);
+    retesave_one_byte(static_cast<byte>(am->acceptable ? 1 : 0), rfs);
 }
 
-void retesave_alpha_memories(agent* thisAgent, FILE* f)
+void retesave_alpha_memories(agent* thisAgent, rete_fs* rfs)
 {
-    uint64_t i, num_ams;
+    alpha_index* index;
+    uint32_t i;
 
+    index = thisAgent->alpha_mem_index;
     thisAgent->current_retesave_amindex = 0;
-    num_ams = 0;
-    for (i = 0; i < 16; i++)
-    {
-        num_ams += thisAgent->alpha_hash_tables[i]->count;
-    }
-    retesave_eight_bytes(num_ams, f);
-    for (i = 0; i < 16; i++)
-        do_for_all_items_in_hash_table(thisAgent, thisAgent->alpha_hash_tables[i],
-                                       retesave_alpha_mem_and_assign_index, f);
+    retesave_eight_bytes(index->count, rfs);
+    for (i = 0; i < index->size; i++)
+        if (index->slots[i].am)
+        {
+            retesave_alpha_mem_and_assign_index(thisAgent, index->slots[i].am, rfs);
+        }
 }
 
-void reteload_alpha_memories(agent* thisAgent, FILE* f)
+void reteload_alpha_memories(agent* thisAgent, rete_fs* rfs)
 {
     uint64_t i;
     Symbol* id, *attr, *value;
     bool acceptable;
 
-    thisAgent->reteload_num_ams = reteload_eight_bytes(f);
+    thisAgent->reteload_num_ams = reteload_eight_bytes(rfs);
     thisAgent->reteload_am_table = (alpha_mem**)
                                    thisAgent->memoryManager->allocate_memory(thisAgent->reteload_num_ams * sizeof(char*), MISCELLANEOUS_MEM_USAGE);
     for (i = 0; i < thisAgent->reteload_num_ams; i++)
     {
-        id = reteload_symbol_from_index(thisAgent, f);
-        attr = reteload_symbol_from_index(thisAgent, f);
-        value = reteload_symbol_from_index(thisAgent, f);
-        acceptable = reteload_one_byte(f) ? true : false;
+        id = reteload_symbol_from_index(thisAgent, rfs);
+        attr = reteload_symbol_from_index(thisAgent, rfs);
+        value = reteload_symbol_from_index(thisAgent, rfs);
+        acceptable = reteload_one_byte(rfs) ? true : false;
         *(thisAgent->reteload_am_table + i) = find_or_make_alpha_mem(thisAgent, id, attr, value, acceptable);
     }
 }
 
-alpha_mem* reteload_am_from_index(agent* thisAgent, FILE* f)
+alpha_mem* reteload_am_from_index(agent* thisAgent, rete_fs* rfs)
 {
     uint64_t amindex;
 
-    amindex = reteload_eight_bytes(f) - 1;
+    amindex = reteload_eight_bytes(rfs) - 1;
     if (amindex >= thisAgent->reteload_num_ams)
     {
         char msg[BUFFER_MSG_SIZE];
@@ -6971,7 +8514,7 @@ void reteload_free_am_table(agent* thisAgent)
     if list: 4 bytes (number of items) + list of symindices
 ---------------------------------------------------------------------- */
 
-void retesave_varnames(varnames* names, FILE* f)
+void retesave_varnames(varnames* names, rete_fs* rfs)
 {
     cons* c;
     uint64_t i;
@@ -6979,50 +8522,50 @@ void retesave_varnames(varnames* names, FILE* f)
 
     if (! names)
     {
-        retesave_one_byte(0, f);
+        retesave_one_byte(0, rfs);
     }
     else if (varnames_is_one_var(names))
     {
-        retesave_one_byte(1, f);
+        retesave_one_byte(1, rfs);
         sym = varnames_to_one_var(names);
-        retesave_eight_bytes(sym->retesave_symindex, f);
+        retesave_eight_bytes(sym->retesave_symindex, rfs);
     }
     else
     {
-        retesave_one_byte(2, f);
+        retesave_one_byte(2, rfs);
         for (i = 0, c = varnames_to_var_list(names); c != NIL; i++, c = c->rest);
-        retesave_eight_bytes(i, f);
+        retesave_eight_bytes(i, rfs);
         for (c = varnames_to_var_list(names); c != NIL; c = c->rest)
         {
-            retesave_eight_bytes(static_cast<Symbol*>(c->first)->retesave_symindex, f);
+            retesave_eight_bytes(static_cast<Symbol*>(c->first)->retesave_symindex, rfs);
         }
     }
 }
 
-varnames* reteload_varnames(agent* thisAgent, FILE* f)
+varnames* reteload_varnames(agent* thisAgent, rete_fs* rfs)
 {
     cons* c;
     uint64_t i, count;
     Symbol* sym;
 
-    i = reteload_one_byte(f);
+    i = reteload_one_byte(rfs);
     if (i == 0)
     {
         return NIL;
     }
     if (i == 1)
     {
-        sym = reteload_symbol_from_index(thisAgent, f);
+        sym = reteload_symbol_from_index(thisAgent, rfs);
         thisAgent->symbolManager->symbol_add_ref(sym);
         return one_var_to_varnames(sym);
     }
     else
     {
-        count = reteload_eight_bytes(f);
+        count = reteload_eight_bytes(rfs);
         c = NIL;
         while (count--)
         {
-            sym = reteload_symbol_from_index(thisAgent, f);
+            sym = reteload_symbol_from_index(thisAgent, rfs);
             thisAgent->symbolManager->symbol_add_ref(sym);
             push(thisAgent, sym, c);
         }
@@ -7031,7 +8574,7 @@ varnames* reteload_varnames(agent* thisAgent, FILE* f)
     }
 }
 
-void retesave_node_varnames(node_varnames* nvn, rete_node* node, FILE* f)
+void retesave_node_varnames(node_varnames* nvn, rete_node* node, rete_fs* rfs)
 {
     while (true)
     {
@@ -7045,15 +8588,15 @@ void retesave_node_varnames(node_varnames* nvn, rete_node* node, FILE* f)
             nvn = nvn->data.bottom_of_subconditions;
             continue;
         }
-        retesave_varnames(nvn->data.fields.id_varnames, f);
-        retesave_varnames(nvn->data.fields.attr_varnames, f);
-        retesave_varnames(nvn->data.fields.value_varnames, f);
+        retesave_varnames(nvn->data.fields.id_varnames, rfs);
+        retesave_varnames(nvn->data.fields.attr_varnames, rfs);
+        retesave_varnames(nvn->data.fields.value_varnames, rfs);
         nvn = nvn->parent;
         node = real_parent_node(node);
     }
 }
 
-node_varnames* reteload_node_varnames(agent* thisAgent, rete_node* node, FILE* f)
+node_varnames* reteload_node_varnames(agent* thisAgent, rete_node* node, rete_fs* rfs)
 {
     node_varnames* nvn, *nvn_for_ncc;
     rete_node* temp;
@@ -7066,7 +8609,7 @@ node_varnames* reteload_node_varnames(agent* thisAgent, rete_node* node, FILE* f
     if (node->node_type == CN_BNODE)
     {
         temp = node->b.cn.partner->parent;
-        nvn_for_ncc = reteload_node_varnames(thisAgent, temp, f);
+        nvn_for_ncc = reteload_node_varnames(thisAgent, temp, rfs);
         nvn->data.bottom_of_subconditions = nvn_for_ncc;
         while (temp != node->parent)
         {
@@ -7077,10 +8620,10 @@ node_varnames* reteload_node_varnames(agent* thisAgent, rete_node* node, FILE* f
     }
     else
     {
-        nvn->data.fields.id_varnames = reteload_varnames(thisAgent, f);
-        nvn->data.fields.attr_varnames = reteload_varnames(thisAgent, f);
-        nvn->data.fields.value_varnames = reteload_varnames(thisAgent, f);
-        nvn->parent = reteload_node_varnames(thisAgent, real_parent_node(node), f);
+        nvn->data.fields.id_varnames = reteload_varnames(thisAgent, rfs);
+        nvn->data.fields.attr_varnames = reteload_varnames(thisAgent, rfs);
+        nvn->data.fields.value_varnames = reteload_varnames(thisAgent, rfs);
+        nvn->parent = reteload_node_varnames(thisAgent, real_parent_node(node), rfs);
     }
     return nvn;
 }
@@ -7097,7 +8640,7 @@ node_varnames* reteload_node_varnames(agent* thisAgent, rete_node* node, FILE* f
     for rhs_unbound_vars: 4 bytes (symindex)
 ---------------------------------------------------------------------- */
 
-void retesave_rhs_value(rhs_value rv, FILE* f)
+void retesave_rhs_value(rhs_value rv, rete_fs* rfs)
 {
     uint64_t i;
     Symbol* sym;
@@ -7105,38 +8648,38 @@ void retesave_rhs_value(rhs_value rv, FILE* f)
 
     if (rhs_value_is_symbol(rv))
     {
-        retesave_one_byte(0, f);
+        retesave_one_byte(0, rfs);
         sym = rhs_value_to_symbol(rv);
-        retesave_eight_bytes(sym->retesave_symindex, f);
+        retesave_eight_bytes(sym->retesave_symindex, rfs);
     }
     else if (rhs_value_is_funcall(rv))
     {
-        retesave_one_byte(1, f);
+        retesave_one_byte(1, rfs);
         c = rhs_value_to_funcall_list(rv);
         sym = static_cast<rhs_function*>(c->first)->name;
-        retesave_eight_bytes(sym->retesave_symindex, f);
+        retesave_eight_bytes(sym->retesave_symindex, rfs);
         c = c->rest;
         for (i = 0; c != NIL; i++, c = c->rest);
-        retesave_eight_bytes(i, f);
+        retesave_eight_bytes(i, rfs);
         for (c = rhs_value_to_funcall_list(rv)->rest; c != NIL; c = c->rest)
         {
-            retesave_rhs_value(static_cast<rhs_value>(c->first), f);
+            retesave_rhs_value(static_cast<rhs_value>(c->first), rfs);
         }
     }
     else if (rhs_value_is_reteloc(rv))
     {
-        retesave_one_byte(2, f);
-        retesave_one_byte(rhs_value_to_reteloc_field_num(rv), f);
-        retesave_two_bytes(rhs_value_to_reteloc_levels_up(rv), f);
+        retesave_one_byte(2, rfs);
+        retesave_one_byte(rhs_value_to_reteloc_field_num(rv), rfs);
+        retesave_two_bytes(rhs_value_to_reteloc_levels_up(rv), rfs);
     }
     else
     {
-        retesave_one_byte(3, f);
-        retesave_eight_bytes(rhs_value_to_unboundvar(rv), f);
+        retesave_one_byte(3, rfs);
+        retesave_eight_bytes(rhs_value_to_unboundvar(rv), rfs);
     }
 }
 
-rhs_value reteload_rhs_value(agent* thisAgent, FILE* f)
+rhs_value reteload_rhs_value(agent* thisAgent, rete_fs* rfs)
 {
     rhs_value rv, temp;
     uint64_t i, count;
@@ -7146,16 +8689,16 @@ rhs_value reteload_rhs_value(agent* thisAgent, FILE* f)
     cons* funcall_list;
     rhs_function* rf;
 
-    type = reteload_one_byte(f);
+    type = reteload_one_byte(rfs);
     switch (type)
     {
         case 0:
-            sym = reteload_symbol_from_index(thisAgent, f);
+            sym = reteload_symbol_from_index(thisAgent, rfs);
             rv = allocate_rhs_value_for_symbol(thisAgent, sym, 0, 0);
             break;
         case 1:
             funcall_list = NIL;
-            sym = reteload_symbol_from_index(thisAgent, f);
+            sym = reteload_symbol_from_index(thisAgent, rfs);
 
             /* I traced through production parsing and the RHS function name is not kept around there. Instead, it "finds" the symbol
              * (as opposed to "make", which adds a ref) and uses that to hash to the existing RHS function structure (which keeps a
@@ -7179,22 +8722,22 @@ rhs_value reteload_rhs_value(agent* thisAgent, FILE* f)
                 abort_with_fatal_error(thisAgent, msg);
             }
             push(thisAgent, rf, funcall_list);
-            count = reteload_eight_bytes(f);
+            count = reteload_eight_bytes(rfs);
             while (count--)
             {
-                temp = reteload_rhs_value(thisAgent, f);
+                temp = reteload_rhs_value(thisAgent, rfs);
                 push(thisAgent, temp, funcall_list);
             }
             funcall_list = destructively_reverse_list(funcall_list);
             rv = funcall_list_to_rhs_value(funcall_list);
             break;
         case 2:
-            field_num = reteload_one_byte(f);
-            levels_up = reteload_two_bytes(f);
+            field_num = reteload_one_byte(rfs);
+            levels_up = reteload_two_bytes(rfs);
             rv = reteloc_to_rhs_value(field_num, static_cast<rete_node_level>(levels_up));
             break;
         case 3:
-            i = reteload_eight_bytes(f);
+            i = reteload_eight_bytes(rfs);
             update_max_rhs_unbound_variables(thisAgent, i + 1);
             rv = unboundvar_to_rhs_value(i);
             break;
@@ -7226,47 +8769,47 @@ rhs_value reteload_rhs_value(agent* thisAgent, FILE* f)
     record for each one (as above)
 ---------------------------------------------------------------------- */
 
-void retesave_rhs_action(action* a, FILE* f)
+void retesave_rhs_action(action* a, rete_fs* rfs)
 {
-    retesave_one_byte(a->type, f);
-    retesave_one_byte(a->preference_type, f);
-    retesave_one_byte(a->support, f);
+    retesave_one_byte(a->type, rfs);
+    retesave_one_byte(a->preference_type, rfs);
+    retesave_one_byte(a->support, rfs);
     if (a->type == FUNCALL_ACTION)
     {
-        retesave_rhs_value(a->value, f);
+        retesave_rhs_value(a->value, rfs);
     }
     else     /* MAKE_ACTION's */
     {
-        retesave_rhs_value(a->id, f);
-        retesave_rhs_value(a->attr, f);
-        retesave_rhs_value(a->value, f);
+        retesave_rhs_value(a->id, rfs);
+        retesave_rhs_value(a->attr, rfs);
+        retesave_rhs_value(a->value, rfs);
         if (preference_is_binary(a->preference_type))
         {
-            retesave_rhs_value(a->referent, f);
+            retesave_rhs_value(a->referent, rfs);
         }
     }
 }
 
-action* reteload_rhs_action(agent* thisAgent, FILE* f)
+action* reteload_rhs_action(agent* thisAgent, rete_fs* rfs)
 {
     action* a;
 
     a = make_action(thisAgent);
-    a->type = static_cast<ActionType>(reteload_one_byte(f));
-    a->preference_type = static_cast<PreferenceType>(reteload_one_byte(f));
-    a->support = static_cast<SupportType>(reteload_one_byte(f));
+    a->type = static_cast<ActionType>(reteload_one_byte(rfs));
+    a->preference_type = static_cast<PreferenceType>(reteload_one_byte(rfs));
+    a->support = static_cast<SupportType>(reteload_one_byte(rfs));
     if (a->type == FUNCALL_ACTION)
     {
-        a->value = reteload_rhs_value(thisAgent, f);
+        a->value = reteload_rhs_value(thisAgent, rfs);
     }
     else     /* MAKE_ACTION's */
     {
-        a->id = reteload_rhs_value(thisAgent, f);
-        a->attr = reteload_rhs_value(thisAgent, f);
-        a->value = reteload_rhs_value(thisAgent, f);
+        a->id = reteload_rhs_value(thisAgent, rfs);
+        a->attr = reteload_rhs_value(thisAgent, rfs);
+        a->value = reteload_rhs_value(thisAgent, rfs);
         if (preference_is_binary(a->preference_type))
         {
-            a->referent = reteload_rhs_value(thisAgent, f);
+            a->referent = reteload_rhs_value(thisAgent, rfs);
         }
         else
         {
@@ -7276,30 +8819,30 @@ action* reteload_rhs_action(agent* thisAgent, FILE* f)
     return a;
 }
 
-void retesave_action_list(action* first_a, FILE* f)
+void retesave_action_list(action* first_a, rete_fs* rfs)
 {
     uint64_t i;
     action* a;
 
     for (i = 0, a = first_a; a != NIL; i++, a = a->next);
-    retesave_eight_bytes(i, f);
+    retesave_eight_bytes(i, rfs);
     for (a = first_a; a != NIL; a = a->next)
     {
-        retesave_rhs_action(a, f);
+        retesave_rhs_action(a, rfs);
     }
 }
 
-action* reteload_action_list(agent* thisAgent, FILE* f)
+action* reteload_action_list(agent* thisAgent, rete_fs* rfs)
 {
     action* a, *prev_a, *first_a;
     uint64_t count;
 
-    count = reteload_eight_bytes(f);
+    count = reteload_eight_bytes(rfs);
     prev_a = NIL;
     first_a = NIL;  /* unneeded, but without it gcc -Wall warns here */
     while (count--)
     {
-        a = reteload_rhs_action(thisAgent, f);
+        a = reteload_rhs_action(thisAgent, rfs);
         if (prev_a)
         {
             prev_a->next = a;
@@ -7337,34 +8880,34 @@ action* reteload_action_list(agent* thisAgent, FILE* f)
     Rete test records (as above) for each one
 ---------------------------------------------------------------------- */
 
-void retesave_rete_test(rete_test* rt, FILE* f)
+void retesave_rete_test(rete_test* rt, rete_fs* rfs)
 {
     int i;
     cons* c;
 
-    retesave_one_byte(rt->type, f);
-    retesave_one_byte(rt->right_field_num, f);
+    retesave_one_byte(rt->type, rfs);
+    retesave_one_byte(rt->right_field_num, rfs);
     if (test_is_constant_relational_test(rt->type))
     {
-        retesave_eight_bytes(rt->data.constant_referent->retesave_symindex, f);
+        retesave_eight_bytes(rt->data.constant_referent->retesave_symindex, rfs);
     }
     else if (test_is_variable_relational_test(rt->type))
     {
-        retesave_one_byte(rt->data.variable_referent.field_num, f);
-        retesave_two_bytes(rt->data.variable_referent.levels_up, f);
+        retesave_one_byte(rt->data.variable_referent.field_num, rfs);
+        retesave_two_bytes(rt->data.variable_referent.levels_up, rfs);
     }
     else if (rt->type == DISJUNCTION_RETE_TEST)
     {
         for (i = 0, c = rt->data.disjunction_list; c != NIL; i++, c = c->rest);
-        retesave_two_bytes(static_cast<uint16_t>(i), f);
+        retesave_two_bytes(static_cast<uint16_t>(i), rfs);
         for (c = rt->data.disjunction_list; c != NIL; c = c->rest)
         {
-            retesave_eight_bytes(static_cast<Symbol*>(c->first)->retesave_symindex, f);
+            retesave_eight_bytes(static_cast<Symbol*>(c->first)->retesave_symindex, rfs);
         }
     }
 }
 
-rete_test* reteload_rete_test(agent* thisAgent, FILE* f)
+rete_test* reteload_rete_test(agent* thisAgent, rete_fs* rfs)
 {
     rete_test* rt;
     Symbol* sym;
@@ -7372,27 +8915,27 @@ rete_test* reteload_rete_test(agent* thisAgent, FILE* f)
     cons* temp;
 
     thisAgent->memoryManager->allocate_with_pool(MP_rete_test, &rt);
-    rt->type = reteload_one_byte(f);
-    rt->right_field_num = reteload_one_byte(f);
+    rt->type = reteload_one_byte(rfs);
+    rt->right_field_num = reteload_one_byte(rfs);
 
     if (test_is_constant_relational_test(rt->type))
     {
-        rt->data.constant_referent = reteload_symbol_from_index(thisAgent, f);
+        rt->data.constant_referent = reteload_symbol_from_index(thisAgent, rfs);
         thisAgent->symbolManager->symbol_add_ref(rt->data.constant_referent);
     }
     else if (test_is_variable_relational_test(rt->type))
     {
-        rt->data.variable_referent.field_num = reteload_one_byte(f);
-        rt->data.variable_referent.levels_up = static_cast<rete_node_level>(reteload_two_bytes(f));
+        rt->data.variable_referent.field_num = reteload_one_byte(rfs);
+        rt->data.variable_referent.levels_up = static_cast<rete_node_level>(reteload_two_bytes(rfs));
 
     }
     else if (rt->type == DISJUNCTION_RETE_TEST)
     {
-        count = reteload_two_bytes(f);
+        count = reteload_two_bytes(rfs);
         temp = NIL;
         while (count--)
         {
-            sym = reteload_symbol_from_index(thisAgent, f);
+            sym = reteload_symbol_from_index(thisAgent, rfs);
             thisAgent->symbolManager->symbol_add_ref(sym);
             push(thisAgent, sym, temp);
         }
@@ -7401,30 +8944,30 @@ rete_test* reteload_rete_test(agent* thisAgent, FILE* f)
     return rt;
 }
 
-void retesave_rete_test_list(rete_test* first_rt, FILE* f)
+void retesave_rete_test_list(rete_test* first_rt, rete_fs* rfs)
 {
     uint64_t i;
     rete_test* rt;
 
     for (i = 0, rt = first_rt; rt != NIL; i++, rt = rt->next);
-    retesave_two_bytes(static_cast<uint16_t>(i), f);
+    retesave_two_bytes(static_cast<uint16_t>(i), rfs);
     for (rt = first_rt; rt != NIL; rt = rt->next)
     {
-        retesave_rete_test(rt, f);
+        retesave_rete_test(rt, rfs);
     }
 }
 
-rete_test* reteload_rete_test_list(agent* thisAgent, FILE* f)
+rete_test* reteload_rete_test_list(agent* thisAgent, rete_fs* rfs)
 {
     rete_test* rt, *prev_rt, *first;
     uint64_t count;
 
     prev_rt = NIL;
     first = NIL;  /* unneeded, but without it gcc -Wall warns here */
-    count = reteload_two_bytes(f);
+    count = reteload_two_bytes(rfs);
     while (count--)
     {
-        rt = reteload_rete_test(thisAgent, f);
+        rt = reteload_rete_test(thisAgent, rfs);
         if (prev_rt)
         {
             prev_rt->next = rt;
@@ -7493,9 +9036,9 @@ rete_test* reteload_rete_test_list(agent* thisAgent, FILE* f)
    all its descendents, and reconstructs the Rete network structures.
 ---------------------------------------------------------------------- */
 
-void retesave_rete_node_and_children(agent* thisAgent, rete_node* node, FILE* f);
+void retesave_rete_node_and_children(agent* thisAgent, rete_node* node, rete_fs* rfs);
 
-void retesave_children_of_node(agent* thisAgent, rete_node* node, FILE* f)
+void retesave_children_of_node(agent* thisAgent, rete_node* node, rete_fs* rfs)
 {
     rete_node* child;
     std::stack<rete_node*> nodeStack;
@@ -7508,17 +9051,17 @@ void retesave_children_of_node(agent* thisAgent, rete_node* node, FILE* f)
             nodeStack.push(child);
         }
     }
-    retesave_eight_bytes(nodeStack.size(), f);
+    retesave_eight_bytes(nodeStack.size(), rfs);
 
     /* --- Write out records for all the node's children except CN's. --- */
     while (!nodeStack.empty())
     {
-        retesave_rete_node_and_children(thisAgent, nodeStack.top(), f);
+        retesave_rete_node_and_children(thisAgent, nodeStack.top(), rfs);
         nodeStack.pop();
     }
 }
 
-void retesave_rete_node_and_children(agent* thisAgent, rete_node* node, FILE* f)
+void retesave_rete_node_and_children(agent* thisAgent, rete_node* node, rete_fs* rfs)
 {
     uint64_t i;
     production* prod;
@@ -7530,41 +9073,45 @@ void retesave_rete_node_and_children(agent* thisAgent, rete_node* node, FILE* f)
         return;    /* ignore CN nodes */
     }
 
-    retesave_one_byte(node->node_type, f);
+    retesave_one_byte(node->node_type, rfs);
 
     switch (node->node_type)
     {
         case MEMORY_BNODE:
-            retesave_one_byte(node->left_hash_loc_field_num, f);
-            retesave_two_bytes(node->left_hash_loc_levels_up, f);
+            retesave_one_byte(node->left_hash_loc_field_num, rfs);
+            retesave_two_bytes(node->left_hash_loc_levels_up, rfs);
         /* ... and fall through to the next case below ... */
         case UNHASHED_MEMORY_BNODE:
+            if (rfs->format == RETE_NET_SNAPSHOT)
+            {
+                retesave_one_byte(static_cast<byte>(node->a.np.is_collection ? 1 : 0), rfs);
+            }
             break;
 
         case MP_BNODE:
-            retesave_one_byte(node->left_hash_loc_field_num, f);
-            retesave_two_bytes(node->left_hash_loc_levels_up, f);
+            retesave_one_byte(node->left_hash_loc_field_num, rfs);
+            retesave_two_bytes(node->left_hash_loc_levels_up, rfs);
         /* ... and fall through to the next case below ... */
         case UNHASHED_MP_BNODE:
-            retesave_eight_bytes(node->b.posneg.alpha_mem_->retesave_amindex, f);
-            retesave_rete_test_list(node->b.posneg.other_tests, f);
-            retesave_one_byte(static_cast<byte>(node->a.np.is_left_unlinked ? 1 : 0), f);
+            retesave_eight_bytes(node->b.posneg.alpha_mem_->retesave_amindex, rfs);
+            retesave_rete_test_list(node->b.posneg.other_tests, rfs);
+            retesave_one_byte(static_cast<byte>(node->a.np.is_left_unlinked ? 1 : 0), rfs);
             break;
 
         case POSITIVE_BNODE:
         case UNHASHED_POSITIVE_BNODE:
-            retesave_eight_bytes(node->b.posneg.alpha_mem_->retesave_amindex, f);
-            retesave_rete_test_list(node->b.posneg.other_tests, f);
-            retesave_one_byte(static_cast<byte>(node_is_left_unlinked(node) ? 1 : 0), f);
+            retesave_eight_bytes(node->b.posneg.alpha_mem_->retesave_amindex, rfs);
+            retesave_rete_test_list(node->b.posneg.other_tests, rfs);
+            retesave_one_byte(static_cast<byte>(node_is_left_unlinked(node) ? 1 : 0), rfs);
             break;
 
         case NEGATIVE_BNODE:
-            retesave_one_byte(node->left_hash_loc_field_num, f);
-            retesave_two_bytes(node->left_hash_loc_levels_up, f);
+            retesave_one_byte(node->left_hash_loc_field_num, rfs);
+            retesave_two_bytes(node->left_hash_loc_levels_up, rfs);
         /* ... and fall through to the next case below ... */
         case UNHASHED_NEGATIVE_BNODE:
-            retesave_eight_bytes(node->b.posneg.alpha_mem_->retesave_amindex, f);
-            retesave_rete_test_list(node->b.posneg.other_tests, f);
+            retesave_eight_bytes(node->b.posneg.alpha_mem_->retesave_amindex, rfs);
+            retesave_rete_test_list(node->b.posneg.other_tests, rfs);
             break;
 
         case CN_PARTNER_BNODE:
@@ -7575,38 +9122,42 @@ void retesave_rete_node_and_children(agent* thisAgent, rete_node* node, FILE* f)
                 temp = real_parent_node(temp);
                 i++;
             }
-            retesave_eight_bytes(i, f);
+            retesave_eight_bytes(i, rfs);
             break;
 
         case P_BNODE:
             prod = node->b.p.prod;
-            retesave_eight_bytes(prod->name->retesave_symindex, f);
+            retesave_eight_bytes(prod->name->retesave_symindex, rfs);
             if (prod->documentation)
             {
-                retesave_one_byte(1, f);
-                retesave_string(prod->documentation, f);
+                retesave_one_byte(1, rfs);
+                retesave_string(prod->documentation, rfs);
             }
             else
             {
-                retesave_one_byte(0, f);
+                retesave_one_byte(0, rfs);
             }
-            retesave_one_byte(prod->type, f);
-            retesave_one_byte(prod->declared_support, f);
-            retesave_action_list(prod->action_list, f);
+            retesave_one_byte(prod->type, rfs);
+            retesave_one_byte(prod->declared_support, rfs);
+            retesave_action_list(prod->action_list, rfs);
             for (i = 0, c = prod->rhs_unbound_variables; c != NIL; i++, c = c->rest);
-            retesave_eight_bytes(i, f);
+            retesave_eight_bytes(i, rfs);
             for (c = prod->rhs_unbound_variables; c != NIL; c = c->rest)
             {
-                retesave_eight_bytes(static_cast<Symbol*>(c->first)->retesave_symindex, f);
+                retesave_eight_bytes(static_cast<Symbol*>(c->first)->retesave_symindex, rfs);
             }
             if (node->b.p.parents_nvn)
             {
-                retesave_one_byte(1, f);
-                retesave_node_varnames(node->b.p.parents_nvn, node->parent, f);
+                retesave_one_byte(1, rfs);
+                retesave_node_varnames(node->b.p.parents_nvn, node->parent, rfs);
             }
             else
             {
-                retesave_one_byte(0, f);
+                retesave_one_byte(0, rfs);
+            }
+            if (rfs->format == RETE_NET_SNAPSHOT)
+            {
+                retesave_one_byte(static_cast<byte>(prod->collection_match ? 1 : 0), rfs);
             }
             break;
 
@@ -7626,12 +9177,12 @@ void retesave_rete_node_and_children(agent* thisAgent, rete_node* node, FILE* f)
         node = node->b.cn.partner;
     }
     /* --- Write out records for all the node's children. --- */
-    retesave_children_of_node(thisAgent, node, f);
+    retesave_children_of_node(thisAgent, node, rfs);
 }
 
-void reteload_node_and_children(agent* thisAgent, rete_node* parent, FILE* f)
+void reteload_node_and_children(agent* thisAgent, rete_node* parent, rete_fs* rfs)
 {
-    byte type, left_unlinked_flag;
+    byte type, left_unlinked_flag, collection_flag;
     rete_node* New, *ncc_top;
     uint64_t count;
     alpha_mem* am;
@@ -7641,7 +9192,7 @@ void reteload_node_and_children(agent* thisAgent, rete_node* parent, FILE* f)
     var_location left_hash_loc;
     rete_test* other_tests;
 
-    type = reteload_one_byte(f);
+    type = reteload_one_byte(rfs);
 
     /*
        Initializing the left_hash_loc structure to flag values.
@@ -7654,49 +9205,50 @@ void reteload_node_and_children(agent* thisAgent, rete_node* parent, FILE* f)
     switch (type)
     {
         case MEMORY_BNODE:
-            left_hash_loc.field_num = reteload_one_byte(f);
-            left_hash_loc.levels_up = static_cast<rete_node_level>(reteload_two_bytes(f));
+            left_hash_loc.field_num = reteload_one_byte(rfs);
+            left_hash_loc.levels_up = static_cast<rete_node_level>(reteload_two_bytes(rfs));
         /* ... and fall through to the next case below ... */
         case UNHASHED_MEMORY_BNODE:
-            New = make_new_mem_node(thisAgent, parent, type, left_hash_loc);
+            collection_flag = (rfs->format == RETE_NET_SNAPSHOT) ? reteload_one_byte(rfs) : 0;
+            New = make_new_mem_node(thisAgent, parent, type, left_hash_loc, collection_flag != 0);
             break;
 
         case MP_BNODE:
-            left_hash_loc.field_num = reteload_one_byte(f);
-            left_hash_loc.levels_up = static_cast<rete_node_level>(reteload_two_bytes(f));
+            left_hash_loc.field_num = reteload_one_byte(rfs);
+            left_hash_loc.levels_up = static_cast<rete_node_level>(reteload_two_bytes(rfs));
         /* ... and fall through to the next case below ... */
         case UNHASHED_MP_BNODE:
-            am = reteload_am_from_index(thisAgent, f);
+            am = reteload_am_from_index(thisAgent, rfs);
             am->reference_count++;
-            other_tests = reteload_rete_test_list(thisAgent, f);
-            left_unlinked_flag = reteload_one_byte(f);
+            other_tests = reteload_rete_test_list(thisAgent, rfs);
+            left_unlinked_flag = reteload_one_byte(rfs);
             New = make_new_mp_node(thisAgent, parent, type, left_hash_loc, am, other_tests,
                                    left_unlinked_flag != 0);
             break;
 
         case POSITIVE_BNODE:
         case UNHASHED_POSITIVE_BNODE:
-            am = reteload_am_from_index(thisAgent, f);
+            am = reteload_am_from_index(thisAgent, rfs);
             am->reference_count++;
-            other_tests = reteload_rete_test_list(thisAgent, f);
-            left_unlinked_flag = reteload_one_byte(f);
+            other_tests = reteload_rete_test_list(thisAgent, rfs);
+            left_unlinked_flag = reteload_one_byte(rfs);
             New = make_new_positive_node(thisAgent, parent, type, am, other_tests,
                                          left_unlinked_flag != 0);
             break;
 
         case NEGATIVE_BNODE:
-            left_hash_loc.field_num = reteload_one_byte(f);
-            left_hash_loc.levels_up = static_cast<rete_node_level>(reteload_two_bytes(f));
+            left_hash_loc.field_num = reteload_one_byte(rfs);
+            left_hash_loc.levels_up = static_cast<rete_node_level>(reteload_two_bytes(rfs));
         /* ... and fall through to the next case below ... */
         case UNHASHED_NEGATIVE_BNODE:
-            am = reteload_am_from_index(thisAgent, f);
+            am = reteload_am_from_index(thisAgent, rfs);
             am->reference_count++;
-            other_tests = reteload_rete_test_list(thisAgent, f);
+            other_tests = reteload_rete_test_list(thisAgent, rfs);
             New = make_new_negative_node(thisAgent, parent, type, left_hash_loc, am, other_tests);
             break;
 
         case CN_PARTNER_BNODE:
-            count = reteload_eight_bytes(f);
+            count = reteload_eight_bytes(rfs);
             ncc_top = parent;
             while (count--)
             {
@@ -7715,13 +9267,14 @@ void reteload_node_and_children(agent* thisAgent, rete_node* parent, FILE* f)
             prod->p_node = NIL;
             prod->interrupt = false;
             prod->interrupt_break = false;
+            prod->collection_match = false;
             prod->duplicate_chunks_this_cycle = 0;
             prod->last_duplicate_dc = 0;
             prod->explain_its_chunks = false;
             prod->save_for_justification_explanation = false;
             prod->p_id = thisAgent->explanationBasedChunker->get_new_prod_id();
 
-            sym = reteload_symbol_from_index(thisAgent, f);
+            sym = reteload_symbol_from_index(thisAgent, rfs);
             thisAgent->symbolManager->symbol_add_ref(sym);
             prod->name = sym;
             /* If this rule was a chunk, then original rule name might be different.  To
@@ -7731,93 +9284,562 @@ void reteload_node_and_children(agent* thisAgent, rete_node* parent, FILE* f)
              * example chunk*chunk-x2*apply-d12 instead of chunk-x3*apply*d12 */
             prod->original_rule_name = make_memory_block_for_string(thisAgent, prod->name->sc->name);
             sym->sc->production = prod;
-            if (reteload_one_byte(f))
+            if (reteload_one_byte(rfs))
+            {
+                prod->documentation = make_memory_block_for_string(thisAgent, reteload_string(rfs));
+            }
+            else
+            {
+                prod->documentation = NIL;
+            }
+            prod->type = static_cast<ProductionType>(reteload_one_byte(rfs));
+            prod->declared_support = static_cast<SupportType>(reteload_one_byte(rfs));
+            prod->action_list = reteload_action_list(thisAgent, rfs);
+
+            count = reteload_eight_bytes(rfs);
+            update_max_rhs_unbound_variables(thisAgent, count);
+            ubv_list = NIL;
+            while (count--)
+            {
+                sym = reteload_symbol_from_index(thisAgent, rfs);
+                thisAgent->symbolManager->symbol_add_ref(sym);
+                push(thisAgent, sym, ubv_list);
+            }
+            prod->rhs_unbound_variables = destructively_reverse_list(ubv_list);
+
+            insert_at_head_of_dll(thisAgent->all_productions_of_type[prod->type],
+                                  prod, next, prev);
+            thisAgent->num_productions_of_type[prod->type]++;
+
+            // Soar-RL stuff
+            prod->rl_update_count = 0.0;
+            prod->rl_delta_bar_delta_beta = -3.0;
+            prod->rl_delta_bar_delta_h = 0.0;
+            prod->rl_update_count = 0;
+            prod->rl_rule = false;
+            prod->rl_ecr = 0.0;
+            prod->rl_efr = 0.0;
+            prod->rl_gql = 0.0;
+            if ((prod->type != JUSTIFICATION_PRODUCTION_TYPE) && (prod->type != TEMPLATE_PRODUCTION_TYPE))
+            {
+                prod->rl_rule = rl_valid_rule(prod);
+                if (prod->rl_rule)
+                {
+                    prod->rl_efr = get_number_from_symbol(rhs_value_to_symbol(prod->action_list->referent));
+
+                    if (prod->documentation)
+                    {
+                        rl_rule_meta(thisAgent, prod);
+                    }
+                }
+            }
+            prod->rl_template_conds = NIL;
+
+            New = make_new_production_node(thisAgent, parent, prod);
+            adjust_sharing_factors_from_here_to_top(New, 1);
+            if (reteload_one_byte(rfs))
+            {
+                New->b.p.parents_nvn = reteload_node_varnames(thisAgent, parent, rfs);
+            }
+            else
+            {
+                New->b.p.parents_nvn = NIL;
+            }
+            if (rfs->format == RETE_NET_SNAPSHOT)
+            {
+                prod->collection_match = (reteload_one_byte(rfs) != 0);
+            }
+
+            /* --- call new node's add_left routine with all the parent's tokens --- */
+            update_node_with_matches_from_above(thisAgent, New);
+
+            /* --- invoke callback on the production --- */
+            soar_invoke_callbacks(thisAgent, PRODUCTION_JUST_ADDED_CALLBACK, static_cast<soar_call_data>(prod));
+
+            break;
+
+        default:
+        {
+            char msg[BUFFER_MSG_SIZE];
+            SNPRINTF(msg, BUFFER_MSG_SIZE, "Internal error: fastload found node type %d\n", type);
+            msg[BUFFER_MSG_SIZE - 1] = 0; /* ensure null termination */
+            abort_with_fatal_error(thisAgent, msg);
+            New = NIL; /* unreachable, but without it gcc -Wall warns here */
+        }
+    } /* end of switch statement */
+
+    /* --- read in the children of the node --- */
+    count = reteload_eight_bytes(rfs);
+    while (count--)
+    {
+        reteload_node_and_children(thisAgent, New, rfs);
+    }
+}
+
+/* ----------------------------------------------------------------------
+                       Checking an Image Before Loading
+
+   Reteload_check_image() walks a whole image the way reteload_image()
+   will, but only reads it: every count has to fit in what is left of
+   the file, every symbol and alpha memory index has to be in range,
+   every node has to be of a type that can hang off its parent, and
+   every RHS function has to be defined.  Load_rete_net() and
+   copy_rete_net() run it before they touch the agent, so a bad file
+   leaves the agent as it was instead of with part of a net.  The
+   reading position is put back where it was when the check is done.
+
+   The check keeps the number of str_constants (the only symbols that
+   can name a production or RHS function) and their names, the number
+   of symbols and alpha memories, and a shadow of the nodes built so
+   far (type, parent and, for CN nodes, partner), since where a node
+   can go and how its varnames are laid out depend on the nodes above.
+---------------------------------------------------------------------- */
+
+typedef struct rete_fs_shadow_node_struct
+{
+    byte type;
+    size_t parent;      /* index of the parent; the dummy top node is 0 */
+    size_t partner;     /* for CN nodes, the partner's index */
+} rete_fs_shadow_node;
+
+typedef struct rete_fs_check_struct
+{
+    std::vector<const char*> str_constants;
+    uint64_t num_syms;
+    uint64_t num_ams;
+    std::vector<rete_fs_shadow_node> nodes;
+    uint64_t num_rhs_unbound_vars;  /* in the actions of the current production */
+} rete_fs_check;
+
+bool reteload_corrupt(agent* thisAgent, const char* what)
+{
+    thisAgent->outputManager->printa_sf(thisAgent, "This rete-net file is corrupted (%s); nothing was loaded.\n", what);
+    return false;
+}
+
+/* --- every record takes at least one byte, so a count can't be more
+   than the bytes left in the file --- */
+inline bool reteload_count_fits(rete_fs* rfs, uint64_t count)
+{
+    return !rfs->in.overrun && (count <= static_cast<uint64_t>(rfs->in.end - rfs->in.next));
+}
+
+bool reteload_check_symbol(rete_fs* rfs, rete_fs_check* check, bool nil_ok)
+{
+    uint64_t index;
+
+    index = reteload_eight_bytes(rfs);
+    return ((index == 0) ? nil_ok : (index <= check->num_syms));
+}
+
+/* --- a symbol that must be a str_constant; its name goes in *name --- */
+bool reteload_check_str_constant(rete_fs* rfs, rete_fs_check* check, const char** name)
+{
+    uint64_t index;
+
+    index = reteload_eight_bytes(rfs);
+    if ((index == 0) || (index > check->str_constants.size()))
+    {
+        return false;
+    }
+    *name = check->str_constants[index - 1];
+    return true;
+}
+
+bool reteload_check_symbols(agent* thisAgent, rete_fs* rfs, rete_fs_check* check)
+{
+    uint64_t counts[4], i;
+    int j;
+
+    for (j = 0; j < 4; j++)
+    {
+        counts[j] = reteload_eight_bytes(rfs);
+        if (!reteload_count_fits(rfs, counts[j]))
+        {
+            return reteload_corrupt(thisAgent, "symbol table");
+        }
+    }
+    check->num_syms = counts[0] + counts[1] + counts[2] + counts[3];
+    for (i = 0; i < counts[0]; i++)
+    {
+        check->str_constants.push_back(reteload_string(rfs));
+    }
+    for (i = 0; i < counts[1]; i++)
+    {
+        reteload_string(rfs);
+    }
+    for (i = 0; i < counts[2] + counts[3]; i++)
+    {
+        if (rfs->format == RETE_NET_SNAPSHOT)
+        {
+            reteload_eight_bytes(rfs);
+        }
+        else
+        {
+            reteload_string(rfs);
+        }
+    }
+    return !rfs->in.overrun || reteload_corrupt(thisAgent, "symbol table");
+}
+
+bool reteload_check_alpha_memories(agent* thisAgent, rete_fs* rfs, rete_fs_check* check)
+{
+    uint64_t i;
+
+    check->num_ams = reteload_eight_bytes(rfs);
+    if (!reteload_count_fits(rfs, check->num_ams))
+    {
+        return reteload_corrupt(thisAgent, "alpha memories");
+    }
+    for (i = 0; i < check->num_ams; i++)
+    {
+        if (!reteload_check_symbol(rfs, check, true) || !reteload_check_symbol(rfs, check, true) ||
+                !reteload_check_symbol(rfs, check, true))
+        {
+            return reteload_corrupt(thisAgent, "alpha memories");
+        }
+        reteload_one_byte(rfs);
+    }
+    return !rfs->in.overrun || reteload_corrupt(thisAgent, "alpha memories");
+}
+
+bool reteload_check_am(rete_fs* rfs, rete_fs_check* check)
+{
+    uint64_t amindex;
+
+    amindex = reteload_eight_bytes(rfs);
+    return (amindex != 0) && (amindex <= check->num_ams);
+}
+
+bool reteload_check_varnames(rete_fs* rfs, rete_fs_check* check)
+{
+    uint64_t count;
+
+    switch (reteload_one_byte(rfs))
+    {
+        case 0:
+            return true;
+        case 1:
+            return reteload_check_symbol(rfs, check, false);
+        default:
+            count = reteload_eight_bytes(rfs);
+            if (!reteload_count_fits(rfs, count))
+            {
+                return false;
+            }
+            while (count--)
+            {
+                if (!reteload_check_symbol(rfs, check, false))
+                {
+                    return false;
+                }
+            }
+            return true;
+    }
+}
+
+inline size_t reteload_check_real_parent(rete_fs_check* check, size_t node)
+{
+    size_t parent = check->nodes[node].parent;
+
+    return bnode_is_bottom_of_split_mp(check->nodes[node].type) ? check->nodes[parent].parent : parent;
+}
+
+/* --- mirrors reteload_node_varnames() --- */
+bool reteload_check_node_varnames(rete_fs* rfs, rete_fs_check* check, size_t node)
+{
+    while (check->nodes[node].type != DUMMY_TOP_BNODE)
+    {
+        if (check->nodes[node].type == CN_BNODE)
+        {
+            return reteload_check_node_varnames(rfs, check, check->nodes[check->nodes[node].partner].parent);
+        }
+        if (!reteload_check_varnames(rfs, check) || !reteload_check_varnames(rfs, check) ||
+                !reteload_check_varnames(rfs, check))
+        {
+            return false;
+        }
+        node = reteload_check_real_parent(check, node);
+    }
+    return true;
+}
+
+bool reteload_check_rhs_value(agent* thisAgent, rete_fs* rfs, rete_fs_check* check)
+{
+    uint64_t count;
+    const char* name;
+    Symbol* sym;
+
+    switch (reteload_one_byte(rfs))
+    {
+        case 0:
+            return reteload_check_symbol(rfs, check, false);
+        case 1:
+            if (!reteload_check_str_constant(rfs, check, &name))
+            {
+                return false;
+            }
+            sym = thisAgent->symbolManager->find_str_constant(name);
+            if (!sym || !lookup_rhs_function(thisAgent, sym))
+            {
+                thisAgent->outputManager->printa_sf(thisAgent, "Error: can't load this file because it uses an undefined RHS function %s\n", name);
+                return false;
+            }
+            count = reteload_eight_bytes(rfs);
+            if (!reteload_count_fits(rfs, count))
+            {
+                return false;
+            }
+            while (count--)
+            {
+                if (!reteload_check_rhs_value(thisAgent, rfs, check))
+                {
+                    return false;
+                }
+            }
+            return true;
+        case 2:
+            reteload_one_byte(rfs);
+            reteload_two_bytes(rfs);
+            return true;
+        case 3:
+            /* --- checked against the production's count once it's read --- */
+            count = reteload_eight_bytes(rfs) + 1;
+            if (count > check->num_rhs_unbound_vars)
+            {
+                check->num_rhs_unbound_vars = count;
+            }
+            return (count != 0);
+        default:
+            return false;
+    }
+}
+
+bool reteload_check_action_list(agent* thisAgent, rete_fs* rfs, rete_fs_check* check)
+{
+    uint64_t count;
+    byte type, preference_type;
+
+    count = reteload_eight_bytes(rfs);
+    if (!reteload_count_fits(rfs, count))
+    {
+        return false;
+    }
+    while (count--)
+    {
+        type = reteload_one_byte(rfs);
+        preference_type = reteload_one_byte(rfs);
+        reteload_one_byte(rfs);
+        if (type == FUNCALL_ACTION)
+        {
+            /* --- the preference type of a funcall isn't used (or set) --- */
+            if (!reteload_check_rhs_value(thisAgent, rfs, check))
+            {
+                return false;
+            }
+        }
+        else if (type == MAKE_ACTION)
+        {
+            if ((preference_type >= NUM_PREFERENCE_TYPES) ||
+                    !reteload_check_rhs_value(thisAgent, rfs, check) ||
+                    !reteload_check_rhs_value(thisAgent, rfs, check) ||
+                    !reteload_check_rhs_value(thisAgent, rfs, check) ||
+                    (preference_is_binary(preference_type) && !reteload_check_rhs_value(thisAgent, rfs, check)))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool reteload_check_rete_test_list(rete_fs* rfs, rete_fs_check* check)
+{
+    uint64_t count, num_syms;
+    byte type;
+
+    count = reteload_two_bytes(rfs);
+    while (count--)
+    {
+        type = reteload_one_byte(rfs);
+        reteload_one_byte(rfs);
+        if (test_is_constant_relational_test(type))
+        {
+            if (!reteload_check_symbol(rfs, check, false))
+            {
+                return false;
+            }
+        }
+        else if (test_is_variable_relational_test(type))
+        {
+            reteload_one_byte(rfs);
+            reteload_two_bytes(rfs);
+        }
+        else if (type == DISJUNCTION_RETE_TEST)
+        {
+            num_syms = reteload_two_bytes(rfs);
+            while (num_syms--)
+            {
+                if (!reteload_check_symbol(rfs, check, false))
+                {
+                    return false;
+                }
+            }
+        }
+        if (rfs->in.overrun)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* --- mirrors reteload_node_and_children() --- */
+bool reteload_check_node_and_children(agent* thisAgent, rete_fs* rfs, rete_fs_check* check, size_t parent)
+{
+    byte type, parent_type;
+    uint64_t count;
+    size_t node, ncc_top;
+    const char* name;
+    rete_fs_shadow_node shadow;
+
+    type = reteload_one_byte(rfs);
+    parent_type = check->nodes[parent].type;
+    if (parent_type == P_BNODE)
+    {
+        return reteload_corrupt(thisAgent, "node under a production");
+    }
+    /* --- joins read the tokens of a memory; nothing else does --- */
+    if ((type == POSITIVE_BNODE) || (type == UNHASHED_POSITIVE_BNODE))
+    {
+        if ((parent_type != MEMORY_BNODE) && (parent_type != UNHASHED_MEMORY_BNODE))
+        {
+            return reteload_corrupt(thisAgent, "join without a memory");
+        }
+    }
+    else if ((parent_type == MEMORY_BNODE) || (parent_type == UNHASHED_MEMORY_BNODE))
+    {
+        return reteload_corrupt(thisAgent, "memory without a join");
+    }
+
+    shadow.type = type;
+    shadow.parent = parent;
+    shadow.partner = 0;
+    switch (type)
+    {
+        case MEMORY_BNODE:
+            reteload_one_byte(rfs);
+            reteload_two_bytes(rfs);
+        /* ... and fall through to the next case below ... */
+        case UNHASHED_MEMORY_BNODE:
+            if (rfs->format == RETE_NET_SNAPSHOT)
+            {
+                reteload_one_byte(rfs);
+            }
+            break;
+
+        case MP_BNODE:
+        case NEGATIVE_BNODE:
+            reteload_one_byte(rfs);
+            reteload_two_bytes(rfs);
+        /* ... and fall through to the next case below ... */
+        case UNHASHED_MP_BNODE:
+        case UNHASHED_NEGATIVE_BNODE:
+        case POSITIVE_BNODE:
+        case UNHASHED_POSITIVE_BNODE:
+            if (!reteload_check_am(rfs, check) || !reteload_check_rete_test_list(rfs, check))
+            {
+                return reteload_corrupt(thisAgent, "join tests");
+            }
+            if (!bnode_is_negative(type))
+            {
+                reteload_one_byte(rfs);
+            }
+            break;
+
+        case CN_PARTNER_BNODE:
+            /* --- the CN node goes count levels up; the partner stays here,
+               and the children hang off the CN node --- */
+            count = reteload_eight_bytes(rfs);
+            ncc_top = parent;
+            while (count--)
+            {
+                if (check->nodes[ncc_top].type == DUMMY_TOP_BNODE)
+                {
+                    return reteload_corrupt(thisAgent, "conjunctive negation");
+                }
+                ncc_top = reteload_check_real_parent(check, ncc_top);
+            }
+            check->nodes.push_back(shadow);
+            shadow.type = CN_BNODE;
+            shadow.parent = ncc_top;
+            shadow.partner = check->nodes.size() - 1;
+            break;
+
+        case P_BNODE:
+            if (!reteload_check_str_constant(rfs, check, &name))
             {
-                reteload_string(f);
-                prod->documentation = make_memory_block_for_string(thisAgent, reteload_string_buf);
+                return reteload_corrupt(thisAgent, "production name");
             }
-            else
+            if (reteload_one_byte(rfs))
             {
-                prod->documentation = NIL;
+                reteload_string(rfs);
             }
-            prod->type = static_cast<ProductionType>(reteload_one_byte(f));
-            prod->declared_support = static_cast<SupportType>(reteload_one_byte(f));
-            prod->action_list = reteload_action_list(thisAgent, f);
-
-            count = reteload_eight_bytes(f);
-            update_max_rhs_unbound_variables(thisAgent, count);
-            ubv_list = NIL;
-            while (count--)
+            if (reteload_one_byte(rfs) >= NUM_PRODUCTION_TYPES)
             {
-                sym = reteload_symbol_from_index(thisAgent, f);
-                thisAgent->symbolManager->symbol_add_ref(sym);
-                push(thisAgent, sym, ubv_list);
+                return reteload_corrupt(thisAgent, "production type");
             }
-            prod->rhs_unbound_variables = destructively_reverse_list(ubv_list);
-
-            insert_at_head_of_dll(thisAgent->all_productions_of_type[prod->type],
-                                  prod, next, prev);
-            thisAgent->num_productions_of_type[prod->type]++;
-
-            // Soar-RL stuff
-            prod->rl_update_count = 0.0;
-            prod->rl_delta_bar_delta_beta = -3.0;
-            prod->rl_delta_bar_delta_h = 0.0;
-            prod->rl_update_count = 0;
-            prod->rl_rule = false;
-            prod->rl_ecr = 0.0;
-            prod->rl_efr = 0.0;
-            prod->rl_gql = 0.0;
-            if ((prod->type != JUSTIFICATION_PRODUCTION_TYPE) && (prod->type != TEMPLATE_PRODUCTION_TYPE))
+            reteload_one_byte(rfs);
+            check->num_rhs_unbound_vars = 0;
+            if (!reteload_check_action_list(thisAgent, rfs, check))
             {
-                prod->rl_rule = rl_valid_rule(prod);
-                if (prod->rl_rule)
+                return reteload_corrupt(thisAgent, "actions");
+            }
+            count = reteload_eight_bytes(rfs);
+            if (!reteload_count_fits(rfs, count) || (check->num_rhs_unbound_vars > count))
+            {
+                return reteload_corrupt(thisAgent, "unbound variables");
+            }
+            while (count--)
+            {
+                if (!reteload_check_symbol(rfs, check, false))
                 {
-                    prod->rl_efr = get_number_from_symbol(rhs_value_to_symbol(prod->action_list->referent));
-
-                    if (prod->documentation)
-                    {
-                        rl_rule_meta(thisAgent, prod);
-                    }
+                    return reteload_corrupt(thisAgent, "unbound variables");
                 }
             }
-            prod->rl_template_conds = NIL;
-
-            New = make_new_production_node(thisAgent, parent, prod);
-            adjust_sharing_factors_from_here_to_top(New, 1);
-            if (reteload_one_byte(f))
+            if (reteload_one_byte(rfs) && !reteload_check_node_varnames(rfs, check, parent))
             {
-                New->b.p.parents_nvn = reteload_node_varnames(thisAgent, parent, f);
+                return reteload_corrupt(thisAgent, "variable names");
             }
-            else
+            if (rfs->format == RETE_NET_SNAPSHOT)
             {
-                New->b.p.parents_nvn = NIL;
+                reteload_one_byte(rfs);
             }
-
-            /* --- call new node's add_left routine with all the parent's tokens --- */
-            update_node_with_matches_from_above(thisAgent, New);
-
-            /* --- invoke callback on the production --- */
-            soar_invoke_callbacks(thisAgent, PRODUCTION_JUST_ADDED_CALLBACK, static_cast<soar_call_data>(prod));
-
             break;
 
         default:
-        {
-            char msg[BUFFER_MSG_SIZE];
-            SNPRINTF(msg, BUFFER_MSG_SIZE, "Internal error: fastload found node type %d\n", type);
-            msg[BUFFER_MSG_SIZE - 1] = 0; /* ensure null termination */
-            abort_with_fatal_error(thisAgent, msg);
-            New = NIL; /* unreachable, but without it gcc -Wall warns here */
-        }
-    } /* end of switch statement */
+            return reteload_corrupt(thisAgent, "unknown node type");
+    }
+    check->nodes.push_back(shadow);
+    node = check->nodes.size() - 1;
 
-    /* --- read in the children of the node --- */
-    count = reteload_eight_bytes(f);
+    count = reteload_eight_bytes(rfs);
+    if (!reteload_count_fits(rfs, count))
+    {
+        return reteload_corrupt(thisAgent, "node children");
+    }
     while (count--)
     {
-        reteload_node_and_children(thisAgent, New, f);
+        if (!reteload_check_node_and_children(thisAgent, rfs, check, node))
+        {
+            return false;
+        }
     }
+    return true;
 }
 
 /* ----------------------------------------------------------------------
@@ -7825,11 +9847,39 @@ void reteload_node_and_children(agent* thisAgent, rete_node* parent, FILE* f)
 
   Save_rete_net() and load_rete_net() save and load everything to and
   from the given (already open) files.  They return true if successful,
-  false if any error occurred.
+  false if any error occurred.  For the snapshot format, save_rete_net()
+  leaves room for the file length and section offsets after the version
+  byte and patches them in once each section has been collected.
+---------------------------------------------------------------------- */
+
+void retesave_patch_eight_bytes(rete_fs* rfs, size_t offset, uint64_t w)
+{
+    int i;
+
+    for (i = 0; i < 8; i++)
+    {
+        rfs->buffer[offset + i] = static_cast<uint8_t>((w >> (8 * i)) & 0xFF);
+    }
+}
+
+/* ----------------------------------------------------------------------
+                     Saving and Loading a Whole Net
+
+   Retesave_image() collects the whole net of an agent, in the given
+   format, in rfs->buffer.  Reteload_header() reads the header of the
+   image at rfs->in and sets rfs->format to match; for a snapshot it also
+   returns where each section starts (otherwise the offsets are 0 and
+   each section follows the one before).  Reteload_image() builds the
+   net described by a checked image into an agent whose production memory
+   and working memory are already empty.  Reteload_clear_agent() empties
+   an agent in preparation for a load.
 ---------------------------------------------------------------------- */
 
-bool save_rete_net(agent* thisAgent, FILE* dest_file, bool use_rete_net_64)
+bool retesave_image(agent* thisAgent, rete_fs* rfs, ReteNetFormat format)
 {
+    size_t header_loc;
+    production* prod;
+    int i;
 
     /* --- make sure there are no justifications present --- */
     if (thisAgent->all_productions_of_type[JUSTIFICATION_PRODUCTION_TYPE])
@@ -7838,22 +9888,54 @@ bool save_rete_net(agent* thisAgent, FILE* dest_file, bool use_rete_net_64)
         return false;
     }
 
-    rete_fs_file = dest_file;
-    rete_net_64 = use_rete_net_64;
-    uint8_t version = use_rete_net_64 ? 4 : 3;
+    /* --- only the snapshot format can record :collection productions --- */
+    if (format != RETE_NET_SNAPSHOT)
+    {
+        for (i = 0; i < NUM_PRODUCTION_TYPES; i++)
+        {
+            for (prod = thisAgent->all_productions_of_type[i]; prod != NIL; prod = prod->next)
+            {
+                if (prod->collection_match)
+                {
+                    thisAgent->outputManager->printa_sf(thisAgent, "Production %y is marked :collection, which only the snapshot format can save.\n", prod->name);
+                    return false;
+                }
+            }
+        }
+    }
+
+    rfs->buffer.clear();
+    rfs->format = format;
+    rfs->net_64 = (format != RETE_NET_COMPACT_32);
+
+    retesave_string("SoarCompactReteNet\n", rfs);
+    retesave_one_byte(static_cast<uint8_t>(format), rfs);  /* format version number */
+    if (format == RETE_NET_SNAPSHOT)
+    {
+        /* --- file length and section offsets, patched in below --- */
+        header_loc = rfs->buffer.size();
+        rfs->buffer.resize(header_loc + 32, 0);
 
-    retesave_string("SoarCompactReteNet\n", dest_file);
-    retesave_one_byte(version, dest_file);  /* format version number */
-    retesave_symbol_table(thisAgent, dest_file);
-    retesave_alpha_memories(thisAgent, dest_file);
-    retesave_children_of_node(thisAgent, thisAgent->dummy_top_node, dest_file);
+        retesave_patch_eight_bytes(rfs, header_loc + 8, rfs->buffer.size());
+        retesave_symbol_table(thisAgent, rfs);
+        retesave_patch_eight_bytes(rfs, header_loc + 16, rfs->buffer.size());
+        retesave_alpha_memories(thisAgent, rfs);
+        retesave_patch_eight_bytes(rfs, header_loc + 24, rfs->buffer.size());
+        retesave_children_of_node(thisAgent, thisAgent->dummy_top_node, rfs);
+        retesave_patch_eight_bytes(rfs, header_loc, rfs->buffer.size());
+    }
+    else
+    {
+        retesave_symbol_table(thisAgent, rfs);
+        retesave_alpha_memories(thisAgent, rfs);
+        retesave_children_of_node(thisAgent, thisAgent->dummy_top_node, rfs);
+    }
     return true;
 }
 
-bool load_rete_net(agent* thisAgent, FILE* source_file)
+bool reteload_clear_agent(agent* thisAgent)
 {
-    int format_version_num;
-    uint64_t i, count;
+    uint64_t i;
 
     /* RDF: 20020814 RDF Cleaning up the agent working memory and production
        memory to avoid unnecessary errors in this function. */
@@ -7874,44 +9956,222 @@ bool load_rete_net(agent* thisAgent, FILE* source_file)
             thisAgent->outputManager->printa_sf(thisAgent, "Internal error: load_rete_net() called with nonempty PM.\n");
             return false;
         }
+    return true;
+}
 
-    // BADBAD: this is global, used in retesave_one_byte
-    rete_fs_file = source_file;
+bool reteload_header(agent* thisAgent, rete_fs* rfs, uint64_t* symbols_loc, uint64_t* alpha_mems_loc, uint64_t* nodes_loc)
+{
+    int format_version_num;
+    uint64_t file_length;
 
     /* --- read file header, make sure it's a valid file --- */
-    reteload_string(source_file);
-    if (strcmp(reteload_string_buf, "SoarCompactReteNet\n"))
+    if (strcmp(reteload_string(rfs), "SoarCompactReteNet\n"))
     {
         thisAgent->outputManager->printa_sf(thisAgent, "This file isn't a Soar fastsave file.\n");
         return false;
     }
-    format_version_num = reteload_one_byte(source_file);
+    format_version_num = reteload_one_byte(rfs);
     switch (format_version_num)
     {
-        case 3:
-            // Since there's already a global, I'm putting the 32- or 64-bit switch out there globally
-            rete_net_64 = false; // used by reteload_eight_bytes
+        case RETE_NET_COMPACT_32:
+            rfs->net_64 = false;
             break;
-        case 4:
-            // Since there's already a global, I'm putting the 32- or 64-bit switch out there globally
-            rete_net_64 = true; // used by reteload_eight_bytes
+        case RETE_NET_COMPACT_64:
+        case RETE_NET_SNAPSHOT:
+            rfs->net_64 = true;
             break;
         default:
             thisAgent->outputManager->printa_sf(thisAgent, "This file is in a format (version %d) I don't understand.\n", static_cast<int64_t>(format_version_num));
             return false;
     }
+    rfs->format = static_cast<ReteNetFormat>(format_version_num);
+
+    *symbols_loc = *alpha_mems_loc = *nodes_loc = 0;
+    if (rfs->format == RETE_NET_SNAPSHOT)
+    {
+        file_length = reteload_eight_bytes(rfs);
+        *symbols_loc = reteload_eight_bytes(rfs);
+        *alpha_mems_loc = reteload_eight_bytes(rfs);
+        *nodes_loc = reteload_eight_bytes(rfs);
+        if ((file_length != static_cast<uint64_t>(rfs->in.end - rfs->in.start)) ||
+                !(*symbols_loc <= *alpha_mems_loc && *alpha_mems_loc <= *nodes_loc && *nodes_loc < file_length) ||
+                (*symbols_loc < static_cast<uint64_t>(rfs->in.next - rfs->in.start)))
+        {
+            thisAgent->outputManager->printa_sf(thisAgent, "This rete-net snapshot is truncated or corrupted.\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+bool reteload_check_image(agent* thisAgent, rete_fs* rfs)
+{
+    const uint8_t* image_start;
+    uint64_t symbols_loc, alpha_mems_loc, nodes_loc, count;
+    rete_fs_check check;
+    rete_fs_shadow_node top;
+    bool ok;
+
+    image_start = rfs->in.next;
+    ok = reteload_header(thisAgent, rfs, &symbols_loc, &alpha_mems_loc, &nodes_loc);
+    if (ok)
+    {
+        if (symbols_loc)
+        {
+            rfs->in.next = rfs->in.start + symbols_loc;
+        }
+        ok = reteload_check_symbols(thisAgent, rfs, &check);
+    }
+    if (ok)
+    {
+        if (alpha_mems_loc)
+        {
+            rfs->in.next = rfs->in.start + alpha_mems_loc;
+        }
+        ok = reteload_check_alpha_memories(thisAgent, rfs, &check);
+    }
+    if (ok)
+    {
+        if (nodes_loc)
+        {
+            rfs->in.next = rfs->in.start + nodes_loc;
+        }
+        top.type = DUMMY_TOP_BNODE;
+        top.parent = top.partner = 0;
+        check.nodes.push_back(top);
+        count = reteload_eight_bytes(rfs);
+        ok = reteload_count_fits(rfs, count) || reteload_corrupt(thisAgent, "node children");
+        while (ok && count--)
+        {
+            ok = reteload_check_node_and_children(thisAgent, rfs, &check, 0);
+        }
+    }
+    if (ok && rfs->in.overrun)
+    {
+        ok = false;
+        thisAgent->outputManager->printa_sf(thisAgent, "The rete-net file ended unexpectedly; it may be truncated.\n");
+    }
+
+    rfs->in.next = image_start;
+    rfs->in.overrun = false;
+    return ok;
+}
+
+void reteload_image(agent* thisAgent, rete_fs* rfs)
+{
+    uint64_t count;
+    uint64_t symbols_loc, alpha_mems_loc, nodes_loc;
 
-    reteload_all_symbols(thisAgent, source_file);
-    reteload_alpha_memories(thisAgent, source_file);
-    count = reteload_eight_bytes(source_file);
+    reteload_header(thisAgent, rfs, &symbols_loc, &alpha_mems_loc, &nodes_loc);
+    if (symbols_loc)
+    {
+        rfs->in.next = rfs->in.start + symbols_loc;
+    }
+    reteload_all_symbols(thisAgent, rfs);
+    if (alpha_mems_loc)
+    {
+        rfs->in.next = rfs->in.start + alpha_mems_loc;
+    }
+    reteload_alpha_memories(thisAgent, rfs);
+    if (nodes_loc)
+    {
+        rfs->in.next = rfs->in.start + nodes_loc;
+    }
+    count = reteload_eight_bytes(rfs);
     while (count--)
     {
-        reteload_node_and_children(thisAgent, thisAgent->dummy_top_node, source_file);
+        reteload_node_and_children(thisAgent, thisAgent->dummy_top_node, rfs);
     }
 
     /* --- clean up auxilliary tables --- */
     reteload_free_am_table(thisAgent);
     reteload_free_symbol_table(thisAgent);
+}
+
+bool save_rete_net(agent* thisAgent, FILE* dest_file, ReteNetFormat format)
+{
+    rete_fs rfs;
+
+    if (!retesave_image(thisAgent, &rfs, format))
+    {
+        return false;
+    }
+    return retesave_write_file(&rfs, dest_file);
+}
+
+/* --- the image is checked before the agent is cleared, so a file that
+   can't be loaded leaves the agent as it was --- */
+bool load_rete_net(agent* thisAgent, FILE* source_file)
+{
+    rete_fs rfs;
+
+    if (!reteload_map_file(thisAgent, &rfs, source_file))
+    {
+        thisAgent->outputManager->printa_sf(thisAgent, "Could not read the rete-net file.\n");
+        return false;
+    }
+    if (!reteload_check_image(thisAgent, &rfs) || !reteload_clear_agent(thisAgent))
+    {
+        reteload_unmap_file(thisAgent, &rfs);
+        return false;
+    }
+    reteload_image(thisAgent, &rfs);
+    reteload_unmap_file(thisAgent, &rfs);
+
+    /* RDF: 20020814 Now adding the top state and io symbols and wmes */
+    init_agent_memory(thisAgent);
+
+    return true;
+}
+
+/* ----------------------------------------------------------------------
+                          Copy Rete Net
+
+   Builds a copy of source_agent's net in thisAgent without going through
+   a file: the source net is saved as a snapshot image in memory and that
+   image is loaded straight back, so none of the productions need to be
+   parsed, reordered or checked for node sharing again.  This is the quick
+   way to start several agents running the same rule set, but it is a
+   copy, not a shared net: each agent still gets its own nodes, alpha
+   memories and symbols, since those all hold per-agent match state and
+   reference counts, so the copy uses as much memory as sourcing the rules.
+   The image is made and checked before thisAgent is cleared, so if the
+   source net can't be copied (say, it calls an RHS function thisAgent
+   doesn't have), thisAgent is left as it was.  The image is held in this
+   call's own rete_fs and freed when it returns, so nothing is left behind
+   between copies and agents on different threads can copy at once.
+---------------------------------------------------------------------- */
+
+bool copy_rete_net(agent* thisAgent, agent* source_agent)
+{
+    rete_fs rfs;
+
+    if (source_agent == thisAgent)
+    {
+        thisAgent->outputManager->printa_sf(thisAgent, "An agent can't copy its own rete net.\n");
+        return false;
+    }
+    /* --- checked here so the error goes to the agent doing the copy --- */
+    if (source_agent->all_productions_of_type[JUSTIFICATION_PRODUCTION_TYPE])
+    {
+        thisAgent->outputManager->printa_sf(thisAgent, "The rete net of an agent with justifications present can't be copied.\n");
+        return false;
+    }
+    if (!retesave_image(source_agent, &rfs, RETE_NET_SNAPSHOT))
+    {
+        return false;
+    }
+
+    /* --- the image is read straight out of the save buffer --- */
+    rfs.in.start = &rfs.buffer[0];
+    rfs.in.next = rfs.in.start;
+    rfs.in.end = rfs.in.start + rfs.buffer.size();
+
+    if (!reteload_check_image(thisAgent, &rfs) || !reteload_clear_agent(thisAgent))
+    {
+        return false;
+    }
+    reteload_image(thisAgent, &rfs);
 
     /* RDF: 20020814 Now adding the top state and io symbols and wmes */
     init_agent_memory(thisAgent);
@@ -7951,13 +10211,15 @@ bool load_rete_net(agent* thisAgent, FILE* source_file)
    production.  The count does not include:
      tokens in the p_node (i.e., tokens representing complete matches)
      local join result tokens on (real) tokens in negative/NCC nodes
+   Each node keeps its own token count (a.np.num_tokens, kept up by
+   new_left_token() and the token removal routines), so this only walks
+   the nodes above the p_node, not their tokens.
 ---------------------------------------------------------------------- */
 
 uint64_t count_rete_tokens_for_production(agent* thisAgent, production* prod)
 {
     uint64_t count;
     rete_node* node;
-    token* tok;
 
     if (! prod->p_node)
     {
@@ -7970,10 +10232,7 @@ uint64_t count_rete_tokens_for_production(agent* thisAgent, production* prod)
         if ((node->node_type != POSITIVE_BNODE) &&
                 (node->node_type != UNHASHED_POSITIVE_BNODE))
         {
-            for (tok = node->a.np.tokens; tok != NIL; tok = tok->next_of_node)
-            {
-                count++;
-            }
+            count += node->a.np.num_tokens;
         }
         if (node->node_type == CN_BNODE)
         {
@@ -7987,6 +10246,117 @@ uint64_t count_rete_tokens_for_production(agent* thisAgent, production* prod)
     return count;
 }
 
+/* --------------------------------------------------------------------
+                          Match Profile Queries
+
+   Get_match_profile_for_production() walks from the p-node up to the
+   top of the net, the same way count_rete_tokens_for_production() does,
+   except that it also charges the CN partner node of each NCC.
+   Reset_match_profile() releases the profile records of every node in
+   the net.
+
+   Set_observed_costs_from_match_profile() takes the conditions rebuilt
+   from a production's p-node (see p_node_to_conditions_and_rhs()) and
+   sets the observed_cost of each positive condition to its branching
+   factor: the tokens that came out of its join divided by the tokens
+   that went into it, rounded and at least 1.  Conditions whose join
+   never saw a token are left alone.  The reorderer uses these in place
+   of its static estimates (see production_reorder.cpp).
+-------------------------------------------------------------------- */
+
+inline void add_node_profile_to_totals(rete_node* node, rete_node_profile* totals)
+{
+    if (node->profile)
+    {
+        totals->left_activations += node->profile->left_activations;
+        totals->right_activations += node->profile->right_activations;
+        totals->tokens_created += node->profile->tokens_created;
+        totals->join_tests += node->profile->join_tests;
+    }
+}
+
+void get_match_profile_for_production(agent* thisAgent, production* prod, rete_node_profile* totals)
+{
+    rete_node* node;
+
+    memset(totals, 0, sizeof(rete_node_profile));
+    if (! prod->p_node)
+    {
+        return;
+    }
+    node = prod->p_node;
+    while (node != thisAgent->dummy_top_node)
+    {
+        add_node_profile_to_totals(node, totals);
+        if (node->node_type == CN_BNODE)
+        {
+            add_node_profile_to_totals(node->b.cn.partner, totals);
+            node = node->b.cn.partner->parent;
+        }
+        else
+        {
+            node = node->parent;
+        }
+    }
+}
+
+void reset_match_profile_of_subtree(agent* thisAgent, rete_node* node)
+{
+    rete_node* child;
+
+    release_node_profile(thisAgent, node, NIL);
+    for (child = node->first_child; child != NIL; child = child->next_sibling)
+    {
+        reset_match_profile_of_subtree(thisAgent, child);
+    }
+}
+
+void reset_match_profile(agent* thisAgent)
+{
+    reset_match_profile_of_subtree(thisAgent, thisAgent->dummy_top_node);
+}
+
+/* --- tokens created by the memory holding a node's left input --- */
+inline uint64_t tokens_into_node(rete_node* node)
+{
+    if (bnode_is_bottom_of_split_mp(node->node_type))
+    {
+        node = node->parent;
+    }
+    return node->profile ? node->profile->tokens_created : 0;
+}
+
+void set_observed_costs_from_match_profile(agent* thisAgent, production* prod, condition* lhs_top)
+{
+    condition* cond;
+    rete_node* node, *below;
+    uint64_t tokens_in, tokens_out;
+
+    for (cond = lhs_top; cond->next != NIL; cond = cond->next);
+
+    /* --- walk up from the p-node, one node per condition --- */
+    below = prod->p_node;
+    for (node = below->parent; node != thisAgent->dummy_top_node; node = real_parent_node(node))
+    {
+        cond->reorder.observed_cost = 0;
+        if ((cond->type == POSITIVE_CONDITION) && bnode_is_positive(node->node_type))
+        {
+            tokens_in = tokens_into_node(node);
+            tokens_out = tokens_into_node(below);
+            if (tokens_in)
+            {
+                cond->reorder.observed_cost = static_cast<int64_t>((tokens_out + (tokens_in / 2)) / tokens_in);
+                if (cond->reorder.observed_cost < 1)
+                {
+                    cond->reorder.observed_cost = 1;
+                }
+            }
+        }
+        below = node;
+        cond = cond->prev;
+    }
+}
+
 /* --------------------------------------------------------------------
                           Rete Statistics
 
@@ -9454,14 +11824,14 @@ void init_rete(agent* thisAgent)
            -AJC (8/9/02)
     */
 
-    int i;
-
     thisAgent->memoryManager->init_memory_pool(MP_alpha_mem, sizeof(alpha_mem),
                      "alpha mem");
     thisAgent->memoryManager->init_memory_pool(MP_rete_test, sizeof(rete_test),
                      "rete test");
     thisAgent->memoryManager->init_memory_pool(MP_rete_node, sizeof(rete_node),
                      "rete node");
+    thisAgent->memoryManager->init_memory_pool(MP_rete_node_profile, sizeof(rete_node_profile),
+                     "rete profile");
     thisAgent->memoryManager->init_memory_pool(MP_node_varnames, sizeof(node_varnames),
                      "node varnames");
     thisAgent->memoryManager->init_memory_pool(MP_token, sizeof(token), "token");
@@ -9470,14 +11840,14 @@ void init_rete(agent* thisAgent)
     thisAgent->memoryManager->init_memory_pool(MP_ms_change, sizeof(ms_change),
                      "ms change");
 
-    for (i = 0; i < 16; i++)
-    {
-        thisAgent->alpha_hash_tables[i] = make_hash_table(thisAgent, 0, hash_alpha_mem);
-    }
-
-    thisAgent->left_ht = thisAgent->memoryManager->allocate_memory_and_zerofill(sizeof(char*) * LEFT_HT_SIZE, HASH_TABLE_MEM_USAGE);
-    thisAgent->right_ht = thisAgent->memoryManager->allocate_memory_and_zerofill(sizeof(char*) * RIGHT_HT_SIZE, HASH_TABLE_MEM_USAGE);
+    thisAgent->alpha_mem_index = make_alpha_index(thisAgent);
+    thisAgent->alpha_workers = NIL;
+    thisAgent->left_ht = make_rete_ht(thisAgent, LOG2_LEFT_HT_SIZE);
+    thisAgent->right_ht = make_rete_ht(thisAgent, LOG2_RIGHT_HT_SIZE);
 
+    thisAgent->match_profiling = false;
+    thisAgent->reorder_period = 0;
+    thisAgent->building_collection_net = false;
     init_dummy_top_node(thisAgent);
 
     thisAgent->max_rhs_unbound_variables = 1;
@@ -26,10 +26,13 @@
    of NO_REFRACTED_INST, REFRACTED_INST_MATCHED, etc. (see below).
    Excise_production_from_rete() removes the given production from the
    rete, and enqueues all its existing instantiations as pending
-   retractions.
+   retractions.  Excise_productions_from_rete() does the same for a
+   whole set of productions, tearing down the nodes they no longer
+   need in a single bottom-up pass.
 
    Add_wme_to_rete() and remove_wme_from_rete() inform the rete of changes
-   to WM.
+   to WM.  Apply_wme_changes_to_rete() does the same for a whole buffered
+   set of additions and removals at once.
 
    P_node_to_conditions_and_nots() takes a p_node and (optionally) a
    token/wme pair, and reconstructs the (optionally instantiated) LHS
@@ -42,6 +45,12 @@
 
    Count_rete_tokens_for_production() returns a count of the number of
    tokens currently in use for the given production.
+   Get_match_profile_for_production() sums the match profiler counts of
+   every beta node the production uses (nodes shared with other
+   productions are charged to each of them); reset_match_profile()
+   zeroes all of the counts.
+   Set_observed_costs_from_match_profile() turns those counts into a
+   run-time branching factor for each condition of a production.
 
    Print_partial_match_information(), print_match_set(), and
    print_rete_statistics() do printouts for various interface routines.
@@ -49,6 +58,11 @@
    Save_rete_net() and load_rete_net() are used for the fastsave/load
    commands.  They save/load everything to/from the given (already open)
    files.  They return true if successful, false if any error occurred.
+   Save_rete_net() writes the given format version; load_rete_net() reads
+   any version, mapping the file into memory rather than reading it a byte
+   at a time.  Copy_rete_net() replaces the agent's productions with those
+   of another agent in the same process, the same way load_rete_net() would
+   if the other agent's net had been saved to a file first.
 ======================================================================= */
 
 #ifndef RETE_H
@@ -57,6 +71,8 @@
 #include <stdio.h>  // Needed for FILE token below
 #include "kernel.h"
 
+#include <vector>
+
 extern void abort_with_fatal_error_noagent(const char* msg);
 
 inline varnames* one_var_to_varnames(Symbol* x)
@@ -131,7 +147,6 @@ test var_test_bound_in_reconstructed_conds(
 /* --- structure of each alpha memory --- */
 typedef struct alpha_mem_struct
 {
-    struct alpha_mem_struct* next_in_hash_table;  /* next mem in hash bucket */
     struct right_mem_struct* right_mems;  /* dll of right_mem structures */
     struct rete_node_struct* beta_nodes;  /* list of attached beta nodes */
     struct rete_node_struct* last_beta_node; /* tail of above dll */
@@ -144,6 +159,31 @@ typedef struct alpha_mem_struct
     uint64_t retesave_amindex;
 } alpha_mem;
 
+/* --- one slot of the alpha memory index; "hash" is the full hash value
+   of the slot's alpha memory, so probes can skip most other entries
+   without touching them --- */
+typedef struct alpha_index_slot_struct
+{
+    uint32_t hash;
+    struct alpha_mem_struct* am;      /* NIL if the slot is empty */
+} alpha_index_slot;
+
+/* --- open-addressing index of all alpha memories (thisAgent->alpha_index),
+   keyed on the constants an alpha memory tests.  Kind_counts counts the
+   alpha memories of each of the 16 kinds (which fields they test, see
+   alpha_mem_kind() in rete.cpp), so a new wme only probes for kinds that
+   exist. --- */
+typedef struct alpha_index_struct
+{
+    alpha_index_slot* slots;
+    uint32_t size;                     /* a power of 2 */
+    uint64_t count;
+    uint64_t kind_counts[16];
+    uint64_t num_probes;               /* statistics for the stats command */
+    uint64_t num_lookups;
+    uint64_t num_parallel_batches;
+} alpha_index;
+
 /* --- the entry for one WME in one alpha memory --- */
 typedef struct right_mem_struct
 {
@@ -156,6 +196,37 @@ typedef struct right_mem_struct
 
 /* Note: right_mem's are stored in hash table thisAgent->right_ht */
 
+/* --- growable hash table used for thisAgent->left_ht and right_ht.  It
+   has (1 << log2size) + split buckets; buckets below "split" have already
+   been split using one more bit of the hash value (linear hashing).  The
+   bucket headers are kept in fixed-size segments, so the table can grow
+   one bucket at a time without ever moving existing headers. --- */
+typedef struct rete_ht_struct
+{
+    void***  segments;         /* directory of bucket segments */
+    uint32_t num_segments;     /* segments currently allocated */
+    uint32_t max_segments;     /* size of the directory */
+    short    log2size;
+    short    min_log2size;     /* the table never shrinks below this */
+    uint32_t split;            /* next bucket to be split */
+    uint32_t low_mask;         /* masks for the current and next log2size */
+    uint32_t high_mask;
+    uint64_t count;            /* number of items in the table */
+    uint64_t num_splits;
+    uint64_t num_merges;
+} rete_ht;
+
+/* --- occupancy statistics for one of the above, for the stats command --- */
+typedef struct rete_ht_stats_struct
+{
+    uint64_t buckets;
+    uint64_t items;
+    uint64_t used_buckets;
+    uint64_t longest_chain;
+    uint64_t splits;
+    uint64_t merges;
+} rete_ht_stats;
+
 typedef struct var_location_struct
 {
     rete_node_level levels_up; /* 0=current node's alphamem, 1=parent's, etc. */
@@ -188,6 +259,7 @@ typedef struct pos_node_data_struct
 typedef struct posneg_node_data_struct
 {
     rete_test* other_tests; /* tests other than the hashed test */
+    byte join_kernel;       /* shape of other_tests (see below) */
     alpha_mem* alpha_mem_;  /* the alpha memory this node uses */
     struct rete_node_struct* next_from_alpha_mem; /* dll of nodes using that */
     struct rete_node_struct* prev_from_alpha_mem; /*   ... alpha memory */
@@ -223,9 +295,21 @@ typedef struct p_node_data_struct
 typedef struct non_pos_node_data_struct
 {
     struct token_struct* tokens;           /* dll of tokens at this node */
+    uint64_t num_tokens;                   /* length of that dll */
     unsigned is_left_unlinked: 1;          /* used on mp nodes only */
+    unsigned is_collection: 1;             /* used on mem nodes only */
 } non_pos_node_data;
 
+/* --- match profiler counters for one beta node (see "production
+   match-profile"); only allocated while the profiler is on --- */
+typedef struct rete_node_profile_struct
+{
+    uint64_t left_activations;
+    uint64_t right_activations;
+    uint64_t tokens_created;
+    uint64_t join_tests;
+} rete_node_profile;
+
 /* --- structure of a rete beta node --- */
 typedef struct rete_node_struct
 {
@@ -246,6 +330,7 @@ typedef struct rete_node_struct
     struct rete_node_struct* parent;       /* points to parent node */
     struct rete_node_struct* first_child;  /* used for dll of all children, */
     struct rete_node_struct* next_sibling; /*   regardless of unlinking status */
+    rete_node_profile* profile;            /* match profiler counts, or NIL */
     union rete_node_a_union
     {
         pos_node_data pos;                   /* for pos. nodes */
@@ -281,6 +366,14 @@ typedef struct rete_node_struct
 #define UNARY_SMEM_LINK_RETE_TEST     0x40
 #define UNARY_SMEM_LINK_NOT_RETE_TEST 0x41
 
+/* --- join kernels: the shapes of a join node's other_tests that
+       match_join_tests() runs inline; anything else goes through the
+       generic rete_test_routines[] chain --- */
+#define GENERIC_JOIN_KERNEL           0
+#define NO_TESTS_JOIN_KERNEL          1  /* only the hashed test, if any */
+#define ONE_VAR_EQUAL_JOIN_KERNEL     2  /* one variable equality test */
+#define TWO_VAR_EQUAL_JOIN_KERNEL     3  /* two variable equality tests */
+
 //#define test_is_constant_relational_test(x) (((x) & 0xF0)==0x00)
 //#define test_is_variable_relational_test(x) (((x) & 0xF0)==0x10)
 //#define kind_of_relational_test(x) ((x) & 0x0F)
@@ -324,6 +417,34 @@ typedef struct token_struct
        I put "parent" at offset 0 in the structure, so that upward scans
        are fast (saves doing an extra integer addition in the inner loop) --- */
     struct token_struct* parent;
+#ifdef COMPACT_TOKENS
+    /* --- Compact layout (see kernel.h): what join tests and hash bucket
+       scans read comes first, sharing a cache line with "parent".  The
+       hash referent is not stored, and "left_token" shares a slot with
+       "negrm_tokens", since no token uses both --- */
+    wme* w;
+    rete_node* node;
+    union token_a_union
+    {
+        struct token_in_hash_table_data_struct
+        {
+            struct token_struct* next_in_bucket, *prev_in_bucket; /*hash bucket dll*/
+        } ht;
+        struct token_from_right_memory_of_negative_or_cn_node_struct
+        {
+            struct token_struct* next_negrm, *prev_negrm;/*other local join results*/
+        } neg;
+    } a;
+    union
+    {
+        struct token_struct* negrm_tokens; /* join results: for Neg, CN nodes only */
+        struct token_struct* left_token; /* negrm, CN_P: token this is local join result for*/
+    };
+    struct token_struct* first_child;  /* first of dll of children */
+    struct token_struct* next_sibling, *prev_sibling; /* for dll of children */
+    struct token_struct* next_of_node, *prev_of_node; /* dll of tokens at node */
+    struct token_struct* next_from_wme, *prev_from_wme; /* tree-based remove */
+#else
     union token_a_union
     {
         struct token_in_hash_table_data_struct
@@ -344,6 +465,7 @@ typedef struct token_struct
     struct token_struct* next_of_node, *prev_of_node; /* dll of tokens at node */
     struct token_struct* next_from_wme, *prev_from_wme; /* tree-based remove */
     struct token_struct* negrm_tokens; /* join results: for Neg, CN nodes only */
+#endif
 } token;
 
 /* --- info about a change to the match set --- */
@@ -383,14 +505,24 @@ extern bool get_next_nil_goal_retraction(agent* thisAgent, struct instantiation_
 #define DUPLICATE_PRODUCTION 3           /* the prod. was a duplicate */
 extern byte add_production_to_rete(agent* thisAgent, production* p, condition* lhs_top,
                                    instantiation* refracted_inst,
-                                   bool warn_on_duplicates, production* &duplicate_rule, bool ignore_rhs = false);
-extern void excise_production_from_rete(agent* thisAgent, production* p);
+                                   bool warn_on_duplicates, production* &duplicate_rule, bool ignore_rhs = false,
+                                   bool invoke_callbacks = true);
+extern void excise_production_from_rete(agent* thisAgent, production* p, bool invoke_callbacks = true);
+extern void excise_productions_from_rete(agent* thisAgent, std::vector< production* >& prods);
 
 extern void add_wme_to_rete(agent* thisAgent, wme* w);
 extern void remove_wme_from_rete(agent* thisAgent, wme* w);
+extern void apply_wme_changes_to_rete(agent* thisAgent, cons* adds, cons* removes);
+
+/* --- With "soar alpha-threads" above 1, a batch with at least this many
+   additions does its alpha index lookups on the worker pool, in tasks
+   of ALPHA_TASK_WMES wmes each --- */
+#define ALPHA_PARALLEL_MIN_WMES 1024
+#define ALPHA_TASK_WMES 256
 
-void retesave_eight_bytes(uint64_t w, FILE* f);
-void retesave_string(const char* s, FILE* f);
+extern void retesave_eight_bytes(uint64_t w, rete_fs* rfs);
+extern void retesave_string(const char* s, rete_fs* rfs);
+extern void retesave_symbol(Symbol* sym, rete_fs* rfs);
 
 extern void p_node_to_conditions_and_rhs(agent* thisAgent,
         struct rete_node_struct* p_node,
@@ -405,6 +537,9 @@ extern Symbol* get_symbol_from_rete_loc(unsigned short levels_up,
                                         struct token_struct* tok, wme* w);
 
 extern uint64_t count_rete_tokens_for_production(agent* thisAgent, production* prod);
+extern void get_match_profile_for_production(agent* thisAgent, production* prod, rete_node_profile* totals);
+extern void reset_match_profile(agent* thisAgent);
+extern void set_observed_costs_from_match_profile(agent* thisAgent, production* prod, condition* lhs_top);
 extern void print_partial_match_information(agent* thisAgent, struct rete_node_struct* p_node,
         wme_trace_type wtt);
 extern void xml_partial_match_information(agent* thisAgent, rete_node* p_node, wme_trace_type wtt) ;
@@ -412,12 +547,16 @@ extern void xml_partial_match_information(agent* thisAgent, rete_node* p_node, w
 extern void print_match_set(agent* thisAgent, wme_trace_type wtt, ms_trace_type  mst);
 extern void xml_match_set(agent* thisAgent, wme_trace_type wtt, ms_trace_type  mst);
 extern void get_all_node_count_stats(agent* thisAgent);
+extern void get_rete_ht_stats(agent* thisAgent, bool left_table, rete_ht_stats* stats);
+extern void free_rete_ht(agent* thisAgent, rete_ht* ht);
+extern void free_alpha_index(agent* thisAgent, alpha_index* index);
 extern int get_node_count_statistic(agent* thisAgent, char* node_type_name,
                                     char* column_name,
                                     uint64_t* result);
 
-extern bool save_rete_net(agent* thisAgent, FILE* dest_file, bool use_rete_net_64);
+extern bool save_rete_net(agent* thisAgent, FILE* dest_file, ReteNetFormat format);
 extern bool load_rete_net(agent* thisAgent, FILE* source_file);
+extern bool copy_rete_net(agent* thisAgent, agent* source_agent);
 
 extern void add_varnames_to_test(agent* thisAgent, varnames* vn, test* t);
 
@@ -29,6 +29,7 @@
 #include "output_manager.h"
 #include "print.h"
 #include "production.h"
+#include "production_reorder.h"
 #include "instantiation.h"
 #include "io_link.h"
 #include "reinforcement_learning.h"
@@ -39,6 +40,7 @@
 #include "soar_rand.h"
 #include "stats.h"
 #include "symbol.h"
+#include "symbol_manager.h"
 #include "working_memory_activation.h"
 #include "working_memory.h"
 #include "xml.h"
@@ -262,6 +264,7 @@ void reset_statistics(agent* thisAgent)
     thisAgent->start_dc_production_firing_count = 0;
     thisAgent->wme_addition_count = 0;
     thisAgent->wme_removal_count = 0;
+    thisAgent->wme_cancel_count = 0;
     thisAgent->max_wm_size = 0;
 
     thisAgent->start_dc_wme_addition_count = 0;
@@ -282,6 +285,11 @@ void reset_statistics(agent* thisAgent)
 
     thisAgent->inner_e_cycle_count = 0;
 
+    thisAgent->gds_elaboration_passes = 0;
+    thisAgent->gds_instantiations_explored = 0;
+    thisAgent->gds_wme_additions = 0;
+    thisAgent->gds_state_removals = 0;
+
     reset_production_firing_counts(thisAgent);
 
     reset_timers(thisAgent);
@@ -300,10 +308,8 @@ void reset_timers(agent* thisAgent)
     thisAgent->timers_cpu.reset();
     thisAgent->timers_kernel.reset();
     thisAgent->timers_phase.reset();
-#ifdef DETAILED_TIMING_STATS
     thisAgent->timers_gds.set_enabled(&(thisAgent->timers_enabled));
     thisAgent->timers_gds.reset();
-#endif
 
     thisAgent->timers_total_cpu_time.reset();
     thisAgent->timers_total_kernel_time.reset();
@@ -314,11 +320,11 @@ void reset_timers(agent* thisAgent)
     {
         thisAgent->timers_decision_cycle_phase[i].reset();
         thisAgent->timers_monitors_cpu_time[i].reset();
+        thisAgent->timers_gds_cpu_time[i].reset();
 #ifdef DETAILED_TIMING_STATS
         thisAgent->timers_ownership_cpu_time[i].reset();
         thisAgent->timers_chunking_cpu_time[i].reset();
         thisAgent->timers_match_cpu_time[i].reset();
-        thisAgent->timers_gds_cpu_time[i].reset();
 #endif
     }
 
@@ -366,6 +372,13 @@ void reinitialize_soar(agent* thisAgent)
     set_trace_setting(thisAgent, TRACE_FIRINGS_WME_TRACE_TYPE_SYSPARAM, NONE_WME_TRACE);
 
     reinitialize_agent(thisAgent);
+    thisAgent->symbolManager->compact_str_constant_names();
+
+    /* Hand the blocks emptied by the reset back to the allocator */
+    if (thisAgent->Decider->settings[DECIDER_POOL_TRIM])
+    {
+        thisAgent->memoryManager->trim_memory_pools();
+    }
 
     /* Reinitializing the various halt and stop flags */
     thisAgent->system_halted = false;
@@ -893,6 +906,13 @@ void do_one_top_level_phase(agent* thisAgent)
                 }
             }
 
+            // Rebuild productions the match profiler shows to be badly ordered
+            if (thisAgent->reorder_period && ((thisAgent->d_cycle_count % thisAgent->reorder_period) == 0))
+            {
+                reorder_productions_from_match_profile(thisAgent, DEFAULT_REORDER_PRODUCTIONS,
+                                                       thisAgent->trace_settings[TRACE_REORDER_SYSPARAM] != 0);
+            }
+
             // Count the outputs the agent generates (or times reaching max-nil-outputs without sending output)
             if (thisAgent->output_link_changed || ((++(thisAgent->run_last_output_count)) >= thisAgent->Decider->settings[DECIDER_MAX_NIL_OUTPUT_CYCLES]))
             {
@@ -995,6 +1015,12 @@ void do_one_top_level_phase(agent* thisAgent)
             {
                 print_phase(thisAgent, "\n--- END Output Phase ---\n", 1);
             }
+            thisAgent->memoryManager->sample_memory_pools(thisAgent->d_cycle_count);
+            thisAgent->symbolManager->compact_str_constant_names();
+            if (thisAgent->Decider->settings[DECIDER_POOL_TRIM])
+            {
+                thisAgent->memoryManager->trim_memory_pools_over_slack(thisAgent->Decider->settings[DECIDER_POOL_TRIM_SLACK]);
+            }
             thisAgent->current_phase = INPUT_PHASE;
             thisAgent->d_cycle_count++;
             thisAgent->WM->wma_d_cycle_count++;
@@ -3656,6 +3656,16 @@ epmem_time_id epmem_previous_episode(agent* thisAgent, epmem_time_id memory_id)
 
 #define QUERY_DEBUG 0
 
+inline bool epmem_literal_print_order(const std::pair<wme*, epmem_literal*>& a, const std::pair<wme*, epmem_literal*>& b)
+{
+    // the root literal has no cue wme and goes first
+    if (!a.first || !b.first)
+    {
+        return (!a.first && b.first);
+    }
+    return (a.first->timetag < b.first->timetag);
+}
+
 void epmem_print_retrieval_state(epmem_wme_literal_map& literals, epmem_triple_pedge_map pedge_caches[], epmem_triple_uedge_map uedge_caches[])
 {
     //std::map<epmem_node_id, std::string> tsh;
@@ -3665,7 +3675,10 @@ void epmem_print_retrieval_state(epmem_wme_literal_map& literals, epmem_triple_p
     // LITERALS
     std::cout << "subgraph cluster_literals {" << std::endl;
     std::cout << "node [fillcolor=\"#0084D1\"];" << std::endl;
-    for (epmem_wme_literal_map::iterator lit_iter = literals.begin(); lit_iter != literals.end(); lit_iter++)
+    // the literal cache is a hash map, so print it in cue wme timetag order
+    std::vector<std::pair<wme*, epmem_literal*> > sorted_literals(literals.begin(), literals.end());
+    std::sort(sorted_literals.begin(), sorted_literals.end(), epmem_literal_print_order);
+    for (std::vector<std::pair<wme*, epmem_literal*> >::iterator lit_iter = sorted_literals.begin(); lit_iter != sorted_literals.end(); lit_iter++)
     {
         epmem_literal* literal = (*lit_iter).second;
         if (literal->id_sym)
@@ -17,6 +17,7 @@
 
 #include "soar_module.h"
 #include "soar_db.h"
+#include "flat_hash.h"
 
 #include <map>
 #include <list>
@@ -498,15 +499,15 @@ typedef struct std::pair<epmem_node_id, epmem_node_id> epmem_node_pair;
 // collection classes
 typedef std::deque<epmem_literal*> epmem_literal_deque;
 typedef std::deque<epmem_node_id> epmem_node_deque;
-typedef std::map<Symbol*, int> epmem_symbol_int_map;
+typedef soar_module::flat_hash_map<Symbol*, int> epmem_symbol_int_map;
 typedef std::map<epmem_literal*, epmem_node_pair> epmem_literal_node_pair_map;
 typedef std::map<epmem_literal_node_pair, int> epmem_literal_node_pair_int_map;
-typedef std::map<epmem_node_id, Symbol*> epmem_node_symbol_map;
+typedef soar_module::flat_hash_map<epmem_node_id, Symbol*> epmem_node_symbol_map;
 typedef std::map<epmem_node_id, int> epmem_node_int_map;
 typedef std::map<epmem_symbol_literal_pair, int> epmem_symbol_literal_pair_int_map;
-typedef std::map<epmem_symbol_node_pair, int> epmem_symbol_node_pair_int_map;
+typedef soar_module::flat_hash_map<epmem_symbol_node_pair, int> epmem_symbol_node_pair_int_map;
 typedef std::map<epmem_triple, epmem_pedge*> epmem_triple_pedge_map;
-typedef std::map<wme*, epmem_literal*> epmem_wme_literal_map;
+typedef soar_module::flat_hash_map<wme*, epmem_literal*> epmem_wme_literal_map;
 typedef std::set<epmem_literal*> epmem_literal_set;
 typedef std::set<epmem_pedge*> epmem_pedge_set;
 
@@ -18,6 +18,9 @@
 #include "working_memory.h"
 #include "xml.h"
 
+#include <algorithm>
+#include <vector>
+
 void Explanation_Based_Chunker::print_current_built_rule(const char* pHeader)
 {
     if (pHeader)
@@ -84,6 +87,20 @@ void Explanation_Based_Chunker::print_merge_map(TraceMode mode)
     outputManager->printa_sf(thisAgent, "------------------------------------\n");
 }
 
+inline bool ebc_identity_print_order(const std::pair<Symbol*, uint64_t>& a, const std::pair<Symbol*, uint64_t>& b)
+{
+    if (a.second != b.second)
+    {
+        return (a.second < b.second);
+    }
+    return (a.first->hash_id < b.first->hash_id);
+}
+
+inline bool ebc_id_print_order(const std::pair<uint64_t, Identity*>& a, const std::pair<uint64_t, Identity*>& b)
+{
+    return (a.first < b.first);
+}
+
 void Explanation_Based_Chunker::print_instantiation_identities_map(TraceMode mode)
 {
     if (!thisAgent->outputManager->is_trace_enabled(mode)) return;
@@ -96,9 +113,11 @@ void Explanation_Based_Chunker::print_instantiation_identities_map(TraceMode mod
         outputManager->printa_sf(thisAgent, "EMPTY MAP\n");
     }
 
-    sym_to_id_map::iterator iter_sym;
+    // the map is a hash map, so print it in identity order
+    std::vector<std::pair<Symbol*, uint64_t> > sorted_identities(instantiation_identities->begin(), instantiation_identities->end());
+    std::sort(sorted_identities.begin(), sorted_identities.end(), ebc_identity_print_order);
 
-    for (auto iter_sym = instantiation_identities->begin(); iter_sym != instantiation_identities->end(); ++iter_sym)
+    for (auto iter_sym = sorted_identities.begin(); iter_sym != sorted_identities.end(); ++iter_sym)
     {
         outputManager->printa_sf(thisAgent, "   %y = o%u\n", iter_sym->first, iter_sym->second);
     }
@@ -119,9 +138,11 @@ void Explanation_Based_Chunker::print_id_to_identity_map(TraceMode mode)
         outputManager->printa_sf(thisAgent, "EMPTY MAP\n");
     }
 
-    id_to_join_map::iterator iter;
+    // the map is a hash map, so print it in identity order
+    std::vector<std::pair<uint64_t, Identity*> > sorted_ids(inst_id_to_identity_map->begin(), inst_id_to_identity_map->end());
+    std::sort(sorted_ids.begin(), sorted_ids.end(), ebc_id_print_order);
 
-    for (iter = inst_id_to_identity_map->begin(); iter != inst_id_to_identity_map->end(); ++iter)
+    for (auto iter = sorted_ids.begin(); iter != sorted_ids.end(); ++iter)
     {
         outputManager->printa_sf(thisAgent, "   %u = %u\n", iter->first, iter->second->get_identity());
     }
@@ -18,6 +18,8 @@
  * Each agent has a separate callback table.  The table has one entry
  * per callback type and the entry is a pointer to a list.  The list
  * contains installed callbacks, one callback per list cons cell.
+ * Callbacks are invoked one at a time across all agents; see
+ * callback.h.
  *
  * =======================================================================
  */
@@ -94,6 +96,12 @@ void soar_init_callbacks(agent* the_agent)
     }
 }
 
+std::recursive_mutex& soar_callback_mutex()
+{
+    static std::recursive_mutex m;
+    return m;
+}
+
 int callback_count(agent* the_agent, SOAR_CALLBACK_TYPE callback_type)
 {
     int count = 0;
@@ -328,14 +336,17 @@ void soar_invoke_callbacks(agent* thisAgent,
     /* REW: end 28.07.96 */
 
 
-    for (c = thisAgent->soar_callbacks[callback_type];
-            c != NIL;
-            c = c->rest)
     {
-        soar_callback* cb;
+        std::lock_guard< std::recursive_mutex > guard(soar_callback_mutex());
+        for (c = thisAgent->soar_callbacks[callback_type];
+                c != NIL;
+                c = c->rest)
+        {
+            soar_callback* cb;
 
-        cb = static_cast< soar_callback* >(c->first);
-        cb->function(thisAgent, cb->eventid, cb->data, call_data);
+            cb = static_cast< soar_callback* >(c->first);
+            cb->function(thisAgent, cb->eventid, cb->data, call_data);
+        }
     }
 
     /* REW: begin 28.07.96 */
@@ -452,8 +463,11 @@ void soar_invoke_first_callback(agent* thisAgent,
 
     soar_callback* cb;
 
-    cb = static_cast< soar_callback* >(head->first);
-    cb->function(thisAgent, cb->eventid, cb->data, call_data);
+    {
+        std::lock_guard< std::recursive_mutex > guard(soar_callback_mutex());
+        cb = static_cast< soar_callback* >(head->first);
+        cb->function(thisAgent, cb->eventid, cb->data, call_data);
+    }
 
 
     /* REW: begin 28.07.96 */
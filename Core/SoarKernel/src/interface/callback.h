@@ -25,6 +25,14 @@
  * per callback type and the entry is a pointer to a list.  The list
  * contains installed callbacks, one callback per list cons cell.
  *
+ * Agents may be stepped on separate threads (see "soar run-threads"),
+ * so callbacks are invoked while holding soar_callback_mutex(), one at
+ * a time across the whole process.  Anything else that calls out of
+ * the kernel during a run, such as RHS functions, takes it too.
+ * The lock does not make other agents safe to touch: a callback may
+ * only work on the agent it was invoked for, since the others may be in
+ * the middle of a step on other threads.
+ *
  * =======================================================================
  */
 
@@ -40,6 +48,8 @@
 #include "kernel.h"
 #include "Export.h"
 
+#include <mutex>
+
 /* --------------------------------------------------------------------
 
   All callback functions installed by the user must use the function
@@ -308,6 +318,7 @@ extern EXPORT soar_callback* soar_exists_callback_id(agent* the_agent,
         SOAR_CALLBACK_TYPE callback_type,
         soar_callback_id id);
 extern void soar_init_callbacks(agent*);
+extern EXPORT std::recursive_mutex& soar_callback_mutex();
 extern void soar_invoke_callbacks(agent* thisAgent,
                                   SOAR_CALLBACK_TYPE,
                                   soar_call_data);
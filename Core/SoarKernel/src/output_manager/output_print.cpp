@@ -44,6 +44,9 @@ void Output_Manager::printa(agent* pSoarAgent, const char* msg)
     {
 //        xml_generate_message(pSoarAgent, const_cast<char*>(msg));
         if (!pSoarAgent->output_settings->print_enabled) return;
+
+        /* The console and its column are shared by every agent */
+        std::lock_guard< std::recursive_mutex > guard(soar_callback_mutex());
         if (pSoarAgent->output_settings->callback_mode)
         {
             soar_invoke_callbacks(pSoarAgent, PRINT_CALLBACK, static_cast<soar_call_data>(const_cast<char*>(msg)));
@@ -2298,7 +2298,7 @@ production* parse_production(agent* thisAgent, const char* prod_string, unsigned
     Lexer lexer(thisAgent, prod_string);
     bool lexSuccess = lexer.get_lexeme();
 
-    bool rhs_okay, interrupt_on_match, explain_chunks;
+    bool rhs_okay, interrupt_on_match, explain_chunks, collection_match;
 
     reset_placeholder_variable_generator(thisAgent);
 
@@ -2340,6 +2340,7 @@ production* parse_production(agent* thisAgent, const char* prod_string, unsigned
     declared_support = UNDECLARED_SUPPORT;
     prod_type = USER_PRODUCTION_TYPE;
     interrupt_on_match = false;
+    collection_match = false;
     explain_chunks = false;
     while (true)
     {
@@ -2407,6 +2408,16 @@ production* parse_production(agent* thisAgent, const char* prod_string, unsigned
             }
             continue;
         }
+        if (!strcmp(lexer.current_lexeme.string(), ":collection"))
+        {
+            collection_match = true;
+            if (!lexer.get_lexeme())
+            {
+                abort_parse_production(thisAgent, name, &documentation);
+                return NULL;
+            }
+            continue;
+        }
         if (!strcmp(lexer.current_lexeme.string(), ":explain"))
         {
             explain_chunks = true;
@@ -2481,6 +2492,7 @@ production* parse_production(agent* thisAgent, const char* prod_string, unsigned
     p->documentation = documentation;
     p->declared_support = declared_support;
     p->interrupt = interrupt_on_match;
+    p->collection_match = collection_match;
     if (explain_chunks) {
         thisAgent->explanationMemory->toggle_production_watch(p);
     } else {
@@ -583,10 +583,7 @@ preference* exploration_choose_according_to_policy(agent* thisAgent, slot* s, pr
 
     // get preference values for each candidate
     // see soar_ecPrintPreferences
-    for (preference* cand = candidates; cand; cand = cand->next_candidate)
-    {
-        exploration_compute_value_of_candidate(thisAgent, cand, s);
-    }
+    exploration_compute_value_of_candidates(thisAgent, candidates, s);
 
     double top_value = candidates->numeric_value;
     bool top_rl = candidates->rl_contribution;
@@ -637,11 +634,11 @@ preference* exploration_choose_according_to_policy(agent* thisAgent, slot* s, pr
             break;
 
         case USER_SELECT_RANDOM:
-            return_val = exploration_randomly_select(candidates);
+            return_val = exploration_randomly_select(thisAgent, candidates);
             break;
 
         case USER_SELECT_SOFTMAX:
-            return_val = exploration_probabilistically_select(candidates);
+            return_val = exploration_probabilistically_select(thisAgent, candidates);
             break;
 
         case USER_SELECT_E_GREEDY:
@@ -692,10 +689,7 @@ double exploration_probability_according_to_policy(agent* thisAgent, slot* s, pr
 
     // get preference values for each candidate
     // see soar_ecPrintPreferences
-    for (preference* cand = candidates; cand; cand = cand->next_candidate)
-    {
-        exploration_compute_value_of_candidate(thisAgent, cand, s);
-    }
+    exploration_compute_value_of_candidates(thisAgent, candidates, s);
 
     switch (exploration_policy)
     {
@@ -812,7 +806,7 @@ double exploration_probability_according_to_policy(agent* thisAgent, slot* s, pr
 /***************************************************************************
  * Function     : exploration_randomly_select
  **************************************************************************/
-preference* exploration_randomly_select(preference* candidates, const bool &update_rho)
+preference* exploration_randomly_select(agent* thisAgent, preference* candidates, const bool &update_rho)
 {
     unsigned int cand_count = 0;
     for (const preference* cand = candidates; cand; cand = cand->next_candidate)
@@ -827,7 +821,7 @@ preference* exploration_randomly_select(preference* candidates, const bool &upda
     }
 
     preference* cand = candidates;
-    for (uint32_t chosen_num = SoarRandInt(cand_count - 1); chosen_num; --chosen_num)
+    for (uint32_t chosen_num = SoarRandInt(thisAgent, cand_count - 1); chosen_num; --chosen_num)
     {
         cand = cand->next_candidate;
     }
@@ -838,7 +832,7 @@ preference* exploration_randomly_select(preference* candidates, const bool &upda
 /***************************************************************************
  * Function     : exploration_probabilistically_select
  **************************************************************************/
-preference* exploration_probabilistically_select(preference* candidates)
+preference* exploration_probabilistically_select(agent* thisAgent, preference* candidates)
 {
     // IF THIS FUNCTION CHANGES, SEE soar_ecPrintPreferences
 
@@ -853,7 +847,7 @@ preference* exploration_probabilistically_select(preference* candidates)
     // if nothing positive, resort to random
     if (total_probability == 0.0)
     {
-        return exploration_randomly_select(candidates);
+        return exploration_randomly_select(thisAgent, candidates);
     }
 
     for (preference* cand = candidates; cand; cand = cand->next_candidate)
@@ -869,7 +863,7 @@ preference* exploration_probabilistically_select(preference* candidates)
     }
 
     // choose a random preference within the distribution
-    const double selected_probability = total_probability * SoarRand();
+    const double selected_probability = total_probability * SoarRand(thisAgent);
 
     // select the candidate based upon the chosen preference
     double current_sum = 0.0;
@@ -958,7 +952,7 @@ preference* exploration_boltzmann_select(agent* thisAgent, preference* candidate
         }
     }
 
-    double r = SoarRand(exptotal);
+    double r = SoarRand(thisAgent, exptotal);
     double sum = 0.0;
 
     for (c = candidates, i = expvals.begin(); c; c = c->next_candidate, i++)
@@ -995,13 +989,13 @@ preference* exploration_epsilon_greedy_select(agent* thisAgent, preference* cand
     }
 
     preference *cand;
-    if (SoarRand() < epsilon)
+    if (SoarRand(thisAgent) < epsilon)
     {
-        cand = exploration_randomly_select(candidates, false);
+        cand = exploration_randomly_select(thisAgent, candidates, false);
     }
     else
     {
-        cand = exploration_get_highest_q_value_pref(candidates);
+        cand = exploration_get_highest_q_value_pref(thisAgent, candidates);
     }
 
     unsigned int cand_count = 0;
@@ -1020,7 +1014,7 @@ preference* exploration_epsilon_greedy_select(agent* thisAgent, preference* cand
 /***************************************************************************
  * Function     : exploration_get_highest_q_value_pref
  **************************************************************************/
-preference* exploration_get_highest_q_value_pref(preference* candidates)
+preference* exploration_get_highest_q_value_pref(agent* thisAgent, preference* candidates)
 {
     preference* top_cand = candidates;
     double top_value = candidates->numeric_value;
@@ -1053,7 +1047,7 @@ preference* exploration_get_highest_q_value_pref(preference* candidates)
         }
 
         // if operators tied for highest Q-value, select among tied set at random
-        for (uint32_t chosen_num = SoarRandInt(num_max_cand - 1); chosen_num; --chosen_num)
+        for (uint32_t chosen_num = SoarRandInt(thisAgent, num_max_cand - 1); chosen_num; --chosen_num)
         {
             cand = cand->next_candidate;
 
@@ -1120,3 +1114,89 @@ void exploration_compute_value_of_candidate(agent* thisAgent, preference* cand,
         cand->numeric_value = cand->numeric_value / cand->total_preferences_for_candidate;
     }
 }
+
+/***************************************************************************
+ * Function     : exploration_compute_value_of_candidates
+ **************************************************************************/
+// fewer candidates than this are computed one at a time
+#define EXPLORATION_BATCH_MIN_CANDIDATES 8
+
+void exploration_compute_value_of_candidates(agent* thisAgent, preference* candidates, slot* s, double default_value)
+{
+    sym_to_pref_map cand_for_value;
+    sym_to_pref_map::iterator it;
+    preference* cand;
+    int num_candidates = 0;
+
+    for (cand = candidates; cand && (num_candidates < EXPLORATION_BATCH_MIN_CANDIDATES); cand = cand->next_candidate)
+    {
+        num_candidates++;
+    }
+
+    // with few candidates, rescanning the preference lists for each one is cheapest
+    if (num_candidates < EXPLORATION_BATCH_MIN_CANDIDATES)
+    {
+        for (cand = candidates; cand; cand = cand->next_candidate)
+        {
+            exploration_compute_value_of_candidate(thisAgent, cand, s, default_value);
+        }
+        return;
+    }
+
+    // initialize candidate values
+    for (cand = candidates; cand; cand = cand->next_candidate)
+    {
+        cand->total_preferences_for_candidate = 0;
+        cand->numeric_value = 0;
+        cand->rl_contribution = false;
+        cand_for_value[cand->value] = cand;
+    }
+
+    // one pass over each list, adding in the same order as
+    // exploration_compute_value_of_candidate so the sums come out identical
+
+    // all numeric indifferents
+    for (preference* pref = s->preferences[ NUMERIC_INDIFFERENT_PREFERENCE_TYPE ]; pref; pref = pref->next)
+    {
+        it = cand_for_value.find(pref->value);
+        if (it != cand_for_value.end())
+        {
+            cand = it->second;
+            cand->total_preferences_for_candidate += 1;
+            cand->numeric_value += get_number_from_symbol(pref->referent);
+
+            if (pref->inst->prod->rl_rule)
+            {
+                cand->rl_contribution = true;
+            }
+        }
+    }
+
+    // all binary indifferents
+    for (preference* pref = s->preferences[ BINARY_INDIFFERENT_PREFERENCE_TYPE ]; pref; pref = pref->next)
+    {
+        it = cand_for_value.find(pref->value);
+        if (it != cand_for_value.end())
+        {
+            cand = it->second;
+            cand->total_preferences_for_candidate += 1;
+            cand->numeric_value += get_number_from_symbol(pref->referent);
+        }
+    }
+
+    for (cand = candidates; cand; cand = cand->next_candidate)
+    {
+        // if no contributors, provide default
+        if (!cand->total_preferences_for_candidate)
+        {
+            cand->numeric_value = default_value;
+            cand->total_preferences_for_candidate = 1;
+        }
+
+        // accomodate average mode
+        if (thisAgent->numeric_indifferent_mode == NUMERIC_INDIFFERENT_MODE_AVG)
+        {
+            cand->numeric_value = cand->numeric_value / cand->total_preferences_for_candidate;
+        }
+    }
+}
@@ -443,6 +443,7 @@ bool SMem_Manager::CLI_query(const char* ltms_str, std::string** err_msg, std::s
             thisAgent->symbolManager->symbol_remove_ref(&s->attr);
             mark_slot_for_possible_removal(thisAgent, s);
         }//End of for-slots loop.
+        free_slot_index(thisAgent, root_cue_id);
         root_cue_id->id->slots = NIL;
 
         for (s = negative_cues->id->slots; s != NIL; s = s->next)
@@ -459,6 +460,7 @@ bool SMem_Manager::CLI_query(const char* ltms_str, std::string** err_msg, std::s
             thisAgent->symbolManager->symbol_remove_ref(&s->attr);
             mark_slot_for_possible_removal(thisAgent, s);
         }//End of for-slots loop.
+        free_slot_index(thisAgent, negative_cues);
         negative_cues->id->slots = NIL;
 
         thisAgent->symbolManager->symbol_remove_ref(&root_cue_id);//gets rid of cue id.
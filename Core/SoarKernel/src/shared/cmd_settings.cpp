@@ -173,7 +173,7 @@ void save_param_container::print_settings(agent* thisAgent)
     outputManager->printa_sf(thisAgent, "save percepts %---open <filename>\n");
     outputManager->printa_sf(thisAgent, "save percepts %-[--close --flush]\n");
     outputManager->printa(thisAgent,    "------------------------------------------------------\n");
-    outputManager->printa_sf(thisAgent, "save rete-network %---save <filename>\n");
+    outputManager->printa_sf(thisAgent, "save rete-network %-[--compact] --save <filename>\n");
     outputManager->printa(thisAgent,    "------------------------------------------------------\n\n");
     outputManager->printa_sf(thisAgent, "For a detailed explanation of sub-commands:  help save\n");
 
@@ -191,6 +191,10 @@ production_param_container::production_param_container(agent* new_agent): soar_m
     add(firing_counts_cmd);
     matches_cmd = new soar_module::boolean_param("matches", on, new soar_module::f_predicate<boolean>());
     add(matches_cmd);
+    match_profile_cmd = new soar_module::boolean_param("match-profile", on, new soar_module::f_predicate<boolean>());
+    add(match_profile_cmd);
+    reorder_cmd = new soar_module::boolean_param("reorder", on, new soar_module::f_predicate<boolean>());
+    add(reorder_cmd);
     memories_cmd = new soar_module::boolean_param("memory-usage", on, new soar_module::f_predicate<boolean>());
     add(memories_cmd);
     multi_attributes_cmd = new soar_module::boolean_param("optimize-attribute", on, new soar_module::f_predicate<boolean>());
@@ -243,11 +247,17 @@ void production_param_container::print_settings(agent* thisAgent)
     outputManager->printa_sf(thisAgent, "production matches %-[--names --count  ] [--assertions ]\n");
     outputManager->printa_sf(thisAgent, "                   %-[--timetags --wmes] [--retractions]\n");
     outputManager->printa(thisAgent,    "------------------------------------------------------------------\n");
+    outputManager->printa_sf(thisAgent, "production match-profile %-[--on --off --reset]\n");
+    outputManager->printa_sf(thisAgent, "production match-profile %-[n]\n");
+    outputManager->printa(thisAgent,    "------------------------------------------------------------------\n");
     outputManager->printa_sf(thisAgent, "production memory-usage   %-[options] [max] %-\n");
     outputManager->printa_sf(thisAgent, "production memory-usage   %-<production_name> %-\n");
     outputManager->printa(thisAgent,    "------------------------------------------------------------------\n");
     outputManager->printa_sf(thisAgent, "production optimize-attribute [symbol [n]]\n");
     outputManager->printa(thisAgent,    "------------------------------------------------------------------\n");
+    outputManager->printa_sf(thisAgent, "production reorder %-[n]\n");
+    outputManager->printa_sf(thisAgent, "production reorder %---period <decisions>\n");
+    outputManager->printa(thisAgent,    "------------------------------------------------------------------\n");
     outputManager->printa_sf(thisAgent, "production watch %-[--disable --enable] <prod-name>\n");
     outputManager->printa(thisAgent,    "------------------------------------------------------------------\n\n");
     outputManager->printa_sf(thisAgent, "For a detailed explanation of sub-commands:    help production\n");
@@ -157,7 +157,8 @@
 #define TRACE_GDS_WMES_SYSPARAM                  24
 #define TRACE_GDS_STATE_REMOVAL_SYSPARAM         25
 #define TRACE_ASSERTIONS_SYSPARAM                26
+#define TRACE_REORDER_SYSPARAM                   27
 /* --- Warning: if you add sysparams, be sure to update the next line! --- */
-#define HIGHEST_SYSPARAM_NUMBER                  27
+#define HIGHEST_SYSPARAM_NUMBER                  28
 
 #endif /* CORE_SOARKERNEL_SRC_SHARED_CONSTANTS_H_ */
@@ -126,6 +126,12 @@ enum Decider_settings {
     DECIDER_WAIT_SNC,
     DECIDER_EXPLORATION_POLICY,
     DECIDER_AUTO_REDUCE,
+    DECIDER_ALPHA_THREADS,
+    DECIDER_POOL_TRIM,
+    DECIDER_POOL_TRIM_SLACK,
+    DECIDER_POOL_HUGE_PAGES,
+    DECIDER_RUN_THREADS,
+    DECIDER_GC_BATCH,
     num_decider_settings
 };
 
@@ -260,6 +266,7 @@ MP_output_link,
 MP_io_wme,
 MP_slot,
 MP_gds,
+MP_parent_inst,
 MP_action,
 MP_test,
 MP_condition,
@@ -270,6 +277,7 @@ MP_saved_test,
 MP_cons_cell,
 MP_dl_cons,
 MP_rete_node,
+MP_rete_node_profile,
 MP_rete_test,
 MP_right_mem,
 MP_token,
@@ -306,6 +314,13 @@ MP_sym_triple,
 num_memory_pools
 };
 
+enum PoolBlockType
+{
+    POOL_BLOCK_HEAP,        /* from allocate_memory() */
+    POOL_BLOCK_HUGETLB,     /* mapped from reserved huge pages */
+    POOL_BLOCK_THP          /* huge-page aligned, advised for transparent huge pages */
+};
+
 enum chunkNameFormats
 {
     numberedFormat,
@@ -455,6 +470,13 @@ enum SupportType {
     DECLARED_I_SUPPORT = 2,
 };
 
+/* --- rete-net save file formats (the value is the format version number) --- */
+enum ReteNetFormat {
+    RETE_NET_COMPACT_32 = 3,
+    RETE_NET_COMPACT_64 = 4,
+    RETE_NET_SNAPSHOT = 6
+};
+
 enum SOAR_CALLBACK_TYPE             // if you change this, update soar_callback_names
 {
     NO_CALLBACK,                      /* Used for missing callback */
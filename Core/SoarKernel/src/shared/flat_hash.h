@@ -0,0 +1,420 @@
+/*************************************************************************
+ * PLEASE SEE THE FILE "license.txt" (INCLUDED WITH THIS SOFTWARE PACKAGE)
+ * FOR LICENSE AND COPYRIGHT INFORMATION.
+ *************************************************************************/
+
+/*************************************************************************
+ *
+ *  file:  flat_hash.h
+ *
+ * =======================================================================
+ *  Open-addressing hash sets and maps for the kernel's hot lookup tables.
+ *
+ *  Entries live in a single array of slots probed linearly, with a byte
+ *  per slot marking it empty, full or deleted, so a lookup touches one
+ *  or two cache lines instead of walking tree or bucket nodes.  Erased
+ *  entries leave a deleted marker behind and are swept out on the next
+ *  rehash, so erasing while iterating is safe.
+ *
+ *  A table allocates nothing until its first insert.  Small slot arrays
+ *  come from the dynamic memory pools, larger ones from allocate_memory
+ *  under HASH_TABLE_MEM_USAGE, so both show up in the memory stats.
+ *
+ *  Keys must be integers, pointers or pairs of those.  Iteration order
+ *  is unspecified, so don't use these where the order of a walk ends up
+ *  in a chunk, a trace or a retrieval.
+ * =======================================================================
+ */
+
+#ifndef FLAT_HASH_H
+#define FLAT_HASH_H
+
+#include "kernel.h"
+#include "memory_manager.h"
+
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <utility>
+
+namespace soar_module
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Key hashing
+    ///////////////////////////////////////////////////////////////////////////
+
+    /* Reduces a key to 64 bits.  The table scatters that with a Fibonacci
+     * multiply, so identity is fine for integers and pointers. */
+    template <typename K>
+    struct flat_hash_key
+    {
+        static uint64_t get(const K& key) { return static_cast<uint64_t>(key); }
+    };
+
+    template <typename K>
+    struct flat_hash_key<K*>
+    {
+        static uint64_t get(K* key) { return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(key)); }
+    };
+
+    template <typename A, typename B>
+    struct flat_hash_key< std::pair<A, B> >
+    {
+        static uint64_t get(const std::pair<A, B>& key)
+        {
+            uint64_t h = flat_hash_key<A>::get(key.first);
+            return h ^ (flat_hash_key<B>::get(key.second) + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2));
+        }
+    };
+
+    /* Slot arrays of at most this many slots are carved out of the dynamic
+     * memory pools.  Anything bigger is rare enough to go to the heap. */
+    #define FLAT_HASH_MAX_POOLED_SLOTS 64
+    #define FLAT_HASH_MIN_SLOTS 8
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Table shared by flat_hash_set and flat_hash_map
+    ///////////////////////////////////////////////////////////////////////////
+
+    template <typename K, typename V, typename KeyOf>
+    class flat_hash_table
+    {
+        protected:
+            enum { SLOT_EMPTY = 0, SLOT_FULL = 1, SLOT_DELETED = 2 };
+
+        public:
+            typedef K           key_type;
+            typedef V           value_type;
+            typedef size_t      size_type;
+
+            template <typename T, typename Table>
+            class iterator_base
+            {
+                public:
+                    typedef std::forward_iterator_tag   iterator_category;
+                    typedef T                           value_type;
+                    typedef ptrdiff_t                   difference_type;
+                    typedef T*                          pointer;
+                    typedef T&                          reference;
+
+                    iterator_base() : table(NULL), index(0) {}
+                    iterator_base(Table* pTable, size_t pIndex) : table(pTable), index(pIndex) {}
+
+                    /* lets an iterator convert to a const_iterator */
+                    template <typename T2, typename Table2>
+                    iterator_base(const iterator_base<T2, Table2>& other) : table(other.table), index(other.index) {}
+
+                    reference operator*() const { return table->slots[index]; }
+                    pointer operator->() const { return &(table->slots[index]); }
+
+                    iterator_base& operator++()
+                    {
+                        index = table->next_full(index + 1);
+                        return *this;
+                    }
+                    iterator_base operator++(int)
+                    {
+                        iterator_base lOld(*this);
+                        ++(*this);
+                        return lOld;
+                    }
+
+                    template <typename T2, typename Table2>
+                    bool operator==(const iterator_base<T2, Table2>& other) const { return index == other.index; }
+                    template <typename T2, typename Table2>
+                    bool operator!=(const iterator_base<T2, Table2>& other) const { return index != other.index; }
+
+                    Table*  table;
+                    size_t  index;
+            };
+
+            typedef iterator_base<V, flat_hash_table>                   iterator;
+            typedef iterator_base<const V, const flat_hash_table>       const_iterator;
+
+            flat_hash_table() : slots(NULL), ctrl(NULL), capacity(0), num_entries(0), occupied(0), shift(64) {}
+
+            flat_hash_table(const flat_hash_table& other) : slots(NULL), ctrl(NULL), capacity(0), num_entries(0), occupied(0), shift(64)
+            {
+                copy_from(other);
+            }
+
+            flat_hash_table& operator=(const flat_hash_table& other)
+            {
+                if (this != &other)
+                {
+                    clear();
+                    copy_from(other);
+                }
+                return *this;
+            }
+
+            ~flat_hash_table()
+            {
+                destroy_all();
+                free_slots(slots, capacity);
+            }
+
+            size_t size() const { return num_entries; }
+            bool empty() const { return num_entries == 0; }
+
+            iterator begin() { return iterator(this, next_full(0)); }
+            iterator end() { return iterator(this, capacity); }
+            const_iterator begin() const { return const_iterator(this, next_full(0)); }
+            const_iterator end() const { return const_iterator(this, capacity); }
+
+            iterator find(const K& key) { return iterator(this, find_index(key)); }
+            const_iterator find(const K& key) const { return const_iterator(this, find_index(key)); }
+            size_t count(const K& key) const { return (find_index(key) != capacity) ? 1 : 0; }
+
+            std::pair<iterator, bool> insert(const V& value)
+            {
+                bool lInserted;
+                size_t lIndex = find_or_claim(KeyOf::get(value), lInserted);
+                if (lInserted)
+                {
+                    new (&slots[lIndex]) V(value);
+                }
+                return std::make_pair(iterator(this, lIndex), lInserted);
+            }
+
+            iterator erase(iterator pos)
+            {
+                erase_index(pos.index);
+                return iterator(this, next_full(pos.index + 1));
+            }
+
+            size_t erase(const K& key)
+            {
+                size_t lIndex = find_index(key);
+                if (lIndex == capacity) return 0;
+                erase_index(lIndex);
+                return 1;
+            }
+
+            /* Keeps the slot array, which is what the kernel wants for tables
+             * cleared and refilled every instantiation. */
+            void clear()
+            {
+                if (!occupied) return;
+                destroy_all();
+                memset(ctrl, SLOT_EMPTY, capacity);
+                num_entries = occupied = 0;
+            }
+
+            void reserve(size_t pCount)
+            {
+                size_t lCapacity = FLAT_HASH_MIN_SLOTS;
+                while (lCapacity * 3 < pCount * 4) lCapacity <<= 1;
+                if (lCapacity > capacity) rehash(lCapacity);
+            }
+
+            void swap(flat_hash_table& other)
+            {
+                std::swap(slots, other.slots);
+                std::swap(ctrl, other.ctrl);
+                std::swap(capacity, other.capacity);
+                std::swap(num_entries, other.num_entries);
+                std::swap(occupied, other.occupied);
+                std::swap(shift, other.shift);
+            }
+
+        protected:
+
+            V*              slots;
+            unsigned char*  ctrl;
+            size_t          capacity;       /* zero or a power of two */
+            size_t          num_entries;    /* full slots */
+            size_t          occupied;       /* full plus deleted slots */
+            unsigned int    shift;          /* 64 - log2(capacity) */
+
+            size_t home_index(const K& key) const
+            {
+                return static_cast<size_t>((flat_hash_key<K>::get(key) * 0x9E3779B97F4A7C15ULL) >> shift);
+            }
+
+            size_t next_full(size_t pIndex) const
+            {
+                while (pIndex < capacity && ctrl[pIndex] != SLOT_FULL) ++pIndex;
+                return pIndex;
+            }
+
+            size_t find_index(const K& key) const
+            {
+                if (!num_entries) return capacity;
+                size_t lMask = capacity - 1;
+                for (size_t i = home_index(key); ; i = (i + 1) & lMask)
+                {
+                    if (ctrl[i] == SLOT_EMPTY) return capacity;
+                    if (ctrl[i] == SLOT_FULL && KeyOf::get(slots[i]) == key) return i;
+                }
+            }
+
+            /* Returns the slot holding key, or marks a slot full for it and
+             * sets pInserted so the caller can construct the entry there. */
+            size_t find_or_claim(const K& key, bool& pInserted)
+            {
+                if ((occupied + 1) * 4 > capacity * 3)
+                {
+                    rehash((num_entries + 1) * 2 > capacity ? (capacity ? capacity * 2 : FLAT_HASH_MIN_SLOTS) : capacity);
+                }
+                size_t lMask = capacity - 1;
+                size_t lTombstone = capacity;
+                for (size_t i = home_index(key); ; i = (i + 1) & lMask)
+                {
+                    if (ctrl[i] == SLOT_EMPTY)
+                    {
+                        if (lTombstone != capacity)
+                        {
+                            i = lTombstone;
+                        }
+                        else
+                        {
+                            ++occupied;
+                        }
+                        ctrl[i] = SLOT_FULL;
+                        ++num_entries;
+                        pInserted = true;
+                        return i;
+                    }
+                    if (ctrl[i] == SLOT_FULL)
+                    {
+                        if (KeyOf::get(slots[i]) == key)
+                        {
+                            pInserted = false;
+                            return i;
+                        }
+                    }
+                    else if (lTombstone == capacity)
+                    {
+                        lTombstone = i;
+                    }
+                }
+            }
+
+            void erase_index(size_t pIndex)
+            {
+                slots[pIndex].~V();
+                ctrl[pIndex] = SLOT_DELETED;
+                --num_entries;
+            }
+
+            void destroy_all()
+            {
+                for (size_t i = 0; i < capacity; ++i)
+                {
+                    if (ctrl[i] == SLOT_FULL) slots[i].~V();
+                }
+            }
+
+            void rehash(size_t pCapacity)
+            {
+                V* lOldSlots = slots;
+                unsigned char* lOldCtrl = ctrl;
+                size_t lOldCapacity = capacity;
+
+                slots = allocate_slots(pCapacity, ctrl);
+                memset(ctrl, SLOT_EMPTY, pCapacity);
+                capacity = pCapacity;
+                shift = 64;
+                for (size_t c = pCapacity; c > 1; c >>= 1) --shift;
+                num_entries = occupied = 0;
+
+                for (size_t i = 0; i < lOldCapacity; ++i)
+                {
+                    if (lOldCtrl[i] != SLOT_FULL) continue;
+                    bool lInserted;
+                    size_t lIndex = find_or_claim(KeyOf::get(lOldSlots[i]), lInserted);
+                    new (&slots[lIndex]) V(lOldSlots[i]);
+                    lOldSlots[i].~V();
+                }
+                free_slots(lOldSlots, lOldCapacity);
+            }
+
+            void copy_from(const flat_hash_table& other)
+            {
+                if (!other.num_entries) return;
+                reserve(other.num_entries);
+                for (size_t i = 0; i < other.capacity; ++i)
+                {
+                    if (other.ctrl[i] == SLOT_FULL) insert(other.slots[i]);
+                }
+            }
+
+            /* The slots and their control bytes share one allocation. */
+            static V* allocate_slots(size_t pCapacity, unsigned char*& pCtrl)
+            {
+                size_t lBytes = pCapacity * (sizeof(V) + 1);
+                Memory_Manager& lMPM = Memory_Manager::Get_MPM();
+                V* lSlots;
+            #if MEM_POOLS_ENABLED
+                if (pCapacity <= FLAT_HASH_MAX_POOLED_SLOTS)
+                {
+                    lMPM.allocate_with_shared_pool(lMPM.get_memory_pool(lBytes), &lSlots);
+                }
+                else
+            #endif
+                {
+                    lSlots = static_cast<V*>(lMPM.allocate_shared_memory(lBytes, HASH_TABLE_MEM_USAGE));
+                }
+                pCtrl = reinterpret_cast<unsigned char*>(lSlots + pCapacity);
+                return lSlots;
+            }
+
+            static void free_slots(V* pSlots, size_t pCapacity)
+            {
+                if (!pSlots) return;
+                Memory_Manager& lMPM = Memory_Manager::Get_MPM();
+            #if MEM_POOLS_ENABLED
+                if (pCapacity <= FLAT_HASH_MAX_POOLED_SLOTS)
+                {
+                    lMPM.free_with_shared_pool(lMPM.get_memory_pool(pCapacity * (sizeof(V) + 1)), pSlots);
+                    return;
+                }
+            #endif
+                lMPM.free_shared_memory(pSlots, HASH_TABLE_MEM_USAGE);
+            }
+    };
+
+    template <typename K>
+    struct flat_hash_set_key
+    {
+        static const K& get(const K& value) { return value; }
+    };
+
+    template <typename K, typename T>
+    struct flat_hash_map_key
+    {
+        static const K& get(const std::pair<K, T>& value) { return value.first; }
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    // flat_hash_set and flat_hash_map
+    ///////////////////////////////////////////////////////////////////////////
+
+    template <typename K>
+    class flat_hash_set : public flat_hash_table< K, K, flat_hash_set_key<K> >
+    {
+    };
+
+    /* Entries are std::pair<K, T> rather than std::pair<const K, T> so they
+     * can be moved on rehash.  Don't assign to ->first. */
+    template <typename K, typename T>
+    class flat_hash_map : public flat_hash_table< K, std::pair<K, T>, flat_hash_map_key<K, T> >
+    {
+        public:
+            typedef T mapped_type;
+
+            T& operator[](const K& key)
+            {
+                bool lInserted;
+                size_t lIndex = this->find_or_claim(key, lInserted);
+                if (lInserted)
+                {
+                    new (&this->slots[lIndex]) std::pair<K, T>(key, T());
+                }
+                return this->slots[lIndex].second;
+            }
+    };
+}
+
+#endif
@@ -27,6 +27,7 @@ typedef struct node_varnames_struct node_varnames;
 typedef struct pi_struct parent_inst;
 typedef struct preference_struct preference;
 typedef struct production_struct production;
+typedef struct rete_fs_struct rete_fs;
 typedef struct rete_node_struct rete_node;
 typedef struct rete_test_struct rete_test;
 typedef struct rhs_function_struct rhs_function;
@@ -54,6 +55,8 @@ typedef unsigned short rete_node_level;
 class soar_timer;
 class Soar_Instance;
 class Memory_Manager;
+class MTRand;
+class Worker_Pool;
 class Symbol_Manager;
 
 class SoarDecider;
@@ -45,6 +45,12 @@
  * because of a sequence of dependent instantiation firings in the top state.
  * - This option was turned on in Soar 6 to 8.6 and turned off in 9.0 to 9.5.1b
  */
+/* COMPACT_TOKENS: Use a smaller rete token (104 instead of 112 bytes on 64-bit
+ * builds), with the fields join tests read grouped at the front.  Tokens in the
+ * left hash table no longer cache their hash referent, so bucket scans and token
+ * removal read it from the token's wme instead.  "scons --compact-tokens"
+ * builds with it on.
+ */
 /*  RETE stat tracking                     Note:  May be broken right now though bug might be superficial */
 
 #define BUG_139_WORKAROUND
@@ -53,6 +59,7 @@
 //#define TOKEN_SHARING_STATS           /* get statistics on token counts with and without sharing */
 //#define SHARING_FACTORS               /* gather statistics on beta node sharing */
 //#define NULL_ACTIVATION_STATS         /* gather statistics on null activation */
+//#define COMPACT_TOKENS                /* smaller rete tokens; see token_struct in rete.h */
 
 /* Timer settings */
 //#define NO_TIMING_STUFF             /* Eliminates all timing statistics. */
@@ -71,7 +78,6 @@
 /* =============================== */
 #ifdef SOAR_RELEASE_VERSION
 
-    //#define MEMORY_POOL_STATS
     #define MEM_POOLS_ENABLED 1
     #ifdef MEM_POOLS_ENABLED
         #define USE_MEM_POOL_ALLOCATORS 1
@@ -81,7 +87,6 @@
     /* Memory settings */
 
     //#define DEBUG_MEMORY            /* Fills with garbage on deallocation. Can be set to also zero out memory on init.*/
-    //#define MEMORY_POOL_STATS             /* Collects memory pool stats for stats command */
     #define MEM_POOLS_ENABLED 1             /* Whether to use memory pools or the heap for allocation */
     #ifdef MEM_POOLS_ENABLED
         #define USE_MEM_POOL_ALLOCATORS 1   /* Whether to use custom STL allocators that use memory pools */
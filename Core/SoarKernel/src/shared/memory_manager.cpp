@@ -7,8 +7,17 @@
 #include "sml_Names.h"
 #include "stats.h"
 
+#include <algorithm>
 #include <iostream>
+#include <mutex>
 #include <stdlib.h>
+#include <vector>
+#ifdef __GLIBC__
+#include <malloc.h> // malloc_trim
+#endif
+#ifdef __linux__
+#include <sys/mman.h> // huge page blocks
+#endif
 
 /* ====================================================================
 
@@ -38,21 +47,67 @@
    to a gradually decreasing CPU cache hit ratio, make this a larger
    number, must be prime */
 #define DEFAULT_BLOCK_SIZE 0x7FF0   /* about 32K bytes per block */
+#define MAX_TRIM_WAIT 1024          /* see trim_memory_pools_over_slack() */
 
 #define POOL_NAME_ERR_MSG_LENGTH = 64 + 2 * MAX_POOL_NAME_LENGTH
 
+/* --- every manager in the process, most recently created first --- */
+static Memory_Manager* managers_in_use = NIL;
+
+static std::mutex& managers_in_use_mutex()
+{
+    static std::mutex m;
+    return m;
+}
+
 Memory_Manager::Memory_Manager()
 {
     memory_for_usage_overhead = memory_for_usage + STATS_OVERHEAD_MEM_USAGE;
+    memory_pools_in_use = NIL;
+    trim_baseline = 0;
+    trim_wait = 1;
+    trim_countdown = 0;
+    huge_pages = false;
+    pool_history_cycles = NIL;
+    pool_history = NIL;
+    pool_history_next = 0;
+    pool_history_count = 0;
+    string_arena = NIL;
+    shared_locking = false;
 
     for (int i = 0; i < NUM_MEM_USAGE_CODES; i++)
     {
         memory_for_usage[i] = 0;
     }
+
+    std::lock_guard< std::mutex > lock(managers_in_use_mutex());
+    prev_manager = NIL;
+    next_manager = managers_in_use;
+    if (managers_in_use)
+    {
+        managers_in_use->prev_manager = this;
+    }
+    managers_in_use = this;
 }
 
 Memory_Manager::~Memory_Manager()
 {
+    {
+        std::lock_guard< std::mutex > lock(managers_in_use_mutex());
+        if (prev_manager)
+        {
+            prev_manager->next_manager = next_manager;
+        }
+        else
+        {
+            managers_in_use = next_manager;
+        }
+        if (next_manager)
+        {
+            next_manager->prev_manager = prev_manager;
+        }
+    }
+
     /* Releasing memory pools */
     memory_pool* cur_pool = memory_pools_in_use;
     memory_pool* next_pool;
@@ -69,6 +124,16 @@ Memory_Manager::~Memory_Manager()
         delete it->second;
     }
     dyn_memory_pools.clear();
+
+    delete[] pool_history_cycles;
+    delete[] pool_history;
+
+    while (string_arena)
+    {
+        string_arena_chunk* next_chunk = string_arena->next;
+        free_memory(string_arena, STRING_MEM_USAGE);
+        string_arena = next_chunk;
+    }
 }
 
 void Memory_Manager::init_memory_pool_by_ptr(memory_pool* pThisPool, size_t item_size, const char* name)
@@ -86,6 +151,7 @@ void Memory_Manager::init_memory_pool_by_ptr(memory_pool* pThisPool, size_t item
     pThisPool->item_size = item_size;
     pThisPool->items_per_block = DEFAULT_BLOCK_SIZE / item_size;
     pThisPool->num_blocks = 0;
+    pThisPool->num_items = 0;
     pThisPool->first_block = NIL;
     pThisPool->free_list = NIL;
     pThisPool->next = memory_pools_in_use;
@@ -104,10 +170,10 @@ void Memory_Manager::init_memory_pool_by_ptr(memory_pool* pThisPool, size_t item
     strncpy(pThisPool->name, name, MAX_POOL_NAME_LENGTH);
     pThisPool->name[MAX_POOL_NAME_LENGTH - 1] = 0; /* ensure null termination */
 
-    #ifdef MEMORY_POOL_STATS
-        pThisPool->used_count = 0;
-    #endif
-
+    pThisPool->used_count = 0;
+    pThisPool->high_water = 0;
+    pThisPool->alloc_count = 0;
+    pThisPool->free_count = 0;
 }
 
 void Memory_Manager::init_memory_pool(MemoryPoolType mempool_index, size_t item_size, const char* name)
@@ -121,6 +187,7 @@ void Memory_Manager::init_memory_pool(MemoryPoolType mempool_index, size_t item_
 memory_pool* Memory_Manager::get_memory_pool(size_t size)
 {
     memory_pool* return_val = NULL;
+    std::unique_lock< std::mutex > guard(shared_guard());
 
     std::unordered_map< size_t, memory_pool* >::iterator it = dyn_memory_pools.find(size);
     if (it == dyn_memory_pools.end())
@@ -143,19 +210,23 @@ memory_pool* Memory_Manager::get_memory_pool(size_t size)
 void Memory_Manager::free_memory_pool_by_ptr(memory_pool* pThisPool)
 {
 //    std::cout << "Free memory pool called for" << pThisPool->name << std::endl;
-    char* cur_block = static_cast<char*>(pThisPool->first_block);
-    char* next_block;
-    for (size_t i = 0; i < pThisPool->num_blocks; i++)
+    pool_block* cur_block = pThisPool->first_block;
+    pool_block* next_block;
+    while (cur_block != NIL)
     {
         //std::cout << "Free memory block for " << pThisPool->name << std::endl;
-        // the first 4 bytes point to the next block
-        next_block = *(char**)cur_block;
-        free_memory(cur_block, POOL_MEM_USAGE);
+        next_block = cur_block->next;
+        free_pool_block(cur_block);
         cur_block = next_block;
     }
     pThisPool->num_blocks = 0;
+    pThisPool->num_items = 0;
     pThisPool->first_block = NIL;
     pThisPool->free_list = NIL;
+
+    /* --- whatever was still allocated went with the blocks --- */
+    pThisPool->free_count += pThisPool->used_count;
+    pThisPool->used_count = 0;
 }
 
 void Memory_Manager::free_memory_pool(MemoryPoolType mempool_index)
@@ -170,12 +241,8 @@ bool Memory_Manager::add_block_to_memory_pool_by_name(const std::string& pool_na
 //    size_t size, i, item_num, interleave_factor;
 //    char* item, *prev_item;
 
-    memory_pool* lThisPool;
+    memory_pool* lThisPool = find_memory_pool(pool_name);
 
-    for (lThisPool = memory_pools_in_use; lThisPool != NIL; lThisPool = lThisPool->next)
-    {
-        if (pool_name == lThisPool->name) break;
-    }
     if (!lThisPool)
         return false;
 
@@ -188,17 +255,30 @@ bool Memory_Manager::add_block_to_memory_pool_by_name(const std::string& pool_na
 
 void Memory_Manager::add_block_to_memory_pool(memory_pool* pThisPool)
 {
-    char* new_block;
-    size_t size, i, item_num, interleave_factor;
-    char* item, *prev_item;
+    pool_block* new_block = NIL;
+    size_t size, i, item_num, interleave_factor, num_items;
+    char* first_item, *item, *prev_item;
 
+    /* --- a pool that already holds a huge page's worth of items grows a huge page at a time --- */
+    if (huge_pages && (pThisPool->num_items * pThisPool->item_size >= HUGE_BLOCK_SIZE))
+    {
+        new_block = allocate_huge_block();
+    }
 
-    /* --- allocate a new block for the pool --- */
-    size = pThisPool->item_size * pThisPool->items_per_block + sizeof(char*);
-    new_block = static_cast<char*>(allocate_memory(size, POOL_MEM_USAGE));
-    *(char**)new_block = static_cast<char*>(pThisPool->first_block);
+    /* --- otherwise, or if there are no huge pages to be had, allocate an ordinary block --- */
+    if (!new_block)
+    {
+        size = pThisPool->item_size * pThisPool->items_per_block + sizeof(pool_block);
+        new_block = static_cast<pool_block*>(allocate_memory(size, POOL_MEM_USAGE));
+        new_block->num_bytes = size;
+        new_block->type = POOL_BLOCK_HEAP;
+    }
+    num_items = (new_block->num_bytes - sizeof(pool_block)) / pThisPool->item_size;
+    new_block->num_items = num_items;
+    new_block->next = pThisPool->first_block;
     pThisPool->first_block = new_block;
     pThisPool->num_blocks++;
+    pThisPool->num_items += num_items;
 
     /* somewhere in here, need to check if total mem usage exceeds limit set by user
 we only check when increasing pools, because the other memories are small by comparison,
@@ -222,27 +302,351 @@ thisAgent->Decider->settings[DECIDER_MAX_MEMORY_USAGE]);
 
     /* --- link up the new entries onto the free list --- */
     interleave_factor = DEFAULT_INTERLEAVE_FACTOR;
-    if (interleave_factor >= pThisPool->items_per_block)
+    if (interleave_factor >= num_items)
     {
         interleave_factor = 1;
     }
 
+    first_item = reinterpret_cast<char*>(new_block) + sizeof(pool_block);
     item_num = interleave_factor;
-    prev_item = new_block + sizeof(char*);   /* prev_item is item number 0 */
-    for (i = 0; i < pThisPool->items_per_block - 1; i++)
+    prev_item = first_item;   /* prev_item is item number 0 */
+    for (i = 0; i < num_items - 1; i++)
     {
-        item = new_block + sizeof(char*) + item_num * pThisPool->item_size;
+        item = first_item + item_num * pThisPool->item_size;
         *(char**)prev_item = item;
         prev_item = item;
         item_num = item_num + interleave_factor;
-        if (item_num >= pThisPool->items_per_block)
+        if (item_num >= num_items)
         {
-            item_num -= pThisPool->items_per_block;
+            item_num -= num_items;
         }
     }
     *(char**)prev_item = static_cast<char*>(pThisPool->free_list);
-    pThisPool->free_list = new_block + sizeof(char*);
+    pThisPool->free_list = first_item;
+
+}
+
+/* --------------------------------------------------------------------
+   Allocate_huge_block() gets a HUGE_BLOCK_SIZE block for a pool.  It
+   first asks for pages from the OS's reserved huge pages and, when none
+   are reserved, for a huge-page aligned block from malloc that is marked
+   for transparent huge pages.  It returns NIL where neither is supported,
+   and the pool then falls back to an ordinary block.
+-------------------------------------------------------------------- */
+
+pool_block* Memory_Manager::allocate_huge_block()
+{
+    pool_block* new_block = NIL;
+
+#ifdef __linux__
+    void* p;
+
+    #ifdef MAP_HUGETLB
+    p = mmap(NULL, HUGE_BLOCK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p != MAP_FAILED)
+    {
+        new_block = static_cast<pool_block*>(p);
+        new_block->type = POOL_BLOCK_HUGETLB;
+    }
+    #endif
+    #ifdef MADV_HUGEPAGE
+    if (!new_block && !posix_memalign(&p, HUGE_BLOCK_SIZE, HUGE_BLOCK_SIZE))
+    {
+        madvise(p, HUGE_BLOCK_SIZE, MADV_HUGEPAGE);
+        new_block = static_cast<pool_block*>(p);
+        new_block->type = POOL_BLOCK_THP;
+    }
+    #endif
+    if (new_block)
+    {
+        new_block->num_bytes = HUGE_BLOCK_SIZE;
+        memory_for_usage[POOL_MEM_USAGE] += HUGE_BLOCK_SIZE;
+    }
+#endif
+
+    return new_block;
+}
+
+void Memory_Manager::free_pool_block(pool_block* pBlock)
+{
+    switch (pBlock->type)
+    {
+#ifdef __linux__
+        case POOL_BLOCK_HUGETLB:
+            memory_for_usage[POOL_MEM_USAGE] -= pBlock->num_bytes;
+            munmap(pBlock, pBlock->num_bytes);
+            break;
+        case POOL_BLOCK_THP:
+            memory_for_usage[POOL_MEM_USAGE] -= pBlock->num_bytes;
+            free(pBlock);
+            break;
+#endif
+        default:
+            free_memory(pBlock, POOL_MEM_USAGE);
+            break;
+    }
+}
+
+/* ====================================================================
+
+                        Trimming Memory Pools
+
+   Pools only ever grow while they're in use, so a passing spike (a deep
+   substate, a large epmem retrieval) would otherwise keep its blocks
+   for the life of the agent.  Trim_memory_pool() gives back every block
+   of a pool whose items are all on the free list.  Nothing is tracked
+   per block while the agent runs; instead, the free list is walked once
+   and each free item is charged to the block it lies in, found by binary
+   search over the sorted block addresses.  The remaining free items keep
+   their order on the free list.  It returns the number of bytes released.
+
+   Trim_memory_pools() trims every pool of this manager and, where the C
+   library supports it, asks malloc to hand the freed pages back to the
+   OS.  It's used by "debug trim" and after init-soar.
+
+   Trim_memory_pools_over_slack() is the automatic policy run once per
+   decision cycle.  Once the pools hold more than slack bytes beyond what
+   they held when it last settled, it trims.  If that doesn't bring them
+   back under the limit, the memory is probably still in use, so it waits
+   twice as many calls before trying again; after MAX_TRIM_WAIT calls, it
+   accepts the current size as the new baseline.
+==================================================================== */
+
+/* Index of the block in the sorted blocks that holds item, or blocks.size() if none does */
+static size_t find_item_block(std::vector< pool_block* >& blocks, char* item, size_t item_size)
+{
+    size_t i = std::upper_bound(blocks.begin(), blocks.end(), reinterpret_cast<pool_block*>(item)) - blocks.begin();
+    if (i == 0)
+    {
+        return blocks.size();
+    }
+    i--;
+    if (item >= reinterpret_cast<char*>(blocks[i]) + sizeof(pool_block) + blocks[i]->num_items * item_size)
+    {
+        return blocks.size();
+    }
+    return i;
+}
+
+size_t Memory_Manager::trim_memory_pool(memory_pool* pThisPool)
+{
+    size_t i, released;
+    std::vector< pool_block* > blocks;
+    std::vector< size_t > free_items;
+    pool_block* block, *next_block, **prev_block;
+    char* item, *next_item, **prev_link;
+
+    if (!pThisPool->num_blocks || !pThisPool->free_list)
+    {
+        return 0;
+    }
+
+    /* --- count the free items in each block --- */
+    blocks.reserve(pThisPool->num_blocks);
+    for (block = pThisPool->first_block; block != NIL; block = block->next)
+    {
+        blocks.push_back(block);
+    }
+    std::sort(blocks.begin(), blocks.end());
+    free_items.assign(blocks.size(), 0);
+    for (item = static_cast<char*>(pThisPool->free_list); item != NIL; item = *(char**)item)
+    {
+        i = find_item_block(blocks, item, pThisPool->item_size);
+        if (i < blocks.size())
+        {
+            free_items[i]++;
+        }
+    }
+
+    /* --- mark the blocks to release by zeroing their entry --- */
+    released = 0;
+    for (i = 0; i < blocks.size(); i++)
+    {
+        if (free_items[i] == blocks[i]->num_items)
+        {
+            free_items[i] = 0;
+            released += blocks[i]->num_bytes;
+        }
+        else
+        {
+            free_items[i] = 1;
+        }
+    }
+    if (!released)
+    {
+        return 0;
+    }
+
+    /* --- take their items off the free list --- */
+    prev_link = reinterpret_cast<char**>(&(pThisPool->free_list));
+    for (item = static_cast<char*>(pThisPool->free_list); item != NIL; item = next_item)
+    {
+        next_item = *(char**)item;
+        i = find_item_block(blocks, item, pThisPool->item_size);
+        if ((i == blocks.size()) || free_items[i])
+        {
+            *prev_link = item;
+            prev_link = reinterpret_cast<char**>(item);
+        }
+    }
+    *prev_link = NIL;
+
+    /* --- unlink the blocks and free them --- */
+    prev_block = &(pThisPool->first_block);
+    for (block = pThisPool->first_block; block != NIL; block = next_block)
+    {
+        next_block = block->next;
+        i = std::lower_bound(blocks.begin(), blocks.end(), block) - blocks.begin();
+        if (free_items[i])
+        {
+            *prev_block = block;
+            prev_block = &(block->next);
+        }
+        else
+        {
+            pThisPool->num_blocks--;
+            pThisPool->num_items -= block->num_items;
+            free_pool_block(block);
+        }
+    }
+    *prev_block = NIL;
+
+    return released;
+}
+
+size_t Memory_Manager::trim_memory_pools()
+{
+    size_t released = 0;
+
+#if MEM_POOLS_ENABLED
+    for (memory_pool* p = memory_pools_in_use; p != NIL; p = p->next)
+    {
+        released += trim_memory_pool(p);
+    }
+#ifdef __GLIBC__
+    if (released)
+    {
+        malloc_trim(0);
+    }
+#endif
+#endif
+    return released;
+}
+
+/* Trim_memory_pools() for the MPM, whose pools other agents' threads may be
+   allocating from */
+size_t Memory_Manager::trim_shared_memory_pools()
+{
+    std::unique_lock< std::mutex > guard(shared_guard());
+    return trim_memory_pools();
+}
+
+void Memory_Manager::trim_memory_pools_over_slack(size_t slack)
+{
+    if (memory_for_usage[POOL_MEM_USAGE] <= trim_baseline + slack)
+    {
+        if (memory_for_usage[POOL_MEM_USAGE] < trim_baseline)
+        {
+            trim_baseline = memory_for_usage[POOL_MEM_USAGE];
+        }
+        trim_wait = 1;
+        trim_countdown = 0;
+        return;
+    }
+    if (trim_countdown)
+    {
+        trim_countdown--;
+        return;
+    }
+
+    trim_memory_pools();
+    if (memory_for_usage[POOL_MEM_USAGE] <= trim_baseline + slack)
+    {
+        trim_wait = 1;
+    }
+    else if (trim_wait >= MAX_TRIM_WAIT)
+    {
+        trim_baseline = memory_for_usage[POOL_MEM_USAGE];
+        trim_wait = 1;
+    }
+    else
+    {
+        trim_countdown = trim_wait;
+        trim_wait *= 2;
+    }
+}
+
+/* ====================================================================
+
+                       Memory Pool History
+
+   Every pool keeps running counts of its allocations, frees, live items
+   and high-water mark; they cost a couple of increments per allocation
+   and are there in every build.  To see how pools grow over a run,
+   sample_memory_pools() is called at the end of each decision cycle and
+   copies the live item and block counts of each core pool into a ring
+   holding the last POOL_HISTORY_SIZE samples.  The ring is only
+   allocated on the first sample, so the shared manager, which is never
+   sampled, doesn't pay for it.
+
+   Get_memory_pool_history() fills in one pool's samples, oldest first,
+   and returns how many there are.  Only the core pools, the ones with a
+   MemoryPoolType, have a history.
+==================================================================== */
+
+memory_pool* Memory_Manager::find_memory_pool(const std::string& pool_name)
+{
+    memory_pool* lThisPool;
+
+    for (lThisPool = memory_pools_in_use; lThisPool != NIL; lThisPool = lThisPool->next)
+    {
+        if (pool_name == lThisPool->name) break;
+    }
+    return lThisPool;
+}
 
+void Memory_Manager::sample_memory_pools(uint64_t d_cycle)
+{
+    if (!pool_history)
+    {
+        pool_history_cycles = new uint64_t[POOL_HISTORY_SIZE];
+        pool_history = new pool_sample[POOL_HISTORY_SIZE * num_memory_pools];
+    }
+
+    pool_sample* lSample = pool_history + (pool_history_next * num_memory_pools);
+    for (int i = 0; i < num_memory_pools; i++)
+    {
+        lSample[i].used_count = memory_pools[i].used_count;
+        lSample[i].num_blocks = memory_pools[i].num_blocks;
+    }
+    pool_history_cycles[pool_history_next] = d_cycle;
+
+    pool_history_next = (pool_history_next + 1) % POOL_HISTORY_SIZE;
+    if (pool_history_count < POOL_HISTORY_SIZE)
+    {
+        pool_history_count++;
+    }
+}
+
+size_t Memory_Manager::get_memory_pool_history(memory_pool* pThisPool, std::vector< uint64_t >& cycles, std::vector< pool_sample >& samples)
+{
+    size_t i, j;
+
+    cycles.clear();
+    samples.clear();
+    if (!pool_history || (pThisPool->index >= num_memory_pools))
+    {
+        return 0;
+    }
+
+    j = (pool_history_next + POOL_HISTORY_SIZE - pool_history_count) % POOL_HISTORY_SIZE;
+    for (i = 0; i < pool_history_count; i++)
+    {
+        cycles.push_back(pool_history_cycles[j]);
+        samples.push_back(pool_history[(j * num_memory_pools) + pThisPool->index]);
+        j = (j + 1) % POOL_HISTORY_SIZE;
+    }
+    return pool_history_count;
 }
 
 /* ====================================================================
@@ -254,7 +658,9 @@ thisAgent->Decider->settings[DECIDER_MAX_MEMORY_USAGE]);
    the inverse of allocate_memory().  Allocate_memory_and_zerofill()
    does the obvious thing.  These routines take a usage_code indicating
    what purpose the memory is for (hash tables, strings, etc.).  This
-   is used purely for statistics keeping.
+   is used purely for statistics keeping.  Allocate_shared_memory() and
+   free_shared_memory() do the same for the MPM, holding its lock while
+   agents are stepping in parallel.
 
    Print_memory_statistics() prints out stats on the memory usage.
 ==================================================================== */
@@ -319,6 +725,251 @@ void Memory_Manager::free_memory(void* mem, int usage_code)
     free(mem);
 }
 
+void* Memory_Manager::allocate_shared_memory(size_t size, int usage_code)
+{
+    std::unique_lock< std::mutex > guard(shared_guard());
+    return allocate_memory(size, usage_code);
+}
+
+void Memory_Manager::free_shared_memory(void* mem, int usage_code)
+{
+    std::unique_lock< std::mutex > guard(shared_guard());
+    free_memory(mem, usage_code);
+}
+
+/* --------------------------------------------------------------------
+                            String Arena
+
+   Make_arena_string() copies a string into the string arena, a list of
+   chunks that strings are packed into back to back with no per-string
+   header.  The first chunk is STRING_ARENA_MIN_CHUNK_SIZE and each new
+   one doubles the arena, up to STRING_ARENA_MAX_CHUNK_SIZE a chunk.  Strings longer than
+   STRING_ARENA_MAX_STRING get a block of their own instead, so
+   free_arena_string() can tell the two apart by length.  Freeing an
+   arena string only updates the counts, and once none are left the
+   arena is emptied.
+
+   When string_arena_is_sparse() says most of the arena is freed space,
+   the owner calls begin_string_arena_compaction(), passes every live
+   arena string to move_arena_string() and stores the copy it returns,
+   then hands the old chunks to end_string_arena_compaction().  The
+   owner must move every live string, since the old chunks are freed.
+-------------------------------------------------------------------- */
+
+/* What a string would take as a block of its own: allocate_memory()'s
+   size word, malloc's size word, and malloc's usual rounding */
+static inline size_t separate_block_bytes(size_t num_bytes)
+{
+    size_t n = (num_bytes + 4 * sizeof(size_t) - 1) & ~(2 * sizeof(size_t) - 1);
+    return (n < 4 * sizeof(size_t)) ? 4 * sizeof(size_t) : n;
+}
+
+char* Memory_Manager::allocate_arena_bytes(size_t num_bytes)
+{
+    string_arena_chunk* chunk = string_arena;
+    char* p;
+
+    if (!chunk || (chunk->used_bytes + num_bytes > chunk->num_bytes))
+    {
+        size_t chunk_size = std::min(std::max(string_arena_counts.chunk_bytes, static_cast<size_t>(STRING_ARENA_MIN_CHUNK_SIZE)), static_cast<size_t>(STRING_ARENA_MAX_CHUNK_SIZE));
+        chunk = static_cast<string_arena_chunk*>(allocate_memory(chunk_size, STRING_MEM_USAGE));
+        chunk->next = string_arena;
+        chunk->num_bytes = chunk_size;
+        chunk->used_bytes = sizeof(string_arena_chunk);
+        string_arena = chunk;
+        string_arena_counts.num_chunks++;
+        string_arena_counts.chunk_bytes += chunk_size;
+    }
+    p = reinterpret_cast<char*>(chunk) + chunk->used_bytes;
+    chunk->used_bytes += num_bytes;
+
+    string_arena_counts.used_bytes += num_bytes;
+    string_arena_counts.live_bytes += num_bytes;
+    string_arena_counts.live_strings++;
+    string_arena_counts.separate_bytes += separate_block_bytes(num_bytes);
+    return p;
+}
+
+char* Memory_Manager::make_arena_string(char const* s)
+{
+    size_t num_bytes = strlen(s) + 1;
+    char* p;
+
+    if (num_bytes > STRING_ARENA_MAX_STRING)
+    {
+        p = static_cast<char*>(allocate_memory(num_bytes, STRING_MEM_USAGE));
+    }
+    else
+    {
+        p = allocate_arena_bytes(num_bytes);
+    }
+    memcpy(p, s, num_bytes);
+    return p;
+}
+
+void Memory_Manager::free_arena_string(char* s)
+{
+    size_t num_bytes = strlen(s) + 1;
+    string_arena_chunk* chunk;
+
+    if (num_bytes > STRING_ARENA_MAX_STRING)
+    {
+        free_memory(s, STRING_MEM_USAGE);
+        return;
+    }
+    fill_with_garbage(s, num_bytes);
+    string_arena_counts.live_bytes -= num_bytes;
+    string_arena_counts.separate_bytes -= separate_block_bytes(num_bytes);
+    if (--string_arena_counts.live_strings)
+    {
+        return;
+    }
+
+    /* --- nothing left, so keep just the newest chunk and start it over --- */
+    while ((chunk = string_arena->next) != NIL)
+    {
+        string_arena->next = chunk->next;
+        string_arena_counts.num_chunks--;
+        string_arena_counts.chunk_bytes -= chunk->num_bytes;
+        free_memory(chunk, STRING_MEM_USAGE);
+    }
+    string_arena->used_bytes = sizeof(string_arena_chunk);
+    string_arena_counts.used_bytes = 0;
+}
+
+bool Memory_Manager::string_arena_is_sparse()
+{
+    return (string_arena_counts.used_bytes > STRING_ARENA_MAX_CHUNK_SIZE) && (string_arena_counts.live_bytes * 2 < string_arena_counts.used_bytes);
+}
+
+string_arena_chunk* Memory_Manager::begin_string_arena_compaction()
+{
+    string_arena_chunk* old_chunks = string_arena;
+
+    string_arena = NIL;
+    string_arena_counts = string_arena_stats();
+    return old_chunks;
+}
+
+char* Memory_Manager::move_arena_string(char* s)
+{
+    size_t num_bytes = strlen(s) + 1;
+    char* p;
+
+    if (num_bytes > STRING_ARENA_MAX_STRING)
+    {
+        return s;
+    }
+    p = allocate_arena_bytes(num_bytes);
+    memcpy(p, s, num_bytes);
+    return p;
+}
+
+size_t Memory_Manager::end_string_arena_compaction(string_arena_chunk* old_chunks)
+{
+    string_arena_chunk* chunk;
+    size_t old_chunk_bytes = 0;
+
+    while ((chunk = old_chunks) != NIL)
+    {
+        old_chunks = chunk->next;
+        old_chunk_bytes += chunk->num_bytes;
+        free_memory(chunk, STRING_MEM_USAGE);
+    }
+    if (old_chunk_bytes <= string_arena_counts.chunk_bytes)
+    {
+        return 0;
+    }
+    return old_chunk_bytes - string_arena_counts.chunk_bytes;
+}
+
+/* --------------------------------------------------------------------
+                        Totals Across Managers
+
+   Get_total_memory_usage() fills in usage[] (NUM_MEM_USAGE_CODES
+   entries) with the memory used for each purpose, summed over every
+   manager in the process.  Get_total_memory_pools() does the same for
+   the pools: same-named pools with the same item size, e.g. every
+   agent's "token" pool, are combined into one entry, and
+   get_total_string_arena_stats() adds up the string arenas.  The
+   counts of other agents are read without stopping them, so they're
+   only a snapshot if those agents are running on other threads.
+-------------------------------------------------------------------- */
+
+void Memory_Manager::get_total_memory_usage(size_t* usage)
+{
+    for (int i = 0; i < NUM_MEM_USAGE_CODES; i++)
+    {
+        usage[i] = 0;
+    }
+
+    std::lock_guard< std::mutex > lock(managers_in_use_mutex());
+    for (Memory_Manager* m = managers_in_use; m != NIL; m = m->next_manager)
+    {
+        for (int i = 0; i < NUM_MEM_USAGE_CODES; i++)
+        {
+            usage[i] += m->memory_for_usage[i];
+        }
+    }
+}
+
+void Memory_Manager::get_total_memory_pools(std::vector< memory_pool >& pools)
+{
+    size_t i;
+
+    pools.clear();
+
+    std::lock_guard< std::mutex > lock(managers_in_use_mutex());
+    for (Memory_Manager* m = managers_in_use; m != NIL; m = m->next_manager)
+    {
+        for (memory_pool* p = m->memory_pools_in_use; p != NIL; p = p->next)
+        {
+            for (i = 0; i < pools.size(); i++)
+            {
+                if ((pools[i].item_size == p->item_size) && !strcmp(pools[i].name, p->name))
+                {
+                    break;
+                }
+            }
+            if (i == pools.size())
+            {
+                pools.push_back(*p);
+                pools[i].num_blocks = 0;
+                pools[i].num_items = 0;
+                pools[i].used_count = 0;
+                pools[i].high_water = 0;
+                pools[i].alloc_count = 0;
+                pools[i].free_count = 0;
+                pools[i].next = NIL;
+            }
+            pools[i].num_blocks += p->num_blocks;
+            pools[i].num_items += p->num_items;
+            pools[i].used_count += p->used_count;
+            pools[i].high_water += p->high_water;
+            pools[i].alloc_count += p->alloc_count;
+            pools[i].free_count += p->free_count;
+        }
+    }
+}
+
+void Memory_Manager::get_total_string_arena_stats(string_arena_stats& stats)
+{
+    stats = string_arena_stats();
+
+    std::lock_guard< std::mutex > lock(managers_in_use_mutex());
+    for (Memory_Manager* m = managers_in_use; m != NIL; m = m->next_manager)
+    {
+        stats.num_chunks += m->string_arena_counts.num_chunks;
+        stats.chunk_bytes += m->string_arena_counts.chunk_bytes;
+        stats.used_bytes += m->string_arena_counts.used_bytes;
+        stats.live_bytes += m->string_arena_counts.live_bytes;
+        stats.live_strings += m->string_arena_counts.live_strings;
+        stats.separate_bytes += m->string_arena_counts.separate_bytes;
+    }
+    /* chunk sizes are multiples of the malloc granularity, so each costs two size words more */
+    stats.saved_bytes = static_cast<int64_t>(stats.separate_bytes) - static_cast<int64_t>(stats.chunk_bytes + stats.num_chunks * 2 * sizeof(size_t));
+}
+
 void Memory_Manager::print_memory_statistics()
 {
     size_t total;
@@ -610,26 +1261,18 @@ void Memory_Manager::debug_print_memory_stats(agent* thisAgent)
     std::cout << std::setw(8) << thisAgent->memoryManager->memory_for_usage[MISCELLANEOUS_MEM_USAGE] << " bytes for miscellaneous other things\n";
 
     std::cout << "Memory pool statistics:\n\n";
-#ifdef MEMORY_POOL_STATS
     std::cout << "Pool Name        Used Items  Free Items  Item Size  Itm/Blk  Blocks  Total Bytes\n";
     std::cout << "---------------  ----------  ----------  ---------  -------  ------  -----------\n";
-#else
-    std::cout << "Pool Name        Item Size  Itm/Blk  Blocks  Total Bytes\n";
-    std::cout << "---------------  ---------  -------  ------  -----------\n";
-#endif
 
     for (memory_pool* p = memory_pools_in_use; p != NIL; p = p->next)
     {
         std::cout << std::setw(MAX_POOL_NAME_LENGTH) << p->name;
-#ifdef MEMORY_POOL_STATS
         std::cout << "  " << std::setw(10) << p->used_count;
-        size_t total_items = p->num_blocks * p->items_per_block;
-        std::cout << "  " << std::setw(10) << total_items - p->used_count;
-#endif
+        std::cout << "  " << std::setw(10) << p->num_items - p->used_count;
         std::cout << "  " << std::setw(9) << p->item_size;
         std::cout << "  " << std::setw(7) << p->items_per_block;
         std::cout << "  " << std::setw(6) << p->num_blocks;
-        std::cout << "  " << std::setw(11) << p->num_blocks* p->items_per_block* p->item_size;
+        std::cout << "  " << std::setw(11) << p->num_items * p->item_size;
         std::cout << "\n";
     }
 
@@ -10,19 +10,47 @@
  * A memory manager class that decouples memory pools from the individual
  * agent.
  *
- * - MPM is a singleton like the OutputManager and SoarInstance.  It
- *   is created on Kernel creation.
+ * - Each agent creates its own Memory_Manager, so agents never share a
+ *   free list and can be run on separate threads.  The agent's manager
+ *   and all of the blocks in its pools are released when the agent is
+ *   destroyed.
+ *
+ * - There is also one process-wide MPM, a singleton like the
+ *   OutputManager and SoarInstance, created on Kernel creation.  It
+ *   holds memory that isn't owned by any one agent, which is currently
+ *   the dynamic pools used by the STL pool allocators.  So only the core
+ *   pools are per agent: the STL containers of every agent still draw
+ *   from the MPM's shared pools.  Agents stepped on separate threads
+ *   share it, so it is only used through the *_shared_* calls and
+ *   get_memory_pool().  Those take its lock, but only while the run
+ *   scheduler has agents stepping in parallel (set_shared_locking()),
+ *   so a run on one thread pays nothing for it.
  *
  * - MPM uses an enum list for all the core memory pool types.  Kernel
  *   calls that deal with memory pools now pass in a parameter to
  *   specify which pool instead of the actual pool itself (which was
  *   in the agent, but is now in the MPM)
  *
- * - Memory pools now have an initialized flag, since more than one
- *   agent may try to initialize a pool.
+ * - Memory pools have an initialized flag, so a pool that's already
+ *   set up is left alone if it's initialized again.
+ *
+ * - Agent caches a pointer to its manager to ease access.
+ *
+ * - Every manager in the process is kept on a list, so memory-stats
+ *   and friends can report totals summed across all of them.
  *
- * - Agent caches a pointer to MPM to ease access.  Also made
- *   refactoring slightly less painful.
+ * - With huge pages turned on, a pool that already holds a huge page's
+ *   worth of items gets its new blocks one huge page at a time, backed
+ *   by huge pages when the OS has them.
+ *
+ * - Each pool counts its allocations, frees, live items and high-water
+ *   mark in every build.  An agent's manager also samples its pools once
+ *   per decision cycle into a ring of the last POOL_HISTORY_SIZE cycles.
+ *
+ * - Short strings that live as long as a symbol, i.e. string constant
+ *   names, can be packed into a string arena instead of getting a block
+ *   each.  Freeing one only updates the arena's counts; the space comes
+ *   back when the owner moves the live strings into fresh chunks.
  *
  * =======================================================================
  */
@@ -32,8 +60,10 @@
 
 #include "kernel.h"
 
+#include <mutex>
 #include <unordered_map>
 #include <string>
+#include <vector>
 
 #ifndef _WIN32
 #include <stdlib.h> // malloc
@@ -48,21 +78,72 @@
 
 #define NUM_MEM_USAGE_CODES 5
 
+#define POOL_HISTORY_SIZE 256   /* decision cycles kept by sample_memory_pools() */
+#define HUGE_BLOCK_SIZE 0x200000    /* 2MB, the usual huge page size */
+
+#define STRING_ARENA_MIN_CHUNK_SIZE 0x400   /* 1KB, chunks double in size up to the max */
+#define STRING_ARENA_MAX_CHUNK_SIZE 0x8000  /* 32KB */
+#define STRING_ARENA_MAX_STRING 256      /* longer strings get a block of their own */
+
+/* Every pool block starts with this header; the items follow it. */
+typedef struct pool_block_struct
+{
+    struct pool_block_struct* next;  /* next block of the pool, must be first */
+    size_t num_items;                /* items carved out of this block */
+    size_t num_bytes;                /* size of the block, header included */
+    PoolBlockType type;              /* where the block's memory came from */
+} pool_block;
+
 typedef struct memory_pool_struct
 {
     void* free_list;             /* header of chain of free items */
     MemoryPoolType index;
-    size_t used_count;             /* used for statistics only when #def'd MEMORY_POOL_STATS */
+    size_t used_count;             /* items currently allocated from the pool */
+    size_t high_water;             /* largest used_count seen */
+    uint64_t alloc_count;          /* items ever allocated */
+    uint64_t free_count;           /* items ever freed */
     size_t item_size;               /* bytes per item */
-    size_t items_per_block;        /* number of items in each big block */
+    size_t items_per_block;        /* number of items in each ordinary big block */
     size_t num_blocks;             /* number of big blocks in use by this pool */
-    void* first_block;           /* header of chain of blocks */
+    size_t num_items;              /* number of items in all of those blocks */
+    pool_block* first_block;       /* header of chain of blocks */
     char name[MAX_POOL_NAME_LENGTH];  /* name of the pool (for memory-stats) */
     bool initialized;
     struct memory_pool_struct* next;  /* next in list of all memory pools */
-    memory_pool_struct() : initialized(false) {}
+    memory_pool_struct() : used_count(0), high_water(0), alloc_count(0), free_count(0), num_blocks(0), num_items(0), initialized(false) {}
 } memory_pool;
 
+/* Every string arena chunk starts with this header; the strings follow it. */
+typedef struct string_arena_chunk_struct
+{
+    struct string_arena_chunk_struct* next;  /* the chunk being filled is first */
+    size_t num_bytes;                        /* size of the chunk, header included */
+    size_t used_bytes;                       /* bytes handed out, header included */
+} string_arena_chunk;
+
+/* Counts for a string arena.  For memory-stats, separate_bytes is what
+ * the live strings would take if each had a block of its own, and
+ * saved_bytes is that less what the chunks take, malloc's overhead
+ * included in both. */
+typedef struct string_arena_stats_struct
+{
+    size_t num_chunks;
+    size_t chunk_bytes;
+    size_t used_bytes;              /* strings handed out, live or freed */
+    size_t live_bytes;
+    size_t live_strings;
+    size_t separate_bytes;
+    int64_t saved_bytes;            /* only filled in by get_total_string_arena_stats() */
+    string_arena_stats_struct() : num_chunks(0), chunk_bytes(0), used_bytes(0), live_bytes(0), live_strings(0), separate_bytes(0), saved_bytes(0) {}
+} string_arena_stats;
+
+/* One pool's entry in a memory pool history sample */
+typedef struct pool_sample_struct
+{
+    size_t used_count;
+    size_t num_blocks;
+} pool_sample;
+
 /* ----------------------- */
 /* basic memory allocation */
 /* ----------------------- */
@@ -93,27 +174,23 @@ typedef struct memory_pool_struct
     #define fill_with_zeroes(block,size) { }
 #endif
 
-#ifdef MEMORY_POOL_STATS
-
 template <typename P>
 inline void increment_used_count(P p)
 {
-    (p)->used_count++;
+    (p)->alloc_count++;
+    if (++((p)->used_count) > (p)->high_water)
+    {
+        (p)->high_water = (p)->used_count;
+    }
 }
 
 template <typename P>
 inline void decrement_used_count(P p)
 {
+    (p)->free_count++;
     (p)->used_count--;
 }
 
-#else
-
-#define increment_used_count(p) { }
-#define decrement_used_count(p) { }
-
-#endif /* MEMORY_POOL_STATS */
-
 class Memory_Manager
 {
         /* CLI is a friend because it prints out mempool stats */
@@ -125,6 +202,7 @@ class Memory_Manager
             static Memory_Manager instance;
             return instance;
         }
+        Memory_Manager();
         virtual ~Memory_Manager();
 
         void init_memory_pool(MemoryPoolType mempool_index, size_t item_size, const char* name);
@@ -134,21 +212,49 @@ class Memory_Manager
         void add_block_to_memory_pool(memory_pool* pThisPool);
         bool add_block_to_memory_pool_by_name(const std::string& pool_name, int blocks);
 
+        size_t trim_memory_pool(memory_pool* pThisPool);
+        size_t trim_memory_pools();
+        size_t trim_shared_memory_pools();
+        void set_shared_locking(bool on)
+        {
+            shared_locking = on;
+        }
+        void trim_memory_pools_over_slack(size_t slack);
+
+        void set_huge_pages(bool on) { huge_pages = on; }
+
+        memory_pool* find_memory_pool(const std::string& pool_name);
+        void sample_memory_pools(uint64_t d_cycle);
+        size_t get_memory_pool_history(memory_pool* pThisPool, std::vector< uint64_t >& cycles, std::vector< pool_sample >& samples);
+
         memory_pool* get_memory_pool(size_t size);
         void* allocate_memory(size_t size, int usage_code);
         void* allocate_memory_and_zerofill(size_t size, int usage_code);
         void free_memory(void* mem, int usage_code);
+        void* allocate_shared_memory(size_t size, int usage_code);
+        void free_shared_memory(void* mem, int usage_code);
+
+        char* make_arena_string(char const* s);
+        void free_arena_string(char* s);
+        bool string_arena_is_sparse();
+        string_arena_chunk* begin_string_arena_compaction();
+        char* move_arena_string(char* s);
+        size_t end_string_arena_compaction(string_arena_chunk* old_chunks);
 
         void print_memory_statistics();
         void debug_print_memory_stats(agent* thisAgent);
 
+        /* Totals across every manager in the process.  Pools with the same
+         * name and item size are combined into a single entry. */
+        static void get_total_memory_usage(size_t* usage);
+        static void get_total_memory_pools(std::vector< memory_pool >& pools);
+        static void get_total_string_arena_stats(string_arena_stats& stats);
+
         std::unordered_map< size_t, memory_pool* >   dyn_memory_pools;
 
     private:
 
-        Memory_Manager();
-
-        /* The following two functions are declared but not implemented to avoid copies of singletons */
+        /* The following two functions are declared but not implemented to avoid copies of managers */
         Memory_Manager(Memory_Manager const&) {};
         void operator=(Memory_Manager const&) {};
 
@@ -157,7 +263,36 @@ class Memory_Manager
         memory_pool*        memory_pools_in_use;
         size_t*             memory_for_usage_overhead;
 
+        Memory_Manager*     next_manager;   /* list of all managers, for the totals above */
+        Memory_Manager*     prev_manager;
+
+        size_t              trim_baseline;  /* pool bytes when trim_memory_pools_over_slack() last settled */
+        uint64_t            trim_wait;      /* calls to wait between unsuccessful trims */
+        uint64_t            trim_countdown; /* calls left before the next trim is tried */
+
+        bool                huge_pages;     /* give pools that have grown large huge-page blocks */
+
+        uint64_t*           pool_history_cycles;  /* ring of POOL_HISTORY_SIZE samples, allocated on first use */
+        pool_sample*        pool_history;         /* num_memory_pools entries per sample */
+        size_t              pool_history_next;
+        size_t              pool_history_count;
+
+        string_arena_chunk* string_arena;         /* chunks of the string arena, NIL until first used */
+        string_arena_stats  string_arena_counts;
+
+        std::mutex          shared_lock;    /* see the *_shared_* calls */
+        bool                shared_locking; /* take shared_lock; set for parallel steps */
+
+        /* shared_lock, held if other threads may be using this manager */
+        std::unique_lock< std::mutex > shared_guard()
+        {
+            return shared_locking ? std::unique_lock< std::mutex >(shared_lock) : std::unique_lock< std::mutex >();
+        }
+
         void free_memory_pool_by_ptr(memory_pool* pThisPool);
+        pool_block* allocate_huge_block();
+        void free_pool_block(pool_block* pBlock);
+        char* allocate_arena_bytes(size_t num_bytes);
 
     public:
         template <typename T>
@@ -275,6 +410,21 @@ class Memory_Manager
         //   p=p;
         #endif // !MEM_POOLS_ENABLED
         }
+
+        /* The same for a pool of a manager that several threads share */
+        template <typename T>
+        inline void allocate_with_shared_pool(memory_pool* pThisPool, T** dest_item_pointer)
+        {
+            std::unique_lock< std::mutex > guard(shared_guard());
+            allocate_with_pool_ptr(pThisPool, dest_item_pointer);
+        }
+
+        template <typename T>
+        inline void free_with_shared_pool(memory_pool* pThisPool, T* item)
+        {
+            std::unique_lock< std::mutex > guard(shared_guard());
+            free_with_pool_ptr(pThisPool, item);
+        }
 //
 //        /* Memory pools */
 //        memory_pool         float_constant_pool;
@@ -90,7 +90,7 @@ namespace soar_module
                 //assert (n==1);
                 pointer t;
                 //assert(mem_pool);
-                memory_manager->allocate_with_pool_ptr(mem_pool, &t);
+                memory_manager->allocate_with_shared_pool(mem_pool, &t);
                 // assert(t);
                 return t;
             }
@@ -101,7 +101,7 @@ namespace soar_module
                 if (p)
                 {
                     //assert (n==1);
-                    memory_manager->free_with_pool_ptr(mem_pool, p);
+                    memory_manager->free_with_shared_pool(mem_pool, p);
                 }
             }
 
@@ -198,11 +198,11 @@ namespace soar_module
                 if (n == 1)
                 {
                     //assert(mem_pool);
-                    memory_manager->allocate_with_pool_ptr(mem_pool, &t);
+                    memory_manager->allocate_with_shared_pool(mem_pool, &t);
                 } else {
                     memory_pool* lMem_pool = memory_manager->get_memory_pool(n*sizeof(value_type));
                     //assert(lMem_pool);
-                    memory_manager->allocate_with_pool_ptr(lMem_pool, &t);
+                    memory_manager->allocate_with_shared_pool(lMem_pool, &t);
                 }
                 //std::cout << "Dynamic memory pool allocation of size " << n << " * " << sizeof(value_type) << " requested!" << std::endl;
                 //assert(t);
@@ -216,11 +216,11 @@ namespace soar_module
                 {
                     if (n == 1)
                     {
-                        memory_manager->free_with_pool_ptr(mem_pool, p);
+                        memory_manager->free_with_shared_pool(mem_pool, p);
                     } else {
                         memory_pool* lMem_pool = memory_manager->get_memory_pool(n*sizeof(value_type));
                         //assert(lMem_pool);
-                        memory_manager->free_with_pool_ptr(lMem_pool, p);
+                        memory_manager->free_with_shared_pool(lMem_pool, p);
                     }
                 }
             }
@@ -562,6 +562,11 @@ void print_production(agent* thisAgent, production* p, bool internal)
         thisAgent->outputManager->printa(thisAgent, "    :interrupt\n");
     }
 
+    if (p->collection_match)
+    {
+        thisAgent->outputManager->printa(thisAgent, "    :collection\n");
+    }
+
     /*
     --- print the LHS and RHS ---
     */
@@ -1,28 +1,40 @@
 #include "soar_rand.h"
 
+#include "agent.h"
+
+#include <mutex>
+
+/* The generator for code outside any agent.  Agents use their own
+ * (agent::random_generator), but this one may still be reached from
+ * more than one thread, so calls take turns with it. */
 static MTRand gSoarRand;
+static std::mutex gSoarRandMutex;
 
 // real number in [0,1]
 double SoarRand()
 {
+    std::lock_guard< std::mutex > guard(gSoarRandMutex);
     return gSoarRand.rand();
 }
 
 // real number in [0,n]
 double SoarRand(const double& max)
 {
+    std::lock_guard< std::mutex > guard(gSoarRandMutex);
     return gSoarRand.rand(max);
 }
 
 // integer in [0,2^32-1]
 uint32_t SoarRandInt()
 {
+    std::lock_guard< std::mutex > guard(gSoarRandMutex);
     return gSoarRand.randInt();
 }
 
 // integer in [0,n] for n < 2^32
 uint32_t SoarRandInt(const uint32_t& max)
 {
+    std::lock_guard< std::mutex > guard(gSoarRandMutex);
     return gSoarRand.randInt(max);
 }
 
@@ -30,11 +42,45 @@ uint32_t SoarRandInt(const uint32_t& max)
 // automatically seed with a value based on the time or /dev/urandom
 void SoarSeedRNG()
 {
+    std::lock_guard< std::mutex > guard(gSoarRandMutex);
     gSoarRand.seed();
 }
 
 // seed with a provided value
 void SoarSeedRNG(const uint32_t seed)
 {
+    std::lock_guard< std::mutex > guard(gSoarRandMutex);
     gSoarRand.seed(seed);
 }
+
+/* --- an agent's own generator; only the agent's thread uses it --- */
+
+double SoarRand(agent* thisAgent)
+{
+    return thisAgent->random_generator->rand();
+}
+
+double SoarRand(agent* thisAgent, const double& max)
+{
+    return thisAgent->random_generator->rand(max);
+}
+
+uint32_t SoarRandInt(agent* thisAgent)
+{
+    return thisAgent->random_generator->randInt();
+}
+
+uint32_t SoarRandInt(agent* thisAgent, const uint32_t& max)
+{
+    return thisAgent->random_generator->randInt(max);
+}
+
+void SoarSeedRNG(agent* thisAgent)
+{
+    thisAgent->random_generator->seed();
+}
+
+void SoarSeedRNG(agent* thisAgent, const uint32_t seed)
+{
+    thisAgent->random_generator->seed(seed);
+}
@@ -473,6 +473,9 @@ inline std::istream& operator>>(std::istream& is, MTRand& mtrand)
     return is;
 }
 
+// The process-wide generator, for code that isn't running as any agent.
+// Agents each have their own generator; use the versions below that take one.
+
 // real number in [0,1]
 EXPORT double SoarRand();
 
@@ -491,6 +494,16 @@ EXPORT void SoarSeedRNG();
 // seed with a provided value
 EXPORT void SoarSeedRNG(const uint32_t seed);
 
+// The same, from an agent's own generator.  Agents don't share one, so an
+// agent's random choices only depend on its own seed and history, even when
+// agents are stepped on separate threads (see "soar run-threads").
+EXPORT double SoarRand(agent* thisAgent);
+EXPORT double SoarRand(agent* thisAgent, const double& max);
+EXPORT uint32_t SoarRandInt(agent* thisAgent);
+EXPORT uint32_t SoarRandInt(agent* thisAgent, const uint32_t& max);
+EXPORT void SoarSeedRNG(agent* thisAgent);
+EXPORT void SoarSeedRNG(agent* thisAgent, const uint32_t seed);
+
 #endif  // SOAR_RAND_H
 
 // Change log:
@@ -3,6 +3,7 @@
 
 #include "kernel.h"
 
+#include "flat_hash.h"
 #include "mempool_allocator.h"
 #include "stl_structs.h"
 
@@ -106,15 +107,12 @@ struct IDSetLessThan;
     typedef std::unordered_set< uint64_t >                          id_set;
     typedef std::unordered_map< uint64_t, uint64_t >                id_to_id_map;
     typedef std::unordered_map< uint64_t, Symbol* >                 id_to_sym_map;
-    typedef std::unordered_map< uint64_t, Identity*>                id_to_join_map;
     typedef std::unordered_map< uint64_t, std::string >             id_to_string_map;
     typedef std::unordered_map< uint64_t, identity_mapping_list* >  inst_identities_map;
     typedef std::unordered_map< rhs_value, std::string >            rhs_val_to_string_map;
     typedef std::unordered_map< Symbol*, augmentation_set* >        sym_to_aug_map;
     typedef std::unordered_map< Symbol*, condition* >               sym_to_cond_map;
-    typedef std::unordered_map< Symbol*, uint64_t >                 sym_to_id_map;
     typedef std::unordered_map< Symbol*, identity_set* >            sym_to_identity_set_map;
-    typedef std::unordered_map< Symbol*, chunk_element* >           sym_to_sym_id_map;
     typedef std::unordered_map< Symbol*, sym_to_cond_map >          sym_to_sym_to_cond_map;
     typedef std::unordered_map< Symbol*, sym_to_sym_to_cond_map >   triple_merge_map;
     typedef std::unordered_map< Symbol*, chunk_record* >            chunk_record_symbol_map;
@@ -151,8 +149,6 @@ struct IDSetLessThan;
                           soar_module::soar_memory_pool_allocator< std::pair< uint64_t const, uint64_t > > >                id_to_id_map;
     typedef std::map< uint64_t, Symbol*, std::less< uint64_t >,
                           soar_module::soar_memory_pool_allocator< std::pair< uint64_t const, Symbol* > > >                 id_to_sym_map;
-    typedef std::map< uint64_t, Identity*, std::less< uint64_t >,
-                          soar_module::soar_memory_pool_allocator< std::pair< uint64_t const, Identity* > >>                id_to_join_map;
     typedef std::map< uint64_t, std::string, std::less< uint64_t >,
                           soar_module::soar_memory_pool_allocator< std::pair< uint64_t const, std::string > > >             id_to_string_map;
     typedef std::map< uint64_t, identity_mapping_list*, std::less< uint64_t >,
@@ -163,12 +159,8 @@ struct IDSetLessThan;
                           soar_module::soar_memory_pool_allocator< std::pair< Symbol* const, augmentation_set* > > >        sym_to_aug_map;
     typedef std::map< Symbol*, condition*, std::less< Symbol* >,
                           soar_module::soar_memory_pool_allocator< std::pair< Symbol* const, condition* > > >               sym_to_cond_map;
-    typedef std::map< Symbol*, uint64_t, std::less< Symbol* >,
-                          soar_module::soar_memory_pool_allocator< std::pair< Symbol* const, uint64_t > > >                 sym_to_id_map;
     typedef std::map< Symbol*, identity_set*, std::less< Symbol* >,
                           soar_module::soar_memory_pool_allocator< std::pair< Symbol* const, identity_set* > > >            sym_to_identity_set_map;
-    typedef std::map< Symbol*, chunk_element*, std::less< Symbol* >,
-                          soar_module::soar_memory_pool_allocator< std::pair< Symbol* const, chunk_element* > > >           sym_to_sym_id_map;
     typedef std::map< Symbol*, sym_to_cond_map, std::less< Symbol* >,
                           soar_module::soar_memory_pool_allocator< std::pair< Symbol* const, sym_to_cond_map > > >          sym_to_sym_to_cond_map;
     typedef std::map< Symbol*, sym_to_sym_to_cond_map, std::less< Symbol* >,
@@ -198,4 +190,12 @@ struct IDSetLessThan;
 typedef std::pair< double, uint64_t >                           smem_activated_lti;
 typedef std::unordered_multimap<uint64_t,wma_decay_element*>    smem_wma_map;
 
+/* Tables looked up on every instantiation, chunk or smem store that are never
+ * walked in an order that matters, so they use the flat pooled hash tables */
+typedef soar_module::flat_hash_map< uint64_t, Identity* >      id_to_join_map;
+typedef soar_module::flat_hash_map< Symbol*, uint64_t >        sym_to_id_map;
+typedef soar_module::flat_hash_map< Symbol*, chunk_element* >  sym_to_sym_id_map;
+typedef soar_module::flat_hash_map< Symbol*, preference* >     sym_to_pref_map;
+typedef soar_module::flat_hash_map< std::pair< Symbol*, Symbol* >, uint64_t > sym_pair_count_map;
+
 #endif /* STL_TYPEDEFS_H_ */
@@ -1180,15 +1180,10 @@ inline void set_tagged_trace_formats(agent* thisAgent)
 growable_string object_to_trace_string(agent* thisAgent, Symbol* object);
 
 
-bool found_undefined;   /* set to true whenever an escape sequence result is
-                           undefined--for use with %ifdef */
-
-struct tracing_parameters
-{
-    Symbol* current_s;          /* current state, etc. -- for use in %cs, etc. */
-    Symbol* current_o;
-    bool allow_cycle_counts;    /* true means allow %dc and %ec */
-} tparams;
+/* The state and operator for %cs, %co, etc. are kept in thisAgent->tparams,
+   and thisAgent->found_undefined is set whenever an escape sequence result
+   is undefined--for use with %ifdef.  They're on the agent since agents
+   may be traced on separate threads (see soar run-threads). */
 
 /* ----------------------------------------------------------------
    Adds all values of the given attribute path off the given object
@@ -1349,7 +1344,7 @@ void add_trace_for_attribute_path(agent* thisAgent,
     add_values_of_attribute_path(thisAgent, object, path, &values, recursive, &count);
     if (! count)
     {
-        found_undefined = true;
+        thisAgent->found_undefined = true;
         free_growable_string(thisAgent, values);
         return;
     }
@@ -1425,13 +1420,13 @@ growable_string trace_format_list_to_string(agent* thisAgent, trace_format* tf,
                 break;
 
             case CURRENT_STATE_TFT:
-                if (! tparams.current_s)
+                if (! thisAgent->tparams.current_s)
                 {
-                    found_undefined = true;
+                    thisAgent->found_undefined = true;
                 }
                 else
                 {
-                    temp_gs = object_to_trace_string(thisAgent, tparams.current_s);
+                    temp_gs = object_to_trace_string(thisAgent, thisAgent->tparams.current_s);
 
                     // KJC added to play with tagged output...
                     //add_to_growable_string (thisAgent, &result, "id=");
@@ -1442,20 +1437,20 @@ growable_string trace_format_list_to_string(agent* thisAgent, trace_format* tf,
                 }
                 break;
             case CURRENT_OPERATOR_TFT:
-                if (! tparams.current_o)
+                if (! thisAgent->tparams.current_o)
                 {
-                    found_undefined = true;
+                    thisAgent->found_undefined = true;
                 }
                 else
                 {
-                    temp_gs = object_to_trace_string(thisAgent, tparams.current_o);
+                    temp_gs = object_to_trace_string(thisAgent, thisAgent->tparams.current_o);
                     add_to_growable_string(thisAgent, &result, text_of_growable_string(temp_gs));
                     free_growable_string(thisAgent, temp_gs);
                 }
                 break;
 
             case DECISION_CYCLE_COUNT_TFT:
-                if (tparams.allow_cycle_counts)
+                if (thisAgent->tparams.allow_cycle_counts)
                 {
                     SNPRINTF(buf, GROWABLE_STRING_TRACE_FORMAT_LIST_TO_STRING_BUFFER_SIZE, "%" SCNu64, thisAgent->d_cycle_count);
                     buf[GROWABLE_STRING_TRACE_FORMAT_LIST_TO_STRING_BUFFER_SIZE - 1] = 0; /* ensure null termination */
@@ -1463,11 +1458,11 @@ growable_string trace_format_list_to_string(agent* thisAgent, trace_format* tf,
                 }
                 else
                 {
-                    found_undefined = true;
+                    thisAgent->found_undefined = true;
                 }
                 break;
             case ELABORATION_CYCLE_COUNT_TFT:
-                if (tparams.allow_cycle_counts)
+                if (thisAgent->tparams.allow_cycle_counts)
                 {
                     SNPRINTF(buf, GROWABLE_STRING_TRACE_FORMAT_LIST_TO_STRING_BUFFER_SIZE, "%" SCNu64, thisAgent->e_cycle_count);
                     buf[GROWABLE_STRING_TRACE_FORMAT_LIST_TO_STRING_BUFFER_SIZE - 1] = 0; /* ensure null termination */
@@ -1475,7 +1470,7 @@ growable_string trace_format_list_to_string(agent* thisAgent, trace_format* tf,
                 }
                 else
                 {
-                    found_undefined = true;
+                    thisAgent->found_undefined = true;
                 }
                 break;
 
@@ -1487,15 +1482,15 @@ growable_string trace_format_list_to_string(agent* thisAgent, trace_format* tf,
             case IF_ALL_DEFINED_TFT:
             {
                 bool saved_found_undefined;
-                saved_found_undefined = found_undefined;
-                found_undefined = false;
+                saved_found_undefined = thisAgent->found_undefined;
+                thisAgent->found_undefined = false;
                 temp_gs = trace_format_list_to_string(thisAgent, tf->data.subformat, object);
-                if (! found_undefined)
+                if (! thisAgent->found_undefined)
                 {
                     add_to_growable_string(thisAgent, &result, text_of_growable_string(temp_gs));
                 }
                 free_growable_string(thisAgent, temp_gs);
-                found_undefined = saved_found_undefined;
+                thisAgent->found_undefined = saved_found_undefined;
             }
             break;
 
@@ -1520,23 +1515,23 @@ growable_string trace_format_list_to_string(agent* thisAgent, trace_format* tf,
                 break;
 
             case SUBGOAL_DEPTH_TFT:
-                if (tparams.current_s)
+                if (thisAgent->tparams.current_s)
                 {
-                    SNPRINTF(buf, GROWABLE_STRING_TRACE_FORMAT_LIST_TO_STRING_BUFFER_SIZE, "%u", tparams.current_s->id->level - 1);
+                    SNPRINTF(buf, GROWABLE_STRING_TRACE_FORMAT_LIST_TO_STRING_BUFFER_SIZE, "%u", thisAgent->tparams.current_s->id->level - 1);
                     buf[GROWABLE_STRING_TRACE_FORMAT_LIST_TO_STRING_BUFFER_SIZE - 1] = 0; /* ensure null termination */
                     add_to_growable_string(thisAgent, &result, buf);
                 }
                 else
                 {
-                    found_undefined = true;
+                    thisAgent->found_undefined = true;
                 }
                 break;
 
             case REPEAT_SUBGOAL_DEPTH_TFT:
-                if (tparams.current_s)
+                if (thisAgent->tparams.current_s)
                 {
                     temp_gs = trace_format_list_to_string(thisAgent, tf->data.subformat, object);
-                    for (i = tparams.current_s->id->level - 1; i > 0; i--)
+                    for (i = thisAgent->tparams.current_s->id->level - 1; i > 0; i--)
                     {
                         add_to_growable_string(thisAgent, &result, text_of_growable_string(temp_gs));
                     }
@@ -1544,7 +1539,7 @@ growable_string trace_format_list_to_string(agent* thisAgent, trace_format* tf,
                 }
                 else
                 {
-                    found_undefined = true;
+                    thisAgent->found_undefined = true;
                 }
                 break;
 
@@ -1627,7 +1622,7 @@ growable_string object_to_trace_string(agent* thisAgent, Symbol* object)
     int type_of_object;
     trace_format* tf;
     Symbol* name;
-    struct tracing_parameters saved_tparams;
+    tracing_parameters saved_tparams;
 
     /* --- If it's not an identifier, just print it as an atom.  Also, if it's
        already being printed, print it as an atom to avoid getting into an
@@ -1665,11 +1660,11 @@ growable_string object_to_trace_string(agent* thisAgent, Symbol* object)
     /* --- now call trace_format_list_to_string() --- */
     if (tf)
     {
-        saved_tparams = tparams;
-        tparams.current_s = tparams.current_o = NIL;
-        tparams.allow_cycle_counts = false;
+        saved_tparams = thisAgent->tparams;
+        thisAgent->tparams.current_s = thisAgent->tparams.current_o = NIL;
+        thisAgent->tparams.allow_cycle_counts = false;
         gs = trace_format_list_to_string(thisAgent, tf, object);
-        tparams = saved_tparams;
+        thisAgent->tparams = saved_tparams;
     }
     else
     {
@@ -1691,7 +1686,7 @@ growable_string selection_to_trace_string(agent* thisAgent,
     trace_format* tf;
     Symbol* name;
     growable_string gs;
-    struct tracing_parameters saved_tparams;
+    tracing_parameters saved_tparams;
 
     /* --- find the problem space name --- */
     name = NIL;
@@ -1706,19 +1701,19 @@ growable_string selection_to_trace_string(agent* thisAgent,
     }
 
     /* --- save/restore tparams, and call trace_format_list_to_string() --- */
-    saved_tparams = tparams;
-    tparams.current_s = tparams.current_o = NIL;
+    saved_tparams = thisAgent->tparams;
+    thisAgent->tparams.current_s = thisAgent->tparams.current_o = NIL;
     if (current_state)
     {
-        tparams.current_s = current_state;
+        thisAgent->tparams.current_s = current_state;
         if (current_state->id->operator_slot->wmes)
         {
-            tparams.current_o = current_state->id->operator_slot->wmes->value;
+            thisAgent->tparams.current_o = current_state->id->operator_slot->wmes->value;
         }
     }
-    tparams.allow_cycle_counts = allow_cycle_counts;
+    thisAgent->tparams.allow_cycle_counts = allow_cycle_counts;
     gs = trace_format_list_to_string(thisAgent, tf, object);
-    tparams = saved_tparams;
+    thisAgent->tparams = saved_tparams;
 
     return gs;
 }
@@ -1854,24 +1849,24 @@ void print_object_trace_using_provided_format_string(agent* thisAgent,
         char*   format_string)
 {
     growable_string gs;
-    struct tracing_parameters saved_tparams;
+    tracing_parameters saved_tparams;
     trace_format* fs;
 
     fs = parse_format_string(thisAgent, format_string);
 
     thisAgent->tf_printing_tc  = get_new_tc_number(thisAgent);
 
-    saved_tparams = tparams;
+    saved_tparams = thisAgent->tparams;
 
     if (current_goal)
     {
-        tparams.current_s = current_goal;
+        thisAgent->tparams.current_s = current_goal;
     }
-    tparams.allow_cycle_counts = true;
+    thisAgent->tparams.allow_cycle_counts = true;
 
     gs = trace_format_list_to_string(thisAgent, fs, object);
 
-    tparams = saved_tparams;
+    thisAgent->tparams = saved_tparams;
 
     thisAgent->outputManager->start_fresh_line(thisAgent);
 
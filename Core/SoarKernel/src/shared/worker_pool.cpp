@@ -0,0 +1,98 @@
+#include "worker_pool.h"
+
+Worker_Pool::Worker_Pool(size_t pNumThreads)
+{
+    task = NULL;
+    num_tasks = 0;
+    next_task = 0;
+    tasks_left = 0;
+    generation = 0;
+    shutting_down = false;
+
+    for (size_t i = 1; i < pNumThreads; i++)
+    {
+        helpers.push_back(std::thread(&Worker_Pool::helper_loop, this));
+    }
+}
+
+Worker_Pool::~Worker_Pool()
+{
+    {
+        std::lock_guard< std::mutex > guard(lock);
+        shutting_down = true;
+    }
+    work_ready.notify_all();
+    for (size_t i = 0; i < helpers.size(); i++)
+    {
+        helpers[i].join();
+    }
+}
+
+/* --- Claims tasks one at a time until none are left --- */
+void Worker_Pool::do_tasks()
+{
+    std::unique_lock< std::mutex > guard(lock);
+    while (next_task < num_tasks)
+    {
+        size_t i = next_task++;
+        guard.unlock();
+        (*task)(i);
+        guard.lock();
+        if (--tasks_left == 0)
+        {
+            work_done.notify_all();
+        }
+    }
+}
+
+void Worker_Pool::helper_loop()
+{
+    uint64_t seen = 0;
+
+    for (;;)
+    {
+        {
+            std::unique_lock< std::mutex > guard(lock);
+            work_ready.wait(guard, [&] { return shutting_down || (generation != seen); });
+            if (shutting_down)
+            {
+                return;
+            }
+            seen = generation;
+        }
+        do_tasks();
+    }
+}
+
+void Worker_Pool::run(size_t pNumTasks, const std::function< void(size_t) >& pTask)
+{
+    if (pNumTasks == 0)
+    {
+        return;
+    }
+    if (helpers.empty() || (pNumTasks == 1))
+    {
+        for (size_t i = 0; i < pNumTasks; i++)
+        {
+            pTask(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard< std::mutex > guard(lock);
+        task = &pTask;
+        num_tasks = pNumTasks;
+        next_task = 0;
+        tasks_left = pNumTasks;
+        generation++;
+    }
+    work_ready.notify_all();
+
+    do_tasks();
+
+    std::unique_lock< std::mutex > guard(lock);
+    work_done.wait(guard, [&] { return tasks_left == 0; });
+    task = NULL;
+    num_tasks = 0;
+}
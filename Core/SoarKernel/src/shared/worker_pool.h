@@ -0,0 +1,73 @@
+/*************************************************************************
+ * PLEASE SEE THE FILE "license.txt" (INCLUDED WITH THIS SOFTWARE PACKAGE)
+ * FOR LICENSE AND COPYRIGHT INFORMATION.
+ *************************************************************************/
+
+/*************************************************************************
+ *
+ *  file:  worker_pool.h
+ *
+ * A small pool of worker threads for splitting read-only kernel work
+ * across cores.
+ *
+ * - run(num_tasks, task) calls task(i) once for each i in [0, num_tasks)
+ *   and returns when all of them are done.  The calling thread works on
+ *   tasks too, so a pool of n threads has n-1 helpers.
+ *
+ * - Tasks must not touch shared kernel state other than to read it.
+ *   Each task writes only its own part of the result, and the caller
+ *   merges the parts in task order, so results do not depend on which
+ *   thread ran which task.
+ *
+ * - The run scheduler also uses a pool to step whole agents at once.
+ *   Each agent owns its own kernel state, random number generator
+ *   included; what agents share is locked (see soar_callback_mutex and
+ *   the shared memory pools).
+ *
+ * - The helpers sleep between calls to run(); they are started when the
+ *   pool is made and joined when it is deleted.
+ *
+ * =======================================================================
+ */
+
+#ifndef WORKER_POOL_H_
+#define WORKER_POOL_H_
+
+#include "kernel.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Worker_Pool
+{
+    public:
+
+        Worker_Pool(size_t pNumThreads);
+        ~Worker_Pool();
+
+        size_t num_threads() { return helpers.size() + 1; }
+
+        void run(size_t pNumTasks, const std::function< void(size_t) >& pTask);
+
+    private:
+
+        void helper_loop();
+        void do_tasks();
+
+        std::vector< std::thread > helpers;
+        std::mutex                 lock;
+        std::condition_variable    work_ready;
+        std::condition_variable    work_done;
+
+        const std::function< void(size_t) >* task;
+        size_t                     num_tasks;
+        size_t                     next_task;
+        size_t                     tasks_left;
+        uint64_t                   generation;
+        bool                       shutting_down;
+};
+
+#endif /* WORKER_POOL_H_ */
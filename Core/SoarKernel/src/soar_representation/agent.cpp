@@ -56,9 +56,11 @@
 #include "smem_structs.h"
 #include "soar_instance.h"
 #include "soar_module.h"
+#include "soar_rand.h"
 #include "stats.h"
 #include "symbol.h"
 #include "trace.h"
+#include "worker_pool.h"
 #include "working_memory_activation.h"
 #include "working_memory.h"
 #include "xml.h"
@@ -107,6 +109,7 @@ void init_soar_agent(agent* thisAgent)
     thisAgent->memoryManager->init_memory_pool(MP_repair_path, sizeof(Repair_Path), "repair_paths");
 
     thisAgent->memoryManager->init_memory_pool(MP_gds, sizeof(goal_dependency_set), "gds");
+    thisAgent->memoryManager->init_memory_pool(MP_parent_inst, sizeof(parent_inst), "gds_parent_inst");
 
     thisAgent->memoryManager->init_memory_pool(MP_rl_info, sizeof(rl_data), "rl_id_data");
     thisAgent->memoryManager->init_memory_pool(MP_rl_et, sizeof(rl_et_map), "rl_et");
@@ -187,6 +190,12 @@ agent* create_soar_agent(char* agent_name)
     thisAgent->init_count                               = 0;
     thisAgent->highest_goal_whose_context_changed       = NIL;
     thisAgent->ids_with_unknown_level                   = NIL;
+    thisAgent->tparams.current_s                        = NIL;
+    thisAgent->tparams.current_o                        = NIL;
+    thisAgent->tparams.allow_cycle_counts               = false;
+    thisAgent->found_undefined                          = false;
+    thisAgent->gc_ids_held                              = false;
+    thisAgent->gc_held_since_cycle                      = 0;
     thisAgent->input_period                             = 0;
     thisAgent->input_cycle_flag                         = true;
     thisAgent->link_update_mode                         = UPDATE_LINKS_NORMALLY;
@@ -256,9 +265,11 @@ agent* create_soar_agent(char* agent_name)
     soar_init_callbacks(thisAgent);
 
     //
-    thisAgent->memoryManager = &Memory_Manager::Get_MPM();
+    thisAgent->memoryManager = new Memory_Manager();
     init_memory_utilities(thisAgent);
 
+    thisAgent->random_generator = new MTRand();
+
     //
     // This was moved here so that system parameters could
     // be set before the agent was initialized.
@@ -271,9 +282,7 @@ agent* create_soar_agent(char* agent_name)
     thisAgent->timers_cpu.set_enabled(&(thisAgent->timers_enabled));
     thisAgent->timers_kernel.set_enabled(&(thisAgent->timers_enabled));
     thisAgent->timers_phase.set_enabled(&(thisAgent->timers_enabled));
-#ifdef DETAILED_TIMING_STATS
     thisAgent->timers_gds.set_enabled(&(thisAgent->timers_enabled));
-#endif
     reset_timers(thisAgent);
 #endif
 
@@ -359,8 +368,10 @@ void destroy_soar_agent(agent* delete_agent)
 
     soar_remove_all_monitorable_callbacks(delete_agent);
 
-    delete_agent->memoryManager->free_memory(delete_agent->left_ht, HASH_TABLE_MEM_USAGE);
-    delete_agent->memoryManager->free_memory(delete_agent->right_ht, HASH_TABLE_MEM_USAGE);
+    free_rete_ht(delete_agent, delete_agent->left_ht);
+    free_rete_ht(delete_agent, delete_agent->right_ht);
+    free_alpha_index(delete_agent, delete_agent->alpha_mem_index);
+    delete delete_agent->alpha_workers;
     delete_agent->memoryManager->free_memory(delete_agent->rhs_variable_bindings, MISCELLANEOUS_MEM_USAGE);
 
     /* Releasing trace formats (needs to happen before tracing hashtables are released) */
@@ -381,12 +392,6 @@ void destroy_soar_agent(agent* delete_agent)
         free_hash_table(delete_agent, delete_agent->stack_tr_ht[i]);
     }
 
-    /* Releasing memory allocated in init_rete */
-    for (int i = 0; i < 16; i++)
-    {
-        free_hash_table(delete_agent, delete_agent->alpha_hash_tables[i]);
-    }
-
     /* Release module managers */
     delete delete_agent->WM;
     delete delete_agent->Decider;
@@ -397,10 +402,15 @@ void destroy_soar_agent(agent* delete_agent)
 
 
     delete delete_agent->dyn_counters;
+    delete delete_agent->random_generator;
 
     /* Release data used by XML generation */
     xml_destroy(delete_agent);
 
+    /* Release the agent's memory pools, along with anything still in them */
+    delete delete_agent->memoryManager;
+    delete_agent->memoryManager = NULL;
+
     /* Release agent data structure */
     delete delete_agent;
 }
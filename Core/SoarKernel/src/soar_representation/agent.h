@@ -41,6 +41,17 @@ typedef void* xml_handle;
 
 typedef struct alpha_mem_struct alpha_mem;
 typedef struct token_struct token;
+typedef struct rete_ht_struct rete_ht;
+typedef struct alpha_index_struct alpha_index;
+
+/* what the %cs, %co, %dc and %ec trace format escapes refer to while a
+   trace format is being expanded (see trace.cpp) */
+typedef struct tracing_parameters_struct
+{
+    Symbol* current_s;          /* current state, etc. -- for use in %cs, etc. */
+    Symbol* current_o;
+    bool allow_cycle_counts;    /* true means allow %dc and %ec */
+} tracing_parameters;
 
 class stats_statement_container;
 #ifndef NO_SVS
@@ -74,10 +85,11 @@ typedef struct EXPORT agent_struct
     /////////////////////////////////////////////////////////////////////////////
     /////////////////////////////////////////////////////////////////////////////
 
-    /* Hash tables for alpha memories, and for entries in left & right memories */
-    void*               left_ht;
-    void*               right_ht;
-    hash_table*        (alpha_hash_tables[16]);
+    /* Index of alpha memories, and hash tables for entries in left & right memories */
+    rete_ht*            left_ht;
+    rete_ht*            right_ht;
+    alpha_index*        alpha_mem_index;
+    Worker_Pool*        alpha_workers;  /* NIL unless "soar alpha-threads" > 1 */
 
     /* Number of WMEs, and list of WMEs, the Rete has been told about */
     uint64_t            num_wmes_in_rete;
@@ -97,6 +109,13 @@ typedef struct EXPORT agent_struct
     uint64_t       num_null_right_activations;
     uint64_t       num_null_left_activations;
 
+    /* Match profiler (see rete_node_profile) */
+    bool           match_profiling;
+    uint64_t       reorder_period;   /* decisions between reorder passes, 0=off */
+
+    /* True while the rete builds nodes for a :collection production */
+    bool           building_collection_net;
+
 
     /* Miscellaneous other stuff */
     uint32_t       alpha_mem_id_counter; /* node id's for hashing */
@@ -171,6 +190,7 @@ typedef struct EXPORT agent_struct
     uint64_t            max_wm_size;    /* maximum size of WM so far */
     uint64_t            wme_addition_count; /* # of wmes added to WM */
     uint64_t            wme_removal_count;  /* # of wmes removed from WM */
+    uint64_t            wme_cancel_count;   /* # of wmes added and removed in one phase */
 
     uint64_t            start_dc_wme_addition_count; /* for calculating max_dc_wm_changes */
     uint64_t            start_dc_wme_removal_count;  /* for calculating max_dc_wm_changes */
@@ -207,6 +227,12 @@ typedef struct EXPORT agent_struct
     parent_inst* parent_list_head;
     /* REW: end   09.15.96 */
 
+    /* Goal dependency set upkeep, reported by stats */
+    uint64_t            gds_elaboration_passes;       /* # of batched GDS elaboration passes */
+    uint64_t            gds_instantiations_explored;  /* # of instantiations walked by those passes */
+    uint64_t            gds_wme_additions;            /* # of wmes added to or moved between GDSs */
+    uint64_t            gds_state_removals;           /* # of states removed because a GDS wme changed */
+
     /* State for new waterfall model */
     uint64_t            inner_e_cycle_count;     /* # of inner elaboration cycles run so far */
 
@@ -326,14 +352,17 @@ typedef struct EXPORT agent_struct
 
     soar_timer_accumulator callback_timers[NUMBER_OF_CALLBACKS];
 
+    /* GDS elaboration and GDS state removal.  With DETAILED_TIMING_STATS the
+       consistency checks are charged here as well. */
+    soar_timer timers_gds;                                                // start_gds_tv
+    soar_timer_accumulator timers_gds_cpu_time[NUM_PHASE_TYPES];          // gds_cpu_time
+
     /* accumulated cpu time spent in various parts of the system */
     /* only used if DETAILED_TIMING_STATS is #def'd in kernel.h */
     #ifdef DETAILED_TIMING_STATS
-        soar_timer timers_gds;                                        // start_gds_tv
         soar_timer_accumulator timers_ownership_cpu_time[NUM_PHASE_TYPES];    // ownership_cpu_time
         soar_timer_accumulator timers_chunking_cpu_time[NUM_PHASE_TYPES];     // chunking_cpu_time
         soar_timer_accumulator timers_match_cpu_time[NUM_PHASE_TYPES];        // match_cpu_time
-        soar_timer_accumulator timers_gds_cpu_time[NUM_PHASE_TYPES];          // gds_cpu_time
     #endif // DETAILED_TIMING_STATS
 #endif // NO_TIMING_STUFF
 
@@ -382,6 +411,8 @@ typedef struct EXPORT agent_struct
     tc_number           walk_tc_number;
     cons*               promoted_ids;
     int                 link_update_mode;
+    bool                gc_ids_held;            /* soar gc-batch is holding ids of unknown level */
+    uint64_t            gc_held_since_cycle;
 
     /* ----------------------- Trace Formats -------------------------- */
 
@@ -391,6 +422,9 @@ typedef struct EXPORT agent_struct
     struct trace_format_struct* (stack_tf_for_anything[3]);
     struct hash_table_struct* (stack_tr_ht[3]);
     tc_number           tf_printing_tc;
+    tracing_parameters  tparams;
+    bool                found_undefined;        /* an escape in the format being expanded had
+                                                   no value--for use with %ifdef */
 
     cons*               wme_filter_list; /* kjh(CUSP-B2) */
 
@@ -476,6 +510,9 @@ typedef struct EXPORT agent_struct
     // select
     select_info* select;
 
+    // random numbers for this agent only; see soar_rand.h
+    MTRand*      random_generator;
+
     // predict
     uint32_t     predict_seed;
     std::string* prediction;
@@ -35,7 +35,8 @@
       bt:  for top-level positive conditions in production instantiations,
         this structure gives information for that will be used in backtracing.
 
-      reorder:  (reserved for use by the reorderer)
+      reorder:  (reserved for use by the reorderer; observed_cost is
+        filled in from the match profiler, see production_reorder.cpp)
 ------------------------------------------------------------------- */
 
 /* --- info on conditions used for backtracing (and by the rete) --- */
@@ -51,6 +52,7 @@ typedef struct reorder_info_struct
 {
     cons* vars_requiring_bindings;         /* used only during reordering */
     struct condition_struct* next_min_cost;  /* used only during reordering */
+    int64_t observed_cost;                 /* run-time branching factor, or 0 */
 } reorder_info;
 
 /* --- info on negated conjunctive conditions only --- */
@@ -371,6 +371,10 @@ bool add_preference_to_tm(agent* thisAgent, preference* pref)
     }
 
     mark_slot_as_changed(thisAgent, s);
+    if (s->isa_context_slot && (pref->type == BINARY_INDIFFERENT_PREFERENCE_TYPE))
+    {
+        add_indifferent_pair(thisAgent, s, pref);
+    }
 
     if (wma_enabled(thisAgent) && !s->isa_context_slot)
     {
@@ -449,6 +453,10 @@ void remove_preference_from_tm(agent* thisAgent, preference* pref)
     pref->in_tm = false;
     pref->slot = NIL;      /* BUG shouldn't we use pref->slot in place of pref->in_tm? */
     mark_slot_as_changed(thisAgent, s);
+    if (s->isa_context_slot && (pref->type == BINARY_INDIFFERENT_PREFERENCE_TYPE))
+    {
+        remove_indifferent_pair(thisAgent, s, pref);
+    }
 
     /*  if acceptable/require pref for context slot, we may need to remove
        a wme later */
@@ -432,6 +432,7 @@ production* make_production(agent*          thisAgent,
     p->rhs_unbound_variables = NIL; /* the Rete fills this in */
     p->instantiations = NIL;
     p->interrupt = false;
+    p->collection_match = false;
     p->explain_its_chunks = false;
     p->save_for_justification_explanation = false;
     p->duplicate_chunks_this_cycle = 0;
@@ -489,7 +490,9 @@ void deallocate_production(agent* thisAgent, production* prod)
     thisAgent->memoryManager->free_with_pool(MP_production, prod);
 }
 
-void excise_production(agent* thisAgent, production* prod, bool print_sharp_sign, bool cacheProdForExplainer)
+/* --- Everything excise_production() does before the production leaves
+   the rete --- */
+void prepare_production_for_excise(agent* thisAgent, production* prod, bool print_sharp_sign, bool cacheProdForExplainer)
 {
     /* When excising, the explainer needs to save the production before we excise it from
      * the RETE.  Otherwise, it won't be able to reconstruct the cached conditions/actions */
@@ -525,6 +528,11 @@ void excise_production(agent* thisAgent, production* prod, bool print_sharp_sign
     {
         thisAgent->outputManager->printa(thisAgent,  "#");
     }
+}
+
+void excise_production(agent* thisAgent, production* prod, bool print_sharp_sign, bool cacheProdForExplainer)
+{
+    prepare_production_for_excise(thisAgent, prod, print_sharp_sign, cacheProdForExplainer);
     if (prod->p_node)
     {
         excise_production_from_rete(thisAgent, prod);
@@ -533,20 +541,52 @@ void excise_production(agent* thisAgent, production* prod, bool print_sharp_sign
     production_remove_ref(thisAgent, prod);
 }
 
+void excise_productions(agent* thisAgent, std::vector< production* >& prods, bool print_sharp_sign, bool cacheProdForExplainer)
+{
+    std::vector< production* > in_rete;
+
+    for (std::vector< production* >::iterator it = prods.begin(); it != prods.end(); ++it)
+    {
+        prepare_production_for_excise(thisAgent, *it, print_sharp_sign, cacheProdForExplainer);
+        if ((*it)->p_node)
+        {
+            in_rete.push_back(*it);
+        }
+    }
+    if (!in_rete.empty())
+    {
+        excise_productions_from_rete(thisAgent, in_rete);
+    }
+    for (std::vector< production* >::iterator it = prods.begin(); it != prods.end(); ++it)
+    {
+        (*it)->name->sc->production = NIL;
+        production_remove_ref(thisAgent, *it);
+    }
+}
+
 void excise_all_productions_of_type(agent* thisAgent, byte type, bool print_sharp_sign, bool cacheProdForExplainer)
 {
-    while (thisAgent->all_productions_of_type[type])
+    std::vector< production* > prods;
+
+    for (production* prod = thisAgent->all_productions_of_type[type]; prod != NIL; prod = prod->next)
     {
-        excise_production(thisAgent, thisAgent->all_productions_of_type[type], print_sharp_sign, cacheProdForExplainer);
+        prods.push_back(prod);
     }
+    excise_productions(thisAgent, prods, print_sharp_sign, cacheProdForExplainer);
 }
 
 void excise_all_productions(agent* thisAgent, bool print_sharp_sign,  bool cacheProdForExplainer)
 {
+    std::vector< production* > prods;
+
     for (int i = 0; i < NUM_PRODUCTION_TYPES; i++)
     {
-        excise_all_productions_of_type(thisAgent, static_cast<byte>(i), print_sharp_sign, cacheProdForExplainer);
+        for (production* prod = thisAgent->all_productions_of_type[i]; prod != NIL; prod = prod->next)
+        {
+            prods.push_back(prod);
+        }
     }
+    excise_productions(thisAgent, prods, print_sharp_sign, cacheProdForExplainer);
 }
 
 /****************************/
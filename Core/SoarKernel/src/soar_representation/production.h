@@ -36,6 +36,7 @@ typedef struct production_struct
         bool interrupt_break : 1;
         bool already_fired : 1;         /* RPM test workaround for bug #139 */
         bool rl_rule : 1;                   /* if true, is a Soar-RL rule */
+        bool collection_match : 1;          /* :collection, see rete.cpp */
     };
 
     double rl_update_count;       /* number of (potentially fractional) updates to this rule */
@@ -154,7 +155,9 @@ void add_all_variables_in_condition_list(agent* thisAgent, condition* cond_list,
 
     Deallocate_production() and excise_production() do just what they
     say.  Normally deallocate_production() should be invoked only via
-    the production_remove_ref() macro.
+    the production_remove_ref() macro.  Excise_productions() excises a
+    whole set of productions, taking them out of the rete together;
+    excise_all_productions() and excise_all_productions_of_type() use it.
 ------------------------------------------------------------------- */
 ProdReorderFailureType reorder_and_validate_lhs_and_rhs(agent*                    thisAgent,
                                                         condition**               lhs_top,
@@ -172,6 +175,7 @@ production* make_production(agent* thisAgent, ProductionType type,
 
 void deallocate_production(agent* thisAgent, production* prod);
 void excise_production(agent* thisAgent, production* prod, bool print_sharp_sign = true, bool cacheProdForExplainer = false);
+void excise_productions(agent* thisAgent, std::vector< production* >& prods, bool print_sharp_sign, bool cacheProdForExplainer = false);
 void excise_all_productions_of_type(agent* thisAgent, byte type, bool print_sharp_sign, bool cacheProdForExplainer = false);
 void excise_all_productions(agent* thisAgent, bool print_sharp_sign, bool cacheProdForExplainer = false);
 
@@ -25,6 +25,7 @@
 #include "preference.h"
 #include "print.h"
 #include "production.h"
+#include "rete.h"
 #include "rhs.h"
 #include "run_soar.h"
 #include "soar_TraceNames.h"
@@ -34,6 +35,8 @@
 #include "xml.h"
 
 #include <stdlib.h>
+#include <algorithm>
+#include <vector>
 
 /* *********************************************************************
 
@@ -908,7 +911,9 @@ int64_t get_cost_of_possible_multi_attribute(agent* thisAgent, Symbol* sym)
    Return an estimate of the "cost" of the given condition.
    The current TC should be the set of previously bound variables;
    "root_vars_not_bound_yet" should be the set of other root
-   variables.
+   variables.  If the match profiler saw how many wmes a positive
+   condition matches per token (its observed_cost), that number is
+   used whenever the condition's value is still unbound.
 ------------------------------------------------------------- */
 
 int64_t cost_of_adding_condition(agent* thisAgent, condition* cond, tc_number tc, cons* root_vars_not_bound_yet)
@@ -931,6 +936,11 @@ int64_t cost_of_adding_condition(agent* thisAgent, condition* cond, tc_number tc
         {
             return MAX_COST;
         }
+        if (cond->reorder.observed_cost &&
+                !(cond->data.tests.value_test->data.referent->is_constant_or_marked_variable(tc)))
+        {
+            return cond->reorder.observed_cost;
+        }
         if ((cond->data.tests.attr_test->data.referent->is_constant_or_marked_variable(tc)))
             result = get_cost_of_possible_multi_attribute
                      (thisAgent, cond->data.tests.attr_test->data.referent);
@@ -961,6 +971,12 @@ int64_t cost_of_adding_condition(agent* thisAgent, condition* cond, tc_number tc
         {
             return MAX_COST;
         }
+        if (cond->reorder.observed_cost &&
+                ! test_covered_by_bound_vars(cond->data.tests.value_test, tc,
+                                             root_vars_not_bound_yet))
+        {
+            return cond->reorder.observed_cost;
+        }
         if (test_covered_by_bound_vars(cond->data.tests.attr_test, tc,
                                        root_vars_not_bound_yet))
         {
@@ -1481,6 +1497,253 @@ ProdReorderFailureType reorder_lhs(agent* thisAgent, condition** lhs_top, bool r
     return reorder_success;
 }
 
+/* =====================================================================
+
+                   Reordering from the Match Profile
+
+   The conditions of a production are ordered once, when it is loaded,
+   using the static estimates above.  Reorder_productions_from_match_profile()
+   revisits that choice once the match profiler has watched the agent
+   run for a while.  It takes the (at most) max_productions productions
+   whose nodes created the most tokens, rebuilds each one's LHS from the
+   rete, gives its conditions the branching factors the profiler saw
+   (see set_observed_costs_from_match_profile()), and runs the reorderer
+   again.  If that gives an order that should make fewer tokens, the
+   production is excised from the rete and added back with the new order.
+
+   A production is only rebuilt while it has no complete matches and no
+   pending match set changes, so no instantiation is retracted or fired
+   again by the swap; busier productions are left for a later pass.  If
+   the new network holds more tokens than the old one did, or would be a
+   duplicate of another production, the old order is put back.  The
+   rebuild goes around the production add/excise callbacks, since the
+   production itself does not change.  If "report" is set, each
+   production is reported with its new order (as the positions its
+   conditions had before) and its token count before and after.
+
+   With thisAgent->reorder_period set, this runs on its own at the end
+   of every reorder_period'th decision cycle (see run_soar.cpp), and
+   reports only while "trace --reorder" is on.
+===================================================================== */
+
+#define MAX_REORDER_CONDITIONS 64
+
+inline bool production_can_be_rebuilt(production* prod)
+{
+    return (prod->p_node && ! prod->instantiations &&
+            ! prod->p_node->a.np.tokens &&
+            ! prod->p_node->b.p.tentative_assertions &&
+            ! prod->p_node->b.p.tentative_retractions);
+}
+
+/* --- A rough count of the tokens an order makes: the running product of
+   the branching factors of its positive conditions, summed.  Conditions
+   whose value is already bound count as 1. --- */
+double estimated_tokens_for_order(agent* thisAgent, condition* lhs_top)
+{
+    condition* cond;
+    tc_number tc;
+    double tokens, total;
+    test value_test;
+
+    tc = get_new_tc_number(thisAgent);
+    tokens = 1;
+    total = 0;
+    for (cond = lhs_top; cond != NIL; cond = cond->next)
+    {
+        if (cond->type == POSITIVE_CONDITION)
+        {
+            value_test = cond->data.tests.value_test;
+            if (value_test && value_test->eq_test &&
+                    value_test->eq_test->data.referent->is_constant_or_marked_variable(tc))
+            {
+                /* a bound value passes at most what came in */
+            }
+            else if (cond->reorder.observed_cost)
+            {
+                tokens *= cond->reorder.observed_cost;
+            }
+            else
+            {
+                tokens *= BF_FOR_VALUES;
+            }
+            total += tokens;
+        }
+        add_bound_variables_in_condition(thisAgent, cond, tc, NIL);
+    }
+    return total;
+}
+
+byte readd_production_to_rete(agent* thisAgent, production* prod, condition* lhs_top, action* rhs)
+{
+    production* duplicate_rule = NIL;
+
+    if (prod->p_node)
+    {
+        excise_production_from_rete(thisAgent, prod, false);
+    }
+    deallocate_action_list(thisAgent, prod->action_list);
+    thisAgent->symbolManager->deallocate_symbol_list_removing_references(prod->rhs_unbound_variables);
+    prod->rhs_unbound_variables = NIL;
+    prod->action_list = rhs;
+    return add_production_to_rete(thisAgent, prod, lhs_top, NIL, false, duplicate_rule, false, false);
+}
+
+bool reorder_production_from_match_profile(agent* thisAgent, production* prod, bool report)
+{
+    condition* lhs_top, *lhs_bottom, *old_top, *old_bottom, *cond, *old_cond;
+    condition* old_order[MAX_REORDER_CONDITIONS];
+    action* rhs, *old_rhs, *a, *last;
+    int num_conds, i, j;
+    bool changed;
+    tc_number tc;
+    uint64_t tokens_before, tokens_after;
+    byte result;
+    std::string new_order;
+
+    p_node_to_conditions_and_rhs(thisAgent, prod->p_node, NIL, NIL, &lhs_top, &lhs_bottom, &rhs);
+    set_observed_costs_from_match_profile(thisAgent, prod, lhs_top);
+
+    /* --- a branching factor seen with the value already bound says
+       nothing about the condition with the value unbound --- */
+    tc = get_new_tc_number(thisAgent);
+    num_conds = 0;
+    for (cond = lhs_top; cond != NIL; cond = cond->next)
+    {
+        if ((cond->type == POSITIVE_CONDITION) && cond->data.tests.value_test &&
+                cond->data.tests.value_test->eq_test &&
+                cond->data.tests.value_test->eq_test->data.referent->is_constant_or_marked_variable(tc))
+        {
+            cond->reorder.observed_cost = 0;
+        }
+        add_bound_variables_in_condition(thisAgent, cond, tc, NIL);
+        if (num_conds < MAX_REORDER_CONDITIONS)
+        {
+            old_order[num_conds] = cond;
+        }
+        num_conds++;
+    }
+
+    copy_condition_list(thisAgent, lhs_top, &old_top, &old_bottom);
+    for (cond = lhs_top, old_cond = old_top; cond != NIL; cond = cond->next, old_cond = old_cond->next)
+    {
+        old_cond->reorder.observed_cost = cond->reorder.observed_cost;
+    }
+    thisAgent->name_of_production_being_reordered = prod->name->sc->name;
+    changed = false;
+    if ((num_conds <= MAX_REORDER_CONDITIONS) && (reorder_lhs(thisAgent, &lhs_top, true) == reorder_success) &&
+            (estimated_tokens_for_order(thisAgent, lhs_top) < estimated_tokens_for_order(thisAgent, old_top)))
+    {
+        for (cond = lhs_top, i = 0; cond != NIL; cond = cond->next, i++)
+        {
+            if (cond != old_order[i])
+            {
+                changed = true;
+            }
+            for (j = 0; old_order[j] != cond; j++);
+            new_order += (i ? " " : "") + std::to_string(j + 1);
+        }
+    }
+    if (! changed)
+    {
+        deallocate_condition_list(thisAgent, lhs_top);
+        deallocate_condition_list(thisAgent, old_top);
+        deallocate_action_list(thisAgent, rhs);
+        return false;
+    }
+
+    /* --- keep a copy of the RHS in case the old order has to go back --- */
+    old_rhs = last = NIL;
+    for (a = rhs; a != NIL; a = a->next)
+    {
+        if (last)
+        {
+            last->next = copy_action(thisAgent, a);
+            last = last->next;
+        }
+        else
+        {
+            old_rhs = last = copy_action(thisAgent, a);
+        }
+    }
+
+    tokens_before = count_rete_tokens_for_production(thisAgent, prod);
+    result = readd_production_to_rete(thisAgent, prod, lhs_top, rhs);
+    tokens_after = prod->p_node ? count_rete_tokens_for_production(thisAgent, prod) : 0;
+    deallocate_condition_list(thisAgent, lhs_top);
+
+    if ((result == DUPLICATE_PRODUCTION) || (tokens_after > tokens_before))
+    {
+        if (! report)
+        {
+            /* --- nothing to say --- */
+        }
+        else if (result == DUPLICATE_PRODUCTION)
+        {
+            thisAgent->outputManager->printa_sf(thisAgent, "\nKept the order of %y: conditions %s would duplicate another production",
+                                                prod->name, new_order.c_str());
+        }
+        else
+        {
+            thisAgent->outputManager->printa_sf(thisAgent, "\nKept the order of %y: conditions %s would hold %u tokens instead of %u",
+                                                prod->name, new_order.c_str(), tokens_after, tokens_before);
+        }
+        /* --- old_top and old_rhs come from the same rebuild, so their variables agree --- */
+        readd_production_to_rete(thisAgent, prod, old_top, old_rhs);
+        deallocate_condition_list(thisAgent, old_top);
+        return false;
+    }
+
+    if (report)
+    {
+        thisAgent->outputManager->printa_sf(thisAgent, "\nReordered %y: conditions %s, %u tokens before, %u after",
+                                            prod->name, new_order.c_str(), tokens_before, tokens_after);
+    }
+    deallocate_condition_list(thisAgent, old_top);
+    deallocate_action_list(thisAgent, old_rhs);
+    return true;
+}
+
+bool production_tokens_greater(const std::pair< uint64_t, production* >& a, const std::pair< uint64_t, production* >& b)
+{
+    return a.first > b.first;
+}
+
+uint64_t reorder_productions_from_match_profile(agent* thisAgent, int max_productions, bool report)
+{
+    std::vector< std::pair< uint64_t, production* > > candidates;
+    rete_node_profile profile;
+    production* prod;
+    uint64_t num_reordered;
+    int i;
+
+    /* --- user, default and chunk productions only: templates keep their
+       conditions for RL, and justifications do not stay around --- */
+    for (i = USER_PRODUCTION_TYPE; i <= CHUNK_PRODUCTION_TYPE; i++)
+    {
+        for (prod = thisAgent->all_productions_of_type[i]; prod != NIL; prod = prod->next)
+        {
+            get_match_profile_for_production(thisAgent, prod, &profile);
+            if (profile.tokens_created)
+            {
+                candidates.push_back(std::make_pair(profile.tokens_created, prod));
+            }
+        }
+    }
+    std::stable_sort(candidates.begin(), candidates.end(), production_tokens_greater);
+
+    num_reordered = 0;
+    for (i = 0; (i < static_cast<int>(candidates.size())) && (i < max_productions); i++)
+    {
+        if (production_can_be_rebuilt(candidates[i].second) &&
+                reorder_production_from_match_profile(thisAgent, candidates[i].second, report))
+        {
+            num_reordered++;
+        }
+    }
+    return num_reordered;
+}
+
 void init_reorderer(agent* thisAgent)     /* called from init_production_utilities() */
 {
     thisAgent->memoryManager->init_memory_pool(MP_saved_test, sizeof(saved_test), "saved test");
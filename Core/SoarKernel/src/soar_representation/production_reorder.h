@@ -27,6 +27,10 @@ typedef struct saved_test_struct
 extern ProdReorderFailureType reorder_action_list(agent* thisAgent, action** action_list, tc_number lhs_tc, matched_symbol_list* ungrounded_syms, bool add_ungrounded = false);
 extern ProdReorderFailureType reorder_lhs(agent* thisAgent, condition** lhs_top, bool reorder_nccs, matched_symbol_list* ungrounded_syms = NULL, bool add_ungrounded = false);
 extern void init_reorderer(agent* thisAgent);
+/* productions looked at by each periodic pass (see production reorder) */
+#define DEFAULT_REORDER_PRODUCTIONS 20
+
+extern uint64_t reorder_productions_from_match_profile(agent* thisAgent, int max_productions, bool report);
 
 /* this prototype moved here from osupport.cpp -ajc (5/3/02) */
 extern cons* collect_root_variables(agent* thisAgent, condition* cond_list, tc_number tc, matched_symbol_list* ungrounded_syms = NULL, bool add_ungrounded = false);
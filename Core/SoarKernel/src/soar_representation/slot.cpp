@@ -19,13 +19,136 @@
    returns it if found.  If no such slot exists, it returns NIL.
    Make_slot() looks for an existing slot for a given id/attr pair,
    returns it if found, and otherwise creates a new slot and returns it.
+   Both use the identifier's slot index when it has one.
 
    Mark_slot_as_changed() is called by the preference manager whenever
    the preferences for a slot change.  This updates the list of
    changed_slots and highest_goal_whose_context_changed for use by the
-   decider.
+   decider, and bumps the slot's pref_changes count, which the
+   consistency check uses to tell whether its last answer still holds.
 ====================================================================== */
 
+/* --- Hash value for an attribute in a slot index.  Attributes are
+   compared by address, so the address is spread over the whole word
+   with a Fibonacci multiply and the top bits are used. --- */
+inline uint32_t slot_index_hash(Symbol* attr)
+{
+    return static_cast<uint32_t>((reinterpret_cast<uintptr_t>(attr) * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+/* --- Puts a slot in the first free entry of its probe sequence.
+   Does not check the load, see add_to_slot_index() --- */
+inline void place_in_slot_index(slot_index* index, slot* s)
+{
+    uint32_t mask, i;
+
+    mask = index->size - 1;
+    for (i = slot_index_hash(s->attr) & mask; index->entries[i].s != NIL; i = (i + 1) & mask)
+        ;
+    index->entries[i].attr = s->attr;
+    index->entries[i].s = s;
+}
+
+inline slot* lookup_slot_index(slot_index* index, Symbol* attr)
+{
+    uint32_t mask, i;
+
+    mask = index->size - 1;
+    for (i = slot_index_hash(attr) & mask; index->entries[i].s != NIL; i = (i + 1) & mask)
+        if (index->entries[i].attr == attr)
+        {
+            return index->entries[i].s;
+        }
+    return NIL;
+}
+
+/* --- (Re)builds the index of an identifier's slots with room for at
+   least num_slots of them at a load of at most 3/4 --- */
+void build_slot_index(agent* thisAgent, Symbol* id, uint32_t num_slots)
+{
+    slot_index* index;
+    slot* s;
+    uint32_t size;
+
+    index = id->id->slot_index;
+    if (index)
+    {
+        thisAgent->memoryManager->free_memory(index->entries, HASH_TABLE_MEM_USAGE);
+    }
+    else
+    {
+        index = static_cast<slot_index*>(thisAgent->memoryManager->allocate_memory(sizeof(slot_index), HASH_TABLE_MEM_USAGE));
+        id->id->slot_index = index;
+    }
+    for (size = 2 * SLOT_INDEX_MIN_SLOTS; static_cast<uint64_t>(num_slots) * 4 > static_cast<uint64_t>(size) * 3; size *= 2)
+        ;
+    index->size = size;
+    index->count = 0;
+    index->entries = static_cast<slot_index_entry*>(thisAgent->memoryManager->allocate_memory_and_zerofill(
+                         size * sizeof(slot_index_entry), HASH_TABLE_MEM_USAGE));
+    for (s = id->id->slots; s != NIL; s = s->next)
+    {
+        place_in_slot_index(index, s);
+        index->count++;
+    }
+}
+
+void free_slot_index(agent* thisAgent, Symbol* id)
+{
+    if (id->id->slot_index)
+    {
+        thisAgent->memoryManager->free_memory(id->id->slot_index->entries, HASH_TABLE_MEM_USAGE);
+        thisAgent->memoryManager->free_memory(id->id->slot_index, HASH_TABLE_MEM_USAGE);
+        id->id->slot_index = NIL;
+    }
+}
+
+/* --- Adds a slot that has just been put on its identifier's slot list --- */
+inline void add_to_slot_index(agent* thisAgent, slot* s)
+{
+    slot_index* index;
+
+    index = s->id->id->slot_index;
+    if ((static_cast<uint64_t>(index->count) + 1) * 4 > static_cast<uint64_t>(index->size) * 3)
+    {
+        /* --- the rebuild picks up the new slot from the slot list --- */
+        build_slot_index(thisAgent, s->id, index->count + 1);
+        return;
+    }
+    place_in_slot_index(index, s);
+    index->count++;
+}
+
+/* --- Removes a slot, then moves back any later entry of the same probe
+   run that could now be found earlier, so that no lookup has to step
+   over an empty entry.  Frees the index once few slots are left. --- */
+void remove_from_slot_index(agent* thisAgent, slot* s)
+{
+    slot_index* index;
+    uint32_t mask, i, j, home;
+
+    index = s->id->id->slot_index;
+    mask = index->size - 1;
+    for (i = slot_index_hash(s->attr) & mask; index->entries[i].s != s; i = (i + 1) & mask)
+        ;
+    for (j = (i + 1) & mask; index->entries[j].s != NIL; j = (j + 1) & mask)
+    {
+        home = slot_index_hash(index->entries[j].attr) & mask;
+        /* --- entry j may move to i unless its home lies cyclically in (i,j] --- */
+        if (((j - home) & mask) >= ((j - i) & mask))
+        {
+            index->entries[i] = index->entries[j];
+            i = j;
+        }
+    }
+    index->entries[i].s = NIL;
+    index->count--;
+    if (index->count < SLOT_INDEX_MIN_SLOTS / 4)
+    {
+        free_slot_index(thisAgent, s->id);
+    }
+}
+
 slot* find_slot(Symbol* id, Symbol* attr)
 {
     slot* s;
@@ -34,6 +157,10 @@ slot* find_slot(Symbol* id, Symbol* attr)
     {
         return NIL;    /* fixes bug #135 kjh */
     }
+    if (id->id->slot_index)
+    {
+        return lookup_slot_index(id->id->slot_index, attr);
+    }
     for (s = id->id->slots; s != NIL; s = s->next)
         if (s->attr == attr)
         {
@@ -45,17 +172,31 @@ slot* find_slot(Symbol* id, Symbol* attr)
 slot* make_slot(agent* thisAgent, Symbol* id, Symbol* attr)
 {
     slot* s;
+    uint32_t num_slots;
     int i;
 
     /* Search for a slot first.  If it exists
     *  for the given symbol, then just return it */
-    for (s = id->id->slots; s != NIL; s = s->next)
+    num_slots = 0;
+    if (id->id->slot_index)
     {
-        if (s->attr == attr)
+        s = lookup_slot_index(id->id->slot_index, attr);
+        if (s)
         {
             return s;
         }
     }
+    else
+    {
+        for (s = id->id->slots; s != NIL; s = s->next)
+        {
+            if (s->attr == attr)
+            {
+                return s;
+            }
+            num_slots++;
+        }
+    }
 
     /* Need to create a new slot */
     thisAgent->memoryManager->allocate_with_pool(MP_slot, &s);
@@ -97,6 +238,19 @@ slot* make_slot(agent* thisAgent, Symbol* id, Symbol* attr)
 
     s->wma_val_references = NIL;
 
+    s->pref_changes = 1;
+    s->consistent_at = 0;
+    s->indifferent_pairs = NIL;
+
+    if (id->id->slot_index)
+    {
+        add_to_slot_index(thisAgent, s);
+    }
+    else if (num_slots + 1 >= SLOT_INDEX_MIN_SLOTS)
+    {
+        build_slot_index(thisAgent, id, num_slots + 1);
+    }
+
     return s;
 }
 
@@ -104,6 +258,7 @@ void mark_slot_as_changed(agent* thisAgent, slot* s)
 {
     dl_cons* dc;
 
+    s->pref_changes++;
     if (s->isa_context_slot)
     {
         if (thisAgent->highest_goal_whose_context_changed)
@@ -193,6 +348,10 @@ void remove_garbage_slots(agent* thisAgent)
             remove_from_dll(thisAgent->changed_slots, s->changed, next, prev);
             thisAgent->memoryManager->free_with_pool(MP_dl_cons, s->changed);
         }
+        if (s->id->id->slot_index)
+        {
+            remove_from_slot_index(thisAgent, s);
+        }
         remove_from_dll(s->id->id->slots, s, next, prev);
         thisAgent->symbolManager->symbol_remove_ref(&s->id);
         thisAgent->symbolManager->symbol_remove_ref(&s->attr);
@@ -202,6 +361,12 @@ void remove_garbage_slots(agent* thisAgent)
             thisAgent->memoryManager->free_with_pool(MP_wma_slot_refs, s->wma_val_references);
             s->wma_val_references = NIL;
         }
+        if (s->indifferent_pairs)
+        {
+            s->indifferent_pairs->~sym_pair_count_map();
+            thisAgent->memoryManager->free_memory(s->indifferent_pairs, HASH_TABLE_MEM_USAGE);
+            s->indifferent_pairs = NIL;
+        }
         thisAgent->memoryManager->free_with_pool(MP_slot, s);
     }
 }
@@ -24,6 +24,14 @@
    of the same production firing, for example).  At the end of the phase,
    we call remove_garbage_slots(), which scans through each marked slot
    and garbage collects it if it has no wmes or preferences.
+
+   Identifiers with many slots (wide objects, usually on the input link)
+   also get a slot index, an open-addressing hash of their slots keyed on
+   the attribute's address, so that find_slot() and make_slot() don't
+   walk the whole slot list.  The index is made when an identifier reaches
+   SLOT_INDEX_MIN_SLOTS slots and freed when it drops back to a quarter
+   of that.  Free_slot_index() drops it early, for code that unhooks an
+   identifier's slot list itself.
 --------------------------------------------------------------------- */
 
 #ifndef TEMPMEM_H
@@ -56,12 +64,39 @@ typedef struct slot_struct
 
     wma_sym_reference_map* wma_val_references;
 
+    uint64_t pref_changes;              /* bumped whenever the slot's prefs change;
+                                           starts at 1 */
+    uint64_t consistent_at;             /* for context slots: pref_changes when the
+                                           current decision was last found consistent
+                                           with the prefs, or 0 if it has to be checked */
+    sym_pair_count_map* indifferent_pairs;  /* for context slots: number of binary
+                                               indifferent prefs between each pair of
+                                               values, or NIL if there never were any */
+
 } slot;
 
+/* --- one entry of a slot index; the attribute is kept next to the slot
+   so probes don't have to touch the slots they skip --- */
+typedef struct slot_index_entry_struct
+{
+    Symbol* attr;
+    struct slot_struct* s;             /* NIL if the entry is empty */
+} slot_index_entry;
+
+typedef struct slot_index_struct
+{
+    slot_index_entry* entries;
+    uint32_t size;                     /* a power of 2 */
+    uint32_t count;
+} slot_index;
+
+#define SLOT_INDEX_MIN_SLOTS 16
+
 extern slot* find_slot(Symbol* id, Symbol* attr);
 extern slot* make_slot(agent* thisAgent, Symbol* id, Symbol* attr);
 extern void mark_slot_as_changed(agent* thisAgent, slot* s);
 extern void mark_slot_for_possible_removal(agent* thisAgent, slot* s);
 extern void remove_garbage_slots(agent* thisAgent);
+extern void free_slot_index(agent* thisAgent, Symbol* id);
 
 #endif
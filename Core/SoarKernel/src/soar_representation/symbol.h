@@ -54,16 +54,13 @@ struct strSymbol;
  * to see the type-specific variables in a debugger.  It can also help find some
  * bugs where some part of the kernel may be treating a symbol as the wrong type.
  *
- * WARNING: next_in_hash_table MUST be the first field.  This field is used
- *          by the resizable hash table routines.
- *
  * Explanations of all the fields are at the end of the file.
  *
  * -- */
 
 typedef struct EXPORT symbol_struct
 {
-    struct symbol_struct* next_in_hash_table;
+    uint64_t table_hash;
     uint64_t reference_count;
     byte symbol_type;
     byte decider_flag;
@@ -177,6 +174,7 @@ struct idSymbol    : public Symbol
     dl_cons* unknown_level;
 
     struct slot_struct* slots;  /* dll of slots for this identifier */
+    struct slot_index_struct* slot_index;  /* NIL until there are many slots, see slot.h */
 
     /* --- fields used only on goals and impasse identifiers --- */
     struct wme_struct* impasse_wmes;
@@ -293,7 +291,9 @@ double get_number_from_symbol(Symbol* sym);
  * =====================
  * symbol_type                 Indicates which of the five kinds of symbols
  * reference_count             Current reference count for this symbol
- * next_in_hash_table          Next item in hash bucket
+ * table_hash                  Hash of the name or value, computed once when
+ *                             the symbol is created and used by the symbol
+ *                             tables for probing and rehashing
  * hash_id                     Used for hashing in the rete (and elsewhere)
  * retesave_symindex           Used for rete fastsave/fastload
  * tc_num                      Used for transitive closure/marking
@@ -333,6 +333,8 @@ double get_number_from_symbol(Symbol* sym);
  *                             figure out whether a given object is an operator.
  * name_number, name_letter    Name and letter of the identifier
  * slots                       DLL of all slots this symbol is used in
+ * slot_index                  Hash index of those slots by attribute, made once
+ *                             there are SLOT_INDEX_MIN_SLOTS of them (see slot.h)
  * tc_num                      Unique numbers put in here to mark ID for things like
  *                             transitive closures
  * variablization              When variablizing chunks, this points to the variable to
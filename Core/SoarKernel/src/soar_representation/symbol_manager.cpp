@@ -34,132 +34,180 @@ Symbol_Manager::Symbol_Manager(agent* pAgent)
 
 Symbol_Manager::~Symbol_Manager()
 {
-    free_hash_table(thisAgent, variable_hash_table);
-    free_hash_table(thisAgent, identifier_hash_table);
-    free_hash_table(thisAgent, str_constant_hash_table);
-    free_hash_table(thisAgent, int_constant_hash_table);
-    free_hash_table(thisAgent, float_constant_hash_table);
+    free_symbol_table(thisAgent, variable_hash_table);
+    free_symbol_table(thisAgent, identifier_hash_table);
+    free_symbol_table(thisAgent, str_constant_hash_table);
+    free_symbol_table(thisAgent, int_constant_hash_table);
+    free_symbol_table(thisAgent, float_constant_hash_table);
 }
 
 /* -------------------------------------------------------------------
                            Hash Functions
 
-   Compress() takes a 32-bit hash value and compresses it down to a few
-   bits, xor-ing pieces of the 32-bit value to avoid throwing away bits
-   that might be important for the hash function to be effective.
-
-   Hash_string() produces a hash value for a string of characters.
-
-   Hash_xxx_raw_info() are the hash functions for the five kinds of
-   symbols.  These functions operate on the basic info about the symbol
-   (i.e., the name, value, etc.).  Hash_xxx(), on the other hand,
-   operate on the symbol table entries for the five kinds of symbols--
-   these routines are the callback hashing functions used by the
-   resizable hash table routines.
+   Hash_symbol_name() hashes a variable or string constant name eight
+   bytes at a time and hash_symbol_value() scrambles an identifier's
+   letter and number or a numeric constant's bits.  Both return full
+   64-bit hashes that are stored in the symbol's table_hash; the symbol
+   tables use the low bits to pick a slot.
 ------------------------------------------------------------------- */
 
-uint32_t compress(uint32_t h, short num_bits)
+static inline uint64_t rotate_left_64(uint64_t x, int r)
 {
-    uint32_t result;
+    return (x << r) | (x >> (64 - r));
+}
 
-    if (num_bits < 16)
-    {
-        h = (h & 0xFFFF) ^ (h >> 16);
-    }
-    if (num_bits < 8)
-    {
-        h = (h & 0xFF) ^ (h >> 8);
-    }
-    result = 0;
-    while (h)
-    {
-        result ^= (h & masks_for_n_low_order_bits[num_bits]);
-        h = h >> num_bits;
-    }
-    return result;
+static inline uint64_t finish_symbol_hash(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
 }
 
-uint32_t hash_string(const char* s)      /* AGR 600 */
+uint64_t hash_symbol_name(const char* name)
 {
-    uint32_t h;
+    const uint64_t c1 = 0x87C37B91114253D5ULL;
+    const uint64_t c2 = 0x4CF5AD432745937FULL;
+    size_t len = strlen(name);
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ len;
+    uint64_t k;
 
-    h = 0;
-    while (*s != 0)
+    for (; len >= 8; len -= 8, name += 8)
     {
-        h = ((h << 8) | (h >> 24)) ^ (*s);
-        s++;
+        memcpy(&k, name, 8);
+        h ^= rotate_left_64(k * c1, 31) * c2;
+        h = rotate_left_64(h, 27) * 5 + 0x52DCE729;
     }
-    return h;
+    if (len)
+    {
+        k = 0;
+        memcpy(&k, name, len);
+        h ^= rotate_left_64(k * c1, 31) * c2;
+    }
+    return finish_symbol_hash(h);
 }
 
-/* -----------------------------------------
-   Hashing symbols using their basic info
------------------------------------------ */
-
-uint32_t hash_variable_raw_info(const char* name, short num_bits)
+uint64_t hash_symbol_value(uint64_t value)
 {
-    return compress(hash_string(name), num_bits);
+    return finish_symbol_hash(value ^ 0x9E3779B97F4A7C15ULL);
 }
 
-uint32_t hash_identifier_raw_info(char name_letter,
-                                  uint64_t name_number,
-                                  short num_bits)
+static inline uint64_t hash_identifier_info(char name_letter, uint64_t name_number)
 {
-    return compress(static_cast<uint32_t>(name_number) ^ (static_cast<uint32_t>(name_letter) << 24), num_bits);  // FIXME: cast from 64 to 32 bits
+    return hash_symbol_value(name_number ^ (static_cast<uint64_t>(name_letter) << 56));
 }
 
-uint32_t hash_str_constant_raw_info(const char* name, short num_bits)
+static inline uint64_t hash_float_value(double value)
 {
-    return compress(hash_string(name), num_bits);
+    uint64_t bits;
+
+    /* -0.0 and 0.0 compare equal, so they have to hash the same */
+    if (value == 0.0) value = 0.0;
+    memcpy(&bits, &value, sizeof(bits));
+    return hash_symbol_value(bits);
 }
 
-uint32_t hash_int_constant_raw_info(int64_t value, short num_bits)
+/* -------------------------------------------------------------------
+                        Symbol Table Storage
+------------------------------------------------------------------- */
+
+#define SYMBOL_TABLE_MIN_SIZE 16
+
+static Symbol** allocate_symbol_slots(agent* thisAgent, uint32_t size)
 {
-    return compress(static_cast<uint32_t>(value), num_bits);
+    Symbol** slots = static_cast<Symbol**>(thisAgent->memoryManager->allocate_memory(size * sizeof(Symbol*), HASH_TABLE_MEM_USAGE));
+    memset(slots, 0, size * sizeof(Symbol*));
+    return slots;
 }
 
-uint32_t hash_float_constant_raw_info(double value, short num_bits)
+static void resize_symbol_table(agent* thisAgent, symbol_table* st, uint32_t new_size)
 {
-    return compress(static_cast<uint32_t>(value), num_bits);
+    Symbol** old_slots = st->slots;
+    uint32_t old_size = st->size;
+    uint32_t mask = new_size - 1;
+    uint32_t i;
+
+    st->slots = allocate_symbol_slots(thisAgent, new_size);
+    st->size = new_size;
+    for (uint32_t j = 0; j < old_size; j++)
+    {
+        if (!old_slots[j]) continue;
+        for (i = old_slots[j]->table_hash & mask; st->slots[i]; i = (i + 1) & mask);
+        st->slots[i] = old_slots[j];
+    }
+    thisAgent->memoryManager->free_memory(old_slots, HASH_TABLE_MEM_USAGE);
 }
 
-/* ---------------------------------------------------
-   Hashing symbols using their symbol table entries
---------------------------------------------------- */
-
-uint32_t hash_variable(void* item, short num_bits)
+symbol_table* make_symbol_table(agent* thisAgent)
 {
-    varSymbol* var;
-    var = static_cast<varSymbol*>(item);
-    return compress(hash_string(var->name), num_bits);
+    symbol_table* st = static_cast<symbol_table*>(thisAgent->memoryManager->allocate_memory(sizeof(symbol_table), HASH_TABLE_MEM_USAGE));
+    st->count = 0;
+    st->size = SYMBOL_TABLE_MIN_SIZE;
+    st->slots = allocate_symbol_slots(thisAgent, st->size);
+    return st;
 }
 
-uint32_t hash_identifier(void* item, short num_bits)
+void free_symbol_table(agent* thisAgent, symbol_table* st)
 {
-    idSymbol* id;
-    id = static_cast<idSymbol*>(item);
-    return compress(static_cast<uint32_t>(id->name_number) ^ (static_cast<uint32_t>(id->name_letter) << 24), num_bits);  // FIXME: cast from 64 to 32 bits
+    thisAgent->memoryManager->free_memory(st->slots, HASH_TABLE_MEM_USAGE);
+    thisAgent->memoryManager->free_memory(st, HASH_TABLE_MEM_USAGE);
 }
 
-uint32_t hash_str_constant(void* item, short num_bits)
+void add_to_symbol_table(agent* thisAgent, symbol_table* st, Symbol* sym)
 {
-    strSymbol* sc;
-    sc = static_cast<strSymbol*>(item);
-    return compress(hash_string(sc->name), num_bits);
+    uint32_t mask, i;
+
+    if ((st->count + 1) * 4 > static_cast<uint64_t>(st->size) * 3)
+    {
+        resize_symbol_table(thisAgent, st, st->size * 2);
+    }
+    mask = st->size - 1;
+    for (i = sym->table_hash & mask; st->slots[i]; i = (i + 1) & mask);
+    st->slots[i] = sym;
+    st->count++;
 }
 
-uint32_t hash_int_constant(void* item, short num_bits)
+void remove_from_symbol_table(agent* thisAgent, symbol_table* st, Symbol* sym)
 {
-    intSymbol* ic;
-    ic = static_cast<intSymbol*>(item);
-    return compress(static_cast<uint32_t>(ic->value), num_bits);
+    uint32_t mask = st->size - 1;
+    uint32_t i, j, home;
+
+    for (i = sym->table_hash & mask; st->slots[i] != sym; i = (i + 1) & mask)
+    {
+        if (!st->slots[i]) return;
+    }
+
+    /* Pull later members of the probe run back over the hole, as long as
+     * that doesn't move one in front of its home slot */
+    for (j = (i + 1) & mask; st->slots[j]; j = (j + 1) & mask)
+    {
+        home = st->slots[j]->table_hash & mask;
+        if ((j > i) ? (home <= i || home > j) : (home <= i && home > j))
+        {
+            st->slots[i] = st->slots[j];
+            i = j;
+        }
+    }
+    st->slots[i] = NIL;
+    st->count--;
+
+    if ((st->size > SYMBOL_TABLE_MIN_SIZE) && (st->count * 8 < st->size))
+    {
+        resize_symbol_table(thisAgent, st, st->size / 2);
+    }
 }
 
-uint32_t hash_float_constant(void* item, short num_bits)
+void do_for_all_symbols_in_table(agent* thisAgent, symbol_table* st, hash_table_callback_fn2 f, void* userdata)
 {
-    floatSymbol* fc;
-    fc = static_cast<floatSymbol*>(item);
-    return compress(static_cast<uint32_t>(fc->value), num_bits);
+    for (uint32_t i = 0; i < st->size; i++)
+    {
+        if (st->slots[i] && (*f)(thisAgent, st->slots[i], userdata))
+        {
+            return;
+        }
+    }
 }
 
 /* -----------------------------------------------------------------
@@ -217,11 +265,11 @@ uint32_t hash_float_constant(void* item, short num_bits)
 
 void Symbol_Manager::init_symbol_tables()
 {
-    variable_hash_table = make_hash_table(thisAgent, 0, hash_variable);
-    identifier_hash_table = make_hash_table(thisAgent, 0, hash_identifier);
-    str_constant_hash_table = make_hash_table(thisAgent, 0, hash_str_constant);
-    int_constant_hash_table = make_hash_table(thisAgent, 0, hash_int_constant);
-    float_constant_hash_table = make_hash_table(thisAgent, 0, hash_float_constant);
+    variable_hash_table = make_symbol_table(thisAgent);
+    identifier_hash_table = make_symbol_table(thisAgent);
+    str_constant_hash_table = make_symbol_table(thisAgent);
+    int_constant_hash_table = make_symbol_table(thisAgent);
+    float_constant_hash_table = make_symbol_table(thisAgent);
 
     thisAgent->memoryManager->init_memory_pool(MP_variable, sizeof(varSymbol), "variable");
     thisAgent->memoryManager->init_memory_pool(MP_identifier, sizeof(idSymbol), "identifier");
@@ -235,40 +283,39 @@ void Symbol_Manager::init_symbol_tables()
 bool retesave_symbol_and_assign_index(agent* thisAgent, void* item, void* userdata)
 {
     Symbol* sym;
-    FILE* f = reinterpret_cast<FILE*>(userdata);
+    rete_fs* rfs = reinterpret_cast<rete_fs*>(userdata);
 
     sym = static_cast<symbol_struct*>(item);
     thisAgent->current_retesave_symindex++;
     sym->retesave_symindex = thisAgent->current_retesave_symindex;
-    retesave_string(sym->to_string(), f);
+    retesave_symbol(sym, rfs);
     return false;
 }
 
 
-void Symbol_Manager::retesave(FILE* f)
+void Symbol_Manager::retesave(rete_fs* rfs)
 {
     thisAgent->current_retesave_symindex = 0;
 
-    retesave_eight_bytes(str_constant_hash_table->count, f);
-    retesave_eight_bytes(variable_hash_table->count, f);
-    retesave_eight_bytes(int_constant_hash_table->count, f);
-    retesave_eight_bytes(float_constant_hash_table->count, f);
+    retesave_eight_bytes(str_constant_hash_table->count, rfs);
+    retesave_eight_bytes(variable_hash_table->count, rfs);
+    retesave_eight_bytes(int_constant_hash_table->count, rfs);
+    retesave_eight_bytes(float_constant_hash_table->count, rfs);
 
-    do_for_all_items_in_hash_table(thisAgent, str_constant_hash_table, retesave_symbol_and_assign_index, f);
-    do_for_all_items_in_hash_table(thisAgent, variable_hash_table, retesave_symbol_and_assign_index, f);
-    do_for_all_items_in_hash_table(thisAgent, int_constant_hash_table, retesave_symbol_and_assign_index, f);
-    do_for_all_items_in_hash_table(thisAgent, float_constant_hash_table, retesave_symbol_and_assign_index, f);
+    do_for_all_symbols_in_table(thisAgent, str_constant_hash_table, retesave_symbol_and_assign_index, rfs);
+    do_for_all_symbols_in_table(thisAgent, variable_hash_table, retesave_symbol_and_assign_index, rfs);
+    do_for_all_symbols_in_table(thisAgent, int_constant_hash_table, retesave_symbol_and_assign_index, rfs);
+    do_for_all_symbols_in_table(thisAgent, float_constant_hash_table, retesave_symbol_and_assign_index, rfs);
 }
 Symbol* Symbol_Manager::find_variable(const char* name)
 {
-    uint32_t hash_value;
-    varSymbol* sym;
+    uint64_t hash_value = hash_symbol_name(name);
+    uint32_t mask = variable_hash_table->size - 1;
+    Symbol* sym;
 
-    hash_value = hash_variable_raw_info(name, variable_hash_table->log2size);
-    sym = reinterpret_cast<varSymbol*>(*(variable_hash_table->buckets + hash_value));
-    for (; sym != NIL; sym = static_cast<varSymbol*>(sym->next_in_hash_table))
+    for (uint32_t i = hash_value & mask; (sym = variable_hash_table->slots[i]) != NIL; i = (i + 1) & mask)
     {
-        if (!strcmp(sym->name, name))
+        if ((sym->table_hash == hash_value) && !strcmp(sym->var->name, name))
         {
             return sym;
         }
@@ -278,16 +325,14 @@ Symbol* Symbol_Manager::find_variable(const char* name)
 
 Symbol* Symbol_Manager::find_identifier(char name_letter, uint64_t name_number)
 {
-    uint32_t hash_value;
-    idSymbol* sym;
+    uint64_t hash_value = hash_identifier_info(name_letter, name_number);
+    uint32_t mask = identifier_hash_table->size - 1;
+    Symbol* sym;
 
-    hash_value = hash_identifier_raw_info(name_letter, name_number,
-                                          identifier_hash_table->log2size);
-    sym = reinterpret_cast<idSymbol*>(*(identifier_hash_table->buckets + hash_value));
-    for (; sym != NIL; sym = static_cast<idSymbol*>(sym->next_in_hash_table))
+    for (uint32_t i = hash_value & mask; (sym = identifier_hash_table->slots[i]) != NIL; i = (i + 1) & mask)
     {
-        if ((name_letter == sym->name_letter) &&
-                (name_number == sym->name_number))
+        if ((name_letter == sym->id->name_letter) &&
+                (name_number == sym->id->name_number))
         {
             return sym;
         }
@@ -297,15 +342,17 @@ Symbol* Symbol_Manager::find_identifier(char name_letter, uint64_t name_number)
 
 Symbol* Symbol_Manager::find_str_constant(const char* name)
 {
-    uint32_t hash_value;
-    strSymbol* sym;
+    return find_str_constant_hashed(name, hash_symbol_name(name));
+}
 
-    hash_value = hash_str_constant_raw_info(name,
-                                            str_constant_hash_table->log2size);
-    sym = reinterpret_cast<strSymbol*>(*(str_constant_hash_table->buckets + hash_value));
-    for (; sym != NIL; sym = static_cast<strSymbol*>(sym->next_in_hash_table))
+Symbol* Symbol_Manager::find_str_constant_hashed(const char* name, uint64_t hash_value)
+{
+    uint32_t mask = str_constant_hash_table->size - 1;
+    Symbol* sym;
+
+    for (uint32_t i = hash_value & mask; (sym = str_constant_hash_table->slots[i]) != NIL; i = (i + 1) & mask)
     {
-        if (!strcmp(sym->name, name))
+        if ((sym->table_hash == hash_value) && !strcmp(sym->sc->name, name))
         {
             return sym;
         }
@@ -315,15 +362,13 @@ Symbol* Symbol_Manager::find_str_constant(const char* name)
 
 Symbol* Symbol_Manager::find_int_constant(int64_t value)
 {
-    uint32_t hash_value;
-    intSymbol* sym;
+    uint64_t hash_value = hash_symbol_value(static_cast<uint64_t>(value));
+    uint32_t mask = int_constant_hash_table->size - 1;
+    Symbol* sym;
 
-    hash_value = hash_int_constant_raw_info(value,
-                                            int_constant_hash_table->log2size);
-    sym = reinterpret_cast<intSymbol*>(*(int_constant_hash_table->buckets + hash_value));
-    for (; sym != NIL; sym = static_cast<intSymbol*>(sym->next_in_hash_table))
+    for (uint32_t i = hash_value & mask; (sym = int_constant_hash_table->slots[i]) != NIL; i = (i + 1) & mask)
     {
-        if (value == sym->value)
+        if (value == sym->ic->value)
         {
             return sym;
         }
@@ -333,15 +378,13 @@ Symbol* Symbol_Manager::find_int_constant(int64_t value)
 
 Symbol* Symbol_Manager::find_float_constant(double value)
 {
-    uint32_t hash_value;
-    floatSymbol* sym;
+    uint64_t hash_value = hash_float_value(value);
+    uint32_t mask = float_constant_hash_table->size - 1;
+    Symbol* sym;
 
-    hash_value = hash_float_constant_raw_info(value,
-                 float_constant_hash_table->log2size);
-    sym = reinterpret_cast<floatSymbol*>(*(float_constant_hash_table->buckets + hash_value));
-    for (; sym != NIL; sym = static_cast<floatSymbol*>(sym->next_in_hash_table))
+    for (uint32_t i = hash_value & mask; (sym = float_constant_hash_table->slots[i]) != NIL; i = (i + 1) & mask)
     {
-        if (value == sym->value)
+        if (value == sym->fc->value)
         {
             return sym;
         }
@@ -363,6 +406,7 @@ Symbol* Symbol_Manager::make_variable(const char* name)
 
     thisAgent->memoryManager->allocate_with_pool(MP_variable, &sym);
     sym->symbol_type = VARIABLE_SYMBOL_TYPE;
+    sym->table_hash = hash_symbol_name(name);
     sym->reference_count = 0;
     sym->hash_id = get_next_symbol_hash_id(thisAgent);
     sym->tc_num = 0;
@@ -378,7 +422,7 @@ Symbol* Symbol_Manager::make_variable(const char* name)
     sym->id = NULL;
     sym->var = sym;
     symbol_add_ref(sym);
-    add_to_hash_table(thisAgent, variable_hash_table, sym);
+    add_to_symbol_table(thisAgent, variable_hash_table, sym);
 
     return sym;
 }
@@ -425,9 +469,11 @@ Symbol* Symbol_Manager::make_new_identifier(char name_letter, goal_stack_level l
         }
     }
     sym->name_number = name_number;
+    sym->table_hash = hash_identifier_info(name_letter, name_number);
     sym->level = level;
     sym->promotion_level = level;
     sym->slots = NULL;
+    sym->slot_index = NULL;
     sym->isa_goal = false;
     sym->isa_impasse = false;
     sym->isa_operator = 0;
@@ -467,7 +513,7 @@ Symbol* Symbol_Manager::make_new_identifier(char name_letter, goal_stack_level l
     sym->var = NULL;
     sym->id = sym;
     symbol_add_ref(sym);
-    add_to_hash_table(thisAgent, identifier_hash_table, sym);
+    add_to_symbol_table(thisAgent, identifier_hash_table, sym);
 
     return sym;
 }
@@ -476,11 +522,17 @@ Symbol* Symbol_Manager::make_new_identifier(char name_letter, goal_stack_level l
  * Avoids calling find
  */
 Symbol* Symbol_Manager::make_str_constant_no_find(char const* name)
+{
+    return make_str_constant_hashed(name, hash_symbol_name(name));
+}
+
+Symbol* Symbol_Manager::make_str_constant_hashed(char const* name, uint64_t hash_value)
 {
     strSymbol* sym;
 
     thisAgent->memoryManager->allocate_with_pool(MP_str_constant, &sym);
     sym->symbol_type = STR_CONSTANT_SYMBOL_TYPE;
+    sym->table_hash = hash_value;
     sym->reference_count = 0;
     sym->hash_id = get_next_symbol_hash_id(thisAgent);
     sym->tc_num = 0;
@@ -489,7 +541,7 @@ Symbol* Symbol_Manager::make_str_constant_no_find(char const* name)
     sym->epmem_valid = 0;
     sym->smem_hash = 0;
     sym->smem_valid = 0;
-    sym->name = make_memory_block_for_string(thisAgent, name);
+    sym->name = thisAgent->memoryManager->make_arena_string(name);
     sym->thisAgent = thisAgent;
     sym->cached_rereadable_print_str = NULL;
     sym->production = NULL;
@@ -499,21 +551,21 @@ Symbol* Symbol_Manager::make_str_constant_no_find(char const* name)
     sym->var = NULL;
     sym->sc = sym;
     symbol_add_ref(sym);
-    add_to_hash_table(thisAgent, str_constant_hash_table, sym);
+    add_to_symbol_table(thisAgent, str_constant_hash_table, sym);
 
     return sym;
 }
 
 Symbol* Symbol_Manager::make_str_constant(char const* name)
 {
-    strSymbol* sym;
-    sym = static_cast<strSymbol*>(find_str_constant(name));
+    uint64_t hash_value = hash_symbol_name(name);
+    Symbol* sym = find_str_constant_hashed(name, hash_value);
     if (sym)
     {
         symbol_add_ref(sym);
         return sym;
     }
-    return make_str_constant_no_find(name);
+    return make_str_constant_hashed(name, hash_value);
 }
 
 Symbol* Symbol_Manager::make_int_constant(int64_t value)
@@ -529,6 +581,7 @@ Symbol* Symbol_Manager::make_int_constant(int64_t value)
     {
         thisAgent->memoryManager->allocate_with_pool(MP_int_constant, &sym);
         sym->symbol_type = INT_CONSTANT_SYMBOL_TYPE;
+        sym->table_hash = hash_symbol_value(static_cast<uint64_t>(value));
         sym->reference_count = 0;
         sym->hash_id = get_next_symbol_hash_id(thisAgent);
         sym->tc_num = 0;
@@ -545,7 +598,7 @@ Symbol* Symbol_Manager::make_int_constant(int64_t value)
         sym->var = NULL;
         sym->ic = sym;
         symbol_add_ref(sym);
-        add_to_hash_table(thisAgent, int_constant_hash_table, sym);
+        add_to_symbol_table(thisAgent, int_constant_hash_table, sym);
     }
     return sym;
 }
@@ -563,6 +616,7 @@ Symbol* Symbol_Manager::make_float_constant(double value)
     {
         thisAgent->memoryManager->allocate_with_pool(MP_float_constant, &sym);
         sym->symbol_type = FLOAT_CONSTANT_SYMBOL_TYPE;
+        sym->table_hash = hash_float_value(value);
         sym->reference_count = 0;
         sym->hash_id = get_next_symbol_hash_id(thisAgent);
         sym->tc_num = 0;
@@ -579,7 +633,7 @@ Symbol* Symbol_Manager::make_float_constant(double value)
         sym->var = NULL;
         sym->fc = sym;
         symbol_add_ref(sym);
-        add_to_hash_table(thisAgent, float_constant_hash_table, sym);
+        add_to_symbol_table(thisAgent, float_constant_hash_table, sym);
     }
     return sym;
 }
@@ -907,31 +961,31 @@ void Symbol_Manager::deallocate_symbol(Symbol*& sym)
     switch (sym->symbol_type)
     {
         case VARIABLE_SYMBOL_TYPE:
-            remove_from_hash_table(thisAgent, variable_hash_table, sym);
+            remove_from_symbol_table(thisAgent, variable_hash_table, sym);
             free_memory_block_for_string(thisAgent, sym->var->name);
             thisAgent->memoryManager->free_with_pool(MP_variable, sym);
             break;
         case IDENTIFIER_SYMBOL_TYPE:
             if (sym->id->cached_print_str) free_memory_block_for_string(thisAgent, sym->id->cached_print_str);
             if (sym->id->cached_lti_str) free_memory_block_for_string(thisAgent, sym->id->cached_lti_str);
-            remove_from_hash_table(thisAgent, identifier_hash_table, sym);
+            remove_from_symbol_table(thisAgent, identifier_hash_table, sym);
             thisAgent->memoryManager->free_with_pool(MP_identifier, sym);
             break;
         case STR_CONSTANT_SYMBOL_TYPE:
             if (sym->sc->cached_rereadable_print_str && (sym->sc->cached_rereadable_print_str != sym->sc->name))
                 free_memory_block_for_string(thisAgent, sym->sc->cached_rereadable_print_str);
-            remove_from_hash_table(thisAgent, str_constant_hash_table, sym);
-            free_memory_block_for_string(thisAgent, sym->sc->name);
+            remove_from_symbol_table(thisAgent, str_constant_hash_table, sym);
+            thisAgent->memoryManager->free_arena_string(sym->sc->name);
             thisAgent->memoryManager->free_with_pool(MP_str_constant, sym);
             break;
         case INT_CONSTANT_SYMBOL_TYPE:
             if (sym->ic->cached_print_str) free_memory_block_for_string(thisAgent, sym->ic->cached_print_str);
-            remove_from_hash_table(thisAgent, int_constant_hash_table, sym);
+            remove_from_symbol_table(thisAgent, int_constant_hash_table, sym);
             thisAgent->memoryManager->free_with_pool(MP_int_constant, sym);
             break;
         case FLOAT_CONSTANT_SYMBOL_TYPE:
             if (sym->fc->cached_print_str) free_memory_block_for_string(thisAgent, sym->fc->cached_print_str);
-            remove_from_hash_table(thisAgent, float_constant_hash_table, sym);
+            remove_from_symbol_table(thisAgent, float_constant_hash_table, sym);
             thisAgent->memoryManager->free_with_pool(MP_float_constant, sym);
             break;
         default:
@@ -1022,21 +1076,49 @@ bool print_sym(agent* thisAgent, void* item, void*)
 
 void Symbol_Manager::clear_variable_gensym_numbers()
 {
-    do_for_all_items_in_hash_table(thisAgent, variable_hash_table, clear_gensym_number, 0);
+    do_for_all_symbols_in_table(thisAgent, variable_hash_table, clear_gensym_number, 0);
 }
 
 void Symbol_Manager::print_internal_symbols()
 {
     thisAgent->outputManager->printa_sf(thisAgent,  "\n--- Symbolic Constants: ---\n");
-    do_for_all_items_in_hash_table(thisAgent, str_constant_hash_table, print_sym, 0);
+    do_for_all_symbols_in_table(thisAgent, str_constant_hash_table, print_sym, 0);
     thisAgent->outputManager->printa_sf(thisAgent,  "\n--- Integer Constants: ---\n");
-    do_for_all_items_in_hash_table(thisAgent, int_constant_hash_table, print_sym, 0);
+    do_for_all_symbols_in_table(thisAgent, int_constant_hash_table, print_sym, 0);
     thisAgent->outputManager->printa_sf(thisAgent,  "\n--- Floating-Point Constants: ---\n");
-    do_for_all_items_in_hash_table(thisAgent, float_constant_hash_table, print_sym, 0);
+    do_for_all_symbols_in_table(thisAgent, float_constant_hash_table, print_sym, 0);
     thisAgent->outputManager->printa_sf(thisAgent,  "\n--- Identifiers: ---\n");
-    do_for_all_items_in_hash_table(thisAgent, identifier_hash_table, print_sym, 0);
+    do_for_all_symbols_in_table(thisAgent, identifier_hash_table, print_sym, 0);
     thisAgent->outputManager->printa_sf(thisAgent,  "\n--- Variables: ---\n");
-    do_for_all_items_in_hash_table(thisAgent, variable_hash_table, print_sym, 0);
+    do_for_all_symbols_in_table(thisAgent, variable_hash_table, print_sym, 0);
+}
+
+size_t Symbol_Manager::compact_str_constant_names()
+{
+    string_arena_chunk* old_chunks;
+    strSymbol* sym;
+    char* old_name;
+
+    if (!thisAgent->memoryManager->string_arena_is_sparse())
+    {
+        return 0;
+    }
+
+    old_chunks = thisAgent->memoryManager->begin_string_arena_compaction();
+    for (uint32_t i = 0; i < str_constant_hash_table->size; i++)
+    {
+        if (str_constant_hash_table->slots[i])
+        {
+            sym = str_constant_hash_table->slots[i]->sc;
+            old_name = sym->name;
+            sym->name = thisAgent->memoryManager->move_arena_string(old_name);
+            if (sym->cached_rereadable_print_str == old_name)
+            {
+                sym->cached_rereadable_print_str = sym->name;
+            }
+        }
+    }
+    return thisAgent->memoryManager->end_string_arena_compaction(old_chunks);
 }
 
 void Symbol_Manager::reset_hash_table(MemoryPoolType lHashTable)
@@ -1051,7 +1133,7 @@ void Symbol_Manager::reset_hash_table(MemoryPoolType lHashTable)
                  * detect refcount leaks in unit tests and print out a message accordingly */
                 #ifndef SOAR_RELEASE_VERSION
                     if (identifier_hash_table->count < 23)
-                        do_for_all_items_in_hash_table(thisAgent, identifier_hash_table, print_sym, 0);
+                        do_for_all_symbols_in_table(thisAgent, identifier_hash_table, print_sym, 0);
                     else
                         std::cout << "Refcount leak of " << identifier_hash_table->count << " identifiers detected. ";
                 #else
@@ -1067,12 +1149,12 @@ void Symbol_Manager::reset_hash_table(MemoryPoolType lHashTable)
                 /* Note:  The do_for_all_items_in_hash_table printing could cause a crash if there's
                  *        memory corruption, but usually prints out and is good for debugging. */
                 #ifndef SOAR_RELEASE_VERSION
-                do_for_all_items_in_hash_table(thisAgent, identifier_hash_table, print_sym, 0);
+                do_for_all_symbols_in_table(thisAgent, identifier_hash_table, print_sym, 0);
                 #endif
             }
-            free_hash_table(thisAgent, identifier_hash_table);
+            free_symbol_table(thisAgent, identifier_hash_table);
             thisAgent->memoryManager->free_memory_pool(MP_identifier);
-            identifier_hash_table = make_hash_table(thisAgent, 0, hash_identifier);
+            identifier_hash_table = make_symbol_table(thisAgent);
         }
     }
 }
@@ -1093,8 +1175,8 @@ bool reset_tc_num(agent* /*thisAgent*/, void* item, void*)
 
 void Symbol_Manager::reset_id_and_variable_tc_numbers()
 {
-    do_for_all_items_in_hash_table(thisAgent, identifier_hash_table, reset_tc_num, 0);
-    do_for_all_items_in_hash_table(thisAgent, variable_hash_table, reset_tc_num, 0);
+    do_for_all_symbols_in_table(thisAgent, identifier_hash_table, reset_tc_num, 0);
+    do_for_all_symbols_in_table(thisAgent, variable_hash_table, reset_tc_num, 0);
 }
 
 Symbol* Symbol_Manager::generate_new_str_constant(const char* prefix, uint64_t* counter)
@@ -10,6 +10,7 @@
 
 #include "kernel.h"
 
+#include "mem.h"
 #include "symbol.h"
 #include "symbols_predefined.h"
 
@@ -17,6 +18,42 @@
 #include <string>
 bool is_DT_mode_enabled(TraceMode mode);
 
+/* --------------------------------------------------------------------
+                            Symbol Tables
+
+   Each kind of symbol lives in an open-addressing table of Symbol
+   pointers, probed linearly from the low bits of the symbol's
+   table_hash.  The hash is computed once, when the symbol is made, so
+   growing or shrinking a table never rehashes a name, and a probe only
+   compares names when the full 64-bit hashes match.  Removal shifts
+   the rest of the probe run back instead of leaving deleted markers,
+   so tables with heavy churn from input don't fill up with them.
+
+   The callback passed to do_for_all_symbols_in_table() must not add
+   or remove symbols in that table.
+
+   String constant names are kept in the agent memory manager's string
+   arena.  Compact_str_constant_names() moves them into fresh chunks
+   once most of the arena is names of symbols that have been freed, and
+   returns the number of bytes that gave back.
+-------------------------------------------------------------------- */
+
+typedef struct symbol_table_struct
+{
+    uint64_t count;     /* number of symbols in the table */
+    uint32_t size;      /* number of slots, always a power of two */
+    Symbol** slots;
+} symbol_table;
+
+extern symbol_table* make_symbol_table(agent* thisAgent);
+extern void free_symbol_table(agent* thisAgent, symbol_table* st);
+extern void add_to_symbol_table(agent* thisAgent, symbol_table* st, Symbol* sym);
+extern void remove_from_symbol_table(agent* thisAgent, symbol_table* st, Symbol* sym);
+extern void do_for_all_symbols_in_table(agent* thisAgent, symbol_table* st, hash_table_callback_fn2 f, void* userdata);
+
+extern uint64_t hash_symbol_name(const char* name);
+extern uint64_t hash_symbol_value(uint64_t value);
+
 class EXPORT Symbol_Manager {
 
         friend Output_Manager;
@@ -28,7 +65,7 @@ class EXPORT Symbol_Manager {
         predefined_symbols  soarSymbols;
 
         void init_symbol_tables();
-        void retesave(FILE* f);
+        void retesave(rete_fs* rfs);
 
         void create_predefined_symbols();
         void create_common_variables_and_numbers();
@@ -59,6 +96,7 @@ class EXPORT Symbol_Manager {
         void reset_id_counters();
         void reset_id_and_variable_tc_numbers();
         void reset_hash_table(MemoryPoolType lHashTable);
+        size_t compact_str_constant_names();
 
         uint64_t* get_id_counter(uint64_t name_letter ) { return &id_counter[name_letter]; }
 
@@ -109,16 +147,19 @@ class EXPORT Symbol_Manager {
         uint64_t    current_variable_gensym_number;
         uint64_t    gensymed_variable_count[26];
 
-        struct hash_table_struct* float_constant_hash_table;
-        struct hash_table_struct* identifier_hash_table;
-        struct hash_table_struct* int_constant_hash_table;
-        struct hash_table_struct* str_constant_hash_table;
-        struct hash_table_struct* variable_hash_table;
+        symbol_table* float_constant_hash_table;
+        symbol_table* identifier_hash_table;
+        symbol_table* int_constant_hash_table;
+        symbol_table* str_constant_hash_table;
+        symbol_table* variable_hash_table;
 
         void clear_variable_gensym_numbers();
 
         void deallocate_symbol(Symbol*& sym);
 
+        Symbol* find_str_constant_hashed(const char* name, uint64_t hash_value);
+        Symbol* make_str_constant_hashed(char const* name, uint64_t hash_value);
+
         uint32_t get_next_symbol_hash_id(agent* thisAgent) { return (current_symbol_hash_id += 137); }
 
 };
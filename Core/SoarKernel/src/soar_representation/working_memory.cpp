@@ -245,7 +245,6 @@ void do_buffered_wm_changes(agent* thisAgent)
             }
         }
         #endif
-        add_wme_to_rete(thisAgent, static_cast<wme_struct*>(c->first));
     }
     for (c = thisAgent->wmes_to_remove; c != NIL; c = c->rest)
     {
@@ -274,8 +273,8 @@ void do_buffered_wm_changes(agent* thisAgent)
             }
         }
         #endif
-        remove_wme_from_rete(thisAgent, static_cast<wme_struct*>(c->first));
     }
+    apply_wme_changes_to_rete(thisAgent, thisAgent->wmes_to_add, thisAgent->wmes_to_remove);
     #ifndef NO_TIMING_STUFF
     #ifdef DETAILED_TIMING_STATS
     local_timer.stop();
@@ -4,6 +4,10 @@
 #include "sml_Client.h"
 #include "sml_Connection.h"
 
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
 using namespace sml;
 
 void MyPrintEventHandler(smlPrintEventId id, void* pUserData, Agent* pAgent, char const* pMessage)
@@ -66,10 +70,1151 @@ void Run_PerformanceTest(int numTrials, int numDecisions, StatsTracker* pSt, con
     std::cout.flush();
 }
 
+// Times "load rete-network" of the given file into a fresh agent, once per trial.
+void Run_ReteNetLoadTest(int numTrials, StatsTracker* pSt, const std::string& reteFile)
+{
+    std::string loadCmd = "time load rete-network --load ";
+    loadCmd += reteFile;
+
+    for (int i = 0; i < numTrials; i++)
+    {
+        Kernel* kernel = Kernel::CreateKernelInNewThread();
+        Agent* agent = kernel->CreateAgent("Soar1");
+        std::cout << (i+1) << " ";
+        std::cout.flush();
+
+        agent->ExecuteCommandLine("pushd SoarPerformanceTests");
+        agent->ExecuteCommandLine("output console off");
+        {
+            ClientAnalyzedXML response;
+            agent->ExecuteCommandLineXML(loadCmd.c_str(), &response);
+
+            // Loading happens outside the decision cycle, so the kernel timers don't see it;
+            // record the wall-clock time of the load in both series.
+            double elapsed = response.GetArgFloat(sml_Names::kParamRealSeconds, 0.0);
+            pSt->realtimes.push_back(elapsed);
+            pSt->kerneltimes.push_back(elapsed);
+        }
+        kernel->Shutdown();
+        delete kernel;
+
+        std::cout << "✅  ";
+        std::cout.flush();
+    }
+
+    std::cout << std::endl;
+    std::cout.flush();
+}
+
+// Times "load rete-network --agent" of the given agent's net into a fresh agent
+// of the same kernel, once per trial.
+void Run_ReteNetCopyTest(int numTrials, StatsTracker* pSt, Kernel* kernel, const std::string& sourceAgent)
+{
+    std::string copyCmd = "time load rete-network --agent ";
+    copyCmd += sourceAgent;
+
+    for (int i = 0; i < numTrials; i++)
+    {
+        Agent* agent = kernel->CreateAgent("Soar2");
+        std::cout << (i+1) << " ";
+        std::cout.flush();
+
+        agent->ExecuteCommandLine("output console off");
+        {
+            ClientAnalyzedXML response;
+            agent->ExecuteCommandLineXML(copyCmd.c_str(), &response);
+
+            double elapsed = response.GetArgFloat(sml_Names::kParamRealSeconds, 0.0);
+            pSt->realtimes.push_back(elapsed);
+            pSt->kerneltimes.push_back(elapsed);
+        }
+        kernel->DestroyAgent(agent);
+
+        std::cout << "✅  ";
+        std::cout.flush();
+    }
+
+    std::cout << std::endl;
+    std::cout.flush();
+}
+
+// Builds a rule set of the given size (propose/apply style rules with shared
+// prefixes, negations, NCCs and numeric constants), saves its rete net in both
+// the compact and the snapshot formats and compares how long each takes to load,
+// and how long it takes to copy the net straight into another agent.
+int Run_ReteNetBenchmark(int numProductions, int numTrials)
+{
+    std::string compactFile = "rete-net-benchmark.compact.rete";
+    std::string snapshotFile = "rete-net-benchmark.snapshot.rete";
+
+    std::cout << "\033[1;31m" << "rete-net" << "\033[0;37m" << ": " << numProductions << " productions, ";
+    if (numTrials > 1) std::cout << numTrials << " trials\n"; else std::cout << "single run\n";
+    std::cout.flush();
+
+    StatsTracker l_copyStats;
+    {
+        Kernel* kernel = Kernel::CreateKernelInNewThread();
+        Agent* agent = kernel->CreateAgent("Soar1");
+
+        agent->ExecuteCommandLine("pushd SoarPerformanceTests");
+        agent->ExecuteCommandLine("output console off");
+        for (int i = 0; i < numProductions; i++)
+        {
+            std::ostringstream rule;
+            rule << "sp {rete-net*benchmark*propose*" << i << "\n"
+                 << "   (state <s> ^superstate nil ^name benchmark-" << (i % 50) << " ^item <it>)\n"
+                 << "   (<it> ^id " << i << " ^value {> " << (i % 100) << "} ^color << red green blue >> ^weight <w>)\n"
+                 << "  -(<it> ^done " << i << ")\n"
+                 << "  -{(<s> ^blocked <it>) (<it> ^reason r" << (i % 7) << ")}\n"
+                 << "-->\n"
+                 << "   (<s> ^operator <o> + =)\n"
+                 << "   (<o> ^name op-" << i << " ^item <it> ^score (+ <w> " << i << ") ^ratio " << (i % 997) / 997.0 << ")}";
+            agent->ExecuteCommandLine(rule.str().c_str());
+        }
+        agent->ExecuteCommandLine(("save rete-network --compact --save " + compactFile).c_str());
+        bool saved = agent->GetLastCommandLineResult();
+        agent->ExecuteCommandLine(("save rete-network --save " + snapshotFile).c_str());
+        saved = saved && agent->GetLastCommandLineResult();
+        if (saved)
+        {
+            Run_ReteNetCopyTest(numTrials, &l_copyStats, kernel, "Soar1");
+        }
+        kernel->Shutdown();
+        delete kernel;
+        if (!saved)
+        {
+            std::cout << "Could not save the benchmark rete net." << std::endl;
+            return 1;
+        }
+    }
+
+    {
+        StatsTracker l_compactStats;
+        Run_ReteNetLoadTest(numTrials, &l_compactStats, compactFile);
+        l_compactStats.PrintResults("rete-net load (compact)");
+    }
+    {
+        StatsTracker l_snapshotStats;
+        Run_ReteNetLoadTest(numTrials, &l_snapshotStats, snapshotFile);
+        l_snapshotStats.PrintResults("rete-net load (snapshot)");
+    }
+    l_copyStats.PrintResults("rete-net copy from agent");
+
+    return 0;
+}
+
+// Builds a rule set with a few thousand alpha memories of several kinds (attribute
+// only, attribute and value, acceptable preferences, negations), then has the input
+// link add and remove numWMEs wmes every decision.  Like most sensor input, nine in
+// ten of the wmes match no rule, and the rules' joins almost never succeed, so the
+// kernel time is mostly spent adding wmes and dispatching them to alpha memories.
+int Run_WMEChurnBenchmark(int numWMEs, int numTrials, int numAlphaThreads)
+{
+    const int numRules = 3000;
+    const int numCycles = 50;
+
+    std::cout << "\033[1;31m" << "wme-churn" << "\033[0;37m" << ": " << numWMEs << " wmes added and removed per decision, "
+              << numAlphaThreads << " alpha thread(s), ";
+    if (numTrials > 1) std::cout << numTrials << " trials\n"; else std::cout << "single run\n";
+    std::cout.flush();
+
+    StatsTracker l_churnStats;
+    for (int i = 0; i < numTrials; i++)
+    {
+        // In the current thread, so that moving the wmes across doesn't share the one
+        // core with the kernel and blur its timers.
+        Kernel* kernel = Kernel::CreateKernelInCurrentThread(true);
+        Agent* agent = kernel->CreateAgent("Soar1");
+        std::cout << (i+1) << " ";
+        std::cout.flush();
+
+        kernel->SetAutoCommit(false);
+        agent->ExecuteCommandLine("output console off");
+        agent->ExecuteCommandLine("watch 0");
+        agent->ExecuteCommandLine(("soar alpha-threads " + std::to_string(numAlphaThreads)).c_str());
+        for (int r = 0; r < numRules; r++)
+        {
+            std::ostringstream rule;
+            rule << "sp {wme-churn*rule*" << r << "\n"
+                 << "   (state <s> ^io.input-link <il>" << ((r % 3) ? "" : " ^operator <o> +") << ")\n"
+                 << "   (<il> ^item <it>)\n"
+                 << "   (<it> ^attr-" << (r % 40) << " " << ((r % 4) ? "value-" : "<v>") << ((r % 4) ? std::to_string(r % 75) : "") << ")\n"
+                 << "  -(<it> ^blocked-" << (r % 13) << " yes)\n"
+                 << "   (<it> ^never-present " << r << ")\n"
+                 << "-->\n"
+                 << "   (<s> ^fired " << r << ")}";
+            agent->ExecuteCommandLine(rule.str().c_str());
+        }
+        agent->ExecuteCommandLine("stats --reset");
+
+        Identifier* inputLink = agent->GetInputLink();
+        std::vector<Identifier*> items;
+        for (int c = 0; c < numCycles; c++)
+        {
+            for (int w = 0; w < numWMEs; w += 4)
+            {
+                Identifier* item = agent->CreateIdWME(inputLink, "item");
+                agent->CreateStringWME(item, ("attr-" + std::to_string((c + w) % 400)).c_str(), ("value-" + std::to_string(w % 75)).c_str());
+                agent->CreateStringWME(item, ("attr-" + std::to_string(w % 401)).c_str(), "other");
+                agent->CreateIntWME(item, "serial", w);
+                items.push_back(item);
+            }
+            agent->Commit();
+            agent->RunSelf(1);
+            for (size_t j = 0; j < items.size(); j++)
+            {
+                agent->DestroyWME(items[j]);
+            }
+            items.clear();
+            agent->Commit();
+            agent->RunSelf(1);
+        }
+        {
+            ClientAnalyzedXML response;
+            agent->ExecuteCommandLineXML("stats", &response);
+            l_churnStats.kerneltimes.push_back(response.GetArgFloat(sml_Names::kParamStatsKernelCPUTime, 0.0));
+            l_churnStats.totaltimes.push_back(response.GetArgFloat(sml_Names::kParamStatsTotalCPUTime, 0.0));
+        }
+        kernel->Shutdown();
+        delete kernel;
+
+        std::cout << "✅  ";
+        std::cout.flush();
+    }
+    std::cout << std::endl;
+    l_churnStats.PrintResults("wme-churn");
+
+    return 0;
+}
+
+// Builds rules whose joins pair up every two items on the input link and
+// compare them with one or two variable equality tests (the shapes the rete
+// has specialized join kernels for), then has the input link add and remove
+// numItems items every other decision.  Each item has a few dozen wmes for
+// the tests to look through, and no pair ever passes them, so the kernel
+// time is mostly spent in join tests rather than making tokens or firing rules.
+int Run_JoinBenchmark(int numItems, int numTrials)
+{
+    const int numRules = 20;
+    const int numCycles = 20;
+
+    std::cout << "\033[1;31m" << "join" << "\033[0;37m" << ": " << numItems << " items joined pairwise per decision, ";
+    if (numTrials > 1) std::cout << numTrials << " trials\n"; else std::cout << "single run\n";
+    std::cout.flush();
+
+    StatsTracker l_joinStats;
+    for (int i = 0; i < numTrials; i++)
+    {
+        Kernel* kernel = Kernel::CreateKernelInCurrentThread(true);
+        Agent* agent = kernel->CreateAgent("Soar1");
+        std::cout << (i+1) << " ";
+        std::cout.flush();
+
+        kernel->SetAutoCommit(false);
+        agent->ExecuteCommandLine("output console off");
+        agent->ExecuteCommandLine("watch 0");
+        for (int r = 0; r < numRules; r++)
+        {
+            std::ostringstream rule;
+            rule << "sp {join*rule*" << r << "\n"
+                 << "   (state <s> ^io.input-link <il>)\n"
+                 << "   (<il> ^item <a>)\n"
+                 << "   (<a> ^group group-" << (r % 10) << " ^key <k> ^val <v>)\n"
+                 << "   (<il> ^item <b>)\n"
+                 << ((r % 2) ? "   (<b> ^slot <k>)\n" : "   (<b> ^<k> <v>)\n")
+                 << "-->\n"
+                 << "   (<s> ^fired " << r << ")}";
+            agent->ExecuteCommandLine(rule.str().c_str());
+        }
+        agent->ExecuteCommandLine("stats --reset");
+
+        Identifier* inputLink = agent->GetInputLink();
+        std::vector<Identifier*> items;
+        for (int c = 0; c < numCycles; c++)
+        {
+            for (int w = 0; w < numItems; w++)
+            {
+                Identifier* item = agent->CreateIdWME(inputLink, "item");
+                agent->CreateStringWME(item, "group", ("group-" + std::to_string(w % 10)).c_str());
+                agent->CreateStringWME(item, "key", ("key-" + std::to_string(w % 16)).c_str());
+                agent->CreateStringWME(item, "val", ("val-" + std::to_string(w % 8)).c_str());
+                for (int slot = 0; slot < 16; slot++)
+                {
+                    agent->CreateStringWME(item, "slot", ("slot-" + std::to_string((w + slot) % 32)).c_str());
+                }
+                agent->CreateStringWME(item, ("key-" + std::to_string(w % 16)).c_str(), ("val-" + std::to_string((w + 1) % 8)).c_str());
+                items.push_back(item);
+            }
+            agent->Commit();
+            agent->RunSelf(1);
+            for (size_t j = 0; j < items.size(); j++)
+            {
+                agent->DestroyWME(items[j]);
+            }
+            items.clear();
+            agent->Commit();
+            agent->RunSelf(1);
+        }
+        {
+            ClientAnalyzedXML response;
+            agent->ExecuteCommandLineXML("stats", &response);
+            l_joinStats.kerneltimes.push_back(response.GetArgFloat(sml_Names::kParamStatsKernelCPUTime, 0.0));
+            l_joinStats.totaltimes.push_back(response.GetArgFloat(sml_Names::kParamStatsTotalCPUTime, 0.0));
+        }
+        kernel->Shutdown();
+        delete kernel;
+
+        std::cout << "✅  ";
+        std::cout.flush();
+    }
+    std::cout << std::endl;
+    l_joinStats.PrintResults("join");
+
+    return 0;
+}
+
+// Page faults this process has taken so far, or 0 where that isn't available
+long GetPageFaults()
+{
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_minflt + usage.ru_majflt;
+#endif
+}
+
+// Builds a large agent, numItems items of twenty wmes each on the input link
+// matched by rules that never fire, then each decision changes a wme on every
+// fourth item.  The changes are spread over the whole of working memory and
+// the rete, so the kernel time is mostly match time spent chasing pointers
+// through the memory pools.  It's run with and without soar pool-huge-pages and
+// reports the kernel time and page faults of the decisions after the first.
+void Run_HugePageTest(int numItems, int numTrials, StatsTracker* pSt, bool hugePages)
+{
+    const int numRules = 30;
+    const int numCycles = 48;
+    long faults = 0;
+
+    for (int i = 0; i < numTrials; i++)
+    {
+        Kernel* kernel = Kernel::CreateKernelInCurrentThread(true);
+        Agent* agent = kernel->CreateAgent("Soar1");
+        std::cout << (i+1) << " ";
+        std::cout.flush();
+
+        kernel->SetAutoCommit(false);
+        agent->ExecuteCommandLine("output console off");
+        agent->ExecuteCommandLine("watch 0");
+        agent->ExecuteCommandLine(hugePages ? "soar pool-huge-pages on" : "soar pool-huge-pages off");
+        for (int r = 0; r < numRules; r++)
+        {
+            std::ostringstream rule;
+            rule << "sp {huge-pages*rule*" << r << "\n"
+                 << "   (state <s> ^io.input-link <il>)\n"
+                 << "   (<il> ^item <a>)\n"
+                 << "   (<a> ^group group-" << (r % 10) << " ^tick <t>)\n"
+                 << "   (<a> ^slot-" << (r % 16) << " <v>)\n"
+                 << "   (<a> ^never-present " << r << ")\n"
+                 << "-->\n"
+                 << "   (<s> ^fired " << r << ")}";
+            agent->ExecuteCommandLine(rule.str().c_str());
+        }
+
+        Identifier* inputLink = agent->GetInputLink();
+        std::vector<Identifier*> items;
+        std::vector<WMElement*> ticks;
+        for (int w = 0; w < numItems; w++)
+        {
+            Identifier* item = agent->CreateIdWME(inputLink, "item");
+            agent->CreateStringWME(item, "group", ("group-" + std::to_string(w % 10)).c_str());
+            for (int slot = 0; slot < 18; slot++)
+            {
+                agent->CreateIntWME(item, ("slot-" + std::to_string(slot)).c_str(), (w + slot) % 64);
+            }
+            ticks.push_back(agent->CreateIntWME(item, "tick", 0));
+            items.push_back(item);
+        }
+        agent->Commit();
+        agent->RunSelf(1);
+
+        double startTime;
+        {
+            ClientAnalyzedXML response;
+            agent->ExecuteCommandLineXML("stats", &response);
+            startTime = response.GetArgFloat(sml_Names::kParamStatsKernelCPUTime, 0.0);
+        }
+        long startFaults = GetPageFaults();
+        for (int c = 1; c <= numCycles; c++)
+        {
+            for (size_t w = c % 4; w < items.size(); w += 4)
+            {
+                agent->DestroyWME(ticks[w]);
+                ticks[w] = agent->CreateIntWME(items[w], "tick", c);
+            }
+            agent->Commit();
+            agent->RunSelf(1);
+        }
+        faults += GetPageFaults() - startFaults;
+        {
+            ClientAnalyzedXML response;
+            agent->ExecuteCommandLineXML("stats", &response);
+            pSt->kerneltimes.push_back(response.GetArgFloat(sml_Names::kParamStatsKernelCPUTime, 0.0) - startTime);
+            pSt->totaltimes.push_back(response.GetArgFloat(sml_Names::kParamStatsTotalCPUTime, 0.0));
+        }
+        kernel->Shutdown();
+        delete kernel;
+
+        std::cout << "✅  ";
+        std::cout.flush();
+    }
+    std::cout << (hugePages ? "with" : "without") << " huge pages, " << (faults / numTrials) << " page faults per trial" << std::endl;
+}
+
+int Run_HugePageBenchmark(int numItems, int numTrials)
+{
+    std::cout << "\033[1;31m" << "huge-pages" << "\033[0;37m" << ": " << numItems << " items of 20 wmes, ";
+    if (numTrials > 1) std::cout << numTrials << " trials\n"; else std::cout << "single run\n";
+    std::cout.flush();
+
+    StatsTracker l_smallStats, l_hugeStats;
+    Run_HugePageTest(numItems, numTrials, &l_smallStats, false);
+    Run_HugePageTest(numItems, numTrials, &l_hugeStats, true);
+    l_smallStats.PrintResults("huge-pages match (ordinary blocks)");
+    l_hugeStats.PrintResults("huge-pages match (huge page blocks)");
+
+    return 0;
+}
+
+// Each step selects an operator with no apply rules, and the substate works
+// out its result from eight wmes of superstate data through an intermediate
+// elaboration.  The rule that returns the result tests the step number as a
+// constant, so every step learns a new chunk of about a dozen conditions
+// instead of reusing the last one.  Reports kernel time, which is mostly
+// backtracing, identity analysis and chunk building.
+void Run_ChunkingTest(int numChunks, int numTrials, StatsTracker* pSt)
+{
+    for (int i = 0; i < numTrials; i++)
+    {
+        Kernel* kernel = Kernel::CreateKernelInCurrentThread(true);
+        Agent* agent = kernel->CreateAgent("Soar1");
+        std::cout << (i+1) << " ";
+        std::cout.flush();
+
+        agent->ExecuteCommandLine("output console off");
+        agent->ExecuteCommandLine("watch 0");
+        agent->ExecuteCommandLine("chunk always");
+        agent->ExecuteCommandLine("sp {chunking*propose*init (state <s> ^superstate nil -^count) --> (<s> ^operator <o> +) (<o> ^name init)}");
+        agent->ExecuteCommandLine("sp {chunking*apply*init (state <s> ^operator.name init) --> (<s> ^count 1 ^data <d>) (<d> ^val1 1 ^val2 2 ^val3 3 ^val4 4 ^val5 5 ^val6 6 ^val7 7 ^val8 8)}");
+        agent->ExecuteCommandLine((std::string("sp {chunking*propose*step (state <s> ^count {<n> <= ") + std::to_string(numChunks) + "}) --> (<s> ^operator <o> +) (<o> ^name step ^n <n>)}").c_str());
+        agent->ExecuteCommandLine("sp {chunking*apply*step (state <s> ^operator <o> ^count <n> ^result <n>) (<o> ^name step ^n <n>) --> (<s> ^count <n> - (+ <n> 1))}");
+        agent->ExecuteCommandLine("sp {chunking*elaborate*partial (state <ss> ^superstate <s>) (<s> ^operator.name step ^data <d>) (<d> ^val1 <a> ^val2 <b> ^val3 <c> ^val4 <e>) --> (<ss> ^partial (+ <a> <b> <c> <e>))}");
+        for (int n = 1; n <= numChunks; n++)
+        {
+            std::ostringstream rule;
+            rule << "sp {chunking*result*" << n << "\n"
+                 << "   (state <ss> ^superstate <s> ^partial <p>)\n"
+                 << "   (<s> ^operator <o> ^data <d>)\n"
+                 << "   (<o> ^n " << n << ")\n"
+                 << "   (<d> ^val5 <w> ^val6 <x> ^val7 <y> ^val8 <z>)\n"
+                 << "-->\n"
+                 << "   (<s> ^result " << n << ")}";
+            agent->ExecuteCommandLine(rule.str().c_str());
+        }
+
+        ClientAnalyzedXML response;
+        agent->ExecuteCommandLineXML(("run " + std::to_string(numChunks * 3 + 1)).c_str(), &response);
+        agent->ExecuteCommandLineXML("stats", &response);
+        pSt->kerneltimes.push_back(response.GetArgFloat(sml_Names::kParamStatsKernelCPUTime, 0.0));
+        pSt->totaltimes.push_back(response.GetArgFloat(sml_Names::kParamStatsTotalCPUTime, 0.0));
+        kernel->Shutdown();
+        delete kernel;
+
+        std::cout << "✅  ";
+        std::cout.flush();
+    }
+    std::cout << std::endl;
+}
+
+int Run_ChunkingBenchmark(int numChunks, int numTrials)
+{
+    std::cout << "\033[1;31m" << "chunking" << "\033[0;37m" << ": " << numChunks << " chunks, ";
+    if (numTrials > 1) std::cout << numTrials << " trials\n"; else std::cout << "single run\n";
+    std::cout.flush();
+
+    StatsTracker l_chunkStats;
+    Run_ChunkingTest(numChunks, numTrials, &l_chunkStats);
+    l_chunkStats.PrintResults("chunking");
+
+    return 0;
+}
+
+// Records numEpisodes episodes of three items whose colors, shapes and sizes
+// cycle at different rates, then issues numQueries cue-based queries of two
+// items each, one at a time.  Only the kernel time of the query phase is
+// kept, which is mostly building the query DNF, interval search and graph
+// match.
+void Run_EpmemQueryTest(int numEpisodes, int numQueries, int numTrials, StatsTracker* pSt)
+{
+    for (int i = 0; i < numTrials; i++)
+    {
+        Kernel* kernel = Kernel::CreateKernelInCurrentThread(true);
+        Agent* agent = kernel->CreateAgent("Soar1");
+        std::cout << (i+1) << " ";
+        std::cout.flush();
+
+        std::string lastEpisode = std::to_string(numEpisodes);
+        agent->ExecuteCommandLine("output console off");
+        agent->ExecuteCommandLine("watch 0");
+        agent->ExecuteCommandLine("epmem --set trigger dc");
+        agent->ExecuteCommandLine("epmem --set learning on");
+        agent->ExecuteCommandLine("sp {epmem-query*propose*init (state <s> ^superstate nil -^count) --> (<s> ^operator <o> +) (<o> ^name init)}");
+        agent->ExecuteCommandLine("sp {epmem-query*apply*init (state <s> ^operator.name init) --> (<s> ^count 0 ^q 0 ^item <a> <b> <c>) (<a> ^id 1) (<b> ^id 2) (<c> ^id 3)}");
+        agent->ExecuteCommandLine(("sp {epmem-query*propose*tick (state <s> ^count {<n> < " + lastEpisode + "}) --> (<s> ^operator <o> +) (<o> ^name tick)}").c_str());
+        agent->ExecuteCommandLine("sp {epmem-query*apply*tick (state <s> ^operator.name tick ^count <n>) --> (<s> ^count <n> - (+ <n> 1))}");
+        agent->ExecuteCommandLine("sp {epmem-query*apply*tick*item (state <s> ^operator.name tick ^count <n> ^item <i>) (<i> ^id <id>) --> (<s> ^item <i> - <j>) (<j> ^id <id> ^color (mod (* <n> <id>) 7) ^shape (mod (+ <n> <id>) 5) ^size (mod <n> 3))}");
+        agent->ExecuteCommandLine(("sp {epmem-query*propose*query (state <s> ^count " + lastEpisode + " ^q {<k> < " + std::to_string(numQueries) + "} ^epmem.command <cmd>) -(<cmd> ^query) --> (<s> ^operator <o> +) (<o> ^name query)}").c_str());
+        agent->ExecuteCommandLine("sp {epmem-query*apply*query (state <s> ^operator.name query ^q <k> ^epmem.command <cmd>) --> (<cmd> ^query <qq>) (<qq> ^item <a> <b>) (<a> ^id 1 ^color (mod <k> 7) ^shape (mod (* <k> 3) 5)) (<b> ^id 2 ^size (mod <k> 3) ^color (mod (+ <k> 1) 7))}");
+        agent->ExecuteCommandLine("sp {epmem-query*propose*next (state <s> ^q <k> ^epmem <e>) (<e> ^command.query <qq> ^result <r>) (<r> ^<< success failure >> <qq>) --> (<s> ^operator <o> +) (<o> ^name next)}");
+        agent->ExecuteCommandLine("sp {epmem-query*apply*next (state <s> ^operator.name next ^q <k> ^epmem.command <cmd>) (<cmd> ^query <qq>) --> (<cmd> ^query <qq> -) (<s> ^q <k> - (+ <k> 1))}");
+        agent->ExecuteCommandLine(("sp {epmem-query*halt (state <s> ^q " + std::to_string(numQueries) + ") --> (halt)}").c_str());
+
+        ClientAnalyzedXML response;
+        agent->ExecuteCommandLineXML(("run " + std::to_string(numEpisodes + 1)).c_str(), &response);
+        agent->ExecuteCommandLineXML("stats", &response);
+        double startTime = response.GetArgFloat(sml_Names::kParamStatsKernelCPUTime, 0.0);
+        agent->ExecuteCommandLineXML("run", &response);
+        agent->ExecuteCommandLineXML("stats", &response);
+        pSt->kerneltimes.push_back(response.GetArgFloat(sml_Names::kParamStatsKernelCPUTime, 0.0) - startTime);
+        pSt->totaltimes.push_back(response.GetArgFloat(sml_Names::kParamStatsTotalCPUTime, 0.0));
+        kernel->Shutdown();
+        delete kernel;
+
+        std::cout << "✅  ";
+        std::cout.flush();
+    }
+    std::cout << std::endl;
+}
+
+int Run_EpmemQueryBenchmark(int numEpisodes, int numTrials)
+{
+    std::cout << "\033[1;31m" << "epmem-query" << "\033[0;37m" << ": " << DEFAULT_EPMEM_QUERIES << " queries over " << numEpisodes << " episodes, ";
+    if (numTrials > 1) std::cout << numTrials << " trials\n"; else std::cout << "single run\n";
+    std::cout.flush();
+
+    StatsTracker l_queryStats;
+    Run_EpmemQueryTest(numEpisodes, DEFAULT_EPMEM_QUERIES, numTrials, &l_queryStats);
+    l_queryStats.PrintResults("epmem-query");
+
+    return 0;
+}
+
+// Interns numStrings distinct strings as the names of input-link objects, in
+// groups of 64, the way an agent reading object names or text would, then replaces every one of them with a
+// fresh string on each of several decisions.  Each replacement frees one
+// string constant and interns another, so the symbol table stays at about
+// numStrings entries throughout.  The decisions have no rules to match, so
+// the wall-clock time is mostly input processing and string interning.
+void Run_InternTest(int numStrings, int numTrials, StatsTracker* pSt)
+{
+    const int numCycles = 10;
+
+    for (int i = 0; i < numTrials; i++)
+    {
+        Kernel* kernel = Kernel::CreateKernelInCurrentThread(true);
+        Agent* agent = kernel->CreateAgent("Soar1");
+        std::cout << (i+1) << " ";
+        std::cout.flush();
+
+        kernel->SetAutoCommit(false);
+        agent->ExecuteCommandLine("output console off");
+        agent->ExecuteCommandLine("watch 0");
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        Identifier* inputLink = agent->GetInputLink();
+        std::vector<StringElement*> words;
+        Identifier* group = NULL;
+        for (int w = 0; w < numStrings; w++)
+        {
+            if (w % 64 == 0) group = agent->CreateIdWME(inputLink, "group");
+            Identifier* object = agent->CreateIdWME(group, "object");
+            words.push_back(agent->CreateStringWME(object, "name", ("object-name-" + std::to_string(w) + "-0").c_str()));
+        }
+        agent->Commit();
+        agent->RunSelf(1);
+        for (int c = 1; c <= numCycles; c++)
+        {
+            std::string suffix = "-" + std::to_string(c);
+            for (int w = 0; w < numStrings; w++)
+            {
+                agent->Update(words[w], ("object-name-" + std::to_string(w) + suffix).c_str());
+            }
+            agent->Commit();
+            agent->RunSelf(1);
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        pSt->realtimes.push_back(elapsed);
+        pSt->kerneltimes.push_back(elapsed);
+        kernel->Shutdown();
+        delete kernel;
+
+        std::cout << "✅  ";
+        std::cout.flush();
+    }
+    std::cout << std::endl;
+}
+
+int Run_InternBenchmark(int numStrings, int numTrials)
+{
+    std::cout << "\033[1;31m" << "intern" << "\033[0;37m" << ": " << numStrings << " strings, 11 decisions, ";
+    if (numTrials > 1) std::cout << numTrials << " trials\n"; else std::cout << "single run\n";
+    std::cout.flush();
+
+    StatsTracker l_internStats;
+    Run_InternTest(numStrings, numTrials, &l_internStats);
+    l_internStats.PrintResults("intern (wall clock)");
+
+    return 0;
+}
+
+// Each agent counts up with one operator per decision, and every count makes
+// thirty new items that a handful of rules join pairwise without ever firing,
+// so each decision does a fair amount of match work in every agent.  All the
+// agents are run together, first on one thread and then on runThreads, and
+// the wall clock times are compared.
+void Run_MultiAgentTest(int numAgents, int numTrials, StatsTracker* pSt, int runThreads)
+{
+    const int numItems = 30;
+    const int numJoinRules = 8;
+    const int numDecisions = 1000;
+
+    for (int i = 0; i < numTrials; i++)
+    {
+        Kernel* kernel = Kernel::CreateKernelInCurrentThread(true);
+        std::vector<Agent*> agents;
+        for (int a = 0; a < numAgents; a++)
+        {
+            Agent* agent = kernel->CreateAgent(("Soar" + std::to_string(a + 1)).c_str());
+            agent->ExecuteCommandLine("output console off");
+            agent->ExecuteCommandLine("watch 0");
+            agent->ExecuteCommandLine("sp {multi-agent*propose*init (state <s> ^superstate nil -^count) --> (<s> ^operator <o> +) (<o> ^name init)}");
+            agent->ExecuteCommandLine("sp {multi-agent*apply*init (state <s> ^operator.name init) --> (<s> ^count 0)}");
+            agent->ExecuteCommandLine("sp {multi-agent*propose*count (state <s> ^superstate nil ^count <c>) --> (<s> ^operator <o> +) (<o> ^name count ^count <c>)}");
+            agent->ExecuteCommandLine("sp {multi-agent*apply*count (state <s> ^operator <o> ^count <c>) (<o> ^name count ^count <c>) --> (<s> ^count <c> - (+ <c> 1))}");
+            for (int k = 0; k < numItems; k++)
+            {
+                std::ostringstream rule;
+                rule << "sp {multi-agent*item*" << k << " (state <s> ^count <c>) --> (<s> ^item <i>) (<i> ^key key-" << (k % 6) << " ^val " << k << " ^tick <c>)}";
+                agent->ExecuteCommandLine(rule.str().c_str());
+            }
+            for (int r = 0; r < numJoinRules; r++)
+            {
+                std::ostringstream rule;
+                rule << "sp {multi-agent*join*" << r << "\n"
+                     << "   (state <s> ^item <a> ^item <b>)\n"
+                     << "   (<a> ^key key-" << (r % 6) << " ^val <v> ^tick <t>)\n"
+                     << "   (<b> ^tick <t> ^val <w>)\n"
+                     << "   (<b> ^never-present <v>)\n"
+                     << "-->\n"
+                     << "   (<s> ^fired " << r << ")}";
+                agent->ExecuteCommandLine(rule.str().c_str());
+            }
+            agents.push_back(agent);
+        }
+        agents[0]->ExecuteCommandLine(("soar run-threads " + std::to_string(runThreads)).c_str());
+        std::cout << (i+1) << " ";
+        std::cout.flush();
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        kernel->RunAllAgents(numDecisions);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        pSt->realtimes.push_back(elapsed);
+        pSt->kerneltimes.push_back(elapsed);
+        kernel->Shutdown();
+        delete kernel;
+
+        std::cout << "✅  ";
+        std::cout.flush();
+    }
+    std::cout << std::endl;
+}
+
+int Run_MultiAgentBenchmark(int numAgents, int numTrials, int runThreads)
+{
+    std::cout << "\033[1;31m" << "multi-agent" << "\033[0;37m" << ": " << numAgents << " agents, 1000 decisions, "
+              << runThreads << " run thread(s), ";
+    if (numTrials > 1) std::cout << numTrials << " trials\n"; else std::cout << "single run\n";
+    std::cout.flush();
+
+    StatsTracker l_oneThreadStats, l_manyThreadStats;
+    Run_MultiAgentTest(numAgents, numTrials, &l_oneThreadStats, 1);
+    Run_MultiAgentTest(numAgents, numTrials, &l_manyThreadStats, runThreads);
+    l_oneThreadStats.PrintResults("multi-agent (1 thread, wall clock)");
+    l_manyThreadStats.PrintResults(("multi-agent (" + std::to_string(runThreads) + " threads, wall clock)").c_str());
+
+    return 0;
+}
+
+// Every decision a counter operator changes the tick, and a few wide objects
+// are rebuilt with numAttrs attributes each, ten to a rule, so every one of
+// their preferences looks up or makes a slot on an identifier that already
+// has hundreds.  Reports kernel time.
+int Run_WideSlotBenchmark(int numAttrs, int numTrials)
+{
+    const int numObjects = 10;
+    const int numDecisions = 200;
+
+    std::cout << "\033[1;31m" << "wide-slots" << "\033[0;37m" << ": " << numObjects << " objects of " << numAttrs << " attributes rebuilt per decision, ";
+    if (numTrials > 1) std::cout << numTrials << " trials\n"; else std::cout << "single run\n";
+    std::cout.flush();
+
+    StatsTracker l_wideStats;
+    for (int i = 0; i < numTrials; i++)
+    {
+        Kernel* kernel = Kernel::CreateKernelInCurrentThread(true);
+        Agent* agent = kernel->CreateAgent("Soar1");
+        std::cout << (i+1) << " ";
+        std::cout.flush();
+
+        agent->ExecuteCommandLine("output console off");
+        agent->ExecuteCommandLine("watch 0");
+        agent->ExecuteCommandLine("sp {wide-slots*propose*init (state <s> ^superstate nil -^tick) --> (<s> ^operator <o> +) (<o> ^name init)}");
+        agent->ExecuteCommandLine("sp {wide-slots*apply*init (state <s> ^operator.name init) --> (<s> ^tick 0)}");
+        agent->ExecuteCommandLine("sp {wide-slots*propose*tick (state <s> ^superstate nil ^tick <t>) --> (<s> ^operator <o> +) (<o> ^name tick ^tick <t>)}");
+        agent->ExecuteCommandLine("sp {wide-slots*apply*tick (state <s> ^operator <o> ^tick <t>) (<o> ^name tick ^tick <t>) --> (<s> ^tick <t> - (+ <t> 1))}");
+        for (int k = 0; k < numObjects; k++)
+        {
+            std::ostringstream rule;
+            rule << "sp {wide-slots*object*" << k << " (state <s> ^tick <t>) --> (<s> ^object <w>) (<w> ^index " << k << " ^tick <t>)}";
+            agent->ExecuteCommandLine(rule.str().c_str());
+        }
+        for (int r = 0; r < numAttrs / 10; r++)
+        {
+            std::ostringstream rule;
+            rule << "sp {wide-slots*attrs*" << r << " (state <s> ^object <w>) (<w> ^tick <t>) --> (<w>";
+            for (int a = 0; a < 10; a++)
+            {
+                rule << " ^attr-" << r << "-" << a << " <t>";
+            }
+            rule << ")}";
+            agent->ExecuteCommandLine(rule.str().c_str());
+        }
+        agent->ExecuteCommandLine("stats --reset");
+        agent->RunSelf(numDecisions);
+        {
+            ClientAnalyzedXML response;
+            agent->ExecuteCommandLineXML("stats", &response);
+            l_wideStats.kerneltimes.push_back(response.GetArgFloat(sml_Names::kParamStatsKernelCPUTime, 0.0));
+            l_wideStats.totaltimes.push_back(response.GetArgFloat(sml_Names::kParamStatsTotalCPUTime, 0.0));
+        }
+        kernel->Shutdown();
+        delete kernel;
+
+        std::cout << "✅  ";
+        std::cout.flush();
+    }
+    std::cout << std::endl;
+    l_wideStats.PrintResults("wide-slots");
+
+    return 0;
+}
+
+int Run_OperatorPrefsBenchmark(int numProposals, int numTrials)
+{
+    std::cout << "\033[1;31m" << "operator-prefs" << "\033[0;37m" << ": " << numProposals << " mutually indifferent proposals, one retired per decision, ";
+    if (numTrials > 1) std::cout << numTrials << " trials\n"; else std::cout << "single run\n";
+    std::cout.flush();
+
+    StatsTracker l_prefStats;
+    for (int i = 0; i < numTrials; i++)
+    {
+        Kernel* kernel = Kernel::CreateKernelInCurrentThread(true);
+        Agent* agent = kernel->CreateAgent("Soar1");
+        std::cout << (i+1) << " ";
+        std::cout.flush();
+
+        agent->ExecuteCommandLine("output console off");
+        agent->ExecuteCommandLine("watch 0");
+        agent->ExecuteCommandLine("sp {operator-prefs*propose*init (state <s> ^superstate nil -^item) --> (<s> ^operator <o> +) (<o> ^name init)}");
+        {
+            std::ostringstream rule;
+            rule << "sp {operator-prefs*apply*init (state <s> ^operator.name init) -->";
+            for (int k = 0; k < numProposals; k++)
+            {
+                rule << " (<s> ^item <i" << k << ">) (<i" << k << "> ^id " << k << ")";
+            }
+            rule << "}";
+            agent->ExecuteCommandLine(rule.str().c_str());
+        }
+        agent->ExecuteCommandLine("sp {operator-prefs*propose*pick (state <s> ^superstate nil ^item.id <k> -^done <k>) --> (<s> ^operator <o> +) (<o> ^name pick ^item <k>)}");
+        agent->ExecuteCommandLine("sp {operator-prefs*compare*pick (state <s> ^operator <o1> + ^operator { <o2> <> <o1> } +) (<o1> ^name pick) (<o2> ^name pick) --> (<s> ^operator <o1> = <o2>)}");
+        agent->ExecuteCommandLine("sp {operator-prefs*apply*pick (state <s> ^operator <o>) (<o> ^name pick ^item <k>) --> (<s> ^done <k>)}");
+        agent->ExecuteCommandLine("srand 1");
+        agent->ExecuteCommandLine("stats --reset");
+        agent->RunSelf(numProposals + 1);
+        {
+            ClientAnalyzedXML response;
+            agent->ExecuteCommandLineXML("stats", &response);
+            l_prefStats.kerneltimes.push_back(response.GetArgFloat(sml_Names::kParamStatsKernelCPUTime, 0.0));
+            l_prefStats.totaltimes.push_back(response.GetArgFloat(sml_Names::kParamStatsTotalCPUTime, 0.0));
+        }
+        kernel->Shutdown();
+        delete kernel;
+
+        std::cout << "✅  ";
+        std::cout.flush();
+    }
+    std::cout << std::endl;
+    l_prefStats.PrintResults("operator-prefs");
+
+    return 0;
+}
+
+int Run_GDSBenchmark(int treeDepth, int numTrials)
+{
+    int numLeaves = 1 << treeDepth;
+    std::cout << "\033[1;31m" << "gds" << "\033[0;37m" << ": " << DEFAULT_GDS_SUBSTATES << " substates, each with a " << (2 * numLeaves - 1) << "-wme i-supported tree under its first o-supported wme, ";
+    if (numTrials > 1) std::cout << numTrials << " trials\n"; else std::cout << "single run\n";
+    std::cout.flush();
+
+    StatsTracker l_gdsStats;
+    for (int i = 0; i < numTrials; i++)
+    {
+        Kernel* kernel = Kernel::CreateKernelInCurrentThread(true);
+        Agent* agent = kernel->CreateAgent("Soar1");
+        std::cout << (i+1) << " ";
+        std::cout.flush();
+
+        agent->ExecuteCommandLine("output console off");
+        agent->ExecuteCommandLine("watch 0");
+        agent->ExecuteCommandLine("sp {gds*propose*init (state <s> ^superstate nil -^count) --> (<s> ^operator <o> + =) (<o> ^name init)}");
+        agent->ExecuteCommandLine("sp {gds*apply*init (state <s> ^operator.name init) --> (<s> ^count 0)}");
+        agent->ExecuteCommandLine((std::string("sp {gds*propose*work (state <s> ^superstate nil ^count { <c> < ") + std::to_string(DEFAULT_GDS_SUBSTATES) + " }) --> (<s> ^operator <o> + =) (<o> ^name work ^tick <c>)}").c_str());
+        agent->ExecuteCommandLine((std::string("sp {gds*halt (state <s> ^superstate nil ^count ") + std::to_string(DEFAULT_GDS_SUBSTATES) + ") --> (halt)}").c_str());
+
+        /* work has no apply rule, so each tick opens a substate that builds a
+           binary tree of i-supported wmes: leaves test the superstate
+           operator, node n<k> needs n<2k> and n<2k+1> */
+        for (int k = 1; k < 2 * numLeaves; k++)
+        {
+            std::ostringstream rule;
+            if (k >= numLeaves)
+            {
+                rule << "sp {gds*elaborate*n" << k << " (state <s> ^superstate.operator.name work) --> (<s> ^n" << k << " true)}";
+            }
+            else
+            {
+                rule << "sp {gds*elaborate*n" << k << " (state <s> ^n" << (2 * k) << " true ^n" << (2 * k + 1) << " true) --> (<s> ^n" << k << " true)}";
+            }
+            agent->ExecuteCommandLine(rule.str().c_str());
+        }
+
+        /* the local ^done is the substate's first o-supported wme, so creating
+           it walks the whole tree into the substate's GDS */
+        agent->ExecuteCommandLine("sp {gds*propose*finish (state <s> ^n1 true ^superstate.operator.tick <t>) --> (<s> ^operator <o> + =) (<o> ^name finish ^tick <t>)}");
+        agent->ExecuteCommandLine("sp {gds*apply*finish (state <s> ^operator <o> ^superstate <ss>) (<o> ^name finish ^tick <t>) (<ss> ^count <t>) --> (<ss> ^count <t> - (+ <t> 1)) (<s> ^done <t>)}");
+        agent->ExecuteCommandLine("stats --reset");
+        agent->RunSelf(4 * DEFAULT_GDS_SUBSTATES + 2);
+        {
+            ClientAnalyzedXML response;
+            agent->ExecuteCommandLineXML("stats", &response);
+            l_gdsStats.kerneltimes.push_back(response.GetArgFloat(sml_Names::kParamStatsKernelCPUTime, 0.0));
+            l_gdsStats.totaltimes.push_back(response.GetArgFloat(sml_Names::kParamStatsTotalCPUTime, 0.0));
+        }
+        kernel->Shutdown();
+        delete kernel;
+
+        std::cout << "✅  ";
+        std::cout.flush();
+    }
+    std::cout << std::endl;
+    l_gdsStats.PrintResults("gds");
+
+    return 0;
+}
+
+// Builds a tree of about numWMEs wmes on the top state, one subtree of 341
+// nodes per rule, with every node linked back to its parent by a ^parent wme,
+// and then takes it apart one subtree per decision.  The back links keep the
+// link count of a pruned subtree above 0, so each prune needs a walk of working
+// memory to find out that the subtree is disconnected.  It's run with soar
+// gc-batch 0, which walks working memory after every prune, and with a batch as
+// large as the number of subtrees, which walks it once at the end.  Reports
+// the kernel time of the teardown.
+void Run_TreeGCTest(int numSubtrees, int numTrials, StatsTracker* pSt, int gcBatch)
+{
+    const int fanOut = 4;
+    const int depth = 4;
+
+    for (int i = 0; i < numTrials; i++)
+    {
+        Kernel* kernel = Kernel::CreateKernelInCurrentThread(true);
+        Agent* agent = kernel->CreateAgent("Soar1");
+        std::cout << (i+1) << " ";
+        std::cout.flush();
+
+        agent->ExecuteCommandLine("output console off");
+        agent->ExecuteCommandLine("watch 0");
+        agent->ExecuteCommandLine(("soar gc-batch " + std::to_string(gcBatch)).c_str());
+        agent->ExecuteCommandLine("sp {tree-gc*propose*build (state <s> ^superstate nil -^tree) --> (<s> ^operator <o> + =) (<o> ^name build)}");
+        agent->ExecuteCommandLine("sp {tree-gc*apply*build (state <s> ^operator.name build) --> (<s> ^tree <t>)}");
+        agent->ExecuteCommandLine("sp {tree-gc*propose*grow (state <s> ^superstate nil ^tree <t> -^grown) --> (<s> ^operator <o> + =) (<o> ^name grow)}");
+        agent->ExecuteCommandLine("sp {tree-gc*apply*grow (state <s> ^operator.name grow) --> (<s> ^grown yes)}");
+        for (int k = 0; k < numSubtrees; k++)
+        {
+            std::ostringstream rule;
+            int numNodes = 0;
+            std::vector<int> level(1, 0);
+            rule << "sp {tree-gc*apply*grow*" << k << " (state <s> ^operator.name grow ^tree <t>) --> (<t> ^sub <n0>) (<n0> ^id " << k << ")";
+            for (int d = 0; d < depth; d++)
+            {
+                std::vector<int> nextLevel;
+                for (size_t p = 0; p < level.size(); p++)
+                {
+                    for (int c = 0; c < fanOut; c++)
+                    {
+                        int n = ++numNodes;
+                        rule << " (<n" << level[p] << "> ^child <n" << n << ">) (<n" << n << "> ^id " << c << " ^parent <n" << level[p] << ">)";
+                        nextLevel.push_back(n);
+                    }
+                }
+                level.swap(nextLevel);
+            }
+            rule << "}";
+            agent->ExecuteCommandLine(rule.str().c_str());
+        }
+        agent->ExecuteCommandLine("sp {tree-gc*propose*prune (state <s> ^superstate nil ^grown yes ^tree.sub <r>) --> (<s> ^operator <o> + =) (<o> ^name prune ^sub <r>)}");
+        agent->ExecuteCommandLine("sp {tree-gc*apply*prune (state <s> ^operator <o> ^tree <t>) (<o> ^name prune ^sub <r>) --> (<t> ^sub <r> -)}");
+        agent->ExecuteCommandLine("sp {tree-gc*halt (state <s> ^superstate nil ^grown yes ^tree <t>) (<t> -^sub) --> (halt)}");
+        agent->RunSelf(2);
+
+        double startTime;
+        {
+            ClientAnalyzedXML response;
+            agent->ExecuteCommandLineXML("stats", &response);
+            startTime = response.GetArgFloat(sml_Names::kParamStatsKernelCPUTime, 0.0);
+        }
+        agent->RunSelf(numSubtrees + 10);
+        {
+            ClientAnalyzedXML response;
+            agent->ExecuteCommandLineXML("stats", &response);
+            pSt->kerneltimes.push_back(response.GetArgFloat(sml_Names::kParamStatsKernelCPUTime, 0.0) - startTime);
+            pSt->totaltimes.push_back(response.GetArgFloat(sml_Names::kParamStatsTotalCPUTime, 0.0));
+        }
+        kernel->Shutdown();
+        delete kernel;
+
+        std::cout << "✅  ";
+        std::cout.flush();
+    }
+    std::cout << "with gc-batch " << gcBatch << std::endl;
+}
+
+int Run_TreeGCBenchmark(int numWMEs, int numTrials)
+{
+    /* a subtree is 341 nodes: the root has an ^id, the others a ^child, ^id and ^parent */
+    const int wmesPerSubtree = 1022;
+    int numSubtrees = (numWMEs + wmesPerSubtree - 1) / wmesPerSubtree;
+
+    std::cout << "\033[1;31m" << "tree-gc" << "\033[0;37m" << ": " << (numSubtrees * wmesPerSubtree) << "-wme tree pruned one subtree of " << wmesPerSubtree << " wmes per decision, ";
+    if (numTrials > 1) std::cout << numTrials << " trials\n"; else std::cout << "single run\n";
+    std::cout.flush();
+
+    StatsTracker l_phaseStats, l_batchStats;
+    Run_TreeGCTest(numSubtrees, numTrials, &l_phaseStats, 0);
+    Run_TreeGCTest(numSubtrees, numTrials, &l_batchStats, numSubtrees);
+    l_phaseStats.PrintResults("tree-gc teardown (gc every phase)");
+    l_batchStats.PrintResults("tree-gc teardown (gc in one batch)");
+
+    return 0;
+}
+
 int main(int argc, char* argv[])
 {
     set_working_directory_to_executable_path();
 
+    if ((argc > 1) && !strcmp(argv[1], "rete-net"))
+    {
+        int numProductions = DEFAULT_RETE_NET_PRODUCTIONS;
+        int numReteTrials = DEFAULT_RETE_NET_TRIALS;
+        if (argc > 2)
+        {
+            std::stringstream(argv[2]) >> numProductions;
+        }
+        if (argc > 3)
+        {
+            std::stringstream(argv[3]) >> numReteTrials;
+        }
+        return Run_ReteNetBenchmark(numProductions, numReteTrials);
+    }
+    if ((argc > 1) && !strcmp(argv[1], "wme-churn"))
+    {
+        int numWMEs = DEFAULT_WME_CHURN_WMES;
+        int numChurnTrials = DEFAULT_WME_CHURN_TRIALS;
+        int numAlphaThreads = 1;
+        if (argc > 2)
+        {
+            std::stringstream(argv[2]) >> numWMEs;
+        }
+        if (argc > 3)
+        {
+            std::stringstream(argv[3]) >> numChurnTrials;
+        }
+        if (argc > 4)
+        {
+            std::stringstream(argv[4]) >> numAlphaThreads;
+        }
+        return Run_WMEChurnBenchmark(numWMEs, numChurnTrials, numAlphaThreads);
+    }
+    if ((argc > 1) && !strcmp(argv[1], "join"))
+    {
+        int numItems = DEFAULT_JOIN_ITEMS;
+        int numJoinTrials = DEFAULT_JOIN_TRIALS;
+        if (argc > 2)
+        {
+            std::stringstream(argv[2]) >> numItems;
+        }
+        if (argc > 3)
+        {
+            std::stringstream(argv[3]) >> numJoinTrials;
+        }
+        return Run_JoinBenchmark(numItems, numJoinTrials);
+    }
+    if ((argc > 1) && !strcmp(argv[1], "huge-pages"))
+    {
+        int numItems = DEFAULT_HUGE_PAGE_ITEMS;
+        int numHugeTrials = DEFAULT_HUGE_PAGE_TRIALS;
+        if (argc > 2)
+        {
+            std::stringstream(argv[2]) >> numItems;
+        }
+        if (argc > 3)
+        {
+            std::stringstream(argv[3]) >> numHugeTrials;
+        }
+        return Run_HugePageBenchmark(numItems, numHugeTrials);
+    }
+    if ((argc > 1) && !strcmp(argv[1], "chunking"))
+    {
+        int numChunks = DEFAULT_CHUNKING_CHUNKS;
+        int numChunkTrials = DEFAULT_CHUNKING_TRIALS;
+        if (argc > 2)
+        {
+            std::stringstream(argv[2]) >> numChunks;
+        }
+        if (argc > 3)
+        {
+            std::stringstream(argv[3]) >> numChunkTrials;
+        }
+        return Run_ChunkingBenchmark(numChunks, numChunkTrials);
+    }
+    if ((argc > 1) && !strcmp(argv[1], "epmem-query"))
+    {
+        int numEpisodes = DEFAULT_EPMEM_EPISODES;
+        int numQueryTrials = DEFAULT_EPMEM_TRIALS;
+        if (argc > 2)
+        {
+            std::stringstream(argv[2]) >> numEpisodes;
+        }
+        if (argc > 3)
+        {
+            std::stringstream(argv[3]) >> numQueryTrials;
+        }
+        return Run_EpmemQueryBenchmark(numEpisodes, numQueryTrials);
+    }
+    if ((argc > 1) && !strcmp(argv[1], "intern"))
+    {
+        int numStrings = DEFAULT_INTERN_STRINGS;
+        int numInternTrials = DEFAULT_INTERN_TRIALS;
+        if (argc > 2)
+        {
+            std::stringstream(argv[2]) >> numStrings;
+        }
+        if (argc > 3)
+        {
+            std::stringstream(argv[3]) >> numInternTrials;
+        }
+        return Run_InternBenchmark(numStrings, numInternTrials);
+    }
+    if ((argc > 1) && !strcmp(argv[1], "multi-agent"))
+    {
+        int numAgents = DEFAULT_MULTI_AGENT_AGENTS;
+        int numAgentTrials = DEFAULT_MULTI_AGENT_TRIALS;
+        int numRunThreads = std::max(2, static_cast<int>(std::thread::hardware_concurrency()));
+        if (argc > 2)
+        {
+            std::stringstream(argv[2]) >> numAgents;
+        }
+        if (argc > 3)
+        {
+            std::stringstream(argv[3]) >> numAgentTrials;
+        }
+        if (argc > 4)
+        {
+            std::stringstream(argv[4]) >> numRunThreads;
+        }
+        return Run_MultiAgentBenchmark(numAgents, numAgentTrials, numRunThreads);
+    }
+    if ((argc > 1) && !strcmp(argv[1], "wide-slots"))
+    {
+        int numAttrs = DEFAULT_WIDE_SLOT_ATTRS;
+        int numWideTrials = DEFAULT_WIDE_SLOT_TRIALS;
+        if (argc > 2)
+        {
+            std::stringstream(argv[2]) >> numAttrs;
+        }
+        if (argc > 3)
+        {
+            std::stringstream(argv[3]) >> numWideTrials;
+        }
+        return Run_WideSlotBenchmark(numAttrs, numWideTrials);
+    }
+
+    if ((argc > 1) && !strcmp(argv[1], "operator-prefs"))
+    {
+        int numProposals = DEFAULT_OPERATOR_PREFS_PROPOSALS;
+        int numPrefTrials = DEFAULT_OPERATOR_PREFS_TRIALS;
+        if (argc > 2)
+        {
+            std::stringstream(argv[2]) >> numProposals;
+        }
+        if (argc > 3)
+        {
+            std::stringstream(argv[3]) >> numPrefTrials;
+        }
+        return Run_OperatorPrefsBenchmark(numProposals, numPrefTrials);
+    }
+
+    if ((argc > 1) && !strcmp(argv[1], "gds"))
+    {
+        int treeDepth = DEFAULT_GDS_TREE_DEPTH;
+        int numGDSTrials = DEFAULT_GDS_TRIALS;
+        if (argc > 2)
+        {
+            std::stringstream(argv[2]) >> treeDepth;
+        }
+        if (argc > 3)
+        {
+            std::stringstream(argv[3]) >> numGDSTrials;
+        }
+        return Run_GDSBenchmark(treeDepth, numGDSTrials);
+    }
+    if ((argc > 1) && !strcmp(argv[1], "tree-gc"))
+    {
+        int numWMEs = DEFAULT_TREE_GC_WMES;
+        int numTreeTrials = DEFAULT_TREE_GC_TRIALS;
+        if (argc > 2)
+        {
+            std::stringstream(argv[2]) >> numWMEs;
+        }
+        if (argc > 3)
+        {
+            std::stringstream(argv[3]) >> numTreeTrials;
+        }
+        return Run_TreeGCBenchmark(numWMEs, numTreeTrials);
+    }
+
     const char* agentname ;
     int numTrials = DEFAULT_TRIALS;
     int numDCs = DEFAULT_DCS;
@@ -104,6 +1249,18 @@ int main(int argc, char* argv[])
     else
     {
         std::cout << "Usage: " << argv[0] << " [default | <agent name>] [<numtrials>] [<num_decisions>] [<num_init_and_rerun>]" << std::endl;
+        std::cout << "       " << argv[0] << " rete-net [<num_productions>] [<numtrials>]" << std::endl;
+        std::cout << "       " << argv[0] << " wme-churn [<num_wmes>] [<numtrials>] [<alpha_threads>]" << std::endl;
+        std::cout << "       " << argv[0] << " join [<num_items>] [<numtrials>]" << std::endl;
+        std::cout << "       " << argv[0] << " huge-pages [<num_items>] [<numtrials>]" << std::endl;
+        std::cout << "       " << argv[0] << " chunking [<num_chunks>] [<numtrials>]" << std::endl;
+        std::cout << "       " << argv[0] << " epmem-query [<num_episodes>] [<numtrials>]" << std::endl;
+        std::cout << "       " << argv[0] << " intern [<num_strings>] [<numtrials>]" << std::endl;
+        std::cout << "       " << argv[0] << " multi-agent [<num_agents>] [<numtrials>] [<run_threads>]" << std::endl;
+        std::cout << "       " << argv[0] << " wide-slots [<num_attributes>] [<numtrials>]" << std::endl;
+        std::cout << "       " << argv[0] << " operator-prefs [<num_proposals>] [<numtrials>]" << std::endl;
+        std::cout << "       " << argv[0] << " gds [<tree_depth>] [<numtrials>]" << std::endl;
+        std::cout << "       " << argv[0] << " tree-gc [<num_wmes>] [<numtrials>]" << std::endl;
         return 1;
     }
     if (!strcmp(agentname, "default"))
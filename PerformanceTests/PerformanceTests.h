@@ -11,10 +11,12 @@
 #include "portability.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cassert>
 #include <iostream>
 #include <iomanip>
 #include <string>
+#include <thread>
 #include <vector>
 #include <sstream>
 #include <iostream>
@@ -27,6 +29,32 @@
 #define DEFAULT_DCS -1
 #define DEFAULT_AGENT "count-test-5000";
 #define DEFAULT_INITS 0
+#define DEFAULT_RETE_NET_PRODUCTIONS 20000
+#define DEFAULT_RETE_NET_TRIALS 5
+#define DEFAULT_WME_CHURN_WMES 4000
+#define DEFAULT_WME_CHURN_TRIALS 3
+#define DEFAULT_JOIN_ITEMS 300
+#define DEFAULT_JOIN_TRIALS 3
+#define DEFAULT_HUGE_PAGE_ITEMS 20000
+#define DEFAULT_HUGE_PAGE_TRIALS 3
+#define DEFAULT_CHUNKING_CHUNKS 1000
+#define DEFAULT_CHUNKING_TRIALS 3
+#define DEFAULT_EPMEM_EPISODES 2000
+#define DEFAULT_EPMEM_QUERIES 300
+#define DEFAULT_EPMEM_TRIALS 3
+#define DEFAULT_INTERN_STRINGS 100000
+#define DEFAULT_INTERN_TRIALS 3
+#define DEFAULT_MULTI_AGENT_AGENTS 8
+#define DEFAULT_MULTI_AGENT_TRIALS 3
+#define DEFAULT_WIDE_SLOT_ATTRS 500
+#define DEFAULT_WIDE_SLOT_TRIALS 3
+#define DEFAULT_OPERATOR_PREFS_PROPOSALS 60
+#define DEFAULT_OPERATOR_PREFS_TRIALS 3
+#define DEFAULT_GDS_TREE_DEPTH 10
+#define DEFAULT_GDS_SUBSTATES 50
+#define DEFAULT_GDS_TRIALS 3
+#define DEFAULT_TREE_GC_WMES 100000
+#define DEFAULT_TREE_GC_TRIALS 3
 
 class StatsTracker
 {
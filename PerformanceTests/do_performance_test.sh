@@ -46,6 +46,7 @@ if [ "$lTestSuite" == "full" ] ; then
     nice -n -10 ./PerformanceTests Teach_Soar_90_Games 2 10000
     nice -n -10 ./PerformanceTests FactorizationStressTest 2
     nice -n -10 ./PerformanceTests FactorizationStressTest_learning 2
+    nice -n -10 ./PerformanceTests FactorizationStressTest_collection 2
     nice -n -10 ./PerformanceTests fifteen 3 5000
     nice -n -10 ./PerformanceTests fifteen_learning 10 500
     nice -n -10 ./PerformanceTests count-test-5000 3
@@ -54,6 +55,8 @@ if [ "$lTestSuite" == "full" ] ; then
     nice -n -10 ./PerformanceTests mac-planning_learning 4 165 64
     nice -n -10 ./PerformanceTests water-jug-lookahead 15 10000
     nice -n -10 ./PerformanceTests water-jug-lookahead_learning 2 102 100
+    nice -n -10 ./PerformanceTests rete-net 100000 5
+    nice -n -10 ./PerformanceTests join 500 5
 elif [ "$lTestSuite" == "fast" ] ; then
     nice -n -10 ./PerformanceTests wait 1 1000000
     nice -n -10 ./PerformanceTests wait_learning 1 1000000
@@ -62,6 +65,7 @@ elif [ "$lTestSuite" == "fast" ] ; then
     nice -n -10 ./PerformanceTests Teach_Soar_90_Games 1 10000
     nice -n -10 ./PerformanceTests FactorizationStressTest 1
     nice -n -10 ./PerformanceTests FactorizationStressTest_learning 1
+    nice -n -10 ./PerformanceTests FactorizationStressTest_collection 1
     nice -n -10 ./PerformanceTests fifteen 2 5000
     nice -n -10 ./PerformanceTests fifteen_learning 2 500
     nice -n -10 ./PerformanceTests count-test-5000 1
@@ -70,6 +74,12 @@ elif [ "$lTestSuite" == "fast" ] ; then
     nice -n -10 ./PerformanceTests mac-planning_learning 2 165 32
     nice -n -10 ./PerformanceTests water-jug-lookahead 3 10000
     nice -n -10 ./PerformanceTests water-jug-lookahead_learning 2 102 100
+    nice -n -10 ./PerformanceTests rete-net 20000 3
+    nice -n -10 ./PerformanceTests wme-churn 4000 3
+    for lThreads in 4 8 16 ; do
+        nice -n -10 ./PerformanceTests wme-churn 4000 3 $lThreads
+    done
+    nice -n -10 ./PerformanceTests join 300 3
 fi
 
 if [ $lUnitTests != off ] ; then
@@ -1114,6 +1114,116 @@ void FullTests_Parent::test64BitReteNet()
     SoarHelper::init_check_to_find_refcount_leaks(agent);
 }
 
+void FullTests_Parent::testReteNetSnapshot()
+{
+    agent->ExecuteCommandLine(("rete-net -l \"" + SoarHelper::GetResource("test64.soarx") + "\"").c_str());
+    no_agent_assertTrue(agent->GetLastCommandLineResult());
+    std::string original = agent->ExecuteCommandLine("print --full");
+
+    // Save in the (default) snapshot format and load it back; the rules should come back unchanged.
+    agent->ExecuteCommandLine("rete-net -s rete-net-snapshot-test.soarx");
+    no_agent_assertTrue(agent->GetLastCommandLineResult());
+    agent->ExecuteCommandLine("rete-net -l rete-net-snapshot-test.soarx");
+    no_agent_assertTrue(agent->GetLastCommandLineResult());
+    remove("rete-net-snapshot-test.soarx");
+
+    std::string reloaded = agent->ExecuteCommandLine("print --full");
+    no_agent_assertTrue_msg("Rules changed across a snapshot save and load", original == reloaded);
+    no_agent_assertTrue(agent->GetInputLink());
+    SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+void FullTests_Parent::testReteNetCopy()
+{
+    agent->ExecuteCommandLine(("rete-net -l \"" + SoarHelper::GetResource("test64.soarx") + "\"").c_str());
+    no_agent_assertTrue(agent->GetLastCommandLineResult());
+    std::string original = agent->ExecuteCommandLine("print --full");
+
+    // Copy the net into a second agent without going through a file; it should match rule for rule.
+    sml::Agent* copy = m_pKernel->CreateAgent("rete-net-copy-test");
+    no_agent_assertTrue(copy);
+    copy->ExecuteCommandLine(("load rete-network --agent " + kAgentName).c_str());
+    no_agent_assertTrue(copy->GetLastCommandLineResult());
+    std::string copied = copy->ExecuteCommandLine("print --full");
+    no_agent_assertTrue_msg("Rules changed when copying a rete net between agents", original == copied);
+    no_agent_assertTrue(copy->GetInputLink());
+
+    // A second copy from the same source comes out the same; nothing from
+    // the first copy is carried over into it.
+    sml::Agent* second = m_pKernel->CreateAgent("rete-net-copy-second");
+    no_agent_assertTrue(second);
+    second->ExecuteCommandLine(("load rete-network --agent " + kAgentName).c_str());
+    no_agent_assertTrue(second->GetLastCommandLineResult());
+    no_agent_assertTrue(copied == second->ExecuteCommandLine("print --full"));
+    no_agent_assertTrue(m_pKernel->DestroyAgent(second));
+
+    copy->ExecuteCommandLine("load rete-network --agent no-such-agent");
+    no_agent_assertTrue(!copy->GetLastCommandLineResult());
+
+    // The source agent is untouched by the copy.
+    no_agent_assertTrue(original == agent->ExecuteCommandLine("print --full"));
+
+    // A net with justifications can't be saved; the copy has to fail without
+    // clearing the agent it was going into.
+    sml::Agent* source = m_pKernel->CreateAgent("rete-net-copy-source");
+    no_agent_assertTrue(source);
+    source->ExecuteCommandLine("sp {copy*propose (state <s> ^superstate nil) --> (<s> ^operator <o> +) (<o> ^name copy-test)}");
+    source->ExecuteCommandLine("sp {copy*result (state <s> ^superstate <ss>) (<ss> ^operator.name copy-test) --> (<ss> ^copy-result true)}");
+    source->RunSelf(3);
+    no_agent_assertTrue(std::string(source->ExecuteCommandLine("print --justifications")).size() > 0);
+    std::string result = copy->ExecuteCommandLine("load rete-network --agent rete-net-copy-source");
+    no_agent_assertTrue(!copy->GetLastCommandLineResult());
+    no_agent_assertTrue_msg(result, result.find("justifications") != std::string::npos);
+    no_agent_assertTrue(copied == copy->ExecuteCommandLine("print --full"));
+    no_agent_assertTrue(copy->GetInputLink());
+    no_agent_assertTrue(m_pKernel->DestroyAgent(source));
+    no_agent_assertTrue(m_pKernel->DestroyAgent(copy));
+
+    SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+void FullTests_Parent::testReteNetCorrupted()
+{
+    agent->ExecuteCommandLine(("rete-net -l \"" + SoarHelper::GetResource("test64.soarx") + "\"").c_str());
+    no_agent_assertTrue(agent->GetLastCommandLineResult());
+    std::string original = agent->ExecuteCommandLine("print --full");
+
+    // The compact format has no length in its header, so a cut-off file is
+    // only caught by reading through it.  Every one of these loads has to
+    // fail and leave the agent's rules as they were.
+    std::vector<char> image;
+    for (int compact = 1; compact >= 0; compact--)
+    {
+        agent->ExecuteCommandLine(compact ? "rete-net -c -s rete-net-corrupt-test.soarx" : "rete-net -s rete-net-corrupt-test.soarx");
+        no_agent_assertTrue(agent->GetLastCommandLineResult());
+        FILE* f = fopen("rete-net-corrupt-test.soarx", "rb");
+        no_agent_assertTrue(f);
+        image.clear();
+        int c;
+        while ((c = fgetc(f)) != EOF)
+        {
+            image.push_back(static_cast<char>(c));
+        }
+        fclose(f);
+        no_agent_assertTrue(image.size() > 100);
+
+        for (size_t cut = 1; cut < 10; cut++)
+        {
+            f = fopen("rete-net-corrupt-test.soarx", "wb");
+            no_agent_assertTrue(f);
+            fwrite(&image[0], 1, image.size() * cut / 10, f);
+            fclose(f);
+            agent->ExecuteCommandLine("rete-net -l rete-net-corrupt-test.soarx");
+            no_agent_assertTrue_msg("Loaded a truncated rete-net file", !agent->GetLastCommandLineResult());
+            no_agent_assertTrue_msg("A failed load changed the rules", original == agent->ExecuteCommandLine("print --full"));
+        }
+    }
+    remove("rete-net-corrupt-test.soarx");
+
+    no_agent_assertTrue(agent->GetInputLink());
+    SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
 void FullTests_Parent::testOSupportCopyDestroy()
 {
     loadProductions(SoarHelper::GetResource("testOSupportCopyDestroy.soar"));
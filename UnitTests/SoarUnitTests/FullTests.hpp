@@ -66,6 +66,9 @@ public:
 	void testSimpleCopy();
 	void testSimpleReteNetLoader();
 	void test64BitReteNet();
+	void testReteNetSnapshot();
+	void testReteNetCopy();
+	void testReteNetCorrupted();
 	void testOSupportCopyDestroy();
 	void testOSupportCopyDestroyCircularParent();
 	void testOSupportCopyDestroyCircular();
@@ -162,6 +165,15 @@ public:
 	TEST(test64BitReteNet, -1);
 	void test64BitReteNet() { this->FullTests_Parent::test64BitReteNet(); }
 
+	TEST(testReteNetSnapshot, -1);
+	void testReteNetSnapshot() { this->FullTests_Parent::testReteNetSnapshot(); }
+
+	TEST(testReteNetCopy, -1);
+	void testReteNetCopy() { this->FullTests_Parent::testReteNetCopy(); }
+
+	TEST(testReteNetCorrupted, -1);
+	void testReteNetCorrupted() { this->FullTests_Parent::testReteNetCorrupted(); }
+
 	TEST(testOSupportCopyDestroy, -1);
 	void testOSupportCopyDestroy() { this->FullTests_Parent::testOSupportCopyDestroy(); }
 
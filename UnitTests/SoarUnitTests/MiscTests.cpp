@@ -17,11 +17,59 @@
 #include "sml_Names.h"
 
 #include <string>
+#include <sstream>
+#include <map>
+#include <vector>
 #include <iostream>
+#include <cstdlib>
 
 #include "SoarHelper.hpp"
 #include "handlers.hpp"
 
+/* One column of a pool's row in the raw "stats --pools" table: 0 is the
+ * item size, then allocs, frees, used items, peak items and blocks. */
+static uint64_t pool_counter(const std::string& counters, const std::string& pool, int column)
+{
+	std::istringstream lines(counters);
+	std::string line;
+	while (std::getline(lines, line))
+	{
+		std::istringstream fields(line);
+		std::string name;
+		fields >> name;
+		if (name != pool)
+		{
+			continue;
+		}
+		uint64_t value = 0;
+		for (int i = 0; i <= column; i++)
+		{
+			fields >> value;
+		}
+		return value;
+	}
+	return 0;
+}
+
+/* The leading byte count of a "debug trim" report */
+static uint64_t trimmed_bytes(const std::string& result)
+{
+	return std::strtoull(result.c_str(), NULL, 10);
+}
+
+/* The byte count of the symbol name arena line of "stats --memory" */
+static uint64_t string_arena_bytes(const std::string& result)
+{
+	size_t pos = result.find(" bytes in symbol name arenas");
+	if (pos == std::string::npos)
+	{
+		return 0;
+	}
+	size_t start = result.rfind('\n', pos);
+	start = (start == std::string::npos) ? 0 : start + 1;
+	return std::strtoull(result.c_str() + start, NULL, 10);
+}
+
 void MiscTests::source(const std::string& file)
 {
 	agent->LoadProductions(SoarHelper::GetResource(file).c_str());
@@ -369,6 +417,637 @@ void MiscTests::testStopPhaseRetrieval()
 	assertTrue(response.GetArgInt(sml::sml_Names::kParamPhase, -1) == sml::smlPhase::sml_APPLY_PHASE);
 }
 
+/* One column of a row of a "stats -r" table, found by its first word: for a
+ * node type 0 is the actual count; for a hash table 0 is the bucket count,
+ * then items, load, used buckets, average and longest chain, splits and
+ * merges. */
+static double rete_table_stat(const std::string& report, const std::string& table, int column)
+{
+	std::istringstream lines(report);
+	std::string line;
+	while (std::getline(lines, line))
+	{
+		std::istringstream fields(line);
+		std::string name;
+		fields >> name;
+		if (name != table)
+		{
+			continue;
+		}
+		double value = 0;
+		for (int i = 0; i <= column; i++)
+		{
+			fields >> value;
+		}
+		return value;
+	}
+	return 0;
+}
+
+void MiscTests::testReteHashTableResize()
+{
+	agent->ExecuteCommandLine("w 0");
+	runTestSetup("testReteHashTableResize");
+
+	std::string before = agent->ExecuteCommandLine("stats -r");
+	double left_buckets = rete_table_stat(before, "Left/Token", 0);
+	double right_buckets = rete_table_stat(before, "Right/WME", 0);
+	assertTrue(left_buckets > 0 && right_buckets > 0);
+
+	// all 4000 items are in working memory once the make phase is over
+	agent->RunSelf(4002);
+	std::string loaded = agent->ExecuteCommandLine("stats -r");
+	assertTrue(rete_table_stat(loaded, "Right/WME", 0) > right_buckets);
+	assertTrue(rete_table_stat(loaded, "Right/WME", 6) > 0);
+
+	// every bucket split on the way up has been merged again on the way down
+	runTestExecute("testReteHashTableResize", -1);
+	std::string cleaned = agent->ExecuteCommandLine("stats -r");
+	assertTrue(rete_table_stat(cleaned, "Left/Token", 6) > 0);
+	assertTrue(rete_table_stat(cleaned, "Right/WME", 6) > rete_table_stat(loaded, "Right/WME", 6));
+	assertTrue(rete_table_stat(cleaned, "Left/Token", 7) == rete_table_stat(cleaned, "Left/Token", 6));
+	assertTrue(rete_table_stat(cleaned, "Right/WME", 7) == rete_table_stat(cleaned, "Right/WME", 6));
+	assertTrue(rete_table_stat(cleaned, "Left/Token", 0) == left_buckets);
+	assertTrue(rete_table_stat(cleaned, "Right/WME", 0) == right_buckets);
+	SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+void MiscTests::testMatchProfile()
+{
+	source("testReteHashTableResize.soar");
+	agent->ExecuteCommandLine("production match-profile --on");
+	assertTrue(agent->GetLastCommandLineResult());
+	agent->RunSelf(50);
+
+	sml::ClientAnalyzedXML response;
+	agent->ExecuteCommandLineXML("production match-profile 1", &response);
+	assertTrue(agent->GetLastCommandLineResult());
+	assertTrue(response.GetArgInt(sml::sml_Names::kParamMatchProfileJoinTests, -1) > 0);
+	assertTrue(response.GetArgInt(sml::sml_Names::kParamMatchProfileLeftActivations, -1) > 0);
+	assertTrue(response.GetArgInt(sml::sml_Names::kParamMatchProfileTokensCreated, -1) > 0);
+
+	agent->ExecuteCommandLine("production match-profile --reset");
+	sml::ClientAnalyzedXML emptyResponse;
+	agent->ExecuteCommandLineXML("production match-profile", &emptyResponse);
+	assertTrue(agent->GetLastCommandLineResult());
+	assertEquals(emptyResponse.GetArgInt(sml::sml_Names::kParamMatchProfileJoinTests, -1), -1);
+}
+
+void MiscTests::testCollectionMatch()
+{
+	agent->ExecuteCommandLine("w 0");
+	runTest("testCollectionMatch", -1);
+	SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+/* The line of a report that mentions the given production */
+static std::string report_line(const std::string& report, const std::string& name)
+{
+	std::istringstream lines(report);
+	std::string line;
+	while (std::getline(lines, line))
+	{
+		if (line.find(name) != std::string::npos)
+		{
+			return line;
+		}
+	}
+	return std::string();
+}
+
+void MiscTests::testCollectionMatchReteNet()
+{
+	agent->ExecuteCommandLine("w 0");
+	runTestSetup("testCollectionMatch");
+
+	// The compact layout has nowhere to keep the flag, so it must refuse.
+	agent->ExecuteCommandLine("save rete-network --compact -s collection-compact-test.soarx");
+	assertFalse(agent->GetLastCommandLineResult());
+	remove("collection-compact-test.soarx");
+
+	agent->ExecuteCommandLine("save rete-network -s collection-test.soarx");
+	assertTrue(agent->GetLastCommandLineResult());
+
+	agent->ExecuteCommandLine("production match-profile --on");
+	runTestExecute("testCollectionMatch", -1);
+	std::string sourced = report_line(agent->ExecuteCommandLine("production match-profile 20"), "elaborate*pair*collection");
+	assertTrue(sourced.size() > 0);
+
+	agent->ExecuteCommandLine("load rete-network -l collection-test.soarx");
+	assertTrue(agent->GetLastCommandLineResult());
+	remove("collection-test.soarx");
+	// loading leaves the agent halted from the first run
+	agent->ExecuteCommandLine("init-soar");
+
+	std::string result = agent->ExecuteCommandLine("print elaborate*pair*collection");
+	assertTrue_msg(result, result.find(":collection") != std::string::npos);
+
+	// A collection memory activates its joins differently from a plain one,
+	// so the reloaded net has to match exactly as the sourced one did.
+	agent->ExecuteCommandLine("production match-profile --reset");
+	agent->ExecuteCommandLine("production match-profile --on");
+	halted = false;
+	runTestExecute("testCollectionMatch", -1);
+	std::string reloaded = report_line(agent->ExecuteCommandLine("production match-profile 20"), "elaborate*pair*collection");
+	assertTrue_msg(sourced + " / " + reloaded, sourced == reloaded);
+
+	SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+void MiscTests::testCollectionSharedPrefix()
+{
+	agent->ExecuteCommandLine("w 0");
+	runTestSetup("testCollectionMatch");
+
+	// The :collection production is sourced before its plain twin, so the
+	// twin must not reuse its collection memories.
+	uint64_t both = static_cast<uint64_t>(rete_table_stat(agent->ExecuteCommandLine("stats -r"), "memory", 0));
+	agent->ExecuteCommandLine("excise elaborate*pair*collection");
+	uint64_t plain = static_cast<uint64_t>(rete_table_stat(agent->ExecuteCommandLine("stats -r"), "memory", 0));
+	assertTrue(plain < both);
+
+	// Added after the twin, it must not share the twin's MP nodes either.
+	agent->ExecuteCommandLine("sp {elaborate*pair*collection :collection (state <s> ^left <l> ^right <r>) (<l> ^key <k>) (<r> ^key <k> ^id <id>) -(<l> ^id <id>) --> (<l> ^collection <r>)}");
+	assertTrue(agent->GetLastCommandLineResult());
+	assertTrue(static_cast<uint64_t>(rete_table_stat(agent->ExecuteCommandLine("stats -r"), "memory", 0)) == both);
+
+	runTestExecute("testCollectionMatch", -1);
+	SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+void MiscTests::testAdaptiveReorder()
+{
+	agent->ExecuteCommandLine("w 0");
+	runTestSetup("testAdaptiveReorder");
+	agent->ExecuteCommandLine("production match-profile --on");
+	agent->RunSelf(70);
+
+	// Rebuilding a production is not adding or excising one
+	int prodEvents = 0;
+	int removedCall = agent->RegisterForProductionEvent(sml::smlEVENT_BEFORE_PRODUCTION_REMOVED, Handlers::MyProductionHandler, &prodEvents);
+	int addedCall = agent->RegisterForProductionEvent(sml::smlEVENT_AFTER_PRODUCTION_ADDED, Handlers::MyProductionHandler, &prodEvents);
+
+	std::string result = agent->ExecuteCommandLine("production reorder");
+	assertTrue_msg(result, agent->GetLastCommandLineResult());
+	assertTrue_msg(result, result.find("Reordered elaborate*pair") != std::string::npos);
+	assertTrue(prodEvents == 0);
+	assertTrue(agent->UnregisterForProductionEvent(removedCall));
+	assertTrue(agent->UnregisterForProductionEvent(addedCall));
+
+	runTestExecute("testAdaptiveReorder", -1);
+	SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+void MiscTests::testBatchExcise()
+{
+	runTestSetup("testBatchExcise");
+	agent->RunSelf(3);
+
+	std::string result = agent->ExecuteCommandLine("production excise --chunks");
+	assertTrue_msg(result, agent->GetLastCommandLineResult());
+	assertTrue_msg(result, result.find("3 productions excised") != std::string::npos);
+
+	runTestExecute("testBatchExcise", -1);
+	SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+void MiscTests::testWmeChangeCancel()
+{
+	runTestSetup("testWmeChangeCancel");
+
+	sml::WMElement* flicker = agent->CreateStringWME(agent->GetInputLink(), "flicker", "on");
+	agent->DestroyWME(flicker);
+	agent->CreateStringWME(agent->GetInputLink(), "steady", "on");
+	agent->RunSelf(1);
+
+	std::string result = agent->ExecuteCommandLine("stats");
+	assertTrue_msg(result, agent->GetLastCommandLineResult());
+	assertTrue_msg(result, result.find(" 1 cancelled)") != std::string::npos);
+
+	runTestExecute("testWmeChangeCancel", -1);
+	SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+void MiscTests::testParallelAlphaLookup()
+{
+	runTestSetup("testParallelAlphaLookup");
+
+	std::string result = agent->ExecuteCommandLine("soar alpha-threads 4");
+	assertTrue_msg(result, agent->GetLastCommandLineResult());
+
+	for (int i = 0; i < 1500; i++)
+	{
+		sml::Identifier* item = agent->CreateIdWME(agent->GetInputLink(), "item");
+		agent->CreateIntWME(item, "serial", i);
+		agent->CreateStringWME(item, "kind", "tracked");
+	}
+	agent->RunSelf(1);
+
+	result = agent->ExecuteCommandLine("production firing-counts item*seen");
+	assertTrue_msg(result, result.find("1500") != std::string::npos);
+	result = agent->ExecuteCommandLine("stats --rete");
+	assertTrue_msg(result, result.find(" parallel batches") != std::string::npos);
+	assertTrue_msg(result, result.find(" 0 parallel batches") == std::string::npos);
+
+	runTestExecute("testParallelAlphaLookup", -1);
+	SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+void MiscTests::testTokenCounts()
+{
+	runTestSetup("testTokenCounts");
+	agent->RunSelf(3);
+
+	std::string result = agent->ExecuteCommandLine("production memory-usage tokens*partial");
+	assertTrue_msg(result, agent->GetLastCommandLineResult());
+	assertTrue_msg(result, result.find("35:  tokens*partial") != std::string::npos);
+
+	result = agent->ExecuteCommandLine("production memory-usage");
+	assertTrue_msg(result, result.find("35:  tokens*partial") != std::string::npos);
+	assertTrue_msg(result, result.find("1:  propose*wait") != std::string::npos);
+
+	agent->ExecuteCommandLine("production excise propose*wait");
+	result = agent->ExecuteCommandLine("production memory-usage tokens*partial");
+	assertTrue_msg(result, result.find("35:  tokens*partial") != std::string::npos);
+
+	agent->ExecuteCommandLine("sp {finish (state <s> ^superstate nil) --> (succeeded)}");
+	runTestExecute("testTokenCounts", -1);
+	SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+void MiscTests::testAgentMemoryPools()
+{
+	/* "stats --pools" sums the pools of every agent */
+	std::string result = agent->ExecuteCommandLine("stats --pools");
+	uint64_t allocs = pool_counter(result, "wme", 1);
+	uint64_t blocks = pool_counter(result, "wme", 5);
+	assertTrue_msg(result, allocs > 0);
+
+	sml::Agent* agent2 = kernel->CreateAgent("soar2");
+	assertTrue(agent2 != NULL);
+	agent2->LoadProductions(SoarHelper::GetResource("testTrimMemoryPools.soar").c_str());
+	assertTrue_msg(agent2->GetLastErrorDescription(), agent2->GetLastCommandLineResult());
+	agent2->RunSelf(10);
+
+	result = agent->ExecuteCommandLine("stats --pools");
+	assertTrue_msg(result, pool_counter(result, "wme", 1) > allocs);
+	std::string result2 = agent2->ExecuteCommandLine("stats --pools");
+	assertTrue_msg(result2, pool_counter(result2, "wme", 1) == pool_counter(result, "wme", 1));
+
+	/* blocks added to one agent's pool stay with it */
+	agent->ExecuteCommandLine("debug allocate wme 20");
+	result = agent->ExecuteCommandLine("stats --pools");
+	assertTrue_msg(result, pool_counter(result, "wme", 5) >= blocks + 20);
+
+	/* and a destroyed agent takes its counts and blocks with it */
+	kernel->DestroyAgent(agent2);
+	result = agent->ExecuteCommandLine("stats --pools");
+	assertTrue_msg(result, pool_counter(result, "wme", 1) == allocs);
+	assertTrue_msg(result, pool_counter(result, "wme", 5) == blocks + 20);
+
+	SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+void MiscTests::testTrimMemoryPools()
+{
+	runTestSetup("testTrimMemoryPools");
+
+	std::string result = agent->ExecuteCommandLine("debug allocate wme 20");
+	assertTrue_msg(result, agent->GetLastCommandLineResult());
+	result = agent->ExecuteCommandLine("stats --pools");
+	assertTrue_msg(result, pool_counter(result, "wme", 5) >= 20);
+
+	result = agent->ExecuteCommandLine("debug trim");
+	assertTrue_msg(result, agent->GetLastCommandLineResult());
+	assertTrue_msg(result, trimmed_bytes(result) > 0);
+	result = agent->ExecuteCommandLine("stats --pools");
+	assertTrue_msg(result, pool_counter(result, "wme", 5) < 20);
+
+	/* everything free went the first time */
+	result = agent->ExecuteCommandLine("debug trim");
+	assertTrue_msg(result, trimmed_bytes(result) == 0);
+
+	runTestExecute("testTrimMemoryPools", -1);
+	result = agent->ExecuteCommandLine("stats --pools");
+	assertTrue_msg(result, pool_counter(result, "wme", 1) > 0);
+	SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+void MiscTests::testPoolStatistics()
+{
+	runTestSetup("testTrimMemoryPools");
+	agent->RunSelf(4);
+
+	std::string result = agent->ExecuteCommandLine("stats --pools");
+	assertTrue_msg(result, agent->GetLastCommandLineResult());
+	assertTrue_msg(result, result.find("Pool Name") != std::string::npos);
+	assertTrue_msg(result, result.find("Item Size") != std::string::npos);
+	assertTrue_msg(result, result.find("Allocs") != std::string::npos);
+	assertTrue_msg(result, result.find("Frees") != std::string::npos);
+	assertTrue_msg(result, result.find("Used Items") != std::string::npos);
+	assertTrue_msg(result, result.find("Peak Items") != std::string::npos);
+	assertTrue_msg(result, result.find("Blocks") != std::string::npos);
+
+	/* the agent has added and removed wmes, so every counter is in use */
+	uint64_t allocs = pool_counter(result, "wme", 1);
+	uint64_t frees = pool_counter(result, "wme", 2);
+	uint64_t used = pool_counter(result, "wme", 3);
+	assertTrue_msg(result, pool_counter(result, "wme", 0) > 0);
+	assertTrue_msg(result, frees > 0);
+	assertTrue_msg(result, used == allocs - frees);
+	assertTrue_msg(result, pool_counter(result, "wme", 4) >= used);
+	assertTrue_msg(result, pool_counter(result, "wme", 5) > 0);
+
+	/* one sample per decision cycle, in order */
+	result = agent->ExecuteCommandLine("stats --pool-history wme");
+	assertTrue_msg(result, agent->GetLastCommandLineResult());
+	assertTrue_msg(result, result.find("Used Items") != std::string::npos);
+	std::istringstream lines(result);
+	std::string line;
+	uint64_t samples = 0;
+	while (std::getline(lines, line))
+	{
+		std::istringstream fields(line);
+		uint64_t dc, sampleUsed, sampleBlocks;
+		if (fields >> dc >> sampleUsed >> sampleBlocks)
+		{
+			assertTrue_msg(result, dc == ++samples);
+			assertTrue_msg(result, sampleBlocks > 0);
+		}
+	}
+	assertTrue_msg(result, samples >= 3);
+
+	agent->ExecuteCommandLine("stats --pool-history no-such-pool");
+	assertFalse(agent->GetLastCommandLineResult());
+
+	SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+void MiscTests::testHugePagePoolBlocks()
+{
+	runTestSetup("testTrimMemoryPools");
+	std::string result = agent->ExecuteCommandLine("soar pool-huge-pages on");
+	assertTrue_msg(result, agent->GetLastCommandLineResult());
+
+	/* grow the wme pool until it holds a huge page's worth of items.  The
+	 * "stats --memory" table's columns are used items, free items, item
+	 * size, items per block, blocks and total bytes. */
+	result = agent->ExecuteCommandLine("stats --memory");
+	for (int i = 0; i < 1000 && pool_counter(result, "wme", 5) < 0x200000; ++i)
+	{
+		agent->ExecuteCommandLine("debug allocate wme 1");
+		result = agent->ExecuteCommandLine("stats --memory");
+	}
+	uint64_t freeItems = pool_counter(result, "wme", 1);
+	uint64_t blocks = pool_counter(result, "wme", 4);
+	uint64_t itemsPerBlock = pool_counter(result, "wme", 3);
+	assertTrue_msg(result, pool_counter(result, "wme", 5) >= 0x200000);
+
+	/* the next block is a huge page where the OS has them, whether
+	 * reserved or transparent, and an ordinary block otherwise */
+	agent->ExecuteCommandLine("debug allocate wme 1");
+	result = agent->ExecuteCommandLine("stats --memory");
+	assertTrue_msg(result, pool_counter(result, "wme", 4) == blocks + 1);
+#ifdef __linux__
+	assertTrue_msg(result, pool_counter(result, "wme", 1) - freeItems > itemsPerBlock);
+#else
+	assertTrue_msg(result, pool_counter(result, "wme", 1) - freeItems == itemsPerBlock);
+#endif
+
+	/* the new block's items head the free list, so the run allocates
+	 * from it, and a trim must leave the items in use alone */
+	runTestExecute("testTrimMemoryPools", -1);
+	result = agent->ExecuteCommandLine("stats --pools");
+	uint64_t used = pool_counter(result, "wme", 3);
+	assertTrue_msg(result, used > 0);
+	result = agent->ExecuteCommandLine("debug trim");
+	assertTrue_msg(result, trimmed_bytes(result) > 0);
+	result = agent->ExecuteCommandLine("stats --pools");
+	assertTrue_msg(result, pool_counter(result, "wme", 3) == used);
+
+	SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+void MiscTests::testStringArenaCompaction()
+{
+	runTestSetup("testStringArena");
+
+	std::vector<sml::WMElement*> dropped;
+	for (int i = 0; i < 1000; ++i)
+	{
+		std::ostringstream name;
+		name << "dropped-string-constant-with-a-longer-name-" << i;
+		dropped.push_back(agent->CreateStringWME(agent->GetInputLink(), "item", name.str().c_str()));
+	}
+	for (int i = 0; i < 40; ++i)
+	{
+		std::ostringstream name;
+		name << "kept-" << i;
+		agent->CreateStringWME(agent->GetInputLink(), "item", name.str().c_str());
+	}
+	agent->RunSelf(1);
+	std::string result = agent->ExecuteCommandLine("stats --memory");
+	uint64_t filled = string_arena_bytes(result);
+	assertTrue_msg(result, filled > 0);
+
+	/* the arena compacts at the end of the next output phase, once more
+	 * than its largest chunk size is used and most of that is freed names */
+	for (size_t i = 0; i < dropped.size(); ++i)
+	{
+		assertTrue(dropped[i]->DestroyWME());
+	}
+	agent->RunSelf(2);
+	result = agent->ExecuteCommandLine("debug trim");
+	assertTrue_msg(result, agent->GetLastCommandLineResult());
+	result = agent->ExecuteCommandLine("stats --memory");
+	assertTrue_msg(result, string_arena_bytes(result) < filled / 2);
+
+	/* the survivors still print */
+	std::string inputLink = agent->ExecuteCommandLine("print I2");
+	for (size_t i = 0; i < inputLink.size(); ++i)
+	{
+		if (inputLink[i] == ')' || inputLink[i] == '\n')
+		{
+			inputLink[i] = ' ';
+		}
+	}
+	for (int i = 0; i < 40; ++i)
+	{
+		std::ostringstream name;
+		name << "^item kept-" << i << " ";
+		assertTrue_msg(inputLink, inputLink.find(name.str()) != std::string::npos);
+	}
+	assertTrue_msg(inputLink, inputLink.find("dropped-string") == std::string::npos);
+
+	/* a new wme interns to the surviving symbol, so the probe matches */
+	agent->CreateStringWME(agent->GetInputLink(), "probe", "kept-17");
+	agent->RunSelf(1);
+	result = agent->ExecuteCommandLine("print (* ^matched *)");
+	assertTrue_msg(result, result.find("^matched kept-17") != std::string::npos);
+
+	/* and parsing a survivor's name finds the symbol again */
+	result = agent->ExecuteCommandLine("print (* ^item kept-31)");
+	assertTrue_msg(result, result.find("^item kept-31") != std::string::npos);
+
+	SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+/* The value "preferences <state> operator" prints for each candidate
+ * under "selection probabilities:", keyed by operator id */
+static std::map<std::string, std::string> selection_values(const std::string& prefs)
+{
+	std::map<std::string, std::string> values;
+	std::istringstream lines(prefs.substr(prefs.find("selection probabilities:")));
+	std::string line, id;
+	std::getline(lines, line);
+	while (std::getline(lines, line))
+	{
+		std::string::size_type start = line.find(" = ");
+		std::string::size_type end = line.find(" :", start);
+		if (start == std::string::npos || end == std::string::npos)
+		{
+			continue;
+		}
+		std::istringstream(line) >> id;
+		values[id] = line.substr(start + 3, end - start - 3);
+	}
+	return values;
+}
+
+void MiscTests::testManyIndifferentCandidates()
+{
+	runTest("testManyIndifferentCandidates", -1);
+	SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+void MiscTests::testManyCandidatesMissingPair()
+{
+	runTest("testManyCandidatesMissingPair", -1);
+	SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+void MiscTests::testManyMixedCandidates()
+{
+	runTest("testManyMixedCandidates", -1);
+	SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+void MiscTests::testManyNumericCandidates()
+{
+	runTestSetup("testManyNumericCandidates");
+	agent->RunSelf(2);
+
+	std::string result = agent->ExecuteCommandLine("preferences s1 operator");
+	std::map<std::string, std::string> all = selection_values(result);
+	assertTrue_msg(result, all.size() == 9);
+
+	// with four candidates left, each one's value is summed on its own
+	agent->CreateStringWME(agent->GetInputLink(), "narrow", "yes");
+	agent->RunSelf(1);
+
+	result = agent->ExecuteCommandLine("preferences s1 operator");
+	std::map<std::string, std::string> few = selection_values(result);
+	assertTrue_msg(result, few.size() == 4);
+	for (std::map<std::string, std::string>::iterator it = few.begin(); it != few.end(); ++it)
+	{
+		assertTrue_msg(it->first + ": " + all[it->first] + " / " + it->second, all[it->first] == it->second);
+	}
+	SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+void MiscTests::testGDSRemoval()
+{
+	runTestSetup("testGDSRemoval");
+
+	/* step three phases at a time so the three-level stack and the GDS
+	 * that removes it are both seen */
+	bool sawThreeLevels = false;
+	bool sawOldGDSValue = false;
+	for (int step = 0; step < 100 && !halted; ++step)
+	{
+		agent->RunSelf(3, sml::sml_PHASE);
+
+		std::string gds = agent->ExecuteCommandLine("print --gds");
+		assertTrue_msg(gds, gds.find("Current GDS") != std::string::npos);
+		if (gds.find("Old GDS value") != std::string::npos)
+		{
+			assertTrue_msg(gds, gds.find("S1 ^flag ") != std::string::npos);
+			sawOldGDSValue = true;
+		}
+
+		std::string stack = agent->ExecuteCommandLine("print --stack");
+		if (stack.find("S3") != std::string::npos)
+		{
+			sawThreeLevels = true;
+		}
+	}
+	assertTrue(sawThreeLevels);
+	assertTrue(sawOldGDSValue);
+	runTestExecute("testGDSRemoval", -1);
+
+	/* one removal for each of the six counts */
+	sml::ClientAnalyzedXML response;
+	agent->ExecuteCommandLineXML("stats", &response);
+	assertTrue(response.GetArgInt(sml::sml_Names::kParamStatsGDSElaborationPasses, -1) == 6);
+	assertTrue(response.GetArgInt(sml::sml_Names::kParamStatsGDSInstantiationsExplored, -1) == 42);
+	assertTrue(response.GetArgInt(sml::sml_Names::kParamStatsGDSWmeAdditions, -1) == 60);
+	assertTrue(response.GetArgInt(sml::sml_Names::kParamStatsGDSStateRemovals, -1) == 6);
+
+	std::string stats = agent->ExecuteCommandLine("stats");
+	assertTrue_msg(stats, stats.find("GDS: 6 elaboration passes, 42 instantiations explored, 60 wme additions, 6 states removed") != std::string::npos);
+	SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+static bool holds_cycle(sml::Agent* agent)
+{
+	std::string result = agent->ExecuteCommandLine("print (* ^parent *)");
+	return result.find("^parent") != std::string::npos;
+}
+
+void MiscTests::testGCBatch()
+{
+	runTestSetup("testGCBatch");
+
+	/* gc-batch 0 collects the cycle in the phase that cuts it loose */
+	agent->RunSelf(3);
+	assertFalse(holds_cycle(agent));
+	agent->ExecuteCommandLine("init-soar");
+	std::string result = agent->ExecuteCommandLine("stats --pools");
+	uint64_t idsAfterInit = pool_counter(result, "identifier", 3);
+
+	/* held for gc-batch decisions, then swept */
+	agent->ExecuteCommandLine("soar gc-batch 5");
+	agent->RunSelf(3);
+	assertTrue(holds_cycle(agent));
+	agent->RunSelf(3);
+	assertTrue(holds_cycle(agent));
+	agent->RunSelf(1);
+	assertFalse(holds_cycle(agent));
+
+	/* init-soar sweeps whatever is held */
+	agent->ExecuteCommandLine("init-soar");
+	agent->ExecuteCommandLine("soar gc-batch 1000");
+	agent->RunSelf(3);
+	assertTrue(holds_cycle(agent));
+	agent->ExecuteCommandLine("init-soar");
+	assertFalse(holds_cycle(agent));
+	result = agent->ExecuteCommandLine("stats --pools");
+	assertTrue_msg(result, pool_counter(result, "identifier", 3) == idsAfterInit);
+
+	/* a substate forces the sweep */
+	agent->RunSelf(3);
+	assertTrue(holds_cycle(agent));
+	agent->CreateStringWME(agent->GetInputLink(), "descend", "yes");
+	agent->RunSelf(1);
+	assertTrue(holds_cycle(agent));
+	agent->RunSelf(1);
+	std::string stack = agent->ExecuteCommandLine("print --stack");
+	assertTrue_msg(stack, stack.find("S2") != std::string::npos);
+	assertFalse(holds_cycle(agent));
+
+	SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
 //void MiscTests::testSoarDebugger()
 //{
 //	bool result = agent->SpawnDebugger();
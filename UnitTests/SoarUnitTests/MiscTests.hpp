@@ -53,6 +53,53 @@ public:
 	TEST(testStopPhaseRetrieval, -1)
     void testStopPhaseRetrieval();
 
+	TEST(testReteHashTableResize, -1)
+	void testReteHashTableResize();
+	TEST(testMatchProfile, -1)
+	void testMatchProfile();
+	TEST(testCollectionMatch, -1)
+	void testCollectionMatch();
+	TEST(testCollectionMatchReteNet, -1)
+	void testCollectionMatchReteNet();
+	TEST(testCollectionSharedPrefix, -1)
+	void testCollectionSharedPrefix();
+	TEST(testAdaptiveReorder, -1)
+	void testAdaptiveReorder();
+	TEST(testBatchExcise, -1)
+	void testBatchExcise();
+
+	TEST(testWmeChangeCancel, -1)
+	void testWmeChangeCancel();
+
+	TEST(testParallelAlphaLookup, -1)
+	void testParallelAlphaLookup();
+
+	TEST(testTokenCounts, -1)
+	void testTokenCounts();
+
+	TEST(testAgentMemoryPools, -1)
+	void testAgentMemoryPools();
+	TEST(testTrimMemoryPools, -1)
+	void testTrimMemoryPools();
+	TEST(testPoolStatistics, -1)
+	void testPoolStatistics();
+	TEST(testHugePagePoolBlocks, -1)
+	void testHugePagePoolBlocks();
+	TEST(testStringArenaCompaction, -1)
+	void testStringArenaCompaction();
+	TEST(testManyIndifferentCandidates, -1)
+	void testManyIndifferentCandidates();
+	TEST(testManyCandidatesMissingPair, -1)
+	void testManyCandidatesMissingPair();
+	TEST(testManyMixedCandidates, -1)
+	void testManyMixedCandidates();
+	TEST(testManyNumericCandidates, -1)
+	void testManyNumericCandidates();
+	TEST(testGDSRemoval, -1)
+	void testGDSRemoval();
+	TEST(testGCBatch, -1)
+	void testGCBatch();
+
 	TEST(testGDS_Failed_Justification_Crash, -1);
 	TEST(testIsupported_Smem_Chunk_Crash, -1);
 	TEST(testNegated_Operator_Crash, -1);
@@ -258,3 +258,140 @@ void MultiAgentTest::doTest()
 	// If it's a remote connection we just disconnect.
 	delete pKernel ;
 }
+
+/* Runs the same agents to completion with the given number of run threads
+ * and returns each agent's trace and decision count. */
+void MultiAgentTest::runWithThreads(int threads, std::vector< std::string >& traces, std::vector< std::string >& decisions)
+{
+	pKernel = sml::Kernel::CreateKernelInCurrentThread(true, sml::Kernel::kUseAnyPort);
+	no_agent_assertTrue_msg(pKernel->GetLastErrorDescription(), !pKernel->HadError());
+
+	std::vector< std::stringstream* > trace;
+
+	for (int agentCounter = 0 ; agentCounter < numberAgents ; ++agentCounter)
+	{
+		std::stringstream name;
+		name << "agent" << 1 + agentCounter;
+
+		sml::Agent* agent = pKernel->CreateAgent(name.str().c_str()) ;
+		assertTrue(agent != NULL);
+		// Every other agent also chunks, uses smem and epmem and picks operators at random
+		assertTrue(agent->LoadProductions(SoarHelper::GetResource(agentCounter % 2 ? "testRunThreadsMixed.soar" : "testRunThreads.soar").c_str()));
+		std::stringstream seed;
+		seed << "srand " << 1 + agentCounter;
+		agent->ExecuteCommandLine(seed.str().c_str());
+		agent->ExecuteCommandLine("watch 1");
+
+		trace.push_back(new std::stringstream());
+
+		auto lambda = [](sml::smlPrintEventId id, void* pUserData, sml::Agent* pAgent, char const* pMessage)
+		{
+			(*static_cast<std::stringstream*>(pUserData)) << pMessage;
+		};
+		agent->RegisterForPrintEvent(sml::smlEVENT_PRINT, lambda, trace[agentCounter]);
+	}
+
+	std::stringstream command;
+	command << "soar run-threads " << threads;
+	pKernel->GetAgentByIndex(0)->ExecuteCommandLine(command.str().c_str());
+	no_agent_assertTrue(pKernel->GetAgentByIndex(0)->GetLastCommandLineResult());
+
+	pKernel->RunAllAgentsForever();
+
+	for (int agentCounter = 0 ; agentCounter < numberAgents ; ++agentCounter)
+	{
+		traces.push_back(trace[agentCounter]->str());
+		sml::Agent* agent = pKernel->GetAgentByIndex(agentCounter);
+		decisions.push_back(agent->ExecuteCommandLine("stats --decision"));
+		decisions.back() += agent->ExecuteCommandLine("print --chunks");
+		delete trace[agentCounter];
+	}
+
+	pKernel->Shutdown() ;
+	delete pKernel ;
+}
+
+void MultiAgentTest::testRunThreads()
+{
+	numberAgents = 6;
+
+	std::vector< std::string > sequentialTraces, sequentialDecisions;
+	std::vector< std::string > parallelTraces, parallelDecisions;
+
+	runWithThreads(1, sequentialTraces, sequentialDecisions);
+	runWithThreads(4, parallelTraces, parallelDecisions);
+
+	for (int agentCounter = 0 ; agentCounter < numberAgents ; ++agentCounter)
+	{
+		if (agentCounter % 2)
+		{
+			no_agent_assertTrue_msg(sequentialTraces[agentCounter], sequentialTraces[agentCounter].find("picked ") != std::string::npos);
+			no_agent_assertTrue_msg(sequentialTraces[agentCounter], sequentialTraces[agentCounter].find("recalled two") != std::string::npos);
+			no_agent_assertTrue_msg(sequentialTraces[agentCounter], sequentialTraces[agentCounter].find("remembered ") != std::string::npos);
+			no_agent_assertTrue_msg(sequentialDecisions[agentCounter], sequentialDecisions[agentCounter].find("chunk*") != std::string::npos);
+		}
+		else
+		{
+			no_agent_assertTrue_msg(sequentialTraces[agentCounter], sequentialTraces[agentCounter].find("descended to 30") != std::string::npos);
+		}
+		no_agent_assertTrue_msg(sequentialTraces[agentCounter], sequentialTraces[agentCounter].find("O: O") != std::string::npos);
+		no_agent_assertEquals(sequentialDecisions[agentCounter], parallelDecisions[agentCounter]);
+		no_agent_assertTrue_msg(parallelTraces[agentCounter], sequentialTraces[agentCounter] == parallelTraces[agentCounter]);
+	}
+}
+
+void MultiAgentTest::testRunThreadsHandlerCommands()
+{
+	// A handler called while agents step on several threads can't send
+	// commands: the call has to fail rather than wait on the run forever.
+	for (int threads = 1 ; threads <= 2 ; ++threads)
+	{
+		pKernel = sml::Kernel::CreateKernelInCurrentThread(true, sml::Kernel::kUseAnyPort);
+		no_agent_assertTrue_msg(pKernel->GetLastErrorDescription(), !pKernel->HadError());
+
+		auto handler = [](sml::smlRhsEventId, void*, sml::Agent* pAgent, char const*, char const*) -> std::string
+		{
+			pAgent->ExecuteCommandLine("echo probe");
+			return pAgent->GetLastCommandLineResult() ? "sent" : "refused";
+		};
+		pKernel->AddRhsFunction("probe", handler, NULL);
+
+		std::vector< std::stringstream* > trace;
+		for (int agentCounter = 0 ; agentCounter < 2 ; ++agentCounter)
+		{
+			std::stringstream name;
+			name << "agent" << 1 + agentCounter;
+
+			sml::Agent* agent = pKernel->CreateAgent(name.str().c_str()) ;
+			assertTrue(agent != NULL);
+			agent->ExecuteCommandLine("sp {propose*probe (state <s> ^superstate nil -^probed) --> (<s> ^operator.name probe)}");
+			assertTrue(agent->GetLastCommandLineResult());
+			agent->ExecuteCommandLine("sp {apply*probe (state <s> ^operator.name probe) --> (<s> ^probed true) (write (exec probe))}");
+			assertTrue(agent->GetLastCommandLineResult());
+
+			trace.push_back(new std::stringstream());
+			auto lambda = [](sml::smlPrintEventId id, void* pUserData, sml::Agent* pAgent, char const* pMessage)
+			{
+				(*static_cast<std::stringstream*>(pUserData)) << pMessage;
+			};
+			agent->RegisterForPrintEvent(sml::smlEVENT_PRINT, lambda, trace[agentCounter]);
+		}
+
+		std::stringstream command;
+		command << "soar run-threads " << threads;
+		pKernel->GetAgentByIndex(0)->ExecuteCommandLine(command.str().c_str());
+		no_agent_assertTrue(pKernel->GetAgentByIndex(0)->GetLastCommandLineResult());
+
+		pKernel->RunAllAgents(2);
+
+		for (int agentCounter = 0 ; agentCounter < 2 ; ++agentCounter)
+		{
+			std::string expected = (threads == 1) ? "sent" : "refused";
+			no_agent_assertTrue_msg(trace[agentCounter]->str(), trace[agentCounter]->str().find(expected) != std::string::npos);
+			delete trace[agentCounter];
+		}
+
+		pKernel->Shutdown() ;
+		delete pKernel ;
+	}
+}
@@ -41,6 +41,12 @@ public:
 	TEST(testMaxAgents, -1)
 	void testMaxAgents();
 	
+	TEST(testRunThreads, -1)
+	void testRunThreads();
+	
+	TEST(testRunThreadsHandlerCommands, -1)
+	void testRunThreadsHandlerCommands();
+	
 private:
 	struct user_data_struct
 	{
@@ -60,6 +66,7 @@ private:
 	void createInput(sml::Agent* agent, int value);
 	void reportAgentStatus(sml::Kernel* pKernel, int numberAgents, std::vector< std::stringstream* >& trace);
 	void initAll(sml::Kernel* pKernel);
+	void runWithThreads(int threads, std::vector< std::string >& traces, std::vector< std::string >& decisions);
 	void UpdateInput(sml::Agent* agent, int value);
 	
 	static const int MAX_AGENTS;